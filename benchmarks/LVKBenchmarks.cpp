@@ -0,0 +1,449 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Headless microbenchmarks of the library hot paths. Results are written as JSON (to stdout or to the file passed via `--out`):
+//
+//   LVKBenchmarks [--out results.json] [--filter substring] [--repetitions N] [--device index]
+//
+// By default, the first discrete GPU is used, then the first integrated GPU, then any device.
+// Every benchmark runs `repetitions` times after one warm-up run; the reported times are nanoseconds per operation.
+
+#include <lvk/LVK.h>
+#include <lvk/vulkan/VulkanClasses.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* codeVS = R"(
+#version 460
+layout(push_constant) uniform constants {
+  uint index;
+} pc;
+void main() {
+  gl_Position = vec4(float(gl_VertexIndex & 1), float(gl_VertexIndex >> 1), float(pc.index) * 1e-9, 1.0);
+}
+)";
+
+const char* codeFS = R"(
+#version 460
+layout (constant_id = 0) const uint kSeed = 0;
+layout (location=0) out vec4 out_FragColor;
+void main() {
+  out_FragColor = vec4(float(kSeed) / 255.0, 0.0, 0.0, 1.0);
+}
+)";
+
+struct BenchmarkResult {
+  std::string name;
+  uint32_t numOps = 0; // per repetition
+  size_t bytesPerOp = 0;
+  std::vector<double> nsPerOp; // one value per repetition
+};
+
+struct Benchmark {
+  std::string name;
+  uint32_t numOps = 0;
+  size_t bytesPerOp = 0;
+  std::function<void()> setup; // not timed
+  std::function<void()> run; // timed
+  std::function<void()> teardown; // not timed
+};
+
+class Runner final {
+ public:
+  Runner(const char* filter, uint32_t repetitions) : filter_(filter), repetitions_(repetitions) {}
+
+  void run(const Benchmark& b) {
+    if (filter_ && !strstr(b.name.c_str(), filter_)) {
+      return;
+    }
+
+    fprintf(stderr, "%-40s", b.name.c_str());
+
+    BenchmarkResult r = {.name = b.name, .numOps = b.numOps, .bytesPerOp = b.bytesPerOp};
+
+    // the first repetition is a warm-up
+    for (uint32_t i = 0; i != repetitions_ + 1; i++) {
+      if (b.setup) {
+        b.setup();
+      }
+      const auto begin = std::chrono::steady_clock::now();
+      b.run();
+      const auto end = std::chrono::steady_clock::now();
+      if (b.teardown) {
+        b.teardown();
+      }
+      if (i) {
+        r.nsPerOp.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()) / b.numOps);
+      }
+    }
+
+    std::sort(r.nsPerOp.begin(), r.nsPerOp.end());
+
+    fprintf(stderr, " %12.1f ns/op (median)\n", getMedian(r));
+
+    results_.push_back(std::move(r));
+  }
+
+  static double getMedian(const BenchmarkResult& r) {
+    const size_t n = r.nsPerOp.size();
+    return n ? (n & 1 ? r.nsPerOp[n / 2] : 0.5 * (r.nsPerOp[n / 2 - 1] + r.nsPerOp[n / 2])) : 0.0;
+  }
+
+  void writeJSON(FILE* file, const lvk::HWDeviceDesc& device) const {
+    fprintf(file, "{\n");
+    fprintf(file, "  \"context\": {\n");
+    fprintf(file, "    \"device\": \"%s\",\n", getEscaped(device.name).c_str());
+    fprintf(file, "    \"deviceType\": %u,\n", (uint32_t)device.type);
+    fprintf(file, "    \"repetitions\": %u\n", repetitions_);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"benchmarks\": [");
+    for (size_t i = 0; i != results_.size(); i++) {
+      const BenchmarkResult& r = results_[i];
+      double mean = 0;
+      for (double v : r.nsPerOp) {
+        mean += v / r.nsPerOp.size();
+      }
+      const double median = getMedian(r);
+      fprintf(file, "%s\n    {\n", i ? "," : "");
+      fprintf(file, "      \"name\": \"%s\",\n", getEscaped(r.name.c_str()).c_str());
+      fprintf(file, "      \"ops\": %u,\n", r.numOps);
+      fprintf(file, "      \"unit\": \"ns/op\",\n");
+      fprintf(file, "      \"min\": %.2f,\n", r.nsPerOp.empty() ? 0.0 : r.nsPerOp.front());
+      fprintf(file, "      \"median\": %.2f,\n", median);
+      fprintf(file, "      \"mean\": %.2f,\n", mean);
+      fprintf(file, "      \"max\": %.2f", r.nsPerOp.empty() ? 0.0 : r.nsPerOp.back());
+      if (r.bytesPerOp && median > 0) {
+        fprintf(file, ",\n      \"bytesPerOp\": %zu,\n", r.bytesPerOp);
+        fprintf(file, "      \"MBps\": %.2f", double(r.bytesPerOp) / median * 1e9 / (1024.0 * 1024.0));
+      }
+      fprintf(file, "\n    }");
+    }
+    fprintf(file, "\n  ]\n}\n");
+  }
+
+ private:
+  static std::string getEscaped(const char* str) {
+    std::string out;
+    for (const char* c = str; *c; c++) {
+      if (*c == '"' || *c == '\\') {
+        out += '\\';
+      }
+      if ((unsigned char)*c >= 0x20) {
+        out += *c;
+      }
+    }
+    return out;
+  }
+
+ private:
+  const char* filter_ = nullptr;
+  uint32_t repetitions_ = 5;
+  std::vector<BenchmarkResult> results_;
+};
+
+// 1. acquireCommandBuffer() + submit() of empty command buffers, including the wait for the last one
+void addSubmitBenchmarks(Runner& runner, lvk::VulkanContext& ctx) {
+  const uint32_t kNumSubmits = 1000;
+
+  runner.run({
+      .name = "submit/empty",
+      .numOps = kNumSubmits,
+      .run =
+          [&ctx]() {
+            lvk::SubmitHandle handle;
+            for (uint32_t i = 0; i != kNumSubmits; i++) {
+              handle = ctx.submit(ctx.acquireCommandBuffer());
+            }
+            ctx.wait(handle);
+          },
+  });
+}
+
+// 2. upload() into a device-local buffer: many small vs. few large uploads of the same total size, flushed by one submit()
+void addUploadBenchmarks(Runner& runner, lvk::VulkanContext& ctx) {
+  const size_t kTotalSize = 4u * 1024u * 1024u;
+
+  auto buffer = std::make_shared<lvk::Holder<lvk::BufferHandle>>(ctx.createBuffer({
+      .usage = lvk::BufferUsageBits_Storage,
+      .storage = lvk::StorageType_Device,
+      .size = kTotalSize,
+      .debugName = "Buffer: benchmark uploads",
+  }));
+  auto data = std::make_shared<std::vector<uint8_t>>(kTotalSize, 0xAB);
+
+  for (size_t size : {size_t(256), size_t(4096), size_t(1024 * 1024)}) {
+    const uint32_t numUploads = uint32_t(kTotalSize / size);
+    runner.run({
+        .name = "upload/" + std::to_string(size) + "B",
+        .numOps = numUploads,
+        .bytesPerOp = size,
+        .run =
+            [&ctx, buffer, data, size, numUploads]() {
+              for (uint32_t i = 0; i != numUploads; i++) {
+                ctx.upload(*buffer, data->data() + i * size, size, i * size);
+              }
+              ctx.wait(ctx.submit(ctx.acquireCommandBuffer()));
+            },
+    });
+  }
+}
+
+// 3. checkAndUpdateDescriptorSets(): writing N new textures at once, and 1 new texture while N textures exist
+void addDescriptorBenchmarks(Runner& runner, lvk::VulkanContext& ctx) {
+  for (uint32_t numTextures : {256u, 1024u, 4096u}) {
+    auto textures = std::make_shared<std::vector<lvk::Holder<lvk::TextureHandle>>>();
+
+    auto createTextures = [&ctx, textures](uint32_t n) {
+      for (uint32_t i = 0; i != n; i++) {
+        textures->push_back(ctx.createTexture({
+            .format = lvk::Format_RGBA_UN8,
+            .dimensions = {1, 1},
+            .usage = lvk::TextureUsageBits_Sampled,
+            .debugName = "Texture: benchmark",
+        }));
+      }
+    };
+    auto destroyTextures = [&ctx, textures]() {
+      textures->clear();
+      ctx.checkAndUpdateDescriptorSets();
+    };
+
+    runner.run({
+        .name = "descriptors/update_all/" + std::to_string(numTextures),
+        .numOps = 1,
+        .setup = [createTextures, numTextures]() { createTextures(numTextures); },
+        .run = [&ctx]() { ctx.checkAndUpdateDescriptorSets(); },
+        .teardown = destroyTextures,
+    });
+
+    createTextures(numTextures);
+    ctx.checkAndUpdateDescriptorSets();
+
+    runner.run({
+        .name = "descriptors/update_one/" + std::to_string(numTextures),
+        .numOps = 1,
+        .setup = [createTextures]() { createTextures(1); },
+        .run = [&ctx]() { ctx.checkAndUpdateDescriptorSets(); },
+        .teardown =
+            [&ctx, textures]() {
+              textures->pop_back();
+              ctx.checkAndUpdateDescriptorSets();
+            },
+    });
+
+    destroyTextures();
+  }
+}
+
+// 4. getVkPipeline(): first use of new render pipelines (unique specialization constants bypass the VkPipelineCache) and lookups
+void addPipelineBenchmarks(Runner& runner, lvk::VulkanContext& ctx) {
+  auto vert = std::make_shared<lvk::Holder<lvk::ShaderModuleHandle>>(
+      ctx.createShaderModule({codeVS, lvk::Stage_Vert, "Shader Module: benchmark (vert)"}));
+  auto frag = std::make_shared<lvk::Holder<lvk::ShaderModuleHandle>>(
+      ctx.createShaderModule({codeFS, lvk::Stage_Frag, "Shader Module: benchmark (frag)"}));
+
+  const uint32_t kNumPipelines = 16;
+
+  // specialization data should be alive until the pipelines are compiled by getVkPipeline()
+  auto seeds = std::make_shared<std::vector<uint32_t>>();
+  auto pipelines = std::make_shared<std::vector<lvk::Holder<lvk::RenderPipelineHandle>>>();
+
+  runner.run({
+      .name = "pipeline/cold",
+      .numOps = kNumPipelines,
+      .setup =
+          [&ctx, vert, frag, seeds, pipelines]() {
+            seeds->resize(kNumPipelines);
+            for (uint32_t i = 0; i != kNumPipelines; i++) {
+              (*seeds)[i] = rand();
+              pipelines->push_back(ctx.createRenderPipeline({
+                  .smVert = *vert,
+                  .smFrag = *frag,
+                  .specInfo = {.entries = {{.constantId = 0, .size = sizeof(uint32_t)}},
+                               .data = &(*seeds)[i],
+                               .dataSize = sizeof(uint32_t)},
+                  .color = {{.format = lvk::Format_RGBA_UN8}},
+                  .debugName = "Pipeline: benchmark",
+              }));
+            }
+          },
+      .run =
+          [&ctx, pipelines]() {
+            for (const lvk::Holder<lvk::RenderPipelineHandle>& p : *pipelines) {
+              ctx.getVkPipeline(p);
+            }
+          },
+      .teardown = [pipelines]() { pipelines->clear(); },
+  });
+
+  const uint32_t kNumLookups = 100000;
+
+  auto pipeline = std::make_shared<lvk::Holder<lvk::RenderPipelineHandle>>(ctx.createRenderPipeline({
+      .smVert = *vert,
+      .smFrag = *frag,
+      .color = {{.format = lvk::Format_RGBA_UN8}},
+      .debugName = "Pipeline: benchmark",
+  }));
+
+  runner.run({
+      .name = "pipeline/warm",
+      .numOps = kNumLookups,
+      .run =
+          [&ctx, pipeline]() {
+            for (uint32_t i = 0; i != kNumLookups; i++) {
+              ctx.getVkPipeline(*pipeline);
+            }
+          },
+  });
+}
+
+// 5. recording draw calls into an offscreen render pass: redundant state only, and a push constant per draw
+void addDrawBenchmarks(Runner& runner, lvk::VulkanContext& ctx) {
+  auto vert = std::make_shared<lvk::Holder<lvk::ShaderModuleHandle>>(
+      ctx.createShaderModule({codeVS, lvk::Stage_Vert, "Shader Module: benchmark (vert)"}));
+  auto frag = std::make_shared<lvk::Holder<lvk::ShaderModuleHandle>>(
+      ctx.createShaderModule({codeFS, lvk::Stage_Frag, "Shader Module: benchmark (frag)"}));
+  auto pipeline = std::make_shared<lvk::Holder<lvk::RenderPipelineHandle>>(ctx.createRenderPipeline({
+      .smVert = *vert,
+      .smFrag = *frag,
+      .color = {{.format = lvk::Format_RGBA_UN8}},
+      .debugName = "Pipeline: benchmark",
+  }));
+  auto target = std::make_shared<lvk::Holder<lvk::TextureHandle>>(ctx.createTexture({
+      .format = lvk::Format_RGBA_UN8,
+      .dimensions = {256, 256},
+      .usage = lvk::TextureUsageBits_Attachment,
+      .debugName = "Texture: benchmark render target",
+  }));
+
+  const uint32_t kNumDraws = 10000;
+
+  for (bool pushConstants : {false, true}) {
+    auto buffer = std::make_shared<lvk::ICommandBuffer*>(nullptr);
+    runner.run({
+        .name = pushConstants ? "draw/record_push_constants" : "draw/record",
+        .numOps = kNumDraws,
+        .run =
+            [&ctx, pipeline, target, buffer, pushConstants]() {
+              lvk::ICommandBuffer& cmd = ctx.acquireCommandBuffer();
+              cmd.cmdBeginRendering({.color = {{.loadOp = lvk::LoadOp_Clear}}}, {.color = {{.texture = *target}}});
+              cmd.cmdBindRenderPipeline(*pipeline);
+              for (uint32_t i = 0; i != kNumDraws; i++) {
+                if (pushConstants) {
+                  cmd.cmdPushConstants(i);
+                }
+                cmd.cmdDraw(3);
+              }
+              cmd.cmdEndRendering();
+              *buffer = &cmd;
+            },
+        .teardown = [&ctx, buffer]() { ctx.wait(ctx.submit(**buffer)); },
+    });
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  minilog::initialize(nullptr, {.threadNames = false});
+
+  const char* outFileName = nullptr;
+  const char* filter = nullptr;
+  uint32_t repetitions = 5;
+  int deviceIndex = -1;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--out") && i + 1 < argc) {
+      outFileName = argv[++i];
+    } else if (!strcmp(argv[i], "--filter") && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (!strcmp(argv[i], "--repetitions") && i + 1 < argc) {
+      repetitions = std::max(atoi(argv[++i]), 1);
+    } else if (!strcmp(argv[i], "--device") && i + 1 < argc) {
+      deviceIndex = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: %s [--out results.json] [--filter substring] [--repetitions N] [--device index]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<lvk::HWDeviceDesc> devices(lvk::queryVulkanDevices(nullptr, 0));
+  lvk::queryVulkanDevices(devices.data(), (uint32_t)devices.size());
+
+  if (devices.empty() || deviceIndex >= (int)devices.size()) {
+    fprintf(stderr, "GPU is not found\n");
+    return 1;
+  }
+
+  if (deviceIndex < 0) {
+    for (lvk::HWDeviceType type : {lvk::HWDeviceType_Discrete, lvk::HWDeviceType_Integrated}) {
+      auto it = std::find_if(devices.begin(), devices.end(), [type](const lvk::HWDeviceDesc& d) { return d.type == type; });
+      if (deviceIndex < 0 && it != devices.end()) {
+        deviceIndex = int(it - devices.begin());
+      }
+    }
+    deviceIndex = std::max(deviceIndex, 0);
+  }
+
+  const lvk::HWDeviceDesc& device = devices[deviceIndex];
+
+  // validation layers would dominate the measurements; bindless capacity is reserved so that descriptor benchmarks do not
+  // include recreation of the descriptor set layout
+  std::unique_ptr<lvk::IContext> ctx = lvk::createVulkanContextHeadless(
+      {
+          .enableValidation = false,
+          .maxTextures = 8192,
+      },
+      device);
+
+  if (!ctx) {
+    fprintf(stderr, "Cannot initialize Vulkan context\n");
+    return 1;
+  }
+
+  fprintf(stderr, "Device: %s\n", device.name);
+
+  // checkAndUpdateDescriptorSets() and getVkPipeline() are not a part of IContext
+  lvk::VulkanContext& vkCtx = *static_cast<lvk::VulkanContext*>(ctx.get());
+
+  {
+    Runner runner(filter, repetitions);
+
+    addSubmitBenchmarks(runner, vkCtx);
+    addUploadBenchmarks(runner, vkCtx);
+    addDescriptorBenchmarks(runner, vkCtx);
+    addPipelineBenchmarks(runner, vkCtx);
+    addDrawBenchmarks(runner, vkCtx);
+
+    FILE* file = outFileName ? fopen(outFileName, "w") : stdout;
+
+    if (!file) {
+      fprintf(stderr, "Cannot open %s\n", outFileName);
+      return 1;
+    }
+
+    runner.writeJSON(file, device);
+
+    if (file != stdout) {
+      fclose(file);
+    }
+  }
+
+  ctx = nullptr;
+
+  return 0;
+}
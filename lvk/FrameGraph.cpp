@@ -0,0 +1,476 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "FrameGraph.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint16_t kWriteUsageBits = lvk::ResourceUsageBits_ColorAttachment | lvk::ResourceUsageBits_DepthStencilAttachment |
+                                     lvk::ResourceUsageBits_ShaderWriteGraphics | lvk::ResourceUsageBits_ShaderWriteCompute |
+                                     lvk::ResourceUsageBits_TransferDst;
+
+// usages within the same class share the image layout, so switching between them does not require a layout transition
+uint32_t getLayoutClass(uint16_t usage) {
+  if (usage & lvk::ResourceUsageBits_ColorAttachment) {
+    return 1;
+  }
+  if (usage & lvk::ResourceUsageBits_DepthStencilAttachment) {
+    return 2;
+  }
+  if (usage & (lvk::ResourceUsageBits_ShaderReadGraphics | lvk::ResourceUsageBits_ShaderReadCompute)) {
+    return 3;
+  }
+  if (usage & (lvk::ResourceUsageBits_ShaderWriteGraphics | lvk::ResourceUsageBits_ShaderWriteCompute)) {
+    return 4;
+  }
+  if (usage & lvk::ResourceUsageBits_TransferSrc) {
+    return 5;
+  }
+  if (usage & lvk::ResourceUsageBits_TransferDst) {
+    return 6;
+  }
+  return 0;
+}
+
+bool isSameTextureDesc(const lvk::TextureDesc& a, const lvk::TextureDesc& b) {
+  return a.type == b.type && a.format == b.format && a.dimensions.width == b.dimensions.width &&
+         a.dimensions.height == b.dimensions.height && a.dimensions.depth == b.dimensions.depth && a.numLayers == b.numLayers &&
+         a.numSamples == b.numSamples && a.usage == b.usage && a.numMipLevels == b.numMipLevels && a.storage == b.storage &&
+         a.swizzle.r == b.swizzle.r && a.swizzle.g == b.swizzle.g && a.swizzle.b == b.swizzle.b && a.swizzle.a == b.swizzle.a;
+}
+
+} // namespace
+
+lvk::FrameGraph::ResourceId lvk::FrameGraph::PassBuilder::read(ResourceId resource, uint16_t usage) {
+  return graph_.addAccess(pass_, resource, usage, false);
+}
+
+lvk::FrameGraph::ResourceId lvk::FrameGraph::PassBuilder::write(ResourceId resource, uint16_t usage) {
+  return graph_.addAccess(pass_, resource, usage, true);
+}
+
+void lvk::FrameGraph::PassBuilder::setSideEffect() {
+  graph_.passes_[pass_].hasSideEffect = true;
+}
+
+void lvk::FrameGraph::reset() {
+  passes_.clear();
+  resources_.clear();
+  finalTextureBarriers_.clear();
+  finalBufferBarriers_.clear();
+  numCulledPasses_ = 0;
+  isCompiled_ = false;
+}
+
+lvk::FrameGraph::ResourceId lvk::FrameGraph::importTexture(const char* name,
+                                                           TextureHandle texture,
+                                                           uint16_t initialUsage,
+                                                           uint16_t finalUsage) {
+  LVK_ASSERT(!texture.empty());
+
+  resources_.push_back({
+      .name = name,
+      .texture = texture,
+      .isImported = true,
+      .initialUsage = initialUsage,
+      .finalUsage = finalUsage,
+  });
+
+  isCompiled_ = false;
+
+  return ResourceId(resources_.size() - 1);
+}
+
+lvk::FrameGraph::ResourceId lvk::FrameGraph::importBuffer(const char* name, BufferHandle buffer, uint16_t initialUsage, uint16_t finalUsage) {
+  LVK_ASSERT(!buffer.empty());
+
+  resources_.push_back({
+      .name = name,
+      .buffer = buffer,
+      .isImported = true,
+      .initialUsage = initialUsage,
+      .finalUsage = finalUsage,
+  });
+
+  isCompiled_ = false;
+
+  return ResourceId(resources_.size() - 1);
+}
+
+lvk::FrameGraph::ResourceId lvk::FrameGraph::createTexture(const char* name, const TextureDesc& desc) {
+  LVK_ASSERT_MSG(!desc.data, "Transient textures cannot have initial data");
+  LVK_ASSERT_MSG(desc.aliasOf.empty(), "Memory aliasing of transient textures is managed by the frame graph");
+
+  resources_.push_back({
+      .name = name,
+      .desc = desc,
+  });
+  resources_.back().desc.debugName = name;
+
+  isCompiled_ = false;
+
+  return ResourceId(resources_.size() - 1);
+}
+
+void lvk::FrameGraph::addPass(const char* name, const SetupFunc& setup, ExecuteFunc&& execute) {
+  passes_.push_back({
+      .name = name,
+      .execute = std::move(execute),
+  });
+
+  if (setup) {
+    PassBuilder builder(*this, uint32_t(passes_.size() - 1));
+    setup(builder);
+  }
+
+  isCompiled_ = false;
+}
+
+lvk::FrameGraph::ResourceId lvk::FrameGraph::addAccess(uint32_t pass, ResourceId resource, uint16_t usage, bool isWrite) {
+  if (!LVK_VERIFY(resource < resources_.size())) {
+    return kInvalidResource;
+  }
+
+  LVK_ASSERT_MSG(usage, "Resource usage cannot be 0");
+
+  std::vector<Access>& accesses = passes_[pass].accesses;
+
+  auto it = std::find_if(accesses.begin(), accesses.end(), [resource](const Access& a) { return a.resource == resource; });
+
+  if (it == accesses.end()) {
+    accesses.push_back({.resource = resource});
+    it = accesses.end() - 1;
+  }
+
+  it->usage |= usage;
+  it->isRead |= !isWrite;
+  it->isWrite |= isWrite;
+
+  return resource;
+}
+
+uint32_t lvk::FrameGraph::acquireTransientTexture(const TextureDesc& desc, uint32_t firstPass, uint32_t lastPass) {
+  // passes are processed in order: everything which is not busy at `firstPass` can be reused
+  auto isFree = [firstPass](const TransientMemory& m) { return m.busyUntilPass == ~0u || m.busyUntilPass < firstPass; };
+
+  // 1. an existing texture with the same description
+  for (uint32_t i = 0; i != transientTextures_.size(); i++) {
+    const TransientTexture& t = transientTextures_[i];
+    if (isFree(transientMemory_[t.memory]) && isSameTextureDesc(t.desc, desc)) {
+      transientMemory_[t.memory].busyUntilPass = lastPass;
+      transientTextures_[i].lastUsedFrame = frameIndex_;
+      return i;
+    }
+  }
+
+  TransientTexture t;
+  t.desc = desc;
+  t.lastUsedFrame = frameIndex_;
+
+  // 2. a new texture aliasing free memory which is large enough
+  if (desc.storage == StorageType_Device) {
+    for (uint32_t m = 0; m != transientMemory_.size() && t.texture.empty(); m++) {
+      if (isFree(transientMemory_[m])) {
+        TextureDesc aliasDesc = desc;
+        aliasDesc.aliasOf = transientMemory_[m].owner;
+        // fails if the memory is too small or incompatible
+        t.texture = ctx_.createTexture(aliasDesc, desc.debugName);
+        t.memory = m;
+      }
+    }
+  }
+
+  // 3. a new texture with its own memory
+  if (t.texture.empty()) {
+    t.texture = ctx_.createTexture(desc, desc.debugName);
+    t.memory = (uint32_t)transientMemory_.size();
+    transientMemory_.push_back({.owner = t.texture});
+  }
+
+  LVK_ASSERT(t.texture.valid());
+
+  transientMemory_[t.memory].busyUntilPass = lastPass;
+  transientTextures_.push_back(std::move(t));
+
+  return uint32_t(transientTextures_.size() - 1);
+}
+
+void lvk::FrameGraph::evictTransientTextures() {
+  auto isStale = [this](uint32_t lastUsedFrame) { return frameIndex_ - lastUsedFrame > kMaxUnusedFrames; };
+
+  // memory is in use as long as any texture placed into it is in use
+  std::vector<uint32_t> memoryLastUsedFrame(transientMemory_.size(), 0);
+
+  for (const TransientTexture& t : transientTextures_) {
+    memoryLastUsedFrame[t.memory] = std::max(memoryLastUsedFrame[t.memory], t.lastUsedFrame);
+  }
+
+  // the owner of the memory is needed to create new aliases, so it goes away only together with the memory; the memory itself is
+  // kept alive by the remaining aliases until they are destroyed
+  std::erase_if(transientTextures_, [&](const TransientTexture& t) {
+    const bool isOwner = transientMemory_[t.memory].owner == t.texture;
+    return isStale(t.lastUsedFrame) && (!isOwner || isStale(memoryLastUsedFrame[t.memory]));
+  });
+
+  std::vector<uint32_t> remap(transientMemory_.size(), ~0u);
+  uint32_t numMemory = 0;
+
+  for (uint32_t m = 0; m != transientMemory_.size(); m++) {
+    if (!isStale(memoryLastUsedFrame[m])) {
+      remap[m] = numMemory;
+      transientMemory_[numMemory++] = transientMemory_[m];
+    }
+  }
+
+  transientMemory_.resize(numMemory);
+
+  for (TransientTexture& t : transientTextures_) {
+    t.memory = remap[t.memory];
+    LVK_ASSERT(t.memory != ~0u);
+  }
+}
+
+void lvk::FrameGraph::compile() {
+  LVK_PROFILER_FUNCTION();
+
+  frameIndex_++;
+
+  const uint32_t numPasses = (uint32_t)passes_.size();
+
+  // 1. cull passes: walking backwards, a pass survives if it has side effects or writes something needed later
+  {
+    std::vector<bool> isNeeded(resources_.size());
+
+    for (uint32_t r = 0; r != resources_.size(); r++) {
+      isNeeded[r] = resources_[r].isImported;
+    }
+
+    numCulledPasses_ = 0;
+
+    for (uint32_t p = numPasses; p-- > 0;) {
+      Pass& pass = passes_[p];
+
+      pass.isCulled = !pass.hasSideEffect && std::none_of(pass.accesses.begin(), pass.accesses.end(), [&isNeeded](const Access& a) {
+        return a.isWrite && isNeeded[a.resource];
+      });
+
+      if (pass.isCulled) {
+        numCulledPasses_++;
+        continue;
+      }
+
+      for (const Access& a : pass.accesses) {
+        if (a.isRead) {
+          isNeeded[a.resource] = true;
+        }
+      }
+    }
+  }
+
+  // 2. lifetimes of transient textures: map them onto physical textures and memory, reusing what is no longer needed
+  for (Resource& r : resources_) {
+    r.firstPass = ~0u;
+    r.lastPass = 0;
+    if (!r.isImported) {
+      r.texture = {};
+      r.transientTexture = ~0u;
+    }
+  }
+
+  for (uint32_t p = 0; p != numPasses; p++) {
+    if (passes_[p].isCulled) {
+      continue;
+    }
+    for (const Access& a : passes_[p].accesses) {
+      Resource& r = resources_[a.resource];
+      r.firstPass = std::min(r.firstPass, p);
+      r.lastPass = std::max(r.lastPass, p);
+    }
+  }
+
+  evictTransientTextures();
+
+  for (TransientMemory& m : transientMemory_) {
+    m.busyUntilPass = ~0u;
+  }
+
+  for (uint32_t p = 0; p != numPasses; p++) {
+    for (const Access& a : passes_[p].accesses) {
+      Resource& r = resources_[a.resource];
+      if (!r.isImported && r.firstPass == p) {
+        r.transientTexture = acquireTransientTexture(r.desc, r.firstPass, r.lastPass);
+        r.texture = transientTextures_[r.transientTexture].texture;
+      }
+    }
+  }
+
+  // 3. barriers: track the state of every physical resource and merge all transitions of a pass; aliases share the state of
+  // their memory so that the first use of a texture waits for the previous one in the same memory
+  std::vector<SyncState> importedStates(resources_.size());
+  std::vector<SyncState> transientStates(transientMemory_.size());
+
+  for (uint32_t r = 0; r != resources_.size(); r++) {
+    const Resource& res = resources_[r];
+    if (res.isImported) {
+      SyncState& s = importedStates[r];
+      s.writeUsage = res.initialUsage & kWriteUsageBits ? res.initialUsage : 0;
+      s.readUsage = res.initialUsage & kWriteUsageBits ? 0 : res.initialUsage;
+      s.layoutUsage = res.initialUsage;
+    }
+  }
+  for (uint32_t i = 0; i != transientMemory_.size(); i++) {
+    // wait for the accesses of the previous frame
+    transientStates[i].writeUsage = transientMemory_[i].lastUsage;
+  }
+
+  // returns true if `usage` needs a barrier and updates the state
+  auto transition = [](SyncState& s, uint16_t usage, bool isTexture, bool discard, uint16_t* outSrcUsage) -> bool {
+    const bool isWriting = (usage & kWriteUsageBits) != 0;
+    const bool layoutChange =
+        isTexture && (discard || !s.layoutUsage || getLayoutClass(s.layoutUsage) != getLayoutClass(usage));
+
+    uint16_t src = 0;
+    bool needBarrier = layoutChange;
+
+    if (isWriting || layoutChange) {
+      // write-after-write, write-after-read, or a layout transition: wait for everything
+      src = s.writeUsage | s.readUsage;
+      needBarrier |= src != 0;
+    } else if (s.writeUsage && (usage & ~s.syncedReadUsage)) {
+      // read-after-write by stages which have not waited for the write yet
+      src = s.writeUsage;
+      needBarrier = true;
+    }
+
+    if (isWriting) {
+      s.writeUsage = usage;
+      s.readUsage = 0;
+      s.syncedReadUsage = 0;
+    } else if (layoutChange) {
+      s.readUsage = usage;
+      s.syncedReadUsage = usage;
+    } else {
+      s.readUsage |= usage;
+      s.syncedReadUsage |= needBarrier ? usage : 0;
+    }
+
+    if (isTexture) {
+      s.layoutUsage = usage;
+    }
+
+    *outSrcUsage = src;
+
+    return needBarrier;
+  };
+
+  for (uint32_t p = 0; p != numPasses; p++) {
+    Pass& pass = passes_[p];
+
+    pass.textureBarriers.clear();
+    pass.bufferBarriers.clear();
+
+    if (pass.isCulled) {
+      continue;
+    }
+
+    for (const Access& a : pass.accesses) {
+      const Resource& r = resources_[a.resource];
+      const bool isTransient = r.transientTexture != ~0u;
+      SyncState& s = isTransient ? transientStates[transientTextures_[r.transientTexture].memory] : importedStates[a.resource];
+      const bool discard = isTransient && r.firstPass == p;
+
+      uint16_t srcUsage = 0;
+
+      if (!transition(s, a.usage, !r.texture.empty(), discard, &srcUsage)) {
+        continue;
+      }
+
+      if (r.texture.valid()) {
+        pass.textureBarriers.push_back({.texture = r.texture, .srcUsage = srcUsage, .dstUsage = a.usage, .discardContents = discard});
+      } else {
+        pass.bufferBarriers.push_back({.buffer = r.buffer, .srcUsage = srcUsage, .dstUsage = a.usage});
+      }
+    }
+  }
+
+  finalTextureBarriers_.clear();
+  finalBufferBarriers_.clear();
+
+  for (uint32_t r = 0; r != resources_.size(); r++) {
+    const Resource& res = resources_[r];
+
+    if (!res.isImported || !res.finalUsage) {
+      continue;
+    }
+
+    uint16_t srcUsage = 0;
+
+    if (!transition(importedStates[r], res.finalUsage, res.texture.valid(), false, &srcUsage)) {
+      continue;
+    }
+
+    if (res.texture.valid()) {
+      finalTextureBarriers_.push_back({.texture = res.texture, .srcUsage = srcUsage, .dstUsage = res.finalUsage});
+    } else {
+      finalBufferBarriers_.push_back({.buffer = res.buffer, .srcUsage = srcUsage, .dstUsage = res.finalUsage});
+    }
+  }
+
+  for (uint32_t i = 0; i != transientMemory_.size(); i++) {
+    const SyncState& s = transientStates[i];
+    transientMemory_[i].lastUsage = s.writeUsage | s.readUsage;
+  }
+
+  isCompiled_ = true;
+}
+
+void lvk::FrameGraph::execute(lvk::ICommandBuffer& cmdBuffer) const {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT_MSG(isCompiled_, "Call FrameGraph::compile() before FrameGraph::execute()");
+
+  for (const Pass& pass : passes_) {
+    if (pass.isCulled) {
+      continue;
+    }
+
+    if (!pass.textureBarriers.empty() || !pass.bufferBarriers.empty()) {
+      cmdBuffer.cmdPipelineBarrier(pass.textureBarriers.data(),
+                                   (uint32_t)pass.textureBarriers.size(),
+                                   pass.bufferBarriers.data(),
+                                   (uint32_t)pass.bufferBarriers.size());
+    }
+
+    cmdBuffer.cmdPushDebugGroupLabel(pass.name);
+    if (pass.execute) {
+      pass.execute(cmdBuffer, *this);
+    }
+    cmdBuffer.cmdPopDebugGroupLabel();
+  }
+
+  if (!finalTextureBarriers_.empty() || !finalBufferBarriers_.empty()) {
+    cmdBuffer.cmdPipelineBarrier(finalTextureBarriers_.data(),
+                                 (uint32_t)finalTextureBarriers_.size(),
+                                 finalBufferBarriers_.data(),
+                                 (uint32_t)finalBufferBarriers_.size());
+  }
+}
+
+lvk::TextureHandle lvk::FrameGraph::getTexture(ResourceId resource) const {
+  LVK_ASSERT(resource < resources_.size());
+  LVK_ASSERT_MSG(isCompiled_, "Transient textures are allocated by FrameGraph::compile()");
+
+  return resource < resources_.size() ? resources_[resource].texture : TextureHandle{};
+}
+
+lvk::BufferHandle lvk::FrameGraph::getBuffer(ResourceId resource) const {
+  LVK_ASSERT(resource < resources_.size());
+
+  return resource < resources_.size() ? resources_[resource].buffer : BufferHandle{};
+}
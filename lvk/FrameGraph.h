@@ -0,0 +1,146 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <lvk/LVK.h>
+
+#include <functional>
+#include <vector>
+
+namespace lvk {
+
+// Optional frame graph on top of IContext/ICommandBuffer:
+//   - passes declare the resources they read and write;
+//   - passes which do not contribute to imported resources (and have no side effects) are culled;
+//   - transient textures with non-overlapping lifetimes share the same TextureHandle (identical descriptions) or alias the same
+//     memory (see TextureDesc::aliasOf);
+//   - all transitions required by a pass are merged into one ICommandBuffer::cmdPipelineBarrier().
+// Every frame: reset(), import/create resources, addPass()..., compile(), execute(). Names should outlive execute().
+class FrameGraph final {
+ public:
+  using ResourceId = uint32_t;
+  enum : ResourceId { kInvalidResource = ~0u };
+  enum { kMaxUnusedFrames = 2 };
+
+  class PassBuilder final {
+   public:
+    // `usage` is a combination of ResourceUsageBits; read() and write() return `resource` so they can be chained
+    ResourceId read(ResourceId resource, uint16_t usage);
+    ResourceId write(ResourceId resource, uint16_t usage);
+    // the pass is never culled
+    void setSideEffect();
+
+   private:
+    friend class FrameGraph;
+    PassBuilder(FrameGraph& graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+
+    FrameGraph& graph_;
+    uint32_t pass_ = 0;
+  };
+
+  using SetupFunc = std::function<void(PassBuilder& builder)>;
+  using ExecuteFunc = std::function<void(lvk::ICommandBuffer& cmdBuffer, const FrameGraph& graph)>;
+
+  explicit FrameGraph(lvk::IContext& ctx) : ctx_(ctx) {}
+
+  // forget all passes and resources; transient textures are kept for the next frame (textures which have not been used by the
+  // last kMaxUnusedFrames compiled frames are destroyed, e.g. after a resize)
+  void reset();
+
+  // `initialUsage` is how the resource was accessed before execute() (0 if there are no accesses to wait for)
+  // `finalUsage` is the state the resource is left in after execute() (0 leaves it in the state of the last pass)
+  ResourceId importTexture(const char* name, TextureHandle texture, uint16_t initialUsage = 0, uint16_t finalUsage = 0);
+  ResourceId importBuffer(const char* name, BufferHandle buffer, uint16_t initialUsage = 0, uint16_t finalUsage = 0);
+  // transient textures are owned by the graph and their contents are undefined at their first use in every frame
+  ResourceId createTexture(const char* name, const TextureDesc& desc);
+
+  void addPass(const char* name, const SetupFunc& setup, ExecuteFunc&& execute);
+
+  void compile();
+  void execute(lvk::ICommandBuffer& cmdBuffer) const;
+
+  [[nodiscard]] TextureHandle getTexture(ResourceId resource) const;
+  [[nodiscard]] BufferHandle getBuffer(ResourceId resource) const;
+  [[nodiscard]] uint32_t getNumPasses() const {
+    return (uint32_t)passes_.size();
+  }
+  [[nodiscard]] uint32_t getNumCulledPasses() const {
+    return numCulledPasses_;
+  }
+
+ private:
+  struct Access {
+    ResourceId resource = kInvalidResource;
+    uint16_t usage = 0;
+    bool isRead = false; // data flow (culling); synchronization depends only on `usage`
+    bool isWrite = false;
+  };
+
+  struct Pass {
+    const char* name = "";
+    ExecuteFunc execute;
+    std::vector<Access> accesses;
+    bool hasSideEffect = false;
+    bool isCulled = false;
+    std::vector<TextureBarrier> textureBarriers;
+    std::vector<BufferBarrier> bufferBarriers;
+  };
+
+  struct Resource {
+    const char* name = "";
+    TextureHandle texture;
+    BufferHandle buffer;
+    bool isImported = false;
+    uint16_t initialUsage = 0;
+    uint16_t finalUsage = 0;
+    TextureDesc desc = {}; // transient textures
+    uint32_t transientTexture = ~0u; // index into `transientTextures_`
+    uint32_t firstPass = ~0u;
+    uint32_t lastPass = 0;
+  };
+
+  struct TransientTexture {
+    TextureDesc desc = {};
+    lvk::Holder<lvk::TextureHandle> texture;
+    uint32_t memory = 0; // index into `transientMemory_`
+    uint32_t lastUsedFrame = 0; // `frameIndex_` of the last compile() which used this texture
+  };
+
+  // all textures placed into the same memory alias each other: at most one of them is alive at any pass
+  struct TransientMemory {
+    TextureHandle owner; // the first texture created in this memory
+    uint32_t busyUntilPass = ~0u; // ~0u if free
+    uint16_t lastUsage = 0; // from the previous frame
+  };
+
+  // synchronization state of a physical resource (transient memory or imported resource) while barriers are computed
+  struct SyncState {
+    uint16_t writeUsage = 0; // the last write (0 if it has been made visible to all subsequent readers)
+    uint16_t readUsage = 0; // all reads since the last write
+    uint16_t syncedReadUsage = 0; // reads which already wait for `writeUsage`
+    uint16_t layoutUsage = 0; // the usage which defined the current image layout (0 if unknown)
+  };
+
+  ResourceId addAccess(uint32_t pass, ResourceId resource, uint16_t usage, bool isWrite);
+  uint32_t acquireTransientTexture(const TextureDesc& desc, uint32_t firstPass, uint32_t lastPass);
+  void evictTransientTextures();
+
+ private:
+  lvk::IContext& ctx_;
+  std::vector<Pass> passes_;
+  std::vector<Resource> resources_;
+  std::vector<TransientTexture> transientTextures_;
+  std::vector<TransientMemory> transientMemory_;
+  std::vector<TextureBarrier> finalTextureBarriers_;
+  std::vector<BufferBarrier> finalBufferBarriers_;
+  uint32_t numCulledPasses_ = 0;
+  uint32_t frameIndex_ = 0; // incremented by every compile()
+  bool isCompiled_ = false;
+};
+
+} // namespace lvk
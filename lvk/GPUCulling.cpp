@@ -0,0 +1,415 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "GPUCulling.h"
+#include "ShaderBindings.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace {
+
+// mip-level 0 is a copy of the depth buffer; every next level keeps the farthest depth of the texels it covers
+const char* kCodeDepthReduce = R"(
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+layout (set = 0, binding = 0) uniform texture2D kTextures2D[];
+layout (set = 0, binding = 1) uniform sampler kSamplers[];
+layout (set = 0, binding = )" LVK_STORAGE_IMAGES_BINDING R"(, r32f) uniform image2D kTextures2DInOut[];
+
+layout(push_constant) uniform constants {
+  uint src;
+  uint dst;
+  uint width;
+  uint height;
+  uint isSrcDepth;
+} pc;
+
+void main() {
+  ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+
+  if (pos.x >= pc.width || pos.y >= pc.height)
+    return;
+
+  float depth = 0.0;
+
+  if (pc.isSrcDepth != 0) {
+    depth = texelFetch(sampler2D(kTextures2D[pc.src], kSamplers[0]), pos, 0).r;
+  } else {
+    ivec2 srcSize = imageSize(kTextures2DInOut[pc.src]);
+    ivec2 p0 = 2 * pos;
+    // with odd source dimensions, the last row and column cover the remaining source texels as well
+    ivec2 p1 = ivec2(pos.x == pc.width - 1 ? srcSize.x - 1 : p0.x + 1, pos.y == pc.height - 1 ? srcSize.y - 1 : p0.y + 1);
+    p1 = min(p1, srcSize - 1);
+    for (int y = p0.y; y <= p1.y; y++) {
+      for (int x = p0.x; x <= p1.x; x++) {
+        depth = max(depth, imageLoad(kTextures2DInOut[pc.src], ivec2(x, y)).r);
+      }
+    }
+  }
+
+  imageStore(kTextures2DInOut[pc.dst], pos, vec4(depth));
+}
+)";
+
+const char* kCodeCull = R"(
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+layout (set = 0, binding = 0) uniform texture2D kTextures2D[];
+layout (set = 0, binding = 1) uniform sampler kSamplers[];
+
+struct Cluster {
+  vec4 sphere; // center, radius
+  vec4 cone; // axis, cutoff
+  uint indexCount;
+  uint firstIndex;
+  int vertexOffset;
+  uint baseInstance;
+};
+
+struct DrawCommand {
+  uint indexCount;
+  uint instanceCount;
+  uint firstIndex;
+  int vertexOffset;
+  uint baseInstance;
+};
+
+layout(std430, buffer_reference) readonly buffer Clusters {
+  Cluster clusters[];
+};
+
+layout(std430, buffer_reference) writeonly buffer DrawCommands {
+  DrawCommand commands[];
+};
+
+layout(std430, buffer_reference) buffer DrawCount {
+  uint drawCount;
+};
+
+layout(push_constant) uniform constants {
+  mat4 viewProj;
+  vec4 cameraPos;
+  Clusters clusters;
+  DrawCommands commands;
+  DrawCount count;
+  uint numClusters;
+  uint depthPyramid; // 0 if occlusion culling is disabled
+} pc;
+
+bool isInsideFrustum(vec3 center, float radius) {
+  // https://www.gamedevs.org/uploads/fast-extraction-viewing-frustum-planes-from-world-view-projection-matrix.pdf
+  mat4 m = transpose(pc.viewProj);
+  vec4 planes[6] = vec4[6](m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[2], m[3] - m[2]);
+  for (int i = 0; i != 6; i++) {
+    if (dot(planes[i].xyz, center) + planes[i].w < -radius * length(planes[i].xyz))
+      return false;
+  }
+  return true;
+}
+
+bool isBackfacing(vec3 center, float radius, vec4 cone) {
+  // https://github.com/zeux/meshoptimizer#clusterization
+  vec3 dir = center - pc.cameraPos.xyz;
+  return cone.w < 1.0 && dot(dir, cone.xyz) >= cone.w * length(dir) + radius;
+}
+
+float fetchDepth(ivec2 pos, int lod) {
+  return texelFetch(sampler2D(kTextures2D[pc.depthPyramid], kSamplers[0]), pos, lod).r;
+}
+
+bool isOccluded(vec3 center, float radius) {
+  vec2 minUV = vec2(1.0);
+  vec2 maxUV = vec2(0.0);
+  float minZ = 1.0;
+
+  // the screen-space rectangle and the nearest depth of the bounding box
+  for (int i = 0; i != 8; i++) {
+    vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+    vec4 clip = pc.viewProj * vec4(corner, 1.0);
+    if (clip.w <= 0.0)
+      return false; // intersects the camera plane
+    vec3 ndc = clip.xyz / clip.w;
+    minUV = min(minUV, ndc.xy * 0.5 + 0.5);
+    maxUV = max(maxUV, ndc.xy * 0.5 + 0.5);
+    minZ = min(minZ, ndc.z);
+  }
+
+  minUV = clamp(minUV, vec2(0.0), vec2(1.0));
+  maxUV = clamp(maxUV, vec2(0.0), vec2(1.0));
+
+  ivec2 size = textureSize(sampler2D(kTextures2D[pc.depthPyramid], kSamplers[0]), 0);
+  int numLevels = textureQueryLevels(sampler2D(kTextures2D[pc.depthPyramid], kSamplers[0]));
+
+  ivec2 p0 = min(ivec2(minUV * vec2(size)), size - 1);
+  ivec2 p1 = min(ivec2(maxUV * vec2(size)), size - 1);
+
+  // the lowest mip-level where the rectangle covers at most 2x2 texels
+  ivec2 extent = p1 - p0 + 1;
+  int lod = min(int(ceil(log2(float(max(extent.x, extent.y))))), numLevels - 1);
+
+  // a texel (x, y) of mip-level `lod` covers texels of mip-level 0 starting at (x << lod, y << lod); the last row and column of
+  // every mip-level cover the remaining texels as well
+  ivec2 levelSize = max(size >> lod, ivec2(1));
+  p0 = min(p0 >> lod, levelSize - 1);
+  p1 = min(p1 >> lod, levelSize - 1);
+
+  float depth = max(max(fetchDepth(p0, lod), fetchDepth(ivec2(p1.x, p0.y), lod)),
+                    max(fetchDepth(ivec2(p0.x, p1.y), lod), fetchDepth(p1, lod)));
+
+  return minZ > depth;
+}
+
+void main() {
+  uint idx = gl_GlobalInvocationID.x;
+
+  if (idx >= pc.numClusters)
+    return;
+
+  Cluster c = pc.clusters.clusters[idx];
+
+  vec3 center = c.sphere.xyz;
+  float radius = c.sphere.w;
+
+  if (!isInsideFrustum(center, radius) || isBackfacing(center, radius, c.cone))
+    return;
+
+  if (pc.depthPyramid != 0 && isOccluded(center, radius))
+    return;
+
+  uint slot = atomicAdd(pc.count.drawCount, 1);
+
+  pc.commands.commands[slot] = DrawCommand(c.indexCount, 1, c.firstIndex, c.vertexOffset, c.baseInstance);
+}
+)";
+
+} // namespace
+
+lvk::GPUCulling::GPUCulling(lvk::IContext& ctx) : ctx_(ctx) {
+  LVK_PROFILER_FUNCTION();
+
+  smDepthReduce_ = ctx_.createShaderModule({kCodeDepthReduce, lvk::Stage_Comp, "Shader Module: depth pyramid (comp)"});
+  smCull_ = ctx_.createShaderModule({kCodeCull, lvk::Stage_Comp, "Shader Module: GPU culling (comp)"});
+
+  pipelineDepthReduce_ = ctx_.createComputePipeline({.smComp = smDepthReduce_, .debugName = "Pipeline: depth pyramid"});
+  pipelineCull_ = ctx_.createComputePipeline({.smComp = smCull_, .debugName = "Pipeline: GPU culling"});
+}
+
+lvk::Result lvk::GPUCulling::setClusters(const GPUCullingCluster* clusters, uint32_t numClusters) {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(clusters && numClusters)) {
+    return Result(Result::Code::ArgumentOutOfRange, "No clusters");
+  }
+
+  numClusters_ = 0;
+
+  Result result;
+
+  clusters_ = ctx_.createBuffer(
+      {
+          .usage = lvk::BufferUsageBits_Storage,
+          .storage = lvk::StorageType_Device,
+          .size = sizeof(GPUCullingCluster) * numClusters,
+          .data = clusters,
+          .debugName = "Buffer: GPU culling clusters",
+      },
+      &result);
+
+  if (!result.isOk()) {
+    return result;
+  }
+
+  // VkDrawIndexedIndirectCommand
+  drawCommands_ = ctx_.createBuffer(
+      {
+          .usage = lvk::BufferUsageBits_Storage | lvk::BufferUsageBits_Indirect,
+          .storage = lvk::StorageType_Device,
+          .size = sizeof(uint32_t) * 5 * numClusters,
+          .debugName = "Buffer: GPU culling draw commands",
+      },
+      &result);
+
+  if (!result.isOk()) {
+    return result;
+  }
+
+  drawCount_ = ctx_.createBuffer(
+      {
+          .usage = lvk::BufferUsageBits_Storage | lvk::BufferUsageBits_Indirect,
+          .storage = lvk::StorageType_Device,
+          .size = sizeof(uint32_t),
+          .debugName = "Buffer: GPU culling draw count",
+      },
+      &result);
+
+  if (!result.isOk()) {
+    return result;
+  }
+
+  numClusters_ = numClusters;
+
+  return Result();
+}
+
+void lvk::GPUCulling::createDepthPyramid(const Dimensions& dim) {
+  LVK_PROFILER_FUNCTION();
+
+  depthPyramidSize_ = {dim.width, dim.height, 1};
+  depthPyramidNumMipLevels_ = std::min(lvk::calcNumMipLevels(dim.width, dim.height), (uint32_t)LVK_ARRAY_NUM_ELEMENTS(depthPyramidMips_));
+  isDepthPyramidValid_ = false;
+
+  for (lvk::Holder<lvk::TextureHandle>& mip : depthPyramidMips_) {
+    mip = nullptr;
+  }
+
+  depthPyramid_ = ctx_.createTexture({
+      .type = lvk::TextureType_2D,
+      .format = lvk::Format_R_F32,
+      .dimensions = depthPyramidSize_,
+      .usage = lvk::TextureUsageBits_Sampled | lvk::TextureUsageBits_Storage,
+      .numMipLevels = depthPyramidNumMipLevels_,
+      .debugName = "Texture: depth pyramid",
+  });
+
+  if (depthPyramid_.empty()) {
+    depthPyramidNumMipLevels_ = 0;
+    return;
+  }
+
+  for (uint32_t i = 0; i != depthPyramidNumMipLevels_; i++) {
+    depthPyramidMips_[i] = ctx_.createTextureView(depthPyramid_, {.mipLevel = i}, "Texture: depth pyramid (mip)");
+  }
+}
+
+void lvk::GPUCulling::buildDepthPyramid(ICommandBuffer& buffer, TextureHandle depth) {
+  LVK_PROFILER_FUNCTION();
+
+  const Dimensions dim = ctx_.getDimensions(depth);
+
+  if (dim.width != depthPyramidSize_.width || dim.height != depthPyramidSize_.height) {
+    createDepthPyramid(dim);
+  }
+
+  if (!depthPyramidNumMipLevels_) {
+    return;
+  }
+
+  buffer.cmdPushDebugGroupLabel("Build depth pyramid", 0xff00ffff);
+
+  const lvk::TextureBarrier barriersBefore[] = {
+      {.texture = depth, .srcUsage = lvk::ResourceUsageBits_DepthStencilAttachment, .dstUsage = lvk::ResourceUsageBits_ShaderReadCompute},
+      {.texture = depthPyramid_,
+       .srcUsage = lvk::ResourceUsageBits_ShaderReadCompute,
+       .dstUsage = lvk::ResourceUsageBits_ShaderWriteCompute,
+       .discardContents = true},
+  };
+  buffer.cmdPipelineBarrier(barriersBefore, LVK_ARRAY_NUM_ELEMENTS(barriersBefore));
+
+  buffer.cmdBindComputePipeline(pipelineDepthReduce_);
+
+  for (uint32_t i = 0; i != depthPyramidNumMipLevels_; i++) {
+    const uint32_t width = std::max(depthPyramidSize_.width >> i, 1u);
+    const uint32_t height = std::max(depthPyramidSize_.height >> i, 1u);
+    struct {
+      uint32_t src;
+      uint32_t dst;
+      uint32_t width;
+      uint32_t height;
+      uint32_t isSrcDepth;
+    } pc = {
+        .src = i ? depthPyramidMips_[i - 1].index() : depth.index(),
+        .dst = depthPyramidMips_[i].index(),
+        .width = width,
+        .height = height,
+        .isSrcDepth = i == 0,
+    };
+    buffer.cmdPushConstants(pc);
+    buffer.cmdDispatchThreadGroups({.width = (width + 15) / 16, .height = (height + 15) / 16});
+    // every mip-level is read by the next dispatch; the entire pyramid is read by cull()
+    const bool isLast = i + 1 == depthPyramidNumMipLevels_;
+    const lvk::TextureBarrier barrier = {
+        .texture = depthPyramid_,
+        .srcUsage = lvk::ResourceUsageBits_ShaderWriteCompute,
+        .dstUsage = isLast ? lvk::ResourceUsageBits_ShaderReadCompute : lvk::ResourceUsageBits_ShaderWriteCompute,
+    };
+    buffer.cmdPipelineBarrier(&barrier, 1);
+  }
+
+  // give the depth buffer back to rendering
+  const lvk::TextureBarrier barrierAfter = {
+      .texture = depth,
+      .srcUsage = lvk::ResourceUsageBits_ShaderReadCompute,
+      .dstUsage = lvk::ResourceUsageBits_DepthStencilAttachment,
+  };
+  buffer.cmdPipelineBarrier(&barrierAfter, 1);
+
+  buffer.cmdPopDebugGroupLabel();
+
+  isDepthPyramidValid_ = true;
+}
+
+void lvk::GPUCulling::cull(ICommandBuffer& buffer, const GPUCullingParams& params) {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(numClusters_)) {
+    return;
+  }
+
+  buffer.cmdPushDebugGroupLabel("GPU culling", 0xff00ffff);
+
+  // the draw count is synchronized with indirect draws of the previous frame by cmdFillBuffer()
+  buffer.cmdFillBuffer(drawCount_, 0, sizeof(uint32_t), 0);
+
+  // do not overwrite draw commands which are still read by indirect draws of the previous frame
+  const lvk::BufferBarrier barrierBefore = {
+      .buffer = drawCommands_,
+      .srcUsage = lvk::ResourceUsageBits_Indirect,
+      .dstUsage = lvk::ResourceUsageBits_ShaderWriteCompute,
+  };
+  buffer.cmdPipelineBarrier(nullptr, 0, &barrierBefore, 1);
+
+  struct {
+    float viewProj[16];
+    float cameraPos[4];
+    uint64_t clusters;
+    uint64_t commands;
+    uint64_t count;
+    uint32_t numClusters;
+    uint32_t depthPyramid;
+  } pc = {
+      .cameraPos = {params.cameraPos[0], params.cameraPos[1], params.cameraPos[2], 1.0f},
+      .clusters = ctx_.gpuAddress(clusters_),
+      .commands = ctx_.gpuAddress(drawCommands_),
+      .count = ctx_.gpuAddress(drawCount_),
+      .numClusters = numClusters_,
+      .depthPyramid = params.enableOcclusionCulling && isDepthPyramidValid_ ? depthPyramid_.index() : 0u,
+  };
+  memcpy(pc.viewProj, params.viewProj, sizeof(pc.viewProj));
+
+  buffer.cmdBindComputePipeline(pipelineCull_);
+  buffer.cmdPushConstants(pc);
+  buffer.cmdDispatchThreadGroups({.width = (numClusters_ + 63) / 64});
+
+  const lvk::BufferBarrier barriers[] = {
+      {.buffer = drawCommands_, .srcUsage = lvk::ResourceUsageBits_ShaderWriteCompute, .dstUsage = lvk::ResourceUsageBits_Indirect},
+      {.buffer = drawCount_, .srcUsage = lvk::ResourceUsageBits_ShaderWriteCompute, .dstUsage = lvk::ResourceUsageBits_Indirect},
+  };
+  buffer.cmdPipelineBarrier(nullptr, 0, barriers, LVK_ARRAY_NUM_ELEMENTS(barriers));
+
+  buffer.cmdPopDebugGroupLabel();
+}
+
+void lvk::GPUCulling::draw(ICommandBuffer& buffer) const {
+  LVK_PROFILER_FUNCTION();
+
+  if (!numClusters_) {
+    return;
+  }
+
+  buffer.cmdDrawIndexedIndirectCount(drawCommands_, 0, drawCount_, 0, numClusters_);
+}
@@ -0,0 +1,94 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <lvk/LVK.h>
+
+namespace lvk {
+
+// one indirect draw: a cluster of triangles (e.g. a meshlet built with meshopt_buildMeshlets()) and its bounds
+struct GPUCullingCluster {
+  float center[3] = {};
+  float radius = 0;
+  // backface culling cone as returned by meshopt_computeMeshletBounds(); `coneCutoff` >= 1 disables cone culling
+  float coneAxis[3] = {};
+  float coneCutoff = 1.0f;
+  // VkDrawIndexedIndirectCommand with instanceCount = 1
+  uint32_t indexCount = 0;
+  uint32_t firstIndex = 0;
+  int32_t vertexOffset = 0;
+  uint32_t baseInstance = 0;
+};
+
+static_assert(sizeof(GPUCullingCluster) == 48, "Should match the GLSL struct");
+
+struct GPUCullingParams {
+  // column-major; transforms cluster bounds into clip space (zero-to-one depth, regular Z)
+  float viewProj[16] = {};
+  // in the space of cluster bounds; used by cone culling
+  float cameraPos[3] = {};
+  // Hi-Z occlusion culling against the latest buildDepthPyramid()
+  bool enableOcclusionCulling = true;
+};
+
+// Optional GPU-driven rendering on top of IContext: all clusters are culled by one compute dispatch which writes indirect commands
+// and a draw count, and then drawn by one cmdDrawIndexedIndirectCount():
+//   - frustum culling and cone (backface) culling of clusters;
+//   - Hi-Z occlusion culling against a depth pyramid (max-reduced mip chain of a depth buffer). The pyramid is built from the depth
+//     buffer of a previous frame, so objects which have just become visible can appear one frame late.
+class GPUCulling final {
+ public:
+  explicit GPUCulling(lvk::IContext& ctx);
+
+  // (re)creates the cluster buffer and the indirect buffers
+  Result setClusters(const GPUCullingCluster* clusters, uint32_t numClusters);
+
+  // `depth` should be single-sampled and have TextureUsageBits_Sampled; it is left in the shader read-only layout
+  void buildDepthPyramid(ICommandBuffer& buffer, TextureHandle depth);
+  // outside of cmdBeginRendering()/cmdEndRendering()
+  void cull(ICommandBuffer& buffer, const GPUCullingParams& params);
+  // one cmdDrawIndexedIndirectCount() of all visible clusters; bind a render pipeline, vertex and index buffers before
+  void draw(ICommandBuffer& buffer) const;
+
+  [[nodiscard]] uint32_t getNumClusters() const {
+    return numClusters_;
+  }
+  [[nodiscard]] TextureHandle getDepthPyramid() const {
+    return depthPyramid_;
+  }
+  [[nodiscard]] BufferHandle getDrawCommands() const {
+    return drawCommands_;
+  }
+  [[nodiscard]] BufferHandle getDrawCount() const {
+    return drawCount_;
+  }
+
+ private:
+  void createDepthPyramid(const Dimensions& dim);
+
+ private:
+  lvk::IContext& ctx_;
+
+  lvk::Holder<lvk::ShaderModuleHandle> smDepthReduce_;
+  lvk::Holder<lvk::ShaderModuleHandle> smCull_;
+  lvk::Holder<lvk::ComputePipelineHandle> pipelineDepthReduce_;
+  lvk::Holder<lvk::ComputePipelineHandle> pipelineCull_;
+
+  uint32_t numClusters_ = 0;
+  lvk::Holder<lvk::BufferHandle> clusters_;
+  lvk::Holder<lvk::BufferHandle> drawCommands_;
+  lvk::Holder<lvk::BufferHandle> drawCount_;
+
+  Dimensions depthPyramidSize_ = {0, 0, 0};
+  uint32_t depthPyramidNumMipLevels_ = 0;
+  bool isDepthPyramidValid_ = false; // it was built at least once
+  lvk::Holder<lvk::TextureHandle> depthPyramid_;
+  lvk::Holder<lvk::TextureHandle> depthPyramidMips_[16] = {}; // storage views of individual mip-levels
+};
+
+} // namespace lvk
@@ -176,7 +176,8 @@ void ImGuiRenderer::endFrame(lvk::ICommandBuffer& cmdBuffer) {
 
   int fb_width = (int)(dd->DisplaySize.x * dd->FramebufferScale.x);
   int fb_height = (int)(dd->DisplaySize.y * dd->FramebufferScale.y);
-  if (fb_width <= 0 || fb_height <= 0 || dd->CmdListsCount == 0) {
+  // nothing to draw (transient allocations cannot be empty)
+  if (fb_width <= 0 || fb_height <= 0 || dd->CmdListsCount == 0 || dd->TotalVtxCount == 0 || dd->TotalIdxCount == 0) {
     return;
   }
 
@@ -197,32 +198,19 @@ void ImGuiRenderer::endFrame(lvk::ICommandBuffer& cmdBuffer) {
   const ImVec2 clip_off = dd->DisplayPos;
   const ImVec2 clip_scale = dd->FramebufferScale;
 
-  DrawableData& drawableData = drawables_[frameIndex_];
-  frameIndex_ = (frameIndex_ + 1) % LVK_ARRAY_NUM_ELEMENTS(drawables_);
-
-  if (drawableData.numAllocatedIndices_ < dd->TotalIdxCount) {
-    drawableData.ib_ = ctx_.createBuffer({
-        .usage = lvk::BufferUsageBits_Index,
-        .storage = lvk::StorageType_HostVisible,
-        .size = dd->TotalIdxCount * sizeof(ImDrawIdx),
-        .debugName = "ImGui: drawableData.ib_",
-    });
-    drawableData.numAllocatedIndices_ = dd->TotalIdxCount;
-  }
-  if (drawableData.numAllocatedVerteices_ < dd->TotalVtxCount) {
-    drawableData.vb_ = ctx_.createBuffer({
-        .usage = lvk::BufferUsageBits_Storage,
-        .storage = lvk::StorageType_HostVisible,
-        .size = dd->TotalVtxCount * sizeof(ImDrawVert),
-        .debugName = "ImGui: drawableData.vb_",
-    });
-    drawableData.numAllocatedVerteices_ = dd->TotalVtxCount;
+  // vertex/index data lives in transient memory which is recycled after the GPU is done with this frame
+  const lvk::TransientAllocation vb = ctx_.allocateTransient(cmdBuffer, dd->TotalVtxCount * sizeof(ImDrawVert));
+  const lvk::TransientAllocation ib = ctx_.allocateTransient(cmdBuffer, dd->TotalIdxCount * sizeof(ImDrawIdx));
+
+  if (!vb.valid() || !ib.valid()) {
+    cmdBuffer.cmdPopDebugGroupLabel();
+    return;
   }
 
   // upload vertex/index buffers
   {
-    ImDrawVert* vtx = (ImDrawVert*)ctx_.getMappedPtr(drawableData.vb_);
-    uint16_t* idx = (uint16_t*)ctx_.getMappedPtr(drawableData.ib_);
+    ImDrawVert* vtx = (ImDrawVert*)vb.mappedPtr;
+    uint16_t* idx = (uint16_t*)ib.mappedPtr;
     for (int n = 0; n < dd->CmdListsCount; n++) {
       const ImDrawList* cmdList = dd->CmdLists[n];
       memcpy(vtx, cmdList->VtxBuffer.Data, cmdList->VtxBuffer.Size * sizeof(ImDrawVert));
@@ -230,14 +218,12 @@ void ImGuiRenderer::endFrame(lvk::ICommandBuffer& cmdBuffer) {
       vtx += cmdList->VtxBuffer.Size;
       idx += cmdList->IdxBuffer.Size;
     }
-    ctx_.flushMappedMemory(drawableData.vb_, 0, dd->TotalVtxCount * sizeof(ImDrawVert));
-    ctx_.flushMappedMemory(drawableData.ib_, 0, dd->TotalIdxCount * sizeof(ImDrawIdx));
   }
 
   uint32_t idxOffset = 0;
   uint32_t vtxOffset = 0;
 
-  cmdBuffer.cmdBindIndexBuffer(drawableData.ib_, lvk::IndexFormat_UI16);
+  cmdBuffer.cmdBindIndexBuffer(ib.buffer, lvk::IndexFormat_UI16, ib.offset);
   cmdBuffer.cmdBindRenderPipeline(pipeline_);
 
   for (int n = 0; n < dd->CmdListsCount; n++) {
@@ -263,7 +249,7 @@ void ImGuiRenderer::endFrame(lvk::ICommandBuffer& cmdBuffer) {
         uint32_t textureId = 0;
       } bindData = {
           .LRTB = {L, R, T, B},
-          .vb = ctx_.gpuAddress(drawableData.vb_),
+          .vb = vb.gpuAddress,
           .textureId = static_cast<uint32_t>(reinterpret_cast<ptrdiff_t>(cmd.TextureId)),
       };
       cmdBuffer.cmdPushConstants(bindData);
@@ -37,17 +37,6 @@ class ImGuiRenderer {
   lvk::Holder<lvk::TextureHandle> fontTexture_;
   float displayScale_ = 1.0f;
   uint32_t nonLinearColorSpace_ = 0;
-
-  uint32_t frameIndex_ = 0;
-
-  struct DrawableData {
-    lvk::Holder<BufferHandle> vb_;
-    lvk::Holder<BufferHandle> ib_;
-    uint32_t numAllocatedIndices_ = 0;
-    uint32_t numAllocatedVerteices_ = 0;
-  };
-
-  DrawableData drawables_[18] = {};
 };
 
 } // namespace lvk
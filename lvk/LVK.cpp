@@ -8,6 +8,7 @@
 #include "LVK.h"
 
 #include <assert.h>
+#include <string.h>
 
 #define NOMINMAX
 #define WIN32_LEAN_AND_MEAN
@@ -186,6 +187,12 @@ uint32_t lvk::getTextureBytesPerLayer(uint32_t width, uint32_t height, lvk::Form
   return widthInBlocks * heightInBlocks * props.bytesPerBlock;
 }
 
+lvk::Dimensions lvk::getTextureBlockDimensions(lvk::Format format) {
+  const auto props = properties[format];
+
+  return {std::max((uint32_t)props.blockWidth, 1u), std::max((uint32_t)props.blockHeight, 1u), 1u};
+}
+
 uint32_t lvk::calcNumMipLevels(uint32_t width, uint32_t height) {
   assert(width > 0);
   assert(height > 0);
@@ -296,6 +303,44 @@ void lvk::logShaderSource(const char* text) {
   LLOGL("\n");
 }
 
+uint32_t lvk::queryVulkanDevices(HWDeviceDesc* outDevices, uint32_t maxOutDevices) {
+  return VulkanContext::queryDevices(outDevices, maxOutDevices);
+}
+
+std::unique_ptr<lvk::IContext> lvk::createVulkanContextHeadless(const lvk::ContextConfig& cfg, lvk::HWDeviceType preferredDeviceType) {
+  using namespace lvk;
+  std::unique_ptr<VulkanContext> ctx = std::make_unique<VulkanContext>(cfg, nullptr);
+  if (!initVulkanContextWithSwapchain(ctx, 0, 0, preferredDeviceType)) {
+    return nullptr;
+  }
+  return std::move(ctx);
+}
+
+std::unique_ptr<lvk::IContext> lvk::createVulkanContextHeadless(const lvk::ContextConfig& cfg, const lvk::HWDeviceDesc& device) {
+  using namespace lvk;
+
+  std::unique_ptr<VulkanContext> ctx = std::make_unique<VulkanContext>(cfg, nullptr);
+
+  // VkPhysicalDevice handles differ between instances: match devices of this context by UUID
+  const uint32_t numDevices = ctx->queryDevices(HWDeviceType_Software, nullptr, UINT32_MAX);
+  std::vector<HWDeviceDesc> devices(numDevices);
+  ctx->queryDevices(HWDeviceType_Software, devices.data(), numDevices);
+
+  for (const HWDeviceDesc& d : devices) {
+    if (!memcmp(d.uuid, device.uuid, sizeof(device.uuid))) {
+      if (!ctx->initContext(d).isOk()) {
+        LVK_ASSERT_MSG(false, "Failed initContext()");
+        return nullptr;
+      }
+      return std::move(ctx);
+    }
+  }
+
+  LVK_ASSERT_MSG(false, "GPU is not found");
+
+  return nullptr;
+}
+
 #if LVK_WITH_GLFW
 GLFWwindow* lvk::initWindow(const char* windowTitle, int& outWidth, int& outHeight, bool resizable) {
   if (!glfwInit()) {
@@ -220,6 +220,14 @@ enum ColorSpace : uint8_t {
   ColorSpace_SRGB_NONLINEAR,
 };
 
+enum PresentMode : uint8_t {
+  PresentMode_Default, // Immediate on Linux, then Mailbox, then Fifo
+  PresentMode_Fifo, // vsync; the only mode every surface supports
+  PresentMode_FifoRelaxed, // vsync, but late frames tear instead of waiting for the next vblank
+  PresentMode_Mailbox, // no tearing; the newest frame replaces the queued one
+  PresentMode_Immediate, // no vsync, tearing
+};
+
 enum TextureType : uint8_t {
   TextureType_2D,
   TextureType_3D,
@@ -239,9 +247,11 @@ enum HWDeviceType {
 
 struct HWDeviceDesc {
   enum { LVK_MAX_PHYSICAL_DEVICE_NAME_SIZE = 256 };
-  uintptr_t guid = 0;
+  enum { LVK_UUID_SIZE = 16 };
+  uintptr_t guid = 0; // valid only for the context which returned it
   HWDeviceType type = HWDeviceType_Software;
   char name[LVK_MAX_PHYSICAL_DEVICE_NAME_SIZE] = {0};
+  uint8_t uuid[LVK_UUID_SIZE] = {0}; // VkPhysicalDeviceIDProperties::deviceUUID, stable across contexts and processes
 };
 
 enum StorageType {
@@ -251,6 +261,7 @@ enum StorageType {
 };
 
 enum CullMode : uint8_t { CullMode_None, CullMode_Front, CullMode_Back };
+enum QueueType : uint8_t { QueueType_Graphics = 0, QueueType_Compute, QueueType_Transfer, QueueType_Num };
 enum WindingMode : uint8_t { WindingMode_CCW, WindingMode_CW };
 
 struct Result {
@@ -506,6 +517,8 @@ enum ShaderStage : uint8_t {
   Stage_Geom,
   Stage_Frag,
   Stage_Comp,
+  Stage_Task, // VK_EXT_mesh_shader
+  Stage_Mesh,
 };
 
 struct VertexInput final {
@@ -591,6 +604,9 @@ struct RenderPipelineDesc final {
   ShaderModuleHandle smTese;
   ShaderModuleHandle smGeom;
   ShaderModuleHandle smFrag;
+  // mesh shading pipelines (VK_EXT_mesh_shader): `smMesh` replaces all vertex processing stages and `vertexInput`; `smTask` is optional
+  ShaderModuleHandle smTask;
+  ShaderModuleHandle smMesh;
 
   SpecializationConstantDesc specInfo = {};
 
@@ -599,6 +615,8 @@ struct RenderPipelineDesc final {
   const char* entryPointTese = "main";
   const char* entryPointFrag = "main";
   const char* entryPointGeom = "main";
+  const char* entryPointTask = "main";
+  const char* entryPointMesh = "main";
 
   ColorAttachment color[LVK_MAX_COLOR_ATTACHMENTS] = {};
   Format depthFormat = Format_Invalid;
@@ -663,6 +681,7 @@ struct Framebuffer final {
   };
 
   AttachmentDesc color[LVK_MAX_COLOR_ATTACHMENTS] = {};
+  // StoreOp_MsaaResolve of the depth attachment resolves sample 0 into `depthStencil.resolveTexture`
   AttachmentDesc depthStencil;
 
   const char* debugName = "";
@@ -692,6 +711,19 @@ struct BufferDesc final {
   const char* debugName = "";
 };
 
+// a sub-range of one of the large persistently mapped buffers owned by the context (see IContext::allocateTransient())
+struct TransientAllocation {
+  BufferHandle buffer;
+  size_t offset = 0;
+  size_t size = 0;
+  uint8_t* mappedPtr = nullptr; // points at `offset`
+  uint64_t gpuAddress = 0; // includes `offset`
+
+  bool valid() const {
+    return !buffer.empty();
+  }
+};
+
 struct TextureRangeDesc {
   uint32_t x = 0;
   uint32_t y = 0;
@@ -703,6 +735,23 @@ struct TextureRangeDesc {
   uint32_t numMipLevels = 1;
 };
 
+// writable staging memory returned by IContext::mapForUpload(); only valid until IContext::commitUpload()
+struct UploadMapping {
+  uint8_t* mappedPtr = nullptr;
+  size_t size = 0;
+  // destination
+  BufferHandle buffer;
+  size_t offset = 0;
+  TextureHandle texture;
+  TextureRangeDesc range;
+  // implementation-specific; ~0u if `mappedPtr` points directly into the host-visible `buffer`
+  uint32_t stagingOffset = ~0u;
+
+  bool valid() const {
+    return mappedPtr != nullptr;
+  }
+};
+
 enum TextureUsageBits : uint8_t {
   TextureUsageBits_Sampled = 1 << 0,
   TextureUsageBits_Storage = 1 << 1,
@@ -735,17 +784,136 @@ struct TextureDesc {
   uint32_t numSamples = 1;
   uint8_t usage = TextureUsageBits_Sampled;
   uint32_t numMipLevels = 1;
-  StorageType storage = StorageType_Device;
+  StorageType storage = StorageType_Device; // StorageType_Memoryless: lazily allocated attachments on tiled GPUs, device-local elsewhere
   ComponentMapping swizzle = {};
   const void* data = nullptr;
   uint32_t dataNumMipLevels = 1; // how many mip-levels we want to upload
   const char* debugName = "";
+  // Explicit memory aliasing: place this texture into the memory of `aliasOf` (StorageType_Device only). Creation fails with
+  // an error Result if it does not fit or needs another memory type or alignment. Aliases share contents; the first access
+  // after another alias was used must discard (TextureBarrier or LoadOp_Clear/LoadOp_DontCare). The memory stays alive until
+  // all its aliases are destroyed.
+  TextureHandle aliasOf = {};
+  // Partially resident (virtual) texture: no memory is committed up front; see IContext::updateTexturePages().
+  // StorageType_Device only, no `data`, no aliasing, and no multisampling.
+  bool isSparse = false;
+};
+
+// a view of a subset of mip-levels and layers of an existing texture; it is a texture with its own bindless index
+struct TextureViewDesc {
+  TextureType type = TextureType_2D; // 2D views of 2D and cube textures, 3D views of 3D textures, cube views of cube textures
+  uint32_t layer = 0;
+  uint32_t numLayers = 1; // 6 for cube views
+  uint32_t mipLevel = 0;
+  uint32_t numMipLevels = 1;
+  ComponentMapping swizzle = {};
+  // Format_Invalid: the format of `texture`. Storage textures with sRGB formats can be viewed as their UNORM counterparts (and vice
+  // versa), e.g. to write them from compute shaders: sRGB views themselves cannot be used as storage images.
+  Format format = Format_Invalid;
 };
 
+// one page (sparse block) of a sparse texture, see IContext::updateTexturePages()
+struct TexturePage {
+  uint32_t mipLevel = 0; // levels >= SparseTextureInfo::mipTailFirstLevel belong to the mip tail which is committed as a whole
+  uint32_t layer = 0;
+  // in pages (see SparseTextureInfo::pageSize); ignored for the mip tail
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t z = 0;
+  bool isResident = true; // false: release the memory of this page
+};
+
+struct SparseTextureInfo {
+  Dimensions pageSize = {0, 0, 0}; // in texels
+  uint32_t pageBytes = 0;
+  uint32_t mipTailFirstLevel = 0; // equal to the number of mip-levels if there is no mip tail
+  uint32_t mipTailBytes = 0; // per layer
+  uint32_t numResidentPages = 0; // mip tails included
+  bool isNonResidentStrict = false; // non-resident texels read as zero
+};
+
+struct SubmitHandle {
+  uint16_t bufferIndex_ = 0;
+  uint16_t queueType_ = QueueType_Graphics;
+  uint32_t submitId_ = 0;
+  SubmitHandle() = default;
+  explicit SubmitHandle(uint64_t handle) :
+    bufferIndex_(uint16_t(handle & 0xffff)), queueType_(uint16_t((handle >> 16) & 0xffff)), submitId_(uint32_t(handle >> 32)) {
+    LVK_ASSERT(submitId_);
+  }
+  bool empty() const {
+    return submitId_ == 0;
+  }
+  uint64_t handle() const {
+    return (uint64_t(submitId_) << 32) + (uint64_t(queueType_) << 16) + bufferIndex_;
+  }
+};
+
+static_assert(sizeof(SubmitHandle) == sizeof(uint64_t));
+
 struct Dependencies {
   enum { LVK_MAX_SUBMIT_DEPENDENCIES = 4 };
   TextureHandle textures[LVK_MAX_SUBMIT_DEPENDENCIES] = {};
   BufferHandle buffers[LVK_MAX_SUBMIT_DEPENDENCIES] = {};
+  // work submitted to other queues which has to complete before this command buffer is executed (cross-queue waits);
+  // sampled/storage textures and shader-accessible buffers are shared between graphics and compute queue families, so no explicit
+  // ownership transfers are required; attachment-only textures cannot be used on the compute queue
+  SubmitHandle submits[LVK_MAX_SUBMIT_DEPENDENCIES] = {};
+};
+
+// how a resource is accessed; translated into pipeline stages, access masks, and image layouts by the backend
+enum ResourceUsageBits : uint16_t {
+  ResourceUsageBits_ColorAttachment = 1 << 0,
+  ResourceUsageBits_DepthStencilAttachment = 1 << 1,
+  ResourceUsageBits_ShaderReadGraphics = 1 << 2, // sampled textures and read-only buffers in graphics shaders
+  ResourceUsageBits_ShaderReadCompute = 1 << 3,
+  ResourceUsageBits_ShaderWriteGraphics = 1 << 4, // read-write storage images and buffers in graphics shaders
+  ResourceUsageBits_ShaderWriteCompute = 1 << 5,
+  ResourceUsageBits_VertexInput = 1 << 6, // vertex and index buffers
+  ResourceUsageBits_Indirect = 1 << 7,
+  ResourceUsageBits_TransferSrc = 1 << 8,
+  ResourceUsageBits_TransferDst = 1 << 9,
+};
+
+struct TextureBarrier {
+  TextureHandle texture;
+  uint16_t srcUsage = 0; // all accesses to wait for (0 if there are none)
+  uint16_t dstUsage = 0; // all bits should map to the same image layout
+  bool discardContents = false; // transition from VK_IMAGE_LAYOUT_UNDEFINED
+};
+
+struct BufferBarrier {
+  BufferHandle buffer;
+  uint16_t srcUsage = 0;
+  uint16_t dstUsage = 0;
+};
+
+// redundant state filtering: state-setting commands which match the current state of a command buffer are not sent to Vulkan
+struct CommandBufferStats {
+  uint64_t numStateCommands = 0; // cmdBind*() and cmdPushConstants()
+  uint64_t numElidedPipelines = 0;
+  uint64_t numElidedViewports = 0;
+  uint64_t numElidedScissorRects = 0;
+  uint64_t numElidedDepthStates = 0;
+  uint64_t numElidedVertexBuffers = 0;
+  uint64_t numElidedIndexBuffers = 0;
+  uint64_t numElidedPushConstants = 0;
+
+  uint64_t getNumElidedStateCommands() const {
+    return numElidedPipelines + numElidedViewports + numElidedScissorRects + numElidedDepthStates + numElidedVertexBuffers +
+           numElidedIndexBuffers + numElidedPushConstants;
+  }
+  CommandBufferStats& operator+=(const CommandBufferStats& other) {
+    numStateCommands += other.numStateCommands;
+    numElidedPipelines += other.numElidedPipelines;
+    numElidedViewports += other.numElidedViewports;
+    numElidedScissorRects += other.numElidedScissorRects;
+    numElidedDepthStates += other.numElidedDepthStates;
+    numElidedVertexBuffers += other.numElidedVertexBuffers;
+    numElidedIndexBuffers += other.numElidedIndexBuffers;
+    numElidedPushConstants += other.numElidedPushConstants;
+    return *this;
+  }
 };
 
 class ICommandBuffer {
@@ -764,6 +932,13 @@ class ICommandBuffer {
   virtual void cmdBeginRendering(const lvk::RenderPass& renderPass, const lvk::Framebuffer& desc, const Dependencies& deps = {}) = 0;
   virtual void cmdEndRendering() = 0;
 
+  // all barriers are recorded with one vkCmdPipelineBarrier2(); attachments transitioned here are not transitioned again by the
+  // next cmdBeginRendering()
+  virtual void cmdPipelineBarrier(const TextureBarrier* textureBarriers,
+                                  uint32_t numTextureBarriers,
+                                  const BufferBarrier* bufferBarriers = nullptr,
+                                  uint32_t numBufferBarriers = 0) = 0;
+
   virtual void cmdBindViewport(const Viewport& viewport) = 0;
   virtual void cmdBindScissorRect(const ScissorRect& rect) = 0;
 
@@ -795,30 +970,112 @@ class ICommandBuffer {
                                            size_t countBufferOffset,
                                            uint32_t maxDrawCount,
                                            uint32_t stride = 0) = 0;
+  // mesh shading pipelines only; indirect commands are VkDrawMeshTasksIndirectCommandEXT
+  virtual void cmdDrawMeshTasks(const Dimensions& threadgroupCount) = 0;
+  virtual void cmdDrawMeshTasksIndirect(BufferHandle indirectBuffer,
+                                        size_t indirectBufferOffset,
+                                        uint32_t drawCount,
+                                        uint32_t stride = 0) = 0;
+  virtual void cmdDrawMeshTasksIndirectCount(BufferHandle indirectBuffer,
+                                             size_t indirectBufferOffset,
+                                             BufferHandle countBuffer,
+                                             size_t countBufferOffset,
+                                             uint32_t maxDrawCount,
+                                             uint32_t stride = 0) = 0;
 
   virtual void cmdSetBlendColor(const float color[4]) = 0;
   virtual void cmdSetDepthBias(float depthBias, float slopeScale, float clamp) = 0;
 
   virtual void cmdResetQueryPool(QueryPoolHandle pool, uint32_t firstQuery, uint32_t queryCount) = 0;
   virtual void cmdWriteTimestamp(QueryPoolHandle pool, uint32_t query) = 0;
+
+  // Non-blocking readback: the copy goes into this command buffer and the SubmitHandle returned by IContext::submit() is the
+  // ticket. Poll it with IContext::isReady() (e.g. a few frames later) and read `dst` via IContext::getMappedPtr(). The
+  // destination buffer should have BufferUsageBits_Storage and StorageType_HostVisible to be readable by the CPU. A host-visible
+  // source buffer acts as a staging buffer for uploads into StorageType_Device buffers.
+  virtual void cmdCopyBuffer(BufferHandle src, size_t srcOffset, BufferHandle dst, size_t dstOffset, size_t size) = 0;
+  // fills `size` bytes (a multiple of 4) with `value`, e.g. to reset counters written by compute shaders; the destination buffer
+  // should have BufferUsageBits_Storage
+  virtual void cmdFillBuffer(BufferHandle buffer, size_t offset, size_t size, uint32_t value) = 0;
+  // `range` is a single mip-level; layers are tightly packed one after another. Compressed formats are copied in whole blocks;
+  // `dstOffset` should be a multiple of the texel block size (and of 4 for depth/stencil formats)
+  virtual void cmdCopyTextureToBuffer(TextureHandle src, const TextureRangeDesc& range, BufferHandle dst, size_t dstOffset = 0) = 0;
+
+  // state-setting commands recorded into this command buffer so far
+  [[nodiscard]] virtual const CommandBufferStats& getStats() const = 0;
 };
 
-struct SubmitHandle {
-  uint32_t bufferIndex_ = 0;
-  uint32_t submitId_ = 0;
-  SubmitHandle() = default;
-  explicit SubmitHandle(uint64_t handle) : bufferIndex_(uint32_t(handle & 0xffffffff)), submitId_(uint32_t(handle >> 32)) {
-    LVK_ASSERT(submitId_);
-  }
-  bool empty() const {
-    return submitId_ == 0;
-  }
-  uint64_t handle() const {
-    return (uint64_t(submitId_) << 32) + bufferIndex_;
-  }
+// a timed cmdPushDebugGroupLabel()/cmdPopDebugGroupLabel() or cmdBeginRendering()/cmdEndRendering() scope
+struct GPUProfilerScope {
+  enum { LVK_MAX_NAME_LENGTH = 64 };
+  char name[LVK_MAX_NAME_LENGTH] = {};
+  uint32_t parent = ~0u; // index of the enclosing scope; ~0u for top-level scopes (every command buffer has its own tree)
+  uint32_t depth = 0;
+  double timeBeginMs = 0; // relative to the earliest scope of the frame
+  double durationMs = 0;
 };
 
-static_assert(sizeof(SubmitHandle) == sizeof(uint64_t));
+struct MemoryHeapStats {
+  uint64_t size = 0; // VkMemoryHeap::size
+  uint64_t budget = 0; // how much this process can allocate before performance or stability suffers
+  uint64_t usage = 0; // how much this process has allocated (0 if unknown: no VMA and no VK_EXT_memory_budget)
+  bool isDeviceLocal = false;
+};
+
+struct MemoryStats {
+  enum { LVK_MAX_MEMORY_HEAPS = 16 };
+  uint32_t numHeaps = 0;
+  MemoryHeapStats heaps[LVK_MAX_MEMORY_HEAPS] = {};
+  bool hasMemoryBudget = false; // VK_EXT_memory_budget is enabled; estimated by VMA otherwise
+  // resources created by this context
+  uint32_t numBuffers = 0;
+  uint64_t bufferBytes = 0; // includes the staging and transient buffers
+  uint32_t numTextures = 0; // no swapchain images; views are counted with their textures
+  uint64_t textureBytes = 0; // the memory of aliased textures is counted once
+  uint64_t stagingBufferBytes = 0;
+  uint64_t stagingBufferBytesInFlight = 0; // regions used by uploads which are not retired yet
+  uint64_t transientBufferBytes = 0; // all buffers backing IContext::allocateTransient()
+};
+
+// blocking host calls reported by IContext::getFrameStats()
+enum HostWait : uint8_t {
+  HostWait_SwapchainAcquire, // vkAcquireNextImageKHR() and its fence
+  HostWait_Present, // vkQueuePresentKHR() - blocks in FIFO mode when the presentation engine is behind
+  HostWait_CommandBuffers, // all command buffers of a queue are in flight
+  HostWait_Submit, // IContext::wait() and other waits for submit handles
+  HostWait_StagingBuffer, // the staging ring buffer is full or being reallocated
+  HostWait_PipelineCompiles, // async pipeline compilation jobs (see IContext::compilePipelinesAsync())
+  HostWait_DeviceIdle, // vkDeviceWaitIdle(), i.e. swapchain recreation
+  HostWait_FramesInFlight, // ContextConfig::maxFramesInFlight
+  HostWait_Num,
+};
+
+struct HostWaitStats {
+  uint32_t count = 0;
+  double timeMs = 0;
+};
+
+// CPU-side frame pacing counters; a frame ends with submit(..., present) or IContext::endFrame()
+struct FrameStats {
+  uint64_t frameIndex = 0;
+  double cpuFrameTimeMs = 0; // between the two frame ends delimiting this frame
+  HostWaitStats hostWaits[HostWait_Num] = {};
+  uint32_t numSubmits = 0; // vkQueueSubmit() on all queues, including uploads
+  uint32_t numBarriers = 0; // pipeline barriers recorded by command buffers and uploads
+  uint32_t numDescriptorSetUpdates = 0; // vkUpdateDescriptorSets() of the bindless descriptor set
+  uint32_t numDescriptorWrites = 0; // contiguous ranges of updated descriptors
+  uint32_t numPipelineCompiles = 0; // synchronous and async
+  double pipelineCompileTimeMs = 0; // summed over all threads
+  uint64_t stagingBytes = 0; // allocated from the staging buffer by uploads and downloads
+
+  double getHostWaitTimeMs() const {
+    double timeMs = 0;
+    for (const HostWaitStats& w : hostWaits) {
+      timeMs += w.timeMs;
+    }
+    return timeMs;
+  }
+};
 
 class IContext {
  protected:
@@ -827,20 +1084,43 @@ class IContext {
  public:
   virtual ~IContext() = default;
 
-  virtual ICommandBuffer& acquireCommandBuffer() = 0;
+  // Thread-safe: command buffers can be acquired and recorded on worker threads (one thread per command buffer at a time).
+  // Resources used while recording should not be destroyed concurrently. Resources can be created, uploaded to and destroyed on
+  // any thread, e.g. directly by asset loaders; uploads from other threads are submitted with the next submit().
+  // QueueType_Compute command buffers go to the async compute queue (if the device has one) and can only dispatch compute work.
+  // QueueType_Transfer is used internally by uploadAsync().
+  virtual ICommandBuffer& acquireCommandBuffer(QueueType queue = QueueType_Graphics) = 0;
 
   virtual SubmitHandle submit(ICommandBuffer& commandBuffer, TextureHandle present = {}) = 0;
+  // submit command buffers recorded in parallel; they are executed in the specified order, `present` is handled by the last one
+  // all command buffers should be acquired for the same queue
+  virtual SubmitHandle submit(ICommandBuffer* const* commandBuffers, uint32_t numCommandBuffers, TextureHandle present = {}) = 0;
+  // ends a frame without presenting (frame stats, GPU profiler, memory budget): headless applications call it once per frame on the
+  // submitting thread; submit(..., present) calls it implicitly
+  virtual void endFrame() = 0;
   virtual void wait(SubmitHandle handle) = 0;
+  // non-blocking check if the submit has been completed by the GPU
+  [[nodiscard]] virtual bool isReady(SubmitHandle handle) const = 0;
 
   [[nodiscard]] virtual Holder<BufferHandle> createBuffer(const BufferDesc& desc, Result* outResult = nullptr) = 0;
   [[nodiscard]] virtual Holder<SamplerHandle> createSampler(const SamplerStateDesc& desc, Result* outResult = nullptr) = 0;
   [[nodiscard]] virtual Holder<TextureHandle> createTexture(const TextureDesc& desc,
                                                             const char* debugName = nullptr,
                                                             Result* outResult = nullptr) = 0;
+  // the view keeps the memory of `texture` alive
+  [[nodiscard]] virtual Holder<TextureHandle> createTextureView(TextureHandle texture,
+                                                                const TextureViewDesc& desc,
+                                                                const char* debugName = nullptr,
+                                                                Result* outResult = nullptr) = 0;
   [[nodiscard]] virtual Holder<ComputePipelineHandle> createComputePipeline(const ComputePipelineDesc& desc,
                                                                             Result* outResult = nullptr) = 0;
   [[nodiscard]] virtual Holder<RenderPipelineHandle> createRenderPipeline(const RenderPipelineDesc& desc, Result* outResult = nullptr) = 0;
   [[nodiscard]] virtual Holder<ShaderModuleHandle> createShaderModule(const ShaderModuleDesc& desc, Result* outResult = nullptr) = 0;
+  // compiles GLSL shaders in parallel on worker threads; `outHandles[i]` is empty if `descs[i]` failed (see `outResults[i]`)
+  virtual void createShaderModules(const ShaderModuleDesc* descs,
+                                   uint32_t numDescs,
+                                   Holder<ShaderModuleHandle>* outHandles,
+                                   Result* outResults = nullptr) = 0;
 
   [[nodiscard]] virtual Holder<QueryPoolHandle> createQueryPool(uint32_t numQueries,
                                                                 const char* debugName,
@@ -857,18 +1137,46 @@ class IContext {
 
 #pragma region Buffer functions
   virtual Result upload(BufferHandle handle, const void* data, size_t size, size_t offset = 0) = 0;
+  // streaming: the copy runs on a dedicated transfer queue (if there is one) and is submitted immediately; wait for the returned
+  // handle or pass it via Dependencies::submits before using the buffer; returns an empty handle on errors
+  virtual SubmitHandle uploadAsync(BufferHandle handle, const void* data, size_t size, size_t offset = 0) = 0;
   [[nodiscard]] virtual uint8_t* getMappedPtr(BufferHandle handle) const = 0;
   [[nodiscard]] virtual uint64_t gpuAddress(BufferHandle handle, size_t offset = 0) const = 0;
   virtual void flushMappedMemory(BufferHandle handle, size_t offset, size_t size) const = 0;
+  // Per-frame data (uniforms, dynamic vertices and indices, indirect commands) without creating buffers: sub-allocated linearly
+  // from host-visible buffers usable with all BufferUsageBits. The memory belongs to `cmdBuffer`: it is flushed when `cmdBuffer`
+  // is submitted and recycled after that submit completes. `alignment` is raised to the uniform/storage buffer offset alignment
+  // of the device. `size` cannot be 0.
+  [[nodiscard]] virtual TransientAllocation allocateTransient(ICommandBuffer& cmdBuffer, size_t size, size_t alignment = 0) = 0;
+  // Zero-copy uploads: decode or generate data directly into the staging buffer instead of passing a temporary copy to upload().
+  // The GPU copy is recorded by commitUpload() and submitted with the next submit(). Host-visible buffers are mapped directly.
+  // Uncommitted mappings pin staging memory, so commit them as soon as possible: upload() and download() return an error if the
+  // staging buffer is blocked by them. Returns an invalid mapping if `size` does not fit into the staging buffer (use upload()).
+  [[nodiscard]] virtual UploadMapping mapForUpload(BufferHandle handle, size_t size, size_t offset = 0, Result* outResult = nullptr) = 0;
+  virtual Result commitUpload(const UploadMapping& mapping) = 0;
 #pragma endregion
 
 #pragma region Texture functions
   // `data` contains mip-levels and layers as in https://registry.khronos.org/KTX/specs/1.0/ktxspec.v1.html
   virtual Result upload(TextureHandle handle, const TextureRangeDesc& range, const void* data) = 0;
+  // see uploadAsync(BufferHandle...); mip-levels cannot be generated on the transfer queue
+  virtual SubmitHandle uploadAsync(TextureHandle handle, const TextureRangeDesc& range, const void* data) = 0;
+  // see mapForUpload(BufferHandle...); the mapped memory has the same layout as `data` of upload()
+  [[nodiscard]] virtual UploadMapping mapForUpload(TextureHandle handle, const TextureRangeDesc& range, Result* outResult = nullptr) = 0;
+  // blocking; use ICommandBuffer::cmdCopyTextureToBuffer() to read back without stalling
   virtual Result download(TextureHandle handle, const TextureRangeDesc& range, void* outData) = 0;
+  // vkCmdBlitImage() chains recorded into the same command buffer as pending uploads (submitted with the next submit()); see
+  // lvk::MipGenerator for compute-based mip generation of formats with slow or unsupported blits
   virtual void generateMipmap(TextureHandle handle) const = 0;
+  virtual void generateMipmap(const TextureHandle* handles, uint32_t numHandles) const = 0;
   [[nodiscard]] virtual Dimensions getDimensions(TextureHandle handle) const = 0;
   [[nodiscard]] virtual Format getFormat(TextureHandle handle) const = 0;
+  [[nodiscard]] virtual uint32_t getNumMipLevels(TextureHandle handle) const = 0;
+  // TextureDesc::isSparse: commit or release memory pages. All page updates are batched into one vkQueueBindSparse() which is
+  // executed before the next submit on any queue. Upload tiles with upload() after their pages are made resident. On errors,
+  // none of the pages are changed.
+  virtual Result updateTexturePages(TextureHandle handle, const TexturePage* pages, uint32_t numPages) = 0;
+  [[nodiscard]] virtual SparseTextureInfo getSparseTextureInfo(TextureHandle handle) const = 0;
 #pragma endregion
 
   virtual TextureHandle getCurrentSwapchainTexture() = 0;
@@ -876,9 +1184,27 @@ class IContext {
   virtual ColorSpace getSwapChainColorSpace() const = 0;
   virtual uint32_t getNumSwapchainImages() const = 0;
   virtual void recreateSwapchain(int newWidth, int newHeight) = 0;
-  
+  // increases by one on every submit(..., present); 0 before the first present
+  [[nodiscard]] virtual uint64_t getLastPresentId() const = 0;
+  // VK_KHR_present_wait (see ContextConfig::enablePresentWait): blocks until the image of `presentId` is displayed; returns false
+  // on timeout or if present wait is not available. Waiting for the previous present before sampling input paces the application
+  // to the display and minimizes input-to-photon latency.
+  virtual bool waitForPresent(uint64_t presentId, uint64_t timeoutNs = UINT64_MAX) = 0;
+
   // MSAA level is supported if ((samples & bitmask) != 0), where samples must be power of two.
   virtual uint32_t getFramebufferMSAABitMask() const = 0;
+  // true if textures of `format` with optimal tiling can be used as storage images (TextureUsageBits_Storage) on this device
+  [[nodiscard]] virtual bool isStorageFormatSupported(Format format) const = 0;
+
+#pragma region Pipeline functions
+  // Pre-warming: compile VkPipeline objects on worker threads instead of lazily on the first bind (the pipeline cache is shared).
+  // All formats are already known from RenderPipelineDesc. Returns immediately; isPipelineReady() tells if binding a pipeline
+  // would stall to compile it.
+  virtual void compilePipelinesAsync(const RenderPipelineHandle* handles, uint32_t numHandles) = 0;
+  virtual void compilePipelinesAsync(const ComputePipelineHandle* handles, uint32_t numHandles) = 0;
+  [[nodiscard]] virtual bool isPipelineReady(RenderPipelineHandle handle) = 0;
+  [[nodiscard]] virtual bool isPipelineReady(ComputePipelineHandle handle) = 0;
+#pragma endregion
 
 #pragma region Performance queries
   virtual double getTimestampPeriodToMs() const = 0;
@@ -888,6 +1214,16 @@ class IContext {
                                    size_t dataSize,
                                    void* outData,
                                    size_t stride) const = 0;
+  // GPU profiler (see ContextConfig::enableGPUProfiler): a frame ends with submit(..., present) or endFrame() and its timings are
+  // resolved a few frames later without stalling. Copies up to `maxOutScopes` scopes of the latest resolved frame into `outScopes` and
+  // returns their total number; parents precede their children. Safe to call from any thread.
+  virtual uint32_t getGPUProfilerScopes(GPUProfilerScope* outScopes, uint32_t maxOutScopes, uint64_t* outFrameIndex = nullptr) const = 0;
+  // accumulated over all command buffers submitted since the context was created
+  [[nodiscard]] virtual CommandBufferStats getCommandBufferStats() const = 0;
+  // per-heap usage and budget, and totals of resources created by this context; iterates over all buffers and textures
+  [[nodiscard]] virtual MemoryStats getMemoryStats() const = 0;
+  // always enabled and does not need Tracy; returns the counters of the latest completed frame
+  [[nodiscard]] virtual FrameStats getFrameStats() const = 0;
 #pragma endregion
 };
 
@@ -900,23 +1236,66 @@ typedef struct GLFWwindow GLFWwindow;
 namespace lvk {
 
 using ShaderModuleErrorCallback = void (*)(lvk::IContext*, lvk::ShaderModuleHandle, int line, int col, const char* debugName);
+using MemoryBudgetCallback = void (*)(lvk::IContext*, uint32_t heapIndex, uint64_t usage, uint64_t budget);
 
 struct ContextConfig {
   bool terminateOnValidationError = false; // invoke std::terminate() on any validation error
   bool enableValidation = true;
   lvk::ColorSpace swapChainColorSpace = lvk::ColorSpace_SRGB_LINEAR;
-  // owned by the application - should be alive until createVulkanContextWithSwapchain() returns
+  // owned by the application - should be alive until createVulkanContextWithSwapchain() or createVulkanContextHeadless() returns
   const void* pipelineCacheData = nullptr;
   size_t pipelineCacheDataSize = 0;
   ShaderModuleErrorCallback shaderModuleErrorCallback = nullptr;
+  // bindless capacity reserved up front; exceeding it recreates the descriptor set layout and all VkPipeline objects
+  uint32_t maxTextures = 16;
+  uint32_t maxSamplers = 16;
+  // if set, the pipeline cache is loaded from this directory in initContext() and saved back after every batch of
+  // asynchronous pipeline compilations and on shutdown; the file is keyed on the device, driver, and pipelineCacheUUID
+  const char* pipelineCacheDir = nullptr;
+  size_t pipelineCacheMaxFileSize = 64u * 1024u * 1024u; // larger pipeline caches are not saved
+  // if set, SPIR-V compiled from GLSL is cached in this directory (it is always cached in memory while the context is alive)
+  const char* shaderCacheDir = nullptr;
+  // write timestamps around debug group labels and render passes into a ring of query pools (see getGPUProfilerScopes())
+  bool enableGPUProfiler = false;
+  uint32_t gpuProfilerMaxScopesPerFrame = 1024;
+  // size of every buffer backing IContext::allocateTransient(); larger allocations get a buffer of their own size
+  size_t transientBufferSize = 4u * 1024u * 1024u;
+  // invoked when the usage of a memory heap rises above `memoryBudgetThreshold` of its budget; checked after buffers and
+  // textures are created and on every present
+  MemoryBudgetCallback memoryBudgetCallback = nullptr;
+  float memoryBudgetThreshold = 0.9f;
+  // falls back to PresentMode_Fifo if the surface does not support the requested mode
+  lvk::PresentMode presentMode = lvk::PresentMode_Default;
+  // submit(..., present) blocks until at most `maxFramesInFlight` - 1 previous frames are in flight: finished on the GPU, or
+  // displayed if present wait is enabled (falls back to the GPU if a present takes longer than 100 ms); 0 - no limit, i.e.
+  // throttled only by acquiring swapchain images and command buffers
+  uint32_t maxFramesInFlight = 0;
+  // enable VK_KHR_present_id and VK_KHR_present_wait if supported (see IContext::waitForPresent())
+  bool enablePresentWait = false;
 };
 
 [[nodiscard]] bool isDepthOrStencilFormat(lvk::Format format);
 [[nodiscard]] uint32_t calcNumMipLevels(uint32_t width, uint32_t height);
 [[nodiscard]] uint32_t getTextureBytesPerLayer(uint32_t width, uint32_t height, lvk::Format format, uint32_t level);
+// texels per compressed block; 1x1 for uncompressed formats
+[[nodiscard]] lvk::Dimensions getTextureBlockDimensions(lvk::Format format);
 [[nodiscard]] uint32_t getVertexFormatSize(lvk::VertexFormat format);
 void logShaderSource(const char* text);
 
+/*
+ * Headless contexts have no window, surface, or swapchain: no surface extensions are enabled, and they are intended for offscreen
+ * rendering, compute, and readback. Any number of contexts can coexist in one process, for example one per GPU. Without presents,
+ * frames are delimited by IContext::endFrame().
+ *   queryVulkanDevices(): all physical devices in enumeration order (only their number if `outDevices` is nullptr); pick one by
+ *     its index in `outDevices` or by `uuid`
+ *   createVulkanContextHeadless(cfg, device): the device with the same HWDeviceDesc::uuid (`guid` is ignored)
+ * Returns nullptr if there is no suitable device or the context cannot be initialized.
+ */
+uint32_t queryVulkanDevices(HWDeviceDesc* outDevices, uint32_t maxOutDevices);
+std::unique_ptr<lvk::IContext> createVulkanContextHeadless(const lvk::ContextConfig& cfg,
+                                                           lvk::HWDeviceType preferredDeviceType = lvk::HWDeviceType_Discrete);
+std::unique_ptr<lvk::IContext> createVulkanContextHeadless(const lvk::ContextConfig& cfg, const lvk::HWDeviceDesc& device);
+
 #if LVK_WITH_GLFW
 /*
  * width/height  > 0: window size in pixels
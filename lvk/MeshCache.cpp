@@ -0,0 +1,428 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "MeshCache.h"
+
+#include <stdio.h>
+#include <vector>
+
+#include <meshoptimizer.h>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace {
+
+struct MeshCacheHeader {
+  uint32_t magic;
+  uint32_t formatVersion;
+  uint32_t version;
+  uint32_t vertexStride;
+  uint32_t numVertices;
+  uint32_t numIndices;
+  uint32_t numChunks;
+  uint32_t reserved;
+  uint64_t fileSize;
+  uint64_t vertexDataOffset;
+  uint64_t vertexDataSize;
+  uint64_t indexDataOffset;
+  uint64_t indexDataSize;
+  // followed by `numChunks` ChunkEntry structures
+};
+
+constexpr uint32_t kMeshCacheMagic = 0x4D4B564C; // "LVKM"
+constexpr uint32_t kMeshCacheFormatVersion = 1; // the container layout, independent from MeshCacheDesc::version
+
+struct ChunkEntry {
+  uint64_t offset;
+  uint64_t size;
+};
+
+static_assert(sizeof(MeshCacheHeader) == 72);
+static_assert(sizeof(ChunkEntry) == 16);
+
+uint64_t alignOffset(uint64_t offset) {
+  return (offset + 15) & ~uint64_t(15);
+}
+
+bool isRangeValid(uint64_t offset, uint64_t size, uint64_t fileSize) {
+  return offset <= fileSize && size <= fileSize - offset;
+}
+
+const MeshCacheHeader* getHeader(const uint8_t* data) {
+  return reinterpret_cast<const MeshCacheHeader*>(data);
+}
+
+const ChunkEntry* getChunks(const uint8_t* data) {
+  return reinterpret_cast<const ChunkEntry*>(data + sizeof(MeshCacheHeader));
+}
+
+} // namespace
+
+lvk::Result lvk::saveMeshCache(const char* fileName, const MeshCacheDesc& desc) {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(fileName)) {
+    return Result(Result::Code::ArgumentOutOfRange, "Invalid file name");
+  }
+  if (!LVK_VERIFY(desc.vertexStride && desc.vertexStride % 4 == 0 && desc.vertexStride <= 256)) {
+    return Result(Result::Code::ArgumentOutOfRange, "Vertex stride should be a multiple of 4 and not larger than 256 bytes");
+  }
+  if (!LVK_VERIFY(desc.numIndices % 3 == 0)) {
+    return Result(Result::Code::ArgumentOutOfRange, "Indices should be a triangle list");
+  }
+  if (!LVK_VERIFY((desc.vertices || !desc.numVertices) && (desc.indices || !desc.numIndices) && (desc.chunks || !desc.numChunks))) {
+    return Result(Result::Code::ArgumentOutOfRange, "Missing mesh data");
+  }
+
+  std::vector<uint8_t> vertexData(meshopt_encodeVertexBufferBound(desc.numVertices, desc.vertexStride));
+  vertexData.resize(
+      meshopt_encodeVertexBuffer(vertexData.data(), vertexData.size(), desc.vertices, desc.numVertices, desc.vertexStride));
+
+  std::vector<uint8_t> indexData(meshopt_encodeIndexBufferBound(desc.numIndices, desc.numVertices));
+  indexData.resize(meshopt_encodeIndexBuffer(indexData.data(), indexData.size(), desc.indices, desc.numIndices));
+
+  if (!LVK_VERIFY((vertexData.size() || !desc.numVertices) && (indexData.size() || !desc.numIndices))) {
+    return Result(Result::Code::RuntimeError, "Cannot encode mesh data");
+  }
+
+  // layout: header, chunk table, vertex data, index data, chunks; every section starts at a 16-byte aligned offset
+  std::vector<ChunkEntry> chunks(desc.numChunks);
+
+  const uint64_t vertexDataOffset = alignOffset(sizeof(MeshCacheHeader) + sizeof(ChunkEntry) * chunks.size());
+  const uint64_t indexDataOffset = alignOffset(vertexDataOffset + vertexData.size());
+
+  uint64_t offset = indexDataOffset + indexData.size();
+
+  for (uint32_t i = 0; i != desc.numChunks; i++) {
+    chunks[i] = {.offset = alignOffset(offset), .size = desc.chunks[i].size};
+    offset = chunks[i].offset + chunks[i].size;
+  }
+
+  const MeshCacheHeader header = {
+      .magic = kMeshCacheMagic,
+      .formatVersion = kMeshCacheFormatVersion,
+      .version = desc.version,
+      .vertexStride = desc.vertexStride,
+      .numVertices = desc.numVertices,
+      .numIndices = desc.numIndices,
+      .numChunks = desc.numChunks,
+      .reserved = 0,
+      .fileSize = offset,
+      .vertexDataOffset = vertexDataOffset,
+      .vertexDataSize = vertexData.size(),
+      .indexDataOffset = indexDataOffset,
+      .indexDataSize = indexData.size(),
+  };
+
+  FILE* file = fopen(fileName, "wb");
+
+  if (!file) {
+    return Result(Result::Code::RuntimeError, "Cannot create mesh cache file");
+  }
+
+  uint64_t pos = 0;
+
+  auto write = [file, &pos](uint64_t at, const void* data, size_t size) -> bool {
+    static const uint8_t kZeros[16] = {};
+    const size_t padding = size_t(at - pos);
+    if (padding && fwrite(kZeros, 1, padding, file) != padding) {
+      return false;
+    }
+    pos = at + size;
+    return !size || fwrite(data, 1, size, file) == size;
+  };
+
+  bool success = write(0, &header, sizeof(header)) && write(sizeof(header), chunks.data(), sizeof(ChunkEntry) * chunks.size()) &&
+                 write(header.vertexDataOffset, vertexData.data(), vertexData.size()) &&
+                 write(header.indexDataOffset, indexData.data(), indexData.size());
+
+  for (uint32_t i = 0; success && i != desc.numChunks; i++) {
+    success = write(chunks[i].offset, desc.chunks[i].data, desc.chunks[i].size);
+  }
+
+  success = (fclose(file) == 0) && success;
+
+  return success ? Result() : Result(Result::Code::RuntimeError, "Cannot write mesh cache file");
+}
+
+lvk::MeshCache::~MeshCache() {
+  close();
+}
+
+lvk::Result lvk::MeshCache::open(const char* fileName, uint32_t version) {
+  LVK_PROFILER_FUNCTION();
+
+  close();
+
+  if (!LVK_VERIFY(fileName)) {
+    return Result(Result::Code::ArgumentOutOfRange, "Invalid file name");
+  }
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return Result(Result::Code::RuntimeError, "Cannot open mesh cache file");
+  }
+  LARGE_INTEGER fileSize = {};
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(MeshCacheHeader)) {
+    CloseHandle(file);
+    return Result(Result::Code::RuntimeError, "Invalid mesh cache file");
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (!data) {
+    if (mapping) {
+      CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    return Result(Result::Code::RuntimeError, "Cannot map mesh cache file");
+  }
+  file_ = file;
+  mapping_ = mapping;
+  size_ = (size_t)fileSize.QuadPart;
+#else
+  const int fd = ::open(fileName, O_RDONLY);
+  if (fd == -1) {
+    return Result(Result::Code::RuntimeError, "Cannot open mesh cache file");
+  }
+  struct stat st = {};
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(MeshCacheHeader)) {
+    ::close(fd);
+    return Result(Result::Code::RuntimeError, "Invalid mesh cache file");
+  }
+  void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file alive
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return Result(Result::Code::RuntimeError, "Cannot map mesh cache file");
+  }
+  madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+  size_ = (size_t)st.st_size;
+#endif // _WIN32
+
+  data_ = static_cast<const uint8_t*>(data);
+
+  const MeshCacheHeader* header = getHeader(data_);
+
+  if (header->magic != kMeshCacheMagic || header->formatVersion != kMeshCacheFormatVersion || header->version != version) {
+    close();
+    return Result(Result::Code::RuntimeError, "Mesh cache file has a wrong version");
+  }
+
+  const uint64_t fileSize = size_;
+
+  bool isValid = header->fileSize == fileSize &&
+                 isRangeValid(sizeof(MeshCacheHeader), sizeof(ChunkEntry) * uint64_t(header->numChunks), fileSize) &&
+                 isRangeValid(header->vertexDataOffset, header->vertexDataSize, fileSize) &&
+                 isRangeValid(header->indexDataOffset, header->indexDataSize, fileSize);
+
+  const ChunkEntry* chunks = getChunks(data_);
+
+  for (uint32_t i = 0; isValid && i != header->numChunks; i++) {
+    isValid = isRangeValid(chunks[i].offset, chunks[i].size, fileSize);
+  }
+
+  if (!isValid) {
+    close();
+    return Result(Result::Code::RuntimeError, "Mesh cache file is truncated");
+  }
+
+  return Result();
+}
+
+void lvk::MeshCache::close() {
+  if (!data_) {
+    return;
+  }
+
+#if defined(_WIN32)
+  UnmapViewOfFile(data_);
+  CloseHandle(mapping_);
+  CloseHandle(file_);
+  mapping_ = nullptr;
+  file_ = nullptr;
+#else
+  munmap(const_cast<uint8_t*>(data_), size_);
+#endif // _WIN32
+
+  data_ = nullptr;
+  size_ = 0;
+}
+
+uint32_t lvk::MeshCache::getVertexStride() const {
+  return data_ ? getHeader(data_)->vertexStride : 0;
+}
+
+uint32_t lvk::MeshCache::getNumVertices() const {
+  return data_ ? getHeader(data_)->numVertices : 0;
+}
+
+uint32_t lvk::MeshCache::getNumIndices() const {
+  return data_ ? getHeader(data_)->numIndices : 0;
+}
+
+uint32_t lvk::MeshCache::getNumChunks() const {
+  return data_ ? getHeader(data_)->numChunks : 0;
+}
+
+lvk::MeshCacheChunk lvk::MeshCache::getChunk(uint32_t index) const {
+  if (index >= getNumChunks()) {
+    return {};
+  }
+
+  const ChunkEntry& chunk = getChunks(data_)[index];
+
+  return {.data = data_ + chunk.offset, .size = (size_t)chunk.size};
+}
+
+lvk::Result lvk::MeshCache::decodeVertices(void* dst) const {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(data_ && dst)) {
+    return Result(Result::Code::ArgumentOutOfRange, "Mesh cache is not open");
+  }
+
+  const MeshCacheHeader* header = getHeader(data_);
+
+  const int result = meshopt_decodeVertexBuffer(
+      dst, header->numVertices, header->vertexStride, data_ + header->vertexDataOffset, (size_t)header->vertexDataSize);
+
+  return result == 0 ? Result() : Result(Result::Code::RuntimeError, "Cannot decode vertex data");
+}
+
+lvk::Result lvk::MeshCache::decodeIndices(uint32_t* dst) const {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(data_ && dst)) {
+    return Result(Result::Code::ArgumentOutOfRange, "Mesh cache is not open");
+  }
+
+  const MeshCacheHeader* header = getHeader(data_);
+
+  const int result = meshopt_decodeIndexBuffer(
+      dst, header->numIndices, sizeof(uint32_t), data_ + header->indexDataOffset, (size_t)header->indexDataSize);
+
+  return result == 0 ? Result() : Result(Result::Code::RuntimeError, "Cannot decode index data");
+}
+
+lvk::Result lvk::MeshCache::createBuffers(IContext& ctx,
+                                          Holder<BufferHandle>* outVertexBuffer,
+                                          Holder<BufferHandle>* outIndexBuffer,
+                                          const char* debugName) const {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(data_ && outVertexBuffer && outIndexBuffer)) {
+    return Result(Result::Code::ArgumentOutOfRange, "Mesh cache is not open");
+  }
+
+  const size_t vertexDataSize = size_t(getNumVertices()) * getVertexStride();
+  const size_t indexDataSize = size_t(getNumIndices()) * sizeof(uint32_t);
+
+  if (!LVK_VERIFY(vertexDataSize && indexDataSize)) {
+    return Result(Result::Code::ArgumentOutOfRange, "Mesh cache is empty");
+  }
+
+  char vertexBufferName[256] = {0};
+  char indexBufferName[256] = {0};
+  if (debugName) {
+    snprintf(vertexBufferName, sizeof(vertexBufferName) - 1, "Buffer: vertex (%s)", debugName);
+    snprintf(indexBufferName, sizeof(indexBufferName) - 1, "Buffer: index (%s)", debugName);
+  }
+
+  Result result;
+
+  Holder<BufferHandle> vertexBuffer = ctx.createBuffer(
+      {
+          .usage = BufferUsageBits_Vertex,
+          .storage = StorageType_Device,
+          .size = vertexDataSize,
+          .debugName = vertexBufferName,
+      },
+      &result);
+
+  if (!result.isOk()) {
+    return result;
+  }
+
+  Holder<BufferHandle> indexBuffer = ctx.createBuffer(
+      {
+          .usage = BufferUsageBits_Index,
+          .storage = StorageType_Device,
+          .size = indexDataSize,
+          .debugName = indexBufferName,
+      },
+      &result);
+
+  if (!result.isOk()) {
+    return result;
+  }
+
+  uint8_t* vertexPtr = ctx.getMappedPtr(vertexBuffer);
+  uint8_t* indexPtr = ctx.getMappedPtr(indexBuffer);
+
+  if (vertexPtr && indexPtr) {
+    // the buffers are host-visible (no staging), decode in place
+    result = decodeVertices(vertexPtr);
+    if (result.isOk()) {
+      result = decodeIndices(reinterpret_cast<uint32_t*>(indexPtr));
+    }
+    if (!result.isOk()) {
+      return result;
+    }
+    ctx.flushMappedMemory(vertexBuffer, 0, vertexDataSize);
+    ctx.flushMappedMemory(indexBuffer, 0, indexDataSize);
+  } else {
+    // `vertexDataSize` is a multiple of 4, so indices are aligned
+    Holder<BufferHandle> staging = ctx.createBuffer(
+        {
+            .usage = BufferUsageBits_Storage,
+            .storage = StorageType_HostVisible,
+            .size = vertexDataSize + indexDataSize,
+            .debugName = "Buffer: mesh cache staging",
+        },
+        &result);
+
+    if (!result.isOk()) {
+      return result;
+    }
+
+    uint8_t* ptr = ctx.getMappedPtr(staging);
+
+    if (!LVK_VERIFY(ptr)) {
+      return Result(Result::Code::RuntimeError, "Cannot map the staging buffer");
+    }
+
+    result = decodeVertices(ptr);
+    if (result.isOk()) {
+      result = decodeIndices(reinterpret_cast<uint32_t*>(ptr + vertexDataSize));
+    }
+    if (!result.isOk()) {
+      return result;
+    }
+    ctx.flushMappedMemory(staging, 0, vertexDataSize + indexDataSize);
+
+    ICommandBuffer& buffer = ctx.acquireCommandBuffer();
+    buffer.cmdCopyBuffer(staging, 0, vertexBuffer, 0, vertexDataSize);
+    buffer.cmdCopyBuffer(staging, vertexDataSize, indexBuffer, 0, indexDataSize);
+    ctx.submit(buffer);
+    // the staging buffer is destroyed after the GPU is done with it
+  }
+
+  *outVertexBuffer = std::move(vertexBuffer);
+  *outIndexBuffer = std::move(indexBuffer);
+
+  return Result();
+}
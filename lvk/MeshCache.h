@@ -0,0 +1,82 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <lvk/LVK.h>
+
+namespace lvk {
+
+// application data stored uncompressed next to the mesh (materials, meshlets, etc.)
+struct MeshCacheChunk {
+  const void* data = nullptr;
+  size_t size = 0;
+};
+
+struct MeshCacheDesc {
+  // application-defined version of the cached data; MeshCache::open() rejects files with a different version
+  uint32_t version = 0;
+  // `vertexStride` should be a multiple of 4 and not larger than 256 bytes (meshoptimizer vertex codec)
+  const void* vertices = nullptr;
+  uint32_t vertexStride = 0;
+  uint32_t numVertices = 0;
+  // triangle list; vertex fetch optimized indices (meshopt_optimizeVertexFetch()) compress much better
+  const uint32_t* indices = nullptr;
+  uint32_t numIndices = 0;
+  const MeshCacheChunk* chunks = nullptr;
+  uint32_t numChunks = 0;
+};
+
+// vertices and indices are compressed with meshoptimizer codecs; chunks are stored as-is and aligned to 16 bytes
+Result saveMeshCache(const char* fileName, const MeshCacheDesc& desc);
+
+// Optional reader of mesh cache files written by saveMeshCache():
+//   - the file is memory-mapped, so chunks are accessed in place without any reads or copies;
+//   - vertices and indices are decoded directly into their final destination, e.g. into mapped host-visible memory.
+class MeshCache final {
+ public:
+  MeshCache() = default;
+  ~MeshCache();
+  MeshCache(const MeshCache&) = delete;
+  MeshCache& operator=(const MeshCache&) = delete;
+
+  // fails if the file is missing, truncated, or has a different `version`
+  Result open(const char* fileName, uint32_t version);
+  void close();
+
+  [[nodiscard]] bool isOpen() const {
+    return data_ != nullptr;
+  }
+  [[nodiscard]] uint32_t getVertexStride() const;
+  [[nodiscard]] uint32_t getNumVertices() const;
+  [[nodiscard]] uint32_t getNumIndices() const;
+  [[nodiscard]] uint32_t getNumChunks() const;
+  // points into the mapped file and stays valid until close()
+  [[nodiscard]] MeshCacheChunk getChunk(uint32_t index) const;
+
+  // `dst` should have room for getNumVertices() * getVertexStride() bytes
+  Result decodeVertices(void* dst) const;
+  // `dst` should have room for getNumIndices() indices
+  Result decodeIndices(uint32_t* dst) const;
+
+  // creates StorageType_Device vertex and index buffers and decodes into a mapped host-visible staging buffer which is copied on the
+  // GPU (or directly into the buffers if they are host-visible, i.e. without staging)
+  Result createBuffers(IContext& ctx,
+                       Holder<BufferHandle>* outVertexBuffer,
+                       Holder<BufferHandle>* outIndexBuffer,
+                       const char* debugName = nullptr) const;
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#if defined(_WIN32)
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif // _WIN32
+};
+
+} // namespace lvk
@@ -0,0 +1,444 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "MipGenerator.h"
+#include "ShaderBindings.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+// textures with more mip-levels than this take the multi-pass path
+constexpr uint32_t kMaxSinglePassMipLevels = 13;
+// enough counters for this many single-pass textures between two resets
+constexpr uint32_t kMaxCounters = 256;
+
+// storage images are declared without a format, so every supported format goes through the same shaders
+const char* kCodeCommon = R"(
+#version 460
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_nonuniform_qualifier : require
+#extension GL_EXT_shader_image_load_formatted : require
+
+layout (set = 0, binding = )" LVK_STORAGE_IMAGES_BINDING R"() uniform coherent image2D kTextures2DInOut[];
+
+layout(std430, buffer_reference) coherent buffer Counters {
+  uint counters[];
+};
+
+layout(push_constant) uniform constants {
+  Counters counters;
+  uint counter; // single-pass: index into `counters`
+  uint level;   // multi-pass: the mip-level to write
+  uint numLevels;
+  uint isSRGB;
+  uvec2 size;
+  uint mips[16]; // storage views of individual mip-levels
+} pc;
+
+vec3 srgbToLinear(vec3 c) {
+  return mix(c / 12.92, pow((c + 0.055) / 1.055, vec3(2.4)), greaterThan(c, vec3(0.04045)));
+}
+
+vec3 linearToSrgb(vec3 c) {
+  return mix(c * 12.92, 1.055 * pow(c, vec3(1.0 / 2.4)) - 0.055, greaterThan(c, vec3(0.0031308)));
+}
+
+ivec2 levelSize(uint level) {
+  return max(ivec2(pc.size) >> int(level), ivec2(1));
+}
+
+vec4 load(uint level, ivec2 pos) {
+  vec4 v = imageLoad(kTextures2DInOut[pc.mips[level]], pos);
+  return pc.isSRGB != 0 ? vec4(srgbToLinear(v.rgb), v.a) : v;
+}
+
+void store(uint level, ivec2 pos, vec4 v) {
+  if (all(lessThan(pos, levelSize(level))))
+    imageStore(kTextures2DInOut[pc.mips[level]], pos, pc.isSRGB != 0 ? vec4(linearToSrgb(v.rgb), v.a) : v);
+}
+)";
+
+// every mip-level halves the previous one, i.e. a texel covers exactly 2x2 texels of the previous level (or 1x2, 2x1 and 1x1
+// texels once a dimension is down to 1): tiles of 64x64 texels are independent and produce 6 mip-levels each
+const char* kCodeSinglePass = R"(
+layout(local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+
+shared vec4 sTile[16][16];
+shared bool sIsLastWorkGroup;
+
+vec4 average(vec4 a, vec4 b, vec4 c, vec4 d) {
+  return 0.25 * (a + b + c + d);
+}
+
+// reduces a 64x64 tile of mip-level `base` into the next 6 mip-levels
+void downsampleTile(uint base, ivec2 tile) {
+  if (base + 1 >= pc.numLevels)
+    return;
+
+  // 16x16 threads: each thread reduces 4x4 texels of `base` into 2x2 texels of `base + 1` and 1 texel of `base + 2`
+  const ivec2 local = ivec2(gl_LocalInvocationIndex % 16, gl_LocalInvocationIndex / 16);
+  const ivec2 pos2 = 16 * tile + local;
+  const ivec2 size0 = levelSize(base);
+
+  vec4 v1[4];
+
+  for (int i = 0; i != 4; i++) {
+    const ivec2 pos1 = 2 * pos2 + ivec2(i & 1, i >> 1);
+    const ivec2 p0 = min(2 * pos1, size0 - 1);
+    const ivec2 p1 = min(2 * pos1 + 1, size0 - 1);
+    v1[i] = average(load(base, p0), load(base, ivec2(p1.x, p0.y)), load(base, ivec2(p0.x, p1.y)), load(base, p1));
+    store(base + 1, pos1, v1[i]);
+  }
+
+  if (base + 2 >= pc.numLevels)
+    return;
+
+  // dimensions of size 1 reuse their only texel
+  const ivec2 size1 = levelSize(base + 1);
+  const int dx = 2 * pos2.x + 1 < size1.x ? 1 : 0;
+  const int dy = 2 * pos2.y + 1 < size1.y ? 2 : 0;
+  const vec4 v2 = average(v1[0], v1[dx], v1[dy], v1[dx + dy]);
+  store(base + 2, pos2, v2);
+  sTile[local.y][local.x] = v2;
+
+  for (uint i = 3; i <= 6; i++) {
+    const uint level = base + i;
+
+    if (level >= pc.numLevels)
+      return;
+
+    const int n = 64 >> i; // this level of the tile is n x n texels
+    const bool isActive = local.x < n && local.y < n;
+    const ivec2 pos = n * tile + local;
+
+    barrier();
+
+    vec4 v = vec4(0.0);
+
+    if (isActive) {
+      const ivec2 origin = 2 * n * tile;
+      const ivec2 size = levelSize(level - 1);
+      const ivec2 p0 = clamp(min(2 * pos, size - 1) - origin, ivec2(0), ivec2(2 * n - 1));
+      const ivec2 p1 = clamp(min(2 * pos + 1, size - 1) - origin, ivec2(0), ivec2(2 * n - 1));
+      v = average(sTile[p0.y][p0.x], sTile[p0.y][p1.x], sTile[p1.y][p0.x], sTile[p1.y][p1.x]);
+    }
+
+    barrier();
+
+    if (isActive) {
+      sTile[local.y][local.x] = v;
+      store(level, pos, v);
+    }
+  }
+}
+
+void main() {
+  downsampleTile(0, ivec2(gl_WorkGroupID.xy));
+
+  if (pc.numLevels <= 7)
+    return;
+
+  // mip-level 6 is complete when all workgroups are done: the last one reduces it (at most 64x64 texels) into the remaining levels
+  memoryBarrierImage();
+  barrier();
+
+  if (gl_LocalInvocationIndex == 0) {
+    const uint numWorkGroups = gl_NumWorkGroups.x * gl_NumWorkGroups.y;
+    sIsLastWorkGroup = atomicAdd(pc.counters.counters[pc.counter], 1) == numWorkGroups - 1;
+  }
+
+  barrier();
+
+  if (!sIsLastWorkGroup)
+    return;
+
+  memoryBarrierImage();
+
+  downsampleTile(6, ivec2(0));
+}
+)";
+
+// one mip-level per dispatch: along odd dimensions, a texel covers 1.5 texels of the previous level and takes 3 weighted taps
+// https://download.nvidia.com/developer/Papers/2005/NP2_Mipmapping/NP2_Mipmap_Creation.pdf
+const char* kCodeMultiPass = R"(
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+vec3 getWeights(int x, int srcSize, int dstSize) {
+  if (srcSize == 1)
+    return vec3(1.0, 0.0, 0.0);
+  if ((srcSize & 1) == 0)
+    return vec3(0.5, 0.5, 0.0);
+  return vec3(dstSize - x, dstSize, x + 1) / float(srcSize);
+}
+
+void main() {
+  const ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+  const ivec2 dstSize = levelSize(pc.level);
+
+  if (any(greaterThanEqual(pos, dstSize)))
+    return;
+
+  const ivec2 srcSize = levelSize(pc.level - 1);
+  const vec3 wx = getWeights(pos.x, srcSize.x, dstSize.x);
+  const vec3 wy = getWeights(pos.y, srcSize.y, dstSize.y);
+
+  vec4 v = vec4(0.0);
+
+  for (int y = 0; y != 3; y++) {
+    for (int x = 0; x != 3; x++) {
+      const float w = wx[x] * wy[y];
+      if (w > 0.0)
+        v += w * load(pc.level - 1, min(2 * pos + ivec2(x, y), srcSize - 1));
+    }
+  }
+
+  store(pc.level, pos, v);
+}
+)";
+
+struct PushConstants {
+  uint64_t counters;
+  uint32_t counter;
+  uint32_t level;
+  uint32_t numLevels;
+  uint32_t isSRGB;
+  uint32_t size[2];
+  uint32_t mips[lvk::LVK_MAX_MIP_LEVELS];
+};
+
+static_assert(sizeof(PushConstants) == 96, "Should match the GLSL push constants");
+
+bool isSRGB(lvk::Format format) {
+  return format == lvk::Format_RGBA_SRGB8 || format == lvk::Format_BGRA_SRGB8;
+}
+
+// sRGB formats cannot be storage images
+lvk::Format getStorageViewFormat(lvk::Format format) {
+  return format == lvk::Format_RGBA_SRGB8   ? lvk::Format_RGBA_UN8
+         : format == lvk::Format_BGRA_SRGB8 ? lvk::Format_BGRA_UN8
+                                             : format;
+}
+
+// a single dispatch needs every mip-level to halve the previous one, and the last workgroup to cover all of mip-level 6
+bool isSinglePass(const lvk::Dimensions& size, uint32_t numMipLevels) {
+  if (numMipLevels > kMaxSinglePassMipLevels || (numMipLevels > 7 && (size.width > 4096 || size.height > 4096))) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i + 1 < numMipLevels; i++) {
+    const uint32_t w = std::max(size.width >> i, 1u);
+    const uint32_t h = std::max(size.height >> i, 1u);
+    if ((w > 1 && (w & 1)) || (h > 1 && (h & 1))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+lvk::MipGenerator::MipGenerator(lvk::IContext& ctx) : ctx_(ctx) {
+  LVK_PROFILER_FUNCTION();
+
+  const std::string codeSinglePass = std::string(kCodeCommon) + kCodeSinglePass;
+  const std::string codeMultiPass = std::string(kCodeCommon) + kCodeMultiPass;
+
+  smSinglePass_ = ctx_.createShaderModule({codeSinglePass.c_str(), lvk::Stage_Comp, "Shader Module: mip generator single-pass (comp)"});
+  smMultiPass_ = ctx_.createShaderModule({codeMultiPass.c_str(), lvk::Stage_Comp, "Shader Module: mip generator multi-pass (comp)"});
+
+  pipelineSinglePass_ = ctx_.createComputePipeline({.smComp = smSinglePass_, .debugName = "Pipeline: mip generator single-pass"});
+  pipelineMultiPass_ = ctx_.createComputePipeline({.smComp = smMultiPass_, .debugName = "Pipeline: mip generator multi-pass"});
+
+  counters_ = ctx_.createBuffer({
+      .usage = lvk::BufferUsageBits_Storage,
+      .storage = lvk::StorageType_Device,
+      .size = sizeof(uint32_t) * kMaxCounters,
+      .debugName = "Buffer: mip generator counters",
+  });
+}
+
+bool lvk::MipGenerator::isSupported(Format format) const {
+  // the storage image support of a format varies between devices (e.g. BGRA_UN8), so the list below is only an upper bound
+  switch (format) {
+  case Format_R_UN8:
+  case Format_R_UN16:
+  case Format_R_F16:
+  case Format_R_F32:
+  case Format_RG_UN8:
+  case Format_RG_UN16:
+  case Format_RG_F16:
+  case Format_RG_F32:
+  case Format_RGBA_UN8:
+  case Format_RGBA_F16:
+  case Format_RGBA_F32:
+  case Format_RGBA_SRGB8:
+  case Format_BGRA_UN8:
+  case Format_BGRA_SRGB8:
+    return ctx_.isStorageFormatSupported(getStorageViewFormat(format));
+  default:
+    return false;
+  }
+}
+
+const lvk::MipGenerator::TextureMips* lvk::MipGenerator::getTextureMips(TextureHandle texture) {
+  auto it = textureMips_.find(texture.index());
+
+  if (it != textureMips_.end() && it->second.texture == texture) {
+    return &it->second;
+  }
+
+  const Format format = ctx_.getFormat(texture);
+
+  if (!LVK_VERIFY(isSupported(format))) {
+    return nullptr;
+  }
+
+  TextureMips mips = {
+      .texture = texture,
+      .size = ctx_.getDimensions(texture),
+      .numMipLevels = ctx_.getNumMipLevels(texture),
+      .isSRGB = isSRGB(format),
+  };
+  mips.isSinglePass = isSinglePass(mips.size, mips.numMipLevels);
+
+  const Format viewFormat = getStorageViewFormat(format);
+
+  for (uint32_t i = 0; i != mips.numMipLevels; i++) {
+    Result result;
+    mips.mips[i] = ctx_.createTextureView(texture, {.mipLevel = i, .format = viewFormat}, "Texture: mip generator (mip)", &result);
+    if (!LVK_VERIFY(result.isOk())) {
+      return nullptr;
+    }
+  }
+
+  // a destroyed texture could have left its views here
+  TextureMips& entry = textureMips_[texture.index()];
+  entry = std::move(mips);
+
+  return &entry;
+}
+
+void lvk::MipGenerator::release(TextureHandle texture) {
+  auto it = textureMips_.find(texture.index());
+
+  if (it != textureMips_.end() && it->second.texture == texture) {
+    textureMips_.erase(it);
+  }
+}
+
+void lvk::MipGenerator::clear() {
+  textureMips_.clear();
+}
+
+void lvk::MipGenerator::generate(ICommandBuffer& buffer, const TextureHandle* textures, uint32_t numTextures, uint16_t srcUsage) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(textures || !numTextures);
+
+  std::vector<const TextureMips*> batch;
+  batch.reserve(numTextures);
+
+  uint32_t maxMultiPassMipLevels = 0;
+
+  for (uint32_t i = 0; i != numTextures; i++) {
+    const TextureMips* mips = getTextureMips(textures[i]);
+    if (mips && mips->numMipLevels > 1) {
+      batch.push_back(mips);
+      if (!mips->isSinglePass) {
+        maxMultiPassMipLevels = std::max(maxMultiPassMipLevels, mips->numMipLevels);
+      }
+    }
+  }
+
+  if (batch.empty()) {
+    return;
+  }
+
+  buffer.cmdPushDebugGroupLabel("Generate mipmaps (compute)", 0xff00ffff);
+
+  std::vector<lvk::TextureBarrier> barriers;
+  barriers.reserve(batch.size());
+
+  for (const TextureMips* mips : batch) {
+    barriers.push_back({.texture = mips->texture, .srcUsage = srcUsage, .dstUsage = lvk::ResourceUsageBits_ShaderWriteCompute});
+  }
+  buffer.cmdPipelineBarrier(barriers.data(), (uint32_t)barriers.size());
+
+  auto getPushConstants = [this](const TextureMips& mips) {
+    PushConstants pc = {
+        .counters = ctx_.gpuAddress(counters_),
+        .numLevels = mips.numMipLevels,
+        .isSRGB = mips.isSRGB,
+        .size = {mips.size.width, mips.size.height},
+    };
+    for (uint32_t i = 0; i != mips.numMipLevels; i++) {
+      pc.mips[i] = mips.mips[i].index();
+    }
+    return pc;
+  };
+
+  // 1. Single-pass textures: independent dispatches without barriers in between
+  uint32_t numCounters = 0;
+
+  for (const TextureMips* mips : batch) {
+    if (!mips->isSinglePass) {
+      continue;
+    }
+    if (numCounters % kMaxCounters == 0) {
+      // cmdFillBuffer() waits for the previous dispatches which use the same counters
+      buffer.cmdFillBuffer(counters_, 0, sizeof(uint32_t) * kMaxCounters, 0);
+      buffer.cmdBindComputePipeline(pipelineSinglePass_);
+    }
+    PushConstants pc = getPushConstants(*mips);
+    pc.counter = numCounters++ % kMaxCounters;
+    buffer.cmdPushConstants(pc);
+    buffer.cmdDispatchThreadGroups({.width = (mips->size.width + 63) / 64, .height = (mips->size.height + 63) / 64});
+  }
+
+  // 2. Multi-pass textures: one barrier per mip-level for all of them
+  if (maxMultiPassMipLevels) {
+    buffer.cmdBindComputePipeline(pipelineMultiPass_);
+  }
+
+  for (uint32_t level = 1; level < maxMultiPassMipLevels; level++) {
+    barriers.clear();
+    for (const TextureMips* mips : batch) {
+      if (mips->isSinglePass || level >= mips->numMipLevels) {
+        continue;
+      }
+      PushConstants pc = getPushConstants(*mips);
+      pc.level = level;
+      buffer.cmdPushConstants(pc);
+      const uint32_t width = std::max(mips->size.width >> level, 1u);
+      const uint32_t height = std::max(mips->size.height >> level, 1u);
+      buffer.cmdDispatchThreadGroups({.width = (width + 7) / 8, .height = (height + 7) / 8});
+      if (level + 1 < mips->numMipLevels) {
+        barriers.push_back({.texture = mips->texture,
+                            .srcUsage = lvk::ResourceUsageBits_ShaderWriteCompute,
+                            .dstUsage = lvk::ResourceUsageBits_ShaderWriteCompute});
+      }
+    }
+    if (!barriers.empty()) {
+      buffer.cmdPipelineBarrier(barriers.data(), (uint32_t)barriers.size());
+    }
+  }
+
+  barriers.clear();
+
+  for (const TextureMips* mips : batch) {
+    barriers.push_back({.texture = mips->texture,
+                        .srcUsage = lvk::ResourceUsageBits_ShaderWriteCompute,
+                        .dstUsage = lvk::ResourceUsageBits_ShaderReadGraphics | lvk::ResourceUsageBits_ShaderReadCompute});
+  }
+  buffer.cmdPipelineBarrier(barriers.data(), (uint32_t)barriers.size());
+
+  buffer.cmdPopDebugGroupLabel();
+}
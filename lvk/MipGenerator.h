@@ -0,0 +1,74 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <lvk/LVK.h>
+
+#include <unordered_map>
+
+namespace lvk {
+
+// Optional compute-based mip generation on top of IContext, for formats where vkCmdBlitImage() is slow or unsupported and for
+// textures generated or streamed at runtime:
+//   - textures whose every mip-level halves the previous one (down to 1 texel in a dimension) take one dispatch which produces up to
+//     12 mip-levels (single-pass downsampler, as in AMD FidelityFX SPD): 64x64 tiles are reduced in shared memory, and the last
+//     finished workgroup reduces the remaining levels;
+//   - other non-power-of-two textures take one dispatch per mip-level with a 3-tap polyphase box filter along odd dimensions;
+//   - sRGB textures are filtered in linear space and written through UNORM views (see TextureViewDesc::format);
+//   - all textures of one generate() share their barriers, so a batch costs as much synchronization as one texture.
+// Textures should be 2D, have TextureUsageBits_Sampled | TextureUsageBits_Storage, and a format accepted by isSupported().
+class MipGenerator final {
+ public:
+  explicit MipGenerator(lvk::IContext& ctx);
+
+  // uncompressed UNORM, float, and sRGB color formats which the device supports as storage images (via UNORM views for sRGB);
+  // use IContext::generateMipmap() for the rest
+  [[nodiscard]] bool isSupported(Format format) const;
+
+  // Generates mip-levels 1.. of all `textures` from their mip-level 0; outside of cmdBeginRendering()/cmdEndRendering().
+  // `srcUsage` is how mip-level 0 has been written: ResourceUsageBits_TransferDst after upload(), ResourceUsageBits_ColorAttachment
+  // after rendering into it, etc. The textures are left in the shader read-only layout.
+  void generate(ICommandBuffer& buffer,
+                const TextureHandle* textures,
+                uint32_t numTextures,
+                uint16_t srcUsage = ResourceUsageBits_TransferDst);
+  void generate(ICommandBuffer& buffer, TextureHandle texture, uint16_t srcUsage = ResourceUsageBits_TransferDst) {
+    generate(buffer, &texture, 1, srcUsage);
+  }
+
+  // storage views of individual mip-levels are cached per texture and keep its memory alive until released
+  void release(TextureHandle texture);
+  void clear();
+
+ private:
+  struct TextureMips {
+    TextureHandle texture;
+    Dimensions size = {};
+    uint32_t numMipLevels = 0;
+    bool isSRGB = false;
+    bool isSinglePass = false;
+    lvk::Holder<lvk::TextureHandle> mips[LVK_MAX_MIP_LEVELS] = {};
+  };
+
+  const TextureMips* getTextureMips(TextureHandle texture);
+
+ private:
+  lvk::IContext& ctx_;
+
+  lvk::Holder<lvk::ShaderModuleHandle> smSinglePass_;
+  lvk::Holder<lvk::ShaderModuleHandle> smMultiPass_;
+  lvk::Holder<lvk::ComputePipelineHandle> pipelineSinglePass_;
+  lvk::Holder<lvk::ComputePipelineHandle> pipelineMultiPass_;
+
+  // single-pass dispatches count finished workgroups here; one counter per texture of a batch
+  lvk::Holder<lvk::BufferHandle> counters_;
+
+  std::unordered_map<uint32_t, TextureMips> textureMips_; // keyed on the index of the texture
+};
+
+} // namespace lvk
@@ -1,7 +1,12 @@
 ﻿#pragma once
 
 #include <assert.h>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
 #include <vector>
 
 #include "lvk/LVK.h"
@@ -9,46 +14,172 @@
 /// Pool<> is used only by the implementation
 namespace lvk {
 
+/// A vector which never moves its elements: it grows by allocating fixed-size chunks, so references to the elements stay valid
+/// and can be read on other threads while new elements are appended. Appending is not thread-safe and is synchronized by Pool<>.
+template<typename T, uint32_t kChunkSizeLog2 = 8, uint32_t kMaxChunks = 4096>
+class ChunkedVector {
+  static constexpr uint32_t kChunkSize = 1u << kChunkSizeLog2;
+
+ public:
+  ChunkedVector() = default;
+  ~ChunkedVector() {
+    clear();
+  }
+  ChunkedVector(const ChunkedVector&) = delete;
+  ChunkedVector& operator=(const ChunkedVector&) = delete;
+
+  template<typename Self, typename Element>
+  class Iterator {
+   public:
+    Iterator(Self* v, uint32_t i) : v_(v), i_(i) {}
+    Element& operator*() const {
+      return (*v_)[i_];
+    }
+    Iterator& operator++() {
+      i_++;
+      return *this;
+    }
+    bool operator!=(const Iterator& other) const {
+      return i_ != other.i_;
+    }
+
+   private:
+    Self* v_ = nullptr;
+    uint32_t i_ = 0;
+  };
+
+  uint32_t size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+  T& operator[](uint32_t i) {
+    return chunks_[i >> kChunkSizeLog2][i & (kChunkSize - 1)];
+  }
+  const T& operator[](uint32_t i) const {
+    return chunks_[i >> kChunkSizeLog2][i & (kChunkSize - 1)];
+  }
+  T& front() {
+    assert(!empty());
+    return (*this)[0];
+  }
+  Iterator<ChunkedVector, T> begin() {
+    return {this, 0};
+  }
+  Iterator<ChunkedVector, T> end() {
+    return {this, size()};
+  }
+  Iterator<const ChunkedVector, const T> begin() const {
+    return {this, 0};
+  }
+  Iterator<const ChunkedVector, const T> end() const {
+    return {this, size()};
+  }
+  // returns nullptr if all the chunks are used (the arguments are not consumed then)
+  template<typename... Args>
+  T* emplace_back(Args&&... args) {
+    const uint32_t i = size_.load(std::memory_order_relaxed);
+    const uint32_t chunk = i >> kChunkSizeLog2;
+    if (chunk >= kMaxChunks) {
+      return nullptr;
+    }
+    if (!chunks_[chunk]) {
+      chunks_[chunk] = std::allocator<T>().allocate(kChunkSize);
+    }
+    T* element = new (&chunks_[chunk][i & (kChunkSize - 1)]) T(std::forward<Args>(args)...);
+    // publish the element after it is constructed
+    size_.store(i + 1, std::memory_order_release);
+    return element;
+  }
+  void clear() {
+    const uint32_t n = size();
+    for (uint32_t i = 0; i != n; i++) {
+      (*this)[i].~T();
+    }
+    for (T*& chunk : chunks_) {
+      if (chunk) {
+        std::allocator<T>().deallocate(chunk, kChunkSize);
+        chunk = nullptr;
+      }
+    }
+    size_.store(0, std::memory_order_release);
+  }
+
+ private:
+  T* chunks_[kMaxChunks] = {};
+  std::atomic<uint32_t> size_ = 0;
+};
+
+/// Thread-safe: objects can be created and destroyed on any thread (e.g. by asset loaders). Lookups are lock-free and the returned
+/// pointers stay valid until the object is destroyed; the application is responsible for not destroying an object which is in use.
+/// Iterating over `objects_` (e.g. to read all objects) requires locking `mutex_`.
 template<typename ObjectType, typename ImplObjectType>
 class Pool {
   static constexpr uint32_t kListEndSentinel = 0xffffffff;
   struct PoolEntry {
-    explicit PoolEntry(ImplObjectType& obj) : obj_(std::move(obj)) {}
+    explicit PoolEntry(ImplObjectType&& obj) : obj_(std::move(obj)) {}
     ImplObjectType obj_ = {};
-    uint32_t gen_ = 1;
+    // written under `mutex_`; read by lock-free lookups
+    std::atomic<uint32_t> gen_ = 1;
     uint32_t nextFree_ = kListEndSentinel;
   };
   uint32_t freeListHead_ = kListEndSentinel;
-  uint32_t numObjects_ = 0;
+  std::atomic<uint32_t> numObjects_ = 0;
 
  public:
-  std::vector<PoolEntry> objects_;
+  ChunkedVector<PoolEntry> objects_;
+  // indices of slots which were created or freed since the last time they were consumed (only if trackDirtySlots_ is set);
+  // consumers have to lock `mutex_`
+  std::vector<uint32_t> dirtySlots_;
+  bool trackDirtySlots_ = false;
+  // guards the free list, `dirtySlots_` and appending to `objects_`
+  mutable std::mutex mutex_;
 
+  // returns an empty handle if the pool is full; `obj` is not consumed then and the caller has to release it
   Handle<ObjectType> create(ImplObjectType&& obj) {
+    std::lock_guard lock(mutex_);
     uint32_t idx = 0;
     if (freeListHead_ != kListEndSentinel) {
       idx = freeListHead_;
       freeListHead_ = objects_[idx].nextFree_;
       objects_[idx].obj_ = std::move(obj);
     } else {
-      idx = (uint32_t)objects_.size();
-      objects_.emplace_back(obj);
+      idx = objects_.size();
+      if (!objects_.emplace_back(std::move(obj))) {
+        return {};
+      }
     }
     numObjects_++;
-    return Handle<ObjectType>(idx, objects_[idx].gen_);
+    if (trackDirtySlots_) {
+      dirtySlots_.push_back(idx);
+    }
+    return Handle<ObjectType>(idx, objects_[idx].gen_.load(std::memory_order_relaxed));
   }
-  void destroy(Handle<ObjectType> handle) {
+  // if `recycleSlot` is false, the slot is not reused until freeSlot() is called
+  void destroy(Handle<ObjectType> handle, bool recycleSlot = true) {
     if (handle.empty())
       return;
-    assert(numObjects_ > 0); // double deletion
-    const uint32_t index = handle.index();
-    assert(index < objects_.size());
-    assert(handle.gen() == objects_[index].gen_); // double deletion
-    objects_[index].obj_ = ImplObjectType{};
-    objects_[index].gen_++;
-    objects_[index].nextFree_ = freeListHead_;
-    freeListHead_ = index;
-    numObjects_--;
+    // the object is destroyed outside of the lock - destructors can schedule deferred tasks or touch other pools
+    ImplObjectType obj = {};
+    {
+      std::lock_guard lock(mutex_);
+      assert(numObjects_ > 0); // double deletion
+      const uint32_t index = handle.index();
+      assert(index < objects_.size());
+      assert(handle.gen() == objects_[index].gen_.load(std::memory_order_relaxed)); // double deletion
+      obj = std::move(objects_[index].obj_);
+      objects_[index].obj_ = ImplObjectType{};
+      objects_[index].gen_.fetch_add(1, std::memory_order_release);
+      numObjects_--;
+      if (recycleSlot) {
+        freeSlotLocked(index);
+      }
+    }
+  }
+  void freeSlot(uint32_t index) {
+    std::lock_guard lock(mutex_);
+    freeSlotLocked(index);
   }
   const ImplObjectType* get(Handle<ObjectType> handle) const {
     if (handle.empty())
@@ -56,7 +187,7 @@ class Pool {
 
     const uint32_t index = handle.index();
     assert(index < objects_.size());
-    assert(handle.gen() == objects_[index].gen_); // accessing deleted object
+    assert(handle.gen() == objects_[index].gen_.load(std::memory_order_acquire)); // accessing deleted object
     return &objects_[index].obj_;
   }
   ImplObjectType* get(Handle<ObjectType> handle) {
@@ -65,36 +196,56 @@ class Pool {
 
     const uint32_t index = handle.index();
     assert(index < objects_.size());
-    assert(handle.gen() == objects_[index].gen_); // accessing deleted object
+    assert(handle.gen() == objects_[index].gen_.load(std::memory_order_acquire)); // accessing deleted object
     return &objects_[index].obj_;
   }
+  bool isValid(Handle<ObjectType> handle) const {
+    return !handle.empty() && handle.index() < objects_.size() &&
+           handle.gen() == objects_[handle.index()].gen_.load(std::memory_order_acquire);
+  }
   Handle<ObjectType> getHandle(uint32_t index) const {
     assert(index < objects_.size());
     if (index >= objects_.size())
       return {};
 
-    return Handle<ObjectType>(index, objects_[index].gen_);
+    return Handle<ObjectType>(index, objects_[index].gen_.load(std::memory_order_acquire));
   }
   Handle<ObjectType> findObject(const ImplObjectType* obj) {
     if (!obj)
       return {};
 
-    for (size_t idx = 0; idx != objects_.size(); idx++) {
+    std::lock_guard lock(mutex_);
+
+    for (uint32_t idx = 0; idx != objects_.size(); idx++) {
       if (objects_[idx].obj_ == *obj) {
-        return Handle<ObjectType>((uint32_t)idx, objects_[idx].gen_);
+        return Handle<ObjectType>(idx, objects_[idx].gen_.load(std::memory_order_relaxed));
       }
     }
 
     return {};
   }
   void clear() {
+    std::lock_guard lock(mutex_);
     objects_.clear();
+    dirtySlots_.clear();
     freeListHead_ = kListEndSentinel;
     numObjects_ = 0;
   }
   uint32_t numObjects() const {
     return numObjects_;
   }
+
+ private:
+  void freeSlotLocked(uint32_t index) {
+    // the pool might have been cleared already
+    if (index >= objects_.size())
+      return;
+    objects_[index].nextFree_ = freeListHead_;
+    freeListHead_ = index;
+    if (trackDirtySlots_) {
+      dirtySlots_.push_back(index);
+    }
+  }
 };
 
 } // namespace lvk
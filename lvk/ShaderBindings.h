@@ -0,0 +1,17 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// Binding of the bindless storage images in set 0 (kBinding_StorageImages in VulkanClasses.cpp) for GLSL sources which declare
+// them explicitly, e.g. compute shaders of MipGenerator and GPUCulling.
+// https://github.com/KhronosGroup/MoltenVK/issues/2106
+#if defined(__APPLE__)
+#define LVK_STORAGE_IMAGES_BINDING "0"
+#else
+#define LVK_STORAGE_IMAGES_BINDING "2"
+#endif // __APPLE__
@@ -0,0 +1,238 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "TextureStreamer.h"
+
+#include <algorithm>
+
+lvk::TextureStreamer::~TextureStreamer() {
+  for (StreamingTexture& tex : textures_) {
+    if (tex.releaseData) {
+      tex.releaseData();
+    }
+  }
+}
+
+lvk::TextureStreamer::TextureId lvk::TextureStreamer::createTexture(const TextureDesc& desc,
+                                                                    std::function<void()>&& releaseData,
+                                                                    Result* outResult) {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(desc.type == TextureType_2D && desc.numLayers == 1 && desc.numSamples <= 1 && desc.numMipLevels && desc.data)) {
+    if (releaseData) {
+      releaseData();
+    }
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Only 2D textures with data can be streamed");
+    return kInvalidTexture;
+  }
+
+  TextureDesc texDesc = desc;
+  texDesc.data = nullptr;
+
+  Result result;
+
+  StreamingTexture tex = {
+      .texture = ctx_.createTexture(texDesc, nullptr, &result),
+      .format = desc.format,
+      .dimensions = desc.dimensions,
+      .numMipLevels = desc.numMipLevels,
+      .swizzle = desc.swizzle,
+      .debugName = desc.debugName ? desc.debugName : "",
+      .data = static_cast<const uint8_t*>(desc.data),
+      .releaseData = std::move(releaseData),
+  };
+
+  if (!result.isOk()) {
+    if (tex.releaseData) {
+      tex.releaseData();
+    }
+    Result::setResult(outResult, result);
+    return kInvalidTexture;
+  }
+
+  tex.mipOffsets.resize(tex.numMipLevels);
+
+  for (uint32_t l = 1; l != tex.numMipLevels; l++) {
+    tex.mipOffsets[l] = tex.mipOffsets[l - 1] + getTextureBytesPerLayer(tex.dimensions.width, tex.dimensions.height, tex.format, l - 1);
+  }
+
+  // the smallest mip-levels which fit into `initialBytes_` (at least one) are uploaded right away
+  uint32_t mipLevel = tex.numMipLevels - 1;
+  uint32_t bytes = getTextureBytesPerLayer(tex.dimensions.width, tex.dimensions.height, tex.format, mipLevel);
+
+  while (mipLevel > 0) {
+    const uint32_t size = getTextureBytesPerLayer(tex.dimensions.width, tex.dimensions.height, tex.format, mipLevel - 1);
+    if (bytes + size > initialBytes_) {
+      break;
+    }
+    bytes += size;
+    mipLevel--;
+  }
+
+  result = uploadMipLevels(tex, mipLevel, tex.numMipLevels - mipLevel);
+
+  if (!result.isOk()) {
+    if (tex.releaseData) {
+      tex.releaseData();
+    }
+    Result::setResult(outResult, result);
+    return kInvalidTexture;
+  }
+
+  tex.residentMipLevel = mipLevel;
+
+  updateView(tex);
+
+  TextureId id = kInvalidTexture;
+
+  if (freeIds_.empty()) {
+    id = (TextureId)textures_.size();
+    textures_.push_back(std::move(tex));
+  } else {
+    id = freeIds_.back();
+    freeIds_.pop_back();
+    textures_[id] = std::move(tex);
+  }
+
+  Result::setResult(outResult, Result());
+
+  return id;
+}
+
+void lvk::TextureStreamer::destroy(TextureId id) {
+  if (id >= textures_.size() || textures_[id].texture.empty()) {
+    return;
+  }
+
+  StreamingTexture& tex = textures_[id];
+
+  if (tex.releaseData) {
+    tex.releaseData();
+  }
+
+  tex = {};
+
+  freeIds_.push_back(id);
+}
+
+bool lvk::TextureStreamer::update() {
+  LVK_PROFILER_FUNCTION();
+
+  const uint32_t numTextures = (uint32_t)textures_.size();
+
+  if (!numTextures) {
+    return false;
+  }
+
+  std::vector<uint32_t> newResidentMipLevels(numTextures);
+
+  for (uint32_t i = 0; i != numTextures; i++) {
+    newResidentMipLevels[i] = textures_[i].residentMipLevel;
+  }
+
+  uint32_t budget = bytesPerFrame_;
+  bool hasUploads = false;
+  bool isBudgetExhausted = false;
+
+  // breadth-first: every round refines each texture by one mip-level, so all textures get sharper at the same rate
+  for (bool hasProgress = true; hasProgress && !isBudgetExhausted;) {
+    hasProgress = false;
+    for (uint32_t n = 0; n != numTextures; n++) {
+      const uint32_t i = (nextTexture_ + n) % numTextures;
+      const StreamingTexture& tex = textures_[i];
+      if (tex.texture.empty() || !newResidentMipLevels[i]) {
+        continue;
+      }
+      const uint32_t mipLevel = newResidentMipLevels[i] - 1;
+      const uint32_t size = getTextureBytesPerLayer(tex.dimensions.width, tex.dimensions.height, tex.format, mipLevel);
+      // a mip-level larger than the entire budget is uploaded alone
+      if (size > budget && hasUploads) {
+        nextTexture_ = i;
+        isBudgetExhausted = true;
+        break;
+      }
+      if (!LVK_VERIFY(uploadMipLevels(tex, mipLevel, 1).isOk())) {
+        continue;
+      }
+      newResidentMipLevels[i] = mipLevel;
+      budget -= std::min(size, budget);
+      hasUploads = true;
+      hasProgress = true;
+    }
+  }
+
+  bool hasChanges = false;
+
+  for (uint32_t i = 0; i != numTextures; i++) {
+    StreamingTexture& tex = textures_[i];
+    if (newResidentMipLevels[i] != tex.residentMipLevel) {
+      tex.residentMipLevel = newResidentMipLevels[i];
+      updateView(tex);
+      hasChanges = true;
+    }
+  }
+
+  return hasChanges;
+}
+
+lvk::TextureHandle lvk::TextureStreamer::getTexture(TextureId id) const {
+  if (id >= textures_.size()) {
+    return {};
+  }
+
+  const StreamingTexture& tex = textures_[id];
+
+  return tex.view.empty() ? tex.texture : tex.view;
+}
+
+uint32_t lvk::TextureStreamer::getResidentMipLevel(TextureId id) const {
+  return id < textures_.size() ? textures_[id].residentMipLevel : 0;
+}
+
+uint32_t lvk::TextureStreamer::getNumStreamingTextures() const {
+  uint32_t num = 0;
+
+  for (const StreamingTexture& tex : textures_) {
+    if (!tex.texture.empty() && tex.residentMipLevel) {
+      num++;
+    }
+  }
+
+  return num;
+}
+
+lvk::Result lvk::TextureStreamer::uploadMipLevels(const StreamingTexture& tex, uint32_t mipLevel, uint32_t numMipLevels) {
+  const TextureRangeDesc range = {
+      .dimensions = {std::max(tex.dimensions.width >> mipLevel, 1u), std::max(tex.dimensions.height >> mipLevel, 1u), 1},
+      .mipLevel = mipLevel,
+      .numMipLevels = numMipLevels,
+  };
+
+  return ctx_.upload(tex.texture, range, tex.data + tex.mipOffsets[mipLevel]);
+}
+
+void lvk::TextureStreamer::updateView(StreamingTexture& tex) {
+  if (!tex.residentMipLevel) {
+    // the previous view is destroyed after the GPU is done with it
+    tex.view = nullptr;
+    if (tex.releaseData) {
+      tex.releaseData();
+      tex.releaseData = nullptr;
+    }
+    tex.data = nullptr;
+    return;
+  }
+
+  tex.view = ctx_.createTextureView(tex.texture,
+                                    {
+                                        .type = TextureType_2D,
+                                        .mipLevel = tex.residentMipLevel,
+                                        .numMipLevels = tex.numMipLevels - tex.residentMipLevel,
+                                        .swizzle = tex.swizzle,
+                                    },
+                                    tex.debugName.c_str());
+}
@@ -0,0 +1,76 @@
+/*
+ * LightweightVK
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <lvk/LVK.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace lvk {
+
+// Optional progressive texture streaming on top of IContext:
+//   - createTexture() creates the full mip chain but uploads only the smallest mip-levels (see `initialBytes`);
+//   - every update() uploads more detailed mip-levels of all textures within a per-frame byte budget;
+//   - getTexture() returns a view which starts at the most detailed resident mip-level, so sampling never touches levels which are
+//     not uploaded yet (the minimal LOD is clamped). The view changes when more levels become resident, and it becomes the texture
+//     itself once all levels are resident.
+class TextureStreamer final {
+ public:
+  using TextureId = uint32_t;
+  enum : TextureId { kInvalidTexture = ~0u };
+
+  // `bytesPerFrame` - the upload budget of update(); `initialBytes` - the smallest mip-levels uploaded by createTexture()
+  explicit TextureStreamer(lvk::IContext& ctx, uint32_t bytesPerFrame = 8u * 1024u * 1024u, uint32_t initialBytes = 64u * 1024u) :
+    ctx_(ctx), bytesPerFrame_(bytesPerFrame), initialBytes_(initialBytes) {}
+  ~TextureStreamer();
+
+  // 2D textures only: `desc.data` contains all `desc.numMipLevels` mip-levels as in IContext::upload() (`desc.dataNumMipLevels` is
+  // ignored). The data should stay valid until `releaseData` is invoked: by update() after the last mip-level is uploaded, by
+  // destroy(), or by createTexture() itself if all mip-levels fit into `initialBytes` or on errors.
+  TextureId createTexture(const TextureDesc& desc, std::function<void()>&& releaseData = nullptr, Result* outResult = nullptr);
+  void destroy(TextureId id);
+
+  // call once per frame; returns true if getTexture() changed for any texture
+  bool update();
+
+  [[nodiscard]] TextureHandle getTexture(TextureId id) const;
+  // the most detailed resident mip-level (0 when fully resident)
+  [[nodiscard]] uint32_t getResidentMipLevel(TextureId id) const;
+  // textures which still have mip-levels to upload
+  [[nodiscard]] uint32_t getNumStreamingTextures() const;
+
+ private:
+  struct StreamingTexture {
+    lvk::Holder<lvk::TextureHandle> texture;
+    lvk::Holder<lvk::TextureHandle> view; // empty when all mip-levels are resident
+    Format format = Format_Invalid;
+    Dimensions dimensions = {};
+    uint32_t numMipLevels = 0;
+    ComponentMapping swizzle = {};
+    std::string debugName;
+    const uint8_t* data = nullptr;
+    std::vector<uint32_t> mipOffsets; // offsets of mip-levels inside `data`
+    std::function<void()> releaseData;
+    uint32_t residentMipLevel = 0;
+  };
+
+  Result uploadMipLevels(const StreamingTexture& tex, uint32_t mipLevel, uint32_t numMipLevels);
+  void updateView(StreamingTexture& tex);
+
+ private:
+  lvk::IContext& ctx_;
+  uint32_t bytesPerFrame_ = 0;
+  uint32_t initialBytes_ = 0;
+  std::vector<StreamingTexture> textures_;
+  std::vector<TextureId> freeIds_;
+  uint32_t nextTexture_ = 0; // round-robin: the first texture refined by the next update()
+};
+
+} // namespace lvk
@@ -5,9 +5,18 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <deque>
+#include <list>
+#include <mutex>
+#include <numeric>
 #include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #define VMA_IMPLEMENTATION
@@ -20,6 +29,10 @@
 #include <SPIRV-Reflect/spirv_reflect.h>
 #include <ldrutils/lutils/ScopeExit.h>
 
+#if defined(LVK_WITH_TRACY)
+#include "tracy/TracyC.h"
+#endif // LVK_WITH_TRACY
+
 #ifndef VK_USE_PLATFORM_WIN32_KHR
 #include <unistd.h>
 #endif
@@ -28,7 +41,7 @@
 #include <malloc.h>
 #endif
 
-uint32_t lvk::VulkanPipelineBuilder::numPipelinesCreated_ = 0;
+std::atomic<uint32_t> lvk::VulkanPipelineBuilder::numPipelinesCreated_ = 0;
 
 static_assert(lvk::HWDeviceDesc::LVK_MAX_PHYSICAL_DEVICE_NAME_SIZE == VK_MAX_PHYSICAL_DEVICE_NAME_SIZE);
 static_assert(lvk::Swizzle_Default == (uint32_t)VK_COMPONENT_SWIZZLE_IDENTITY);
@@ -43,7 +56,14 @@ namespace {
 
 const char* kDefaultValidationLayers[] = {"VK_LAYER_KHRONOS_validation"};
 
-// These bindings should match GLSL declarations injected into shaders in VulkanContext::createShaderModule().
+// volk keeps core instance-level entry points in global variables shared by all contexts in the process. They are loaded once,
+// from the instance of the first VulkanContext: the loader returns them as trampolines which dispatch on their first argument and
+// do not depend on that instance. Never reload them while other contexts may be calling them. Entry points of extensions are
+// loaded per instance into VulkanContext::vkIT_ and per device into VulkanContext::vkDT_.
+std::mutex volkMutex;
+
+// These bindings should match GLSL declarations injected into shaders in VulkanContext::createShaderModule() and
+// LVK_STORAGE_IMAGES_BINDING in lvk/ShaderBindings.h.
 enum Bindings {
   kBinding_Textures = 0,
   kBinding_Samplers = 1,
@@ -216,6 +236,10 @@ VkShaderStageFlagBits shaderStageToVkShaderStage(lvk::ShaderStage stage) {
     return VK_SHADER_STAGE_FRAGMENT_BIT;
   case lvk::Stage_Comp:
     return VK_SHADER_STAGE_COMPUTE_BIT;
+  case lvk::Stage_Task:
+    return VK_SHADER_STAGE_TASK_BIT_EXT;
+  case lvk::Stage_Mesh:
+    return VK_SHADER_STAGE_MESH_BIT_EXT;
   };
   LVK_ASSERT(false);
   return VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
@@ -238,6 +262,136 @@ VkMemoryPropertyFlags storageTypeToVkMemoryPropertyFlags(lvk::StorageType storag
   return memFlags;
 }
 
+bool hasMemoryType(VkPhysicalDevice physDev, VkMemoryPropertyFlags flags) {
+  VkPhysicalDeviceMemoryProperties memProperties;
+  vkGetPhysicalDeviceMemoryProperties(physDev, &memProperties);
+
+  for (uint32_t i = 0; i != memProperties.memoryTypeCount; i++) {
+    if ((memProperties.memoryTypes[i].propertyFlags & flags) == flags) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// sparse textures: the mip tail is stored as mip-level 0xff
+uint64_t getTexturePageKey(uint32_t mipLevel, uint32_t layer, uint32_t x, uint32_t y, uint32_t z) {
+  LVK_ASSERT(x < (1u << 12) && y < (1u << 12) && z < (1u << 12) && layer < (1u << 16));
+  return (uint64_t(mipLevel & 0xff) << 52) | (uint64_t(layer) << 36) | (uint64_t(z) << 24) | (uint64_t(y) << 12) | uint64_t(x);
+}
+
+// non-VMA sparse pages: pages of the same size and memory type are sub-allocated from VkDeviceMemory blocks instead of having a
+// VkDeviceMemory each; a block is freed when its last page is freed
+class SparsePageBlocks final {
+ public:
+  enum { kPagesPerBlock = 64 };
+
+  VkResult allocate(const lvk::VulkanDeviceTable& vkDT,
+                    VkPhysicalDevice physDev,
+                    VkDevice device,
+                    const VkMemoryRequirements& req,
+                    lvk::VulkanImage::SparsePage* outPage) {
+    std::lock_guard lock(mutex_);
+
+    uint32_t emptySlot = ~0u;
+
+    for (uint32_t i = 0; i != blocks_.size(); i++) {
+      Block& b = blocks_[i];
+      if (b.memory == VK_NULL_HANDLE) {
+        emptySlot = std::min(emptySlot, i);
+      } else if (b.pageSize == req.size && b.memoryTypeBits == req.memoryTypeBits && !b.freePages.empty()) {
+        return take(i, outPage);
+      }
+    }
+
+    const VkMemoryRequirements blockReq = {
+        .size = req.size * kPagesPerBlock,
+        .alignment = req.alignment,
+        .memoryTypeBits = req.memoryTypeBits,
+    };
+
+    Block b = {.pageSize = req.size, .memoryTypeBits = req.memoryTypeBits};
+
+    const VkResult result =
+        lvk::allocateMemory(vkDT, physDev, device, &blockReq, storageTypeToVkMemoryPropertyFlags(lvk::StorageType_Device), &b.memory);
+
+    if (result != VK_SUCCESS) {
+      return result;
+    }
+
+    b.freePages.resize(kPagesPerBlock);
+    for (uint32_t p = 0; p != kPagesPerBlock; p++) {
+      b.freePages[p] = kPagesPerBlock - 1 - p;
+    }
+
+    const uint32_t index = emptySlot != ~0u ? emptySlot : (uint32_t)blocks_.size();
+
+    if (index == blocks_.size()) {
+      blocks_.push_back(std::move(b));
+    } else {
+      blocks_[index] = std::move(b);
+    }
+
+    return take(index, outPage);
+  }
+  void free(const lvk::VulkanDeviceTable& vkDT, VkDevice device, const lvk::VulkanImage::SparsePage& page) {
+    std::lock_guard lock(mutex_);
+
+    Block& b = blocks_[page.block];
+    b.freePages.push_back(uint32_t(page.offset / b.pageSize));
+
+    if (b.freePages.size() == kPagesPerBlock) {
+      vkDT.vkFreeMemory(device, b.memory, nullptr);
+      b = {};
+    }
+  }
+  void destroy(const lvk::VulkanDeviceTable& vkDT, VkDevice device) {
+    for (const Block& b : blocks_) {
+      if (b.memory != VK_NULL_HANDLE) {
+        vkDT.vkFreeMemory(device, b.memory, nullptr);
+      }
+    }
+    blocks_.clear();
+  }
+
+ private:
+  VkResult take(uint32_t index, lvk::VulkanImage::SparsePage* outPage) {
+    Block& b = blocks_[index];
+    const uint32_t page = b.freePages.back();
+    b.freePages.pop_back();
+    outPage->memory = b.memory;
+    outPage->offset = page * b.pageSize;
+    outPage->size = b.pageSize;
+    outPage->block = index;
+    return VK_SUCCESS;
+  }
+
+ private:
+  struct Block {
+    VkDeviceMemory memory = VK_NULL_HANDLE; // VK_NULL_HANDLE if the slot is free
+    VkDeviceSize pageSize = 0;
+    uint32_t memoryTypeBits = 0;
+    std::vector<uint32_t> freePages;
+  };
+  std::vector<Block> blocks_;
+  std::mutex mutex_;
+};
+
+void freeSparsePage(VmaAllocator vma,
+                    const lvk::VulkanDeviceTable& vkDT,
+                    VkDevice device,
+                    SparsePageBlocks* blocks,
+                    const lvk::VulkanImage::SparsePage& page) {
+  if (LVK_VULKAN_USE_VMA) {
+    vmaFreeMemory(vma, page.allocation);
+  } else if (page.block != ~0u) {
+    blocks->free(vkDT, device, page);
+  } else {
+    vkDT.vkFreeMemory(device, page.memory, nullptr);
+  }
+}
+
 VkPolygonMode polygonModeToVkPolygonMode(lvk::PolygonMode mode) {
   switch (mode) {
   case lvk::PolygonMode_Fill:
@@ -592,6 +746,71 @@ void transitionToColorAttachment(VkCommandBuffer buffer, lvk::VulkanTexture* col
                             VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
 }
 
+struct VulkanResourceState {
+  VkPipelineStageFlags2 stageMask = VK_PIPELINE_STAGE_2_NONE;
+  VkAccessFlags2 accessMask = VK_ACCESS_2_NONE;
+  VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+// combines lvk::ResourceUsageBits into tight stage and access masks
+VulkanResourceState getVulkanResourceState(uint16_t usage) {
+  VulkanResourceState state;
+
+  auto add = [&state](VkPipelineStageFlags2 stageMask, VkAccessFlags2 accessMask, VkImageLayout layout) {
+    LVK_ASSERT_MSG(state.layout == VK_IMAGE_LAYOUT_UNDEFINED || layout == VK_IMAGE_LAYOUT_UNDEFINED || state.layout == layout,
+                   "Resource usage bits map to different image layouts");
+    state.stageMask |= stageMask;
+    state.accessMask |= accessMask;
+    if (layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+      state.layout = layout;
+    }
+  };
+
+  if (usage & lvk::ResourceUsageBits_ColorAttachment) {
+    add(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+  }
+  if (usage & lvk::ResourceUsageBits_DepthStencilAttachment) {
+    // depth-stencil resolves are written in the color attachment output stage
+    add(VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT |
+            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+  }
+  if (usage & lvk::ResourceUsageBits_ShaderReadGraphics) {
+    add(VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+        VK_ACCESS_2_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  }
+  if (usage & lvk::ResourceUsageBits_ShaderReadCompute) {
+    add(VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  }
+  if (usage & lvk::ResourceUsageBits_ShaderWriteGraphics) {
+    add(VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+        VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_GENERAL);
+  }
+  if (usage & lvk::ResourceUsageBits_ShaderWriteCompute) {
+    add(VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+  }
+  if (usage & lvk::ResourceUsageBits_VertexInput) {
+    add(VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+  }
+  if (usage & lvk::ResourceUsageBits_Indirect) {
+    add(VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+  }
+  if (usage & lvk::ResourceUsageBits_TransferSrc) {
+    add(VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+  }
+  if (usage & lvk::ResourceUsageBits_TransferDst) {
+    add(VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+  }
+
+  return state;
+}
+
 bool isDepthOrStencilVkFormat(VkFormat format) {
   switch (format) {
   case VK_FORMAT_D16_UNORM:
@@ -608,6 +827,21 @@ bool isDepthOrStencilVkFormat(VkFormat format) {
   return false;
 }
 
+VkPresentModeKHR presentModeToVkPresentMode(lvk::PresentMode mode) {
+  switch (mode) {
+  case lvk::PresentMode_Default:
+  case lvk::PresentMode_Fifo:
+    return VK_PRESENT_MODE_FIFO_KHR;
+  case lvk::PresentMode_FifoRelaxed:
+    return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+  case lvk::PresentMode_Mailbox:
+    return VK_PRESENT_MODE_MAILBOX_KHR;
+  case lvk::PresentMode_Immediate:
+    return VK_PRESENT_MODE_IMMEDIATE_KHR;
+  }
+  return VK_PRESENT_MODE_FIFO_KHR;
+}
+
 VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& formats, lvk::ColorSpace colorSpace) {
   LVK_ASSERT(!formats.empty());
 
@@ -661,1185 +895,2182 @@ VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>
   return formats[0];
 }
 
-} // namespace
+// a bounded pool of hardware_concurrency()-1 threads shared by all background work of a context: parallel shader compilation
+// and async pipeline compilation; the threads are started on first use and exit after draining the queue
+class WorkerPool final {
+ public:
+  WorkerPool() = default;
+  ~WorkerPool() {
+    {
+      std::lock_guard lock(mutex_);
+      isStopping_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& t : threads_) {
+      t.join();
+    }
+  }
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
 
-namespace lvk {
+  // leave one hardware thread for the render thread
+  uint32_t getNumThreads() const {
+    return std::max(std::thread::hardware_concurrency(), 2u) - 1;
+  }
 
-struct DeferredTask {
-  DeferredTask(std::packaged_task<void()>&& task, SubmitHandle handle) : task_(std::move(task)), handle_(handle) {}
-  std::packaged_task<void()> task_;
-  SubmitHandle handle_;
-};
+  void run(std::function<void()>&& task) {
+    {
+      std::lock_guard lock(mutex_);
+      if (threads_.empty()) {
+        threads_.reserve(getNumThreads());
+        for (uint32_t i = 0; i != getNumThreads(); i++) {
+          threads_.emplace_back([this]() { workerLoop(); });
+        }
+      }
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
 
-struct VulkanContextImpl final {
-  // Vulkan Memory Allocator
-  VmaAllocator vma_ = VK_NULL_HANDLE;
+  // runs `job(0...numJobs-1)` on the calling thread and the worker threads; returns when all jobs are done. The calling thread
+  // keeps pulling jobs itself, so this makes progress even when all workers are busy with other tasks
+  void parallelFor(uint32_t numJobs, const std::function<void(uint32_t)>& job) {
+    if (!numJobs) {
+      return;
+    }
 
-  lvk::CommandBuffer currentCommandBuffer_;
+    struct State {
+      const std::function<void(uint32_t)>* job = nullptr;
+      uint32_t numJobs = 0;
+      std::atomic<uint32_t> nextJob = 0;
+      std::mutex mutex;
+      std::condition_variable cv;
+      uint32_t numFinishedJobs = 0;
+    };
 
-  mutable std::deque<DeferredTask> deferredTasks_;
-};
+    // helpers which start after all jobs are taken only touch the atomic counter, so the state outlives this call
+    auto state = std::make_shared<State>();
+    state->job = &job;
+    state->numJobs = numJobs;
 
-} // namespace lvk
+    auto runJobs = [](State& s) {
+      uint32_t numFinished = 0;
+      for (uint32_t i = s.nextJob.fetch_add(1); i < s.numJobs; i = s.nextJob.fetch_add(1)) {
+        (*s.job)(i);
+        numFinished++;
+      }
+      if (numFinished) {
+        std::lock_guard lock(s.mutex);
+        s.numFinishedJobs += numFinished;
+        if (s.numFinishedJobs == s.numJobs) {
+          s.cv.notify_all();
+        }
+      }
+    };
 
-lvk::VulkanBuffer::VulkanBuffer(lvk::VulkanContext* ctx,
-                                VkDevice device,
-                                VkDeviceSize bufferSize,
-                                VkBufferUsageFlags usageFlags,
-                                VkMemoryPropertyFlags memFlags,
-                                const char* debugName) :
-  ctx_(ctx), device_(device), bufferSize_(bufferSize), vkUsageFlags_(usageFlags), vkMemFlags_(memFlags) {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
+    const uint32_t numHelpers = std::min(getNumThreads(), numJobs - 1);
 
-  LVK_ASSERT(ctx);
-  LVK_ASSERT(bufferSize > 0);
+    for (uint32_t i = 0; i != numHelpers; i++) {
+      run([state, runJobs]() { runJobs(*state); });
+    }
 
-  const VkBufferCreateInfo ci = {
-      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-      .pNext = nullptr,
-      .flags = 0,
-      .size = bufferSize,
-      .usage = usageFlags,
-      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-      .queueFamilyIndexCount = 0,
-      .pQueueFamilyIndices = nullptr,
-  };
+    runJobs(*state);
 
-  if (LVK_VULKAN_USE_VMA) {
-    // Initialize VmaAllocation Info
-    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-      vmaAllocInfo_.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
-      vmaAllocInfo_.preferredFlags = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
-      vmaAllocInfo_.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
-    }
+    std::unique_lock lock(state->mutex);
+    state->cv.wait(lock, [&state]() { return state->numFinishedJobs == state->numJobs; });
+  }
 
-    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-      // Check if coherent buffer is available.
-      VK_ASSERT(vkCreateBuffer(device_, &ci, nullptr, &vkBuffer_));
-      VkMemoryRequirements requirements = {};
-      vkGetBufferMemoryRequirements(device_, vkBuffer_, &requirements);
-      vkDestroyBuffer(device, vkBuffer_, nullptr);
-      vkBuffer_ = VK_NULL_HANDLE;
+ private:
+  void workerLoop() {
+    LVK_PROFILER_THREAD("LVK worker");
 
-      if (requirements.memoryTypeBits & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
-        vmaAllocInfo_.requiredFlags |= VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-        isCoherentMemory_ = true;
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [this]() { return isStopping_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
       }
+      task();
     }
+  }
 
-    vmaAllocInfo_.usage = VMA_MEMORY_USAGE_AUTO;
-
-    vmaCreateBuffer((VmaAllocator)ctx_->getVmaAllocator(), &ci, &vmaAllocInfo_, &vkBuffer_, &vmaAllocation_, nullptr);
-
-    // handle memory-mapped buffers
-    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-      vmaMapMemory((VmaAllocator)ctx_->getVmaAllocator(), vmaAllocation_, &mappedPtr_);
-    }
-  } else {
-    // create buffer
-    VK_ASSERT(vkCreateBuffer(device_, &ci, nullptr, &vkBuffer_));
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  std::vector<std::thread> threads_;
+  bool isStopping_ = false;
+};
 
-    // back the buffer with some memory
-    {
-      VkMemoryRequirements requirements = {};
-      vkGetBufferMemoryRequirements(device_, vkBuffer_, &requirements);
-      if (requirements.memoryTypeBits & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
-        isCoherentMemory_ = true;
+// a batch of IContext::compilePipelinesAsync() jobs; it is pulled by the worker threads and by any thread waiting for it
+struct PipelineCompileBatch final {
+  std::function<void(uint32_t)> job;
+  uint32_t numJobs = 0;
+  // shader modules the jobs compile from (see VulkanContext::destroy(ShaderModuleHandle))
+  std::vector<VkShaderModule> shaderModules;
+
+  // `onLastJob` is invoked by the thread which finishes the last job, before the batch is marked as done
+  void run(const std::function<void()>& onLastJob) {
+    for (uint32_t i = nextJob_.fetch_add(1); i < numJobs; i = nextJob_.fetch_add(1)) {
+      job(i);
+      if (numFinishedJobs_.fetch_add(1) + 1 == numJobs) {
+        onLastJob();
+        std::lock_guard lock(mutex_);
+        isDone_ = true;
+        cv_.notify_all();
       }
-
-      VK_ASSERT(lvk::allocateMemory(ctx_->getVkPhysicalDevice(), device_, &requirements, memFlags, &vkMemory_));
-      VK_ASSERT(vkBindBufferMemory(device_, vkBuffer_, vkMemory_, 0));
-    }
-
-    // handle memory-mapped buffers
-    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-      VK_ASSERT(vkMapMemory(device_, vkMemory_, 0, bufferSize_, 0, &mappedPtr_));
     }
   }
+  void wait() {
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [this]() { return isDone_; });
+  }
+  bool isDone() {
+    std::lock_guard lock(mutex_);
+    return isDone_;
+  }
+  bool uses(VkShaderModule sm) const {
+    return std::find(shaderModules.begin(), shaderModules.end(), sm) != shaderModules.end();
+  }
 
-  LVK_ASSERT(vkBuffer_ != VK_NULL_HANDLE);
+ private:
+  std::atomic<uint32_t> nextJob_ = 0;
+  std::atomic<uint32_t> numFinishedJobs_ = 0;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool isDone_ = false;
+};
 
-  // set debug name
-  VK_ASSERT(lvk::setDebugObjectName(device_, VK_OBJECT_TYPE_BUFFER, (uint64_t)vkBuffer_, debugName));
+#if defined(LVK_WITH_TRACY)
+// forward GPU profiler timestamps into Tracy GPU zones via the public C API for manually timed GPU contexts (see TracyC.h)
+uint8_t tracyCreateGpuContext(int64_t gpuTime, float period) {
+  // Tracy does not hand out GPU context ids to C API users: count down from 255 to stay clear of TracyVkContext() ids
+  static std::atomic<uint8_t> nextContext = 255;
+  const uint8_t context = nextContext.fetch_sub(1, std::memory_order_relaxed);
+
+  ___tracy_emit_gpu_new_context_serial({
+      .gpuTime = gpuTime,
+      .period = period,
+      .context = context,
+      .flags = 0,
+      .type = 2, // tracy::GpuContextType::Vulkan
+  });
 
-  // handle shader access
-  if (usageFlags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
-    const VkBufferDeviceAddressInfo ai = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-        .buffer = vkBuffer_,
-    };
-    vkDeviceAddress_ = vkGetBufferDeviceAddress(device_, &ai);
-    LVK_ASSERT(vkDeviceAddress_);
-  }
+  return context;
 }
 
-lvk::VulkanBuffer::~VulkanBuffer() {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
-
-  if (!ctx_) {
-    return;
-  }
+void tracyGpuZoneBegin(uint8_t context, uint16_t queryId, const char* name) {
+  const uint64_t srcloc =
+      ___tracy_alloc_srcloc_name(__LINE__, __FILE__, strlen(__FILE__), __FUNCTION__, strlen(__FUNCTION__), name, strlen(name));
 
-  if (LVK_VULKAN_USE_VMA) {
-    if (mappedPtr_) {
-      vmaUnmapMemory((VmaAllocator)ctx_->getVmaAllocator(), vmaAllocation_);
-    }
-    ctx_->deferredTask(std::packaged_task<void()>([vma = ctx_->getVmaAllocator(), buffer = vkBuffer_, allocation = vmaAllocation_]() {
-      vmaDestroyBuffer((VmaAllocator)vma, buffer, allocation);
-    }));
-  } else {
-    if (mappedPtr_) {
-      vkUnmapMemory(device_, vkMemory_);
-    }
-    ctx_->deferredTask(std::packaged_task<void()>([device = device_, buffer = vkBuffer_, memory = vkMemory_]() {
-      vkDestroyBuffer(device, buffer, nullptr);
-      vkFreeMemory(device, memory, nullptr);
-    }));
-  }
+  ___tracy_emit_gpu_zone_begin_alloc_serial({.srcloc = srcloc, .queryId = queryId, .context = context});
 }
 
-lvk::VulkanBuffer::VulkanBuffer(VulkanBuffer&& other) :
-  ctx_(other.ctx_),
-  device_(other.device_),
-  vkBuffer_(other.vkBuffer_),
-  vkMemory_(other.vkMemory_),
-  vmaAllocInfo_(other.vmaAllocInfo_),
-  vmaAllocation_(other.vmaAllocation_),
-  vkDeviceAddress_(other.vkDeviceAddress_),
-  bufferSize_(other.bufferSize_),
-  vkUsageFlags_(other.vkUsageFlags_),
-  vkMemFlags_(other.vkMemFlags_),
-  mappedPtr_(other.mappedPtr_) {
-  other.ctx_ = nullptr;
+void tracyGpuZoneEnd(uint8_t context, uint16_t queryId) {
+  ___tracy_emit_gpu_zone_end_serial({.queryId = queryId, .context = context});
 }
 
-lvk::VulkanBuffer& lvk::VulkanBuffer::operator=(VulkanBuffer&& other) {
-  std::swap(ctx_, other.ctx_);
-  std::swap(device_, other.device_);
-  std::swap(vkBuffer_, other.vkBuffer_);
-  std::swap(vkMemory_, other.vkMemory_);
-  std::swap(vmaAllocInfo_, other.vmaAllocInfo_);
-  std::swap(vmaAllocation_, other.vmaAllocation_);
-  std::swap(vkDeviceAddress_, other.vkDeviceAddress_);
-  std::swap(bufferSize_, other.bufferSize_);
-  std::swap(vkUsageFlags_, other.vkUsageFlags_);
-  std::swap(vkMemFlags_, other.vkMemFlags_);
-  std::swap(mappedPtr_, other.mappedPtr_);
-  return *this;
+void tracyGpuTime(uint8_t context, uint16_t queryId, int64_t gpuTime) {
+  ___tracy_emit_gpu_time_serial({.gpuTime = gpuTime, .queryId = queryId, .context = context});
 }
+#endif // LVK_WITH_TRACY
 
-void lvk::VulkanBuffer::flushMappedMemory(VkDeviceSize offset, VkDeviceSize size) const {
-  if (!LVK_VERIFY(isMapped())) {
-    return;
-  }
+// prepended to the VkPipelineCache blob in the on-disk pipeline cache file
+struct PipelineCacheFileHeader {
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint32_t vendorID = 0;
+  uint32_t deviceID = 0;
+  uint32_t driverVersion = 0;
+  uint8_t pipelineCacheUUID[VK_UUID_SIZE] = {};
+  uint64_t dataSize = 0;
+  uint64_t dataHash = 0;
+};
 
-  if (LVK_VULKAN_USE_VMA) {
-    vmaFlushAllocation((VmaAllocator)ctx_->getVmaAllocator(), vmaAllocation_, offset, size);
-  } else {
-    const VkMappedMemoryRange range = {
-        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-        .memory = vkMemory_,
-        .offset = offset,
-        .size = size,
-    };
-    vkFlushMappedMemoryRanges(device_, 1, &range);
-  }
-}
+constexpr uint32_t kPipelineCacheFileMagic = 0x504B564C; // 'LVKP'
+constexpr uint32_t kPipelineCacheFileVersion = 1;
 
-void lvk::VulkanBuffer::invalidateMappedMemory(VkDeviceSize offset, VkDeviceSize size) const {
-  if (!LVK_VERIFY(isMapped())) {
-    return;
-  }
+constexpr uint64_t kFNV1aOffsetBasis = 0xcbf29ce484222325ull;
 
-  if (LVK_VULKAN_USE_VMA) {
-    vmaInvalidateAllocation(static_cast<VmaAllocator>(ctx_->getVmaAllocator()), vmaAllocation_, offset, size);
-  } else {
-    const VkMappedMemoryRange range = {
-        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-        .memory = vkMemory_,
-        .offset = offset,
-        .size = size,
-    };
-    vkInvalidateMappedMemoryRanges(device_, 1, &range);
+// pass the previous hash as `hash` to hash several chunks of memory
+uint64_t hashFNV1a(const void* data, size_t size, uint64_t hash = kFNV1aOffsetBasis) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i != size; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
   }
+  return hash;
 }
 
-void lvk::VulkanBuffer::getBufferSubData(size_t offset, size_t size, void* data) {
-  // only host-visible buffers can be downloaded this way
-  LVK_ASSERT(mappedPtr_);
+// writes into a temporary file first so that a crash never leaves a truncated file behind
+bool writeFileAtomically(const char* fileName, const void* header, size_t headerSize, const std::vector<uint8_t>& data) {
+  // unique per thread: several threads can write the same file
+  const std::string tmpFileName =
+      std::string(fileName) + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
 
-  if (!mappedPtr_) {
-    return;
+  FILE* file = fopen(tmpFileName.c_str(), "wb");
+
+  if (!file) {
+    LLOGW("Cannot open file `%s` for writing\n", tmpFileName.c_str());
+    return false;
   }
 
-  LVK_ASSERT(offset + size <= bufferSize_);
+  const bool written = fwrite(header, headerSize, 1, file) == 1 && fwrite(data.data(), data.size(), 1, file) == 1;
 
-  if (!isCoherentMemory_) {
-    invalidateMappedMemory(offset, size);
+  if (fclose(file) != 0 || !written) {
+    LLOGW("Cannot write file `%s`\n", tmpFileName.c_str());
+    remove(tmpFileName.c_str());
+    return false;
   }
 
-  const uint8_t* src = static_cast<uint8_t*>(mappedPtr_) + offset;
-  memcpy(data, src, size);
-}
-
-void lvk::VulkanBuffer::bufferSubData(size_t offset, size_t size, const void* data) {
-  // only host-visible buffers can be uploaded this way
-  LVK_ASSERT(mappedPtr_);
+  // rename() does not overwrite existing files on Windows
+  remove(fileName);
 
-  if (!mappedPtr_) {
-    return;
+  if (rename(tmpFileName.c_str(), fileName) != 0) {
+    LLOGW("Cannot rename `%s` into `%s`\n", tmpFileName.c_str(), fileName);
+    remove(tmpFileName.c_str());
+    return false;
   }
 
-  LVK_ASSERT(offset + size <= bufferSize_);
-
-  if (data) {
-    memcpy((uint8_t*)mappedPtr_ + offset, data, size);
-  } else {
-    memset((uint8_t*)mappedPtr_ + offset, 0, size);
-  }
+  return true;
+}
 
-  if (!isCoherentMemory_) {
-    flushMappedMemory(offset, size);
-  }
+PipelineCacheFileHeader getPipelineCacheFileHeader(const VkPhysicalDeviceProperties& props) {
+  PipelineCacheFileHeader header = {
+      .magic = kPipelineCacheFileMagic,
+      .version = kPipelineCacheFileVersion,
+      .vendorID = props.vendorID,
+      .deviceID = props.deviceID,
+      .driverVersion = props.driverVersion,
+  };
+  memcpy(header.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE);
+  return header;
 }
 
-lvk::VulkanImage::VulkanImage(lvk::VulkanContext& ctx,
-                              VkDevice device,
-                              VkImage image,
-                              VkImageUsageFlags usageFlags,
-                              VkFormat imageFormat,
-                              VkExtent3D extent,
-                              const char* debugName) :
-  ctx_(ctx),
-  vkDevice_(device),
-  vkImage_(image),
-  vkUsageFlags_(usageFlags),
-  isSwapchainImage_(true),
-  vkExtent_(extent),
-  vkType_(VK_IMAGE_TYPE_2D),
-  vkImageFormat_(imageFormat),
-  isDepthFormat_(isDepthFormat(imageFormat)),
-  isStencilFormat_(isStencilFormat(imageFormat)) {
-  VK_ASSERT(lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_IMAGE, (uint64_t)vkImage_, debugName));
+std::string getPipelineCacheFileName(const char* dir, const VkPhysicalDeviceProperties& props) {
+  char fileName[64];
+  snprintf(fileName, sizeof(fileName), "/lvk_pipeline_cache_%04x_%04x.bin", props.vendorID, props.deviceID);
+  return std::string(dir) + fileName;
 }
 
-lvk::VulkanImage::VulkanImage(lvk::VulkanContext& ctx,
-                              VkDevice device,
-                              VkExtent3D extent,
-                              VkImageType type,
-                              VkFormat format,
-                              uint32_t numLevels,
-                              uint32_t numLayers,
-                              VkImageTiling tiling,
-                              VkImageUsageFlags usageFlags,
-                              VkMemoryPropertyFlags memFlags,
-                              VkImageCreateFlags createFlags,
-                              VkSampleCountFlagBits samples,
-                              const char* debugName) :
-  ctx_(ctx),
-  vkDevice_(device),
-  vkUsageFlags_(usageFlags),
-  vkExtent_(extent),
-  vkType_(type),
-  vkImageFormat_(format),
-  numLevels_(numLevels),
-  numLayers_(numLayers),
-  vkSamples_(samples),
-  isDepthFormat_(isDepthFormat(format)),
-  isStencilFormat_(isStencilFormat(format)) {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
+// returns an empty vector if the file does not exist or was produced by a different device/driver
+std::vector<uint8_t> loadPipelineCacheFile(const char* fileName, const VkPhysicalDeviceProperties& props, size_t maxFileSize) {
+  LVK_PROFILER_FUNCTION();
 
-  LVK_ASSERT_MSG(numLevels_ > 0, "The image must contain at least one mip-level");
-  LVK_ASSERT_MSG(numLayers_ > 0, "The image must contain at least one layer");
-  LVK_ASSERT_MSG(vkImageFormat_ != VK_FORMAT_UNDEFINED, "Invalid VkFormat value");
-  LVK_ASSERT_MSG(vkSamples_ > 0, "The image must contain at least one sample");
-  LVK_ASSERT(extent.width > 0);
-  LVK_ASSERT(extent.height > 0);
-  LVK_ASSERT(extent.depth > 0);
+  FILE* file = fopen(fileName, "rb");
 
-  const VkImageCreateInfo ci = {
-      .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-      .pNext = nullptr,
-      .flags = createFlags,
-      .imageType = type,
-      .format = vkImageFormat_,
-      .extent = vkExtent_,
-      .mipLevels = numLevels_,
-      .arrayLayers = numLayers_,
-      .samples = samples,
-      .tiling = tiling,
-      .usage = usageFlags,
-      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-      .queueFamilyIndexCount = 0,
-      .pQueueFamilyIndices = nullptr,
-      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  if (!file) {
+    return {};
+  }
+
+  SCOPE_EXIT {
+    fclose(file);
   };
 
-  if (LVK_VULKAN_USE_VMA) {
-    vmaAllocInfo_.usage = memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ? VMA_MEMORY_USAGE_CPU_TO_GPU : VMA_MEMORY_USAGE_AUTO;
-    VkResult result = vmaCreateImage((VmaAllocator)ctx_.getVmaAllocator(), &ci, &vmaAllocInfo_, &vkImage_, &vmaAllocation_, nullptr);
+  const PipelineCacheFileHeader expected = getPipelineCacheFileHeader(props);
+  PipelineCacheFileHeader header = {};
 
-    if (!LVK_VERIFY(result == VK_SUCCESS)) {
-      LLOGW("failed: error result: %d, memflags: %d,  imageformat: %d\n", result, memFlags, vkImageFormat_);
-    }
+  if (fread(&header, sizeof(header), 1, file) != 1) {
+    LLOGW("Pipeline cache file `%s` is corrupted\n", fileName);
+    return {};
+  }
 
-    // handle memory-mapped buffers
-    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-      vmaMapMemory((VmaAllocator)ctx_.getVmaAllocator(), vmaAllocation_, &mappedPtr_);
-    }
-  } else {
-    // create image
-    VK_ASSERT(vkCreateImage(vkDevice_, &ci, nullptr, &vkImage_));
+  if (header.magic != expected.magic || header.version != expected.version || header.vendorID != expected.vendorID ||
+      header.deviceID != expected.deviceID || header.driverVersion != expected.driverVersion ||
+      memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+    LLOGL("Pipeline cache file `%s` was created by a different device or driver, ignoring it\n", fileName);
+    return {};
+  }
 
-    // back the image with some memory
-    {
-      VkMemoryRequirements memRequirements;
-      vkGetImageMemoryRequirements(device, vkImage_, &memRequirements);
+  if (!header.dataSize || header.dataSize > maxFileSize) {
+    LLOGW("Pipeline cache file `%s` has invalid size %llu\n", fileName, (unsigned long long)header.dataSize);
+    return {};
+  }
 
-      VK_ASSERT(lvk::allocateMemory(ctx.getVkPhysicalDevice(), vkDevice_, &memRequirements, memFlags, &vkMemory_));
-      VK_ASSERT(vkBindImageMemory(vkDevice_, vkImage_, vkMemory_, 0));
-    }
+  std::vector<uint8_t> data(header.dataSize);
 
-    // handle memory-mapped images
-    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-      VK_ASSERT(vkMapMemory(vkDevice_, vkMemory_, 0, VK_WHOLE_SIZE, 0, &mappedPtr_));
-    }
+  if (fread(data.data(), data.size(), 1, file) != 1 || hashFNV1a(data.data(), data.size()) != header.dataHash) {
+    LLOGW("Pipeline cache file `%s` is corrupted\n", fileName);
+    return {};
   }
 
-  VK_ASSERT(lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_IMAGE, (uint64_t)vkImage_, debugName));
-
-  // Get physical device's properties for the image's format
-  vkGetPhysicalDeviceFormatProperties(ctx.getVkPhysicalDevice(), vkImageFormat_, &vkFormatProperties_);
+  return data;
 }
 
-lvk::VulkanImage::~VulkanImage() {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
+bool savePipelineCacheFile(const char* fileName, const VkPhysicalDeviceProperties& props, const std::vector<uint8_t>& data) {
+  LVK_PROFILER_FUNCTION();
 
-  if (!isSwapchainImage_) {
-    if (LVK_VULKAN_USE_VMA) {
-      if (mappedPtr_) {
-        vmaUnmapMemory((VmaAllocator)ctx_.getVmaAllocator(), vmaAllocation_);
-      }
-      ctx_.deferredTask(std::packaged_task<void()>([vma = ctx_.getVmaAllocator(), image = vkImage_, allocation = vmaAllocation_]() {
-        vmaDestroyImage((VmaAllocator)vma, image, allocation);
-      }));
-    } else {
-      if (mappedPtr_) {
-        vkUnmapMemory(vkDevice_, vkMemory_);
-      }
-      ctx_.deferredTask(std::packaged_task<void()>([device = vkDevice_, image = vkImage_, memory = vkMemory_]() {
-        vkDestroyImage(device, image, nullptr);
-        if (memory != VK_NULL_HANDLE) {
-          vkFreeMemory(device, memory, nullptr);
-        }
-      }));
-    }
-  }
+  PipelineCacheFileHeader header = getPipelineCacheFileHeader(props);
+  header.dataSize = data.size();
+  header.dataHash = hashFNV1a(data.data(), data.size());
+
+  return writeFileAtomically(fileName, &header, sizeof(header), data);
 }
 
-VkImageView lvk::VulkanImage::createImageView(VkImageViewType type,
-                                              VkFormat format,
-                                              VkImageAspectFlags aspectMask,
-                                              uint32_t baseLevel,
-                                              uint32_t numLevels,
-                                              uint32_t baseLayer,
-                                              uint32_t numLayers,
-                                              const VkComponentMapping mapping,
-                                              const char* debugName) const {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
+// prepended to the SPIR-V binary in the on-disk SPIR-V cache files
+struct SpirvCacheFileHeader {
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint64_t key = 0;
+  uint64_t dataSize = 0;
+  uint64_t dataHash = 0;
+};
 
-  const VkImageViewCreateInfo ci = {
-      .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-      .image = vkImage_,
-      .viewType = type,
-      .format = format,
-      .components = mapping,
-      .subresourceRange = {aspectMask, baseLevel, numLevels ? numLevels : numLevels_, baseLayer, numLayers},
+// ContextConfig::maxFramesInFlight: presents of hidden or minimized windows may never complete
+constexpr uint64_t kFramesInFlightPresentTimeoutNs = 100ull * 1000ull * 1000ull;
+
+constexpr uint32_t kSpirvCacheFileMagic = 0x534B564C; // 'LVKS'
+// bump when the GLSL preamble or glslang options in lvk::compileShader() change
+constexpr uint32_t kSpirvCacheVersion = 1;
+
+// hashes only the limits lvk::getGlslangResource() reads, field by field, so struct padding and unrelated limits do not matter
+uint64_t hashGlslangLimits(const VkPhysicalDeviceLimits& limits, uint64_t hash) {
+  const uint32_t values[] = {
+      limits.maxVertexInputAttributes,
+      limits.maxClipDistances,
+      limits.maxCullDistances,
+      limits.maxCombinedClipAndCullDistances,
+      limits.maxComputeWorkGroupCount[0],
+      limits.maxComputeWorkGroupCount[1],
+      limits.maxComputeWorkGroupCount[2],
+      limits.maxComputeWorkGroupSize[0],
+      limits.maxComputeWorkGroupSize[1],
+      limits.maxComputeWorkGroupSize[2],
+      limits.maxVertexOutputComponents,
+      limits.maxGeometryInputComponents,
+      limits.maxGeometryOutputComponents,
+      limits.maxGeometryOutputVertices,
+      limits.maxGeometryTotalOutputComponents,
+      limits.maxTessellationControlPerVertexInputComponents,
+      limits.maxTessellationControlPerVertexOutputComponents,
+      limits.maxTessellationEvaluationInputComponents,
+      limits.maxTessellationEvaluationOutputComponents,
+      limits.maxFragmentInputComponents,
+      limits.maxViewports,
   };
-  VkImageView vkView = VK_NULL_HANDLE;
-  VK_ASSERT(vkCreateImageView(vkDevice_, &ci, nullptr, &vkView));
-  VK_ASSERT(lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)vkView, debugName));
+  return hashFNV1a(values, sizeof(values), hash);
+}
 
-  return vkView;
+std::string getSpirvCacheFileName(const char* dir, uint64_t key) {
+  char fileName[32];
+  snprintf(fileName, sizeof(fileName), "/%016llx.spv", (unsigned long long)key);
+  return std::string(dir) + fileName;
 }
 
-void lvk::VulkanImage::transitionLayout(VkCommandBuffer commandBuffer,
-                                        VkImageLayout newImageLayout,
-                                        VkPipelineStageFlags srcStageMask,
-                                        VkPipelineStageFlags dstStageMask,
-                                        const VkImageSubresourceRange& subresourceRange) const {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_BARRIER);
+bool loadSpirvCacheFile(const char* fileName, uint64_t key, std::vector<uint8_t>* outSPIRV) {
+  LVK_PROFILER_FUNCTION();
 
-  VkAccessFlags srcAccessMask = 0;
-  VkAccessFlags dstAccessMask = 0;
+  FILE* file = fopen(fileName, "rb");
 
-  if (vkImageLayout_ == VK_IMAGE_LAYOUT_UNDEFINED) {
-    // we do not need to wait for any previous operations in this case
-    srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+  if (!file) {
+    return false;
   }
 
-  const VkPipelineStageFlags doNotRequireAccessMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT |
-                                                      VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-  VkPipelineStageFlags srcRemainingMask = srcStageMask & ~doNotRequireAccessMask;
-  VkPipelineStageFlags dstRemainingMask = dstStageMask & ~doNotRequireAccessMask;
+  SCOPE_EXIT {
+    fclose(file);
+  };
 
-  if (srcStageMask & VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT) {
-    srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    srcRemainingMask &= ~VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-  }
-  if (srcStageMask & VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT) {
-    srcAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    srcRemainingMask &= ~VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-  }
-  if (srcStageMask & VK_PIPELINE_STAGE_TRANSFER_BIT) {
-    srcAccessMask |= VK_ACCESS_TRANSFER_WRITE_BIT;
-    srcRemainingMask &= ~VK_PIPELINE_STAGE_TRANSFER_BIT;
-  }
-  if (srcStageMask & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) {
-    srcAccessMask |= VK_ACCESS_SHADER_WRITE_BIT;
-    srcRemainingMask &= ~VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-  }
-  if (srcStageMask & VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT) {
-    srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-    srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    srcRemainingMask &= ~VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+  SpirvCacheFileHeader header = {};
+
+  if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != kSpirvCacheFileMagic || header.version != kSpirvCacheVersion ||
+      header.key != key || !header.dataSize || header.dataSize % sizeof(uint32_t)) {
+    LLOGW("SPIR-V cache file `%s` is corrupted\n", fileName);
+    return false;
   }
 
-  LVK_ASSERT_MSG(srcRemainingMask == 0, "Automatic access mask deduction is not implemented (yet) for this srcStageMask");
+  std::vector<uint8_t> spirv(header.dataSize);
 
-  if (dstStageMask & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) {
-    dstAccessMask |= VK_ACCESS_SHADER_READ_BIT;
-    dstAccessMask |= VK_ACCESS_SHADER_WRITE_BIT;
-    dstRemainingMask &= ~VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-  }
-  if (dstStageMask & VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT) {
-    dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dstRemainingMask &= ~VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-  }
-  if (dstStageMask & VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT) {
-    dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-    dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dstRemainingMask &= ~VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-  }
-  if (dstStageMask & VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT) {
-    dstAccessMask |= VK_ACCESS_SHADER_READ_BIT;
-    dstAccessMask |= VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
-    dstRemainingMask &= ~VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-  }
-  if (dstStageMask & VK_PIPELINE_STAGE_TRANSFER_BIT) {
-    dstAccessMask |= VK_ACCESS_TRANSFER_READ_BIT;
-    dstRemainingMask &= ~VK_PIPELINE_STAGE_TRANSFER_BIT;
+  if (fread(spirv.data(), spirv.size(), 1, file) != 1 || hashFNV1a(spirv.data(), spirv.size()) != header.dataHash) {
+    LLOGW("SPIR-V cache file `%s` is corrupted\n", fileName);
+    return false;
   }
 
-  LVK_ASSERT_MSG(dstRemainingMask == 0, "Automatic access mask deduction is not implemented (yet) for this dstStageMask");
-
-  lvk::imageMemoryBarrier(
-      commandBuffer, vkImage_, srcAccessMask, dstAccessMask, vkImageLayout_, newImageLayout, srcStageMask, dstStageMask, subresourceRange);
+  *outSPIRV = std::move(spirv);
 
-  vkImageLayout_ = newImageLayout;
+  return true;
 }
 
-VkImageAspectFlags lvk::VulkanImage::getImageAspectFlags() const {
-  VkImageAspectFlags flags = 0;
+bool saveSpirvCacheFile(const char* fileName, uint64_t key, const std::vector<uint8_t>& spirv) {
+  LVK_PROFILER_FUNCTION();
 
-  flags |= isDepthFormat_ ? VK_IMAGE_ASPECT_DEPTH_BIT : 0;
-  flags |= isStencilFormat_ ? VK_IMAGE_ASPECT_STENCIL_BIT : 0;
-  flags |= !(isDepthFormat_ || isStencilFormat_) ? VK_IMAGE_ASPECT_COLOR_BIT : 0;
+  const SpirvCacheFileHeader header = {
+      .magic = kSpirvCacheFileMagic,
+      .version = kSpirvCacheVersion,
+      .key = key,
+      .dataSize = spirv.size(),
+      .dataHash = hashFNV1a(spirv.data(), spirv.size()),
+  };
 
-  return flags;
+  return writeFileAtomically(fileName, &header, sizeof(header), spirv);
 }
 
-void lvk::VulkanImage::generateMipmap(VkCommandBuffer commandBuffer) const {
-  LVK_PROFILER_FUNCTION();
-
-  // Check if device supports downscaling for color or depth/stencil buffer based on image format
-  {
-    const uint32_t formatFeatureMask = (VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT);
-
-    const bool hardwareDownscalingSupported = (vkFormatProperties_.optimalTilingFeatures & formatFeatureMask) == formatFeatureMask;
+uint64_t getTimeNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-    if (!LVK_VERIFY(hardwareDownscalingSupported)) {
-      LVK_ASSERT_MSG(false, "Doesn't support hardware downscaling of this image format: {}");
-      return;
+// reports the duration of a blocking call to IContext::getFrameStats(); does nothing if `counters` is nullptr
+class ScopedHostWait final {
+ public:
+  ScopedHostWait(lvk::VulkanFrameCounters* counters, lvk::HostWait wait) :
+    counters_(counters), wait_(wait), beginNs_(counters ? getTimeNs() : 0) {}
+  ~ScopedHostWait() {
+    if (counters_) {
+      counters_->addHostWait(wait_, getTimeNs() - beginNs_);
     }
   }
+  ScopedHostWait(const ScopedHostWait&) = delete;
+  ScopedHostWait& operator=(const ScopedHostWait&) = delete;
 
-  // Choose linear filter for color formats if supported by the device, else use nearest filter
-  // Choose nearest filter by default for depth/stencil formats
-  const VkFilter blitFilter = [](bool isDepthOrStencilFormat, bool imageFilterLinear) {
-    if (isDepthOrStencilFormat) {
-      return VK_FILTER_NEAREST;
-    }
-    if (imageFilterLinear) {
-      return VK_FILTER_LINEAR;
-    }
-    return VK_FILTER_NEAREST;
-  }(isDepthFormat_ || isStencilFormat_, vkFormatProperties_.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
-
-  const VkImageAspectFlags imageAspectFlags = getImageAspectFlags();
-
-  const VkDebugUtilsLabelEXT utilsLabel = {
-      .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
-      .pLabelName = "Generate mipmaps",
-      .color = {1.0f, 0.75f, 1.0f, 1.0f},
-  };
-  vkCmdBeginDebugUtilsLabelEXT(commandBuffer, &utilsLabel);
+ private:
+  lvk::VulkanFrameCounters* counters_ = nullptr;
+  lvk::HostWait wait_ = lvk::HostWait_Submit;
+  uint64_t beginNs_ = 0;
+};
 
-  const VkImageLayout originalImageLayout = vkImageLayout_;
+// VK_FORMAT_UNDEFINED if there is no UNORM counterpart of an sRGB format (or vice versa)
+VkFormat getSRGBAliasVkFormat(VkFormat format) {
+  switch (format) {
+  case VK_FORMAT_R8G8B8A8_SRGB:
+    return VK_FORMAT_R8G8B8A8_UNORM;
+  case VK_FORMAT_R8G8B8A8_UNORM:
+    return VK_FORMAT_R8G8B8A8_SRGB;
+  case VK_FORMAT_B8G8R8A8_SRGB:
+    return VK_FORMAT_B8G8R8A8_UNORM;
+  case VK_FORMAT_B8G8R8A8_UNORM:
+    return VK_FORMAT_B8G8R8A8_SRGB;
+  default:
+    return VK_FORMAT_UNDEFINED;
+  }
+}
 
-  LVK_ASSERT(originalImageLayout != VK_IMAGE_LAYOUT_UNDEFINED);
+// Queue families which access a resource; it is VK_SHARING_MODE_CONCURRENT only if there is more than one. Concurrent sharing
+// disables framebuffer compression (DCC, AFBC) on some GPUs, so only resources which can cross queues are shared: async compute
+// reaches resources only from shaders, and the transfer queue only writes them in uploadAsync().
+uint32_t getSharingQueueFamilies(const lvk::DeviceQueues& q, bool isComputeShared, bool isTransferShared, uint32_t* outFamilies) {
+  uint32_t numFamilies = 0;
 
-  // 0: Transition the first level and all layers into VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
-  transitionLayout(commandBuffer,
-                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                   VK_PIPELINE_STAGE_TRANSFER_BIT,
-                   VkImageSubresourceRange{imageAspectFlags, 0, 1, 0, numLayers_});
+  outFamilies[numFamilies++] = q.graphicsQueueFamilyIndex;
 
-  for (uint32_t layer = 0; layer < numLayers_; ++layer) {
-    int32_t mipWidth = (int32_t)vkExtent_.width;
-    int32_t mipHeight = (int32_t)vkExtent_.height;
+  if (isComputeShared && q.computeQueueFamilyIndex != q.graphicsQueueFamilyIndex) {
+    outFamilies[numFamilies++] = q.computeQueueFamilyIndex;
+  }
+  // a dedicated transfer queue family is never the compute queue family
+  if (isTransferShared && q.transferQueueFamilyIndex != q.graphicsQueueFamilyIndex) {
+    outFamilies[numFamilies++] = q.transferQueueFamilyIndex;
+  }
 
-    for (uint32_t i = 1; i < numLevels_; ++i) {
-      // 1: Transition the i-th level to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL; it will be copied into from the (i-1)-th layer
-      lvk::imageMemoryBarrier(commandBuffer,
-                              vkImage_,
-                              0, /* srcAccessMask */
-                              VK_ACCESS_TRANSFER_WRITE_BIT, // dstAccessMask
-                              VK_IMAGE_LAYOUT_UNDEFINED, // oldImageLayout
-                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // newImageLayout
-                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // srcStageMask
-                              VK_PIPELINE_STAGE_TRANSFER_BIT, // dstStageMask
-                              VkImageSubresourceRange{imageAspectFlags, i, 1, layer, 1});
+  return numFamilies;
+}
 
-      const int32_t nextLevelWidth = mipWidth > 1 ? mipWidth / 2 : 1;
-      const int32_t nextLevelHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+bool isSRGBVkFormat(VkFormat format) {
+  return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_B8G8R8A8_SRGB;
+}
 
-      const VkOffset3D srcOffsets[2] = {
-          VkOffset3D{0, 0, 0},
-          VkOffset3D{mipWidth, mipHeight, 1},
-      };
-      const VkOffset3D dstOffsets[2] = {
-          VkOffset3D{0, 0, 0},
-          VkOffset3D{nextLevelWidth, nextLevelHeight, 1},
-      };
+uint32_t enumeratePhysicalDevices(VkInstance instance,
+                                  lvk::HWDeviceType deviceType,
+                                  lvk::HWDeviceDesc* outDevices,
+                                  uint32_t maxOutDevices) {
+  // loaded from `instance`: volk globals are not loaded from short-lived instances (see `volkMutex`)
+  const PFN_vkEnumeratePhysicalDevices enumerateDevices =
+      (PFN_vkEnumeratePhysicalDevices)vkGetInstanceProcAddr(instance, "vkEnumeratePhysicalDevices");
+  const PFN_vkGetPhysicalDeviceProperties2 getDeviceProperties2 =
+      (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2");
 
-      // 2: Blit the image from the prev mip-level (i-1) (VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) to the current mip-level (i)
-      // (VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
-#if LVK_VULKAN_PRINT_COMMANDS
-      LLOGL("%p vkCmdBlitImage()\n", commandBuffer);
-#endif // LVK_VULKAN_PRINT_COMMANDS
-      const VkImageBlit blit = {
-          .srcSubresource = VkImageSubresourceLayers{imageAspectFlags, i - 1, layer, 1},
-          .srcOffsets = {srcOffsets[0], srcOffsets[1]},
-          .dstSubresource = VkImageSubresourceLayers{imageAspectFlags, i, layer, 1},
-          .dstOffsets = {dstOffsets[0], dstOffsets[1]},
-      };
-      vkCmdBlitImage(commandBuffer,
-                     vkImage_,
-                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                     vkImage_,
-                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                     1,
-                     &blit,
-                     blitFilter);
-      // 3: Transition i-th level to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL as it will be read from in
-      // the next iteration
-      lvk::imageMemoryBarrier(commandBuffer,
-                              vkImage_,
-                              VK_ACCESS_TRANSFER_WRITE_BIT, /* srcAccessMask */
-                              VK_ACCESS_TRANSFER_READ_BIT, /* dstAccessMask */
-                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, /* oldImageLayout */
-                              VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, /* newImageLayout */
-                              VK_PIPELINE_STAGE_TRANSFER_BIT, /* srcStageMask */
-                              VK_PIPELINE_STAGE_TRANSFER_BIT /* dstStageMask */,
-                              VkImageSubresourceRange{imageAspectFlags, i, 1, layer, 1});
+  // Physical devices
+  uint32_t deviceCount = 0;
+  VK_ASSERT(enumerateDevices(instance, &deviceCount, nullptr));
+  std::vector<VkPhysicalDevice> vkDevices(deviceCount);
+  VK_ASSERT(enumerateDevices(instance, &deviceCount, vkDevices.data()));
 
-      // Compute the size of the next mip level
-      mipWidth = nextLevelWidth;
-      mipHeight = nextLevelHeight;
+  auto convertVulkanDeviceTypeToIGL = [](VkPhysicalDeviceType vkDeviceType) -> lvk::HWDeviceType {
+    switch (vkDeviceType) {
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+      return lvk::HWDeviceType_Integrated;
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+      return lvk::HWDeviceType_Discrete;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+      return lvk::HWDeviceType_External;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+      return lvk::HWDeviceType_Software;
+    default:
+      return lvk::HWDeviceType_Software;
     }
-  }
-
-  // 4: Transition all levels and layers (faces) to their final layout
-  lvk::imageMemoryBarrier(commandBuffer,
-                          vkImage_,
-                          VK_ACCESS_TRANSFER_WRITE_BIT, // srcAccessMask
-                          0, // dstAccessMask
-                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // oldImageLayout
-                          originalImageLayout, // newImageLayout
-                          VK_PIPELINE_STAGE_TRANSFER_BIT, // srcStageMask
-                          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, // dstStageMask
-                          VkImageSubresourceRange{imageAspectFlags, 0, numLevels_, 0, numLayers_});
-  vkCmdEndDebugUtilsLabelEXT(commandBuffer);
-
-  vkImageLayout_ = originalImageLayout;
-}
-
-bool lvk::VulkanImage::isDepthFormat(VkFormat format) {
-  return (format == VK_FORMAT_D16_UNORM) || (format == VK_FORMAT_X8_D24_UNORM_PACK32) || (format == VK_FORMAT_D32_SFLOAT) ||
-         (format == VK_FORMAT_D16_UNORM_S8_UINT) || (format == VK_FORMAT_D24_UNORM_S8_UINT) || (format == VK_FORMAT_D32_SFLOAT_S8_UINT);
-}
+  };
 
-bool lvk::VulkanImage::isStencilFormat(VkFormat format) {
-  return (format == VK_FORMAT_S8_UINT) || (format == VK_FORMAT_D16_UNORM_S8_UINT) || (format == VK_FORMAT_D24_UNORM_S8_UINT) ||
-         (format == VK_FORMAT_D32_SFLOAT_S8_UINT);
-}
+  const lvk::HWDeviceType desiredDeviceType = deviceType;
 
-lvk::VulkanTexture::VulkanTexture(std::shared_ptr<VulkanImage> image, VkImageView imageView) :
-  image_(std::move(image)), imageView_(imageView) {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
+  uint32_t numCompatibleDevices = 0;
 
-  LVK_ASSERT(image_.get());
-  LVK_ASSERT(imageView_ != VK_NULL_HANDLE);
-}
+  for (uint32_t i = 0; i < deviceCount; ++i) {
+    VkPhysicalDevice physicalDevice = vkDevices[i];
+    VkPhysicalDeviceIDProperties idProperties = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES};
+    VkPhysicalDeviceProperties2 properties2 = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &idProperties};
+    getDeviceProperties2(physicalDevice, &properties2);
+    const VkPhysicalDeviceProperties& deviceProperties = properties2.properties;
 
-lvk::VulkanTexture::~VulkanTexture() {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
+    const lvk::HWDeviceType deviceType = convertVulkanDeviceTypeToIGL(deviceProperties.deviceType);
 
-  if (image_) {
-    image_->ctx_.deferredTask(std::packaged_task<void()>(
-        [device = image_->ctx_.getVkDevice(), imageView = imageView_]() { vkDestroyImageView(device, imageView, nullptr); }));
-    for (size_t i = 0; i != LVK_MAX_MIP_LEVELS; i++) {
-      for (size_t j = 0; j != LVK_ARRAY_NUM_ELEMENTS(imageViewForFramebuffer_[0]); j++) {
-        VkImageView v = imageViewForFramebuffer_[i][j];
-        if (v != VK_NULL_HANDLE) {
-          image_->ctx_.deferredTask(std::packaged_task<void()>(
-              [device = image_->ctx_.getVkDevice(), imageView = v]() { vkDestroyImageView(device, imageView, nullptr); }));
-        }
-      }
+    // filter non-suitable hardware devices
+    if (desiredDeviceType != lvk::HWDeviceType_Software && desiredDeviceType != deviceType) {
+      continue;
     }
-  }
-}
 
-lvk::VulkanTexture::VulkanTexture(VulkanTexture&& other) {
-  std::swap(image_, other.image_);
-  std::swap(imageView_, other.imageView_);
-  for (size_t i = 0; i != LVK_MAX_MIP_LEVELS; i++) {
-    for (size_t j = 0; j != LVK_ARRAY_NUM_ELEMENTS(imageViewForFramebuffer_[0]); j++) {
-      std::swap(imageViewForFramebuffer_[i][j], other.imageViewForFramebuffer_[i][j]);
+    if (!outDevices) {
+      // only count the devices
+      numCompatibleDevices++;
+    } else if (numCompatibleDevices < maxOutDevices) {
+      outDevices[numCompatibleDevices] = {.guid = (uintptr_t)vkDevices[i], .type = deviceType};
+      strncpy(outDevices[numCompatibleDevices].name, deviceProperties.deviceName, strlen(deviceProperties.deviceName));
+      memcpy(outDevices[numCompatibleDevices].uuid, idProperties.deviceUUID, VK_UUID_SIZE);
+      numCompatibleDevices++;
     }
   }
-}
 
-lvk::VulkanTexture& lvk::VulkanTexture::operator=(VulkanTexture&& other) {
-  std::swap(image_, other.image_);
-  std::swap(imageView_, other.imageView_);
-  for (size_t i = 0; i != LVK_MAX_MIP_LEVELS; i++) {
-    for (size_t j = 0; j != LVK_ARRAY_NUM_ELEMENTS(imageViewForFramebuffer_[0]); j++) {
-      std::swap(imageViewForFramebuffer_[i][j], other.imageViewForFramebuffer_[i][j]);
-    }
-  }
-  return *this;
+  return numCompatibleDevices;
 }
 
-VkImageView lvk::VulkanTexture::getOrCreateVkImageViewForFramebuffer(uint8_t level, uint16_t layer) {
-  LVK_ASSERT(image_ != nullptr);
-  LVK_ASSERT(level < LVK_MAX_MIP_LEVELS);
-  LVK_ASSERT(layer < LVK_ARRAY_NUM_ELEMENTS(imageViewForFramebuffer_[0]));
+} // namespace
 
-  if (!image_ || level >= LVK_MAX_MIP_LEVELS) {
-    return VK_NULL_HANDLE;
-  }
+namespace lvk {
 
-  if (imageViewForFramebuffer_[level][layer] != VK_NULL_HANDLE) {
-    return imageViewForFramebuffer_[level][layer];
-  }
+struct DeferredTask {
+  DeferredTask() = default;
+  explicit DeferredTask(std::packaged_task<void()>&& task) : task_(std::move(task)) {}
+  std::packaged_task<void()> task_;
+  // one handle per queue: a resource can be in use on all of them when the task is scheduled
+  SubmitHandle handles_[lvk::QueueType_Num] = {};
+};
 
-  imageViewForFramebuffer_[level][layer] =
-      image_->createImageView(VK_IMAGE_VIEW_TYPE_2D, image_->vkImageFormat_, image_->getImageAspectFlags(), level, 1u, layer, 1u);
+struct VulkanContextImpl final {
+  // Vulkan Memory Allocator
+  VmaAllocator vma_ = VK_NULL_HANDLE;
 
-  return imageViewForFramebuffer_[level][layer];
-}
+  // indexed by VulkanImmediateCommands::CommandBufferWrapper::handle_ (queueType_, bufferIndex_)
+  lvk::CommandBuffer commandBuffers_[lvk::QueueType_Num][lvk::VulkanImmediateCommands::kMaxCommandBuffers];
 
-lvk::VulkanSwapchain::VulkanSwapchain(VulkanContext& ctx, uint32_t width, uint32_t height) :
-  ctx_(ctx), device_(ctx.vkDevice_), graphicsQueue_(ctx.deviceQueues_.graphicsQueue), width_(width), height_(height) {
-  surfaceFormat_ = chooseSwapSurfaceFormat(ctx.deviceSurfaceFormats_, ctx.config_.swapChainColorSpace);
+  mutable std::deque<DeferredTask> deferredTasks_;
+  mutable std::mutex deferredTasksMutex_;
+
+  // guard the state shared between threads recording command buffers
+  std::mutex pipelinesMutex_;
+  std::mutex descriptorsMutex_;
+
+  // parallel shader compilation and background pipeline compilation (see VulkanContext::compilePipelinesAsync())
+  WorkerPool workerPool_;
+  std::vector<std::shared_ptr<PipelineCompileBatch>> pipelineCompileBatches_;
+  std::mutex pipelineCompileBatchesMutex_;
+  // serializes writes into ContextConfig::pipelineCacheDir
+  std::mutex pipelineCacheFileMutex_;
+
+  // SPIR-V compiled from GLSL, keyed on the hash of everything glslang sees (see createShaderModuleFromGLSL()); the least
+  // recently used entries are evicted once the cache grows over kSpirvCacheMaxBytes
+  enum { kSpirvCacheMaxBytes = 32 * 1024 * 1024 };
+  struct SpirvCacheEntry {
+    std::vector<uint8_t> spirv;
+    std::list<uint64_t>::iterator lru;
+  };
+  std::unordered_map<uint64_t, SpirvCacheEntry> spirvCache_;
+  std::list<uint64_t> spirvCacheLRU_; // most recently used first
+  size_t spirvCacheBytes_ = 0;
+  std::mutex spirvCacheMutex_;
+
+  // GPU profiler (see ContextConfig::enableGPUProfiler): a ring of query pools with 2 timestamps per scope
+  struct GPUProfilerFrame {
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    std::vector<lvk::GPUProfilerScope> scopes; // ContextConfig::gpuProfilerMaxScopesPerFrame
+    uint32_t numScopes = 0;
+    std::vector<lvk::SubmitHandle> submits; // all command buffers which wrote timestamps into this frame
+    uint64_t frameIndex = 0;
+  };
+  enum { kGPUProfilerNumFrames = 4 };
+  GPUProfilerFrame gpuProfilerFrames_[kGPUProfilerNumFrames];
+  uint32_t gpuProfilerCurrentFrame_ = 0;
+  uint64_t gpuProfilerFrameIndex_ = 0;
+  std::vector<lvk::GPUProfilerScope> gpuProfilerResolvedScopes_;
+  uint64_t gpuProfilerResolvedFrameIndex_ = 0;
+  std::mutex gpuProfilerMutex_;
+
+  // IContext::allocateTransient(): every queue fills its current buffer linearly; a retired buffer can be reused when all command
+  // buffers which allocated from it have been submitted and completed. Buffers larger than ContextConfig::transientBufferSize
+  // are freed instead; their slots (empty `buffer`) are reused for new buffers
+  struct TransientBuffer {
+    lvk::Holder<lvk::BufferHandle> buffer;
+    uint8_t* mappedPtr = nullptr;
+    uint64_t gpuAddress = 0;
+    size_t size = 0;
+    size_t offset = 0; // allocated bytes
+    lvk::QueueType queue = lvk::QueueType_Graphics;
+    uint32_t numPendingCommandBuffers = 0; // command buffers with allocations in this buffer which were not submitted yet
+    std::vector<lvk::SubmitHandle> submits; // submits of all command buffers which allocated from this buffer
+  };
+  std::vector<TransientBuffer> transientBuffers_;
+  uint32_t transientCurrentBuffer_[lvk::QueueType_Num] = {~0u, ~0u, ~0u};
+  std::mutex transientBuffersMutex_;
+
+  // bit N: heap N is above ContextConfig::memoryBudgetThreshold (the callback is invoked only when the threshold is crossed)
+  std::atomic<uint32_t> memoryBudgetExceededHeaps_ = 0;
+  uint32_t vmaFrameIndex_ = 0;
+
+  // redundant state filtering counters of all submitted command buffers
+  lvk::CommandBufferStats commandBufferStats_;
+  mutable std::mutex commandBufferStatsMutex_;
+
+  // ContextConfig::maxFramesInFlight
+  struct FrameInFlight {
+    lvk::SubmitHandle submit;
+    uint64_t presentId = 0;
+  };
+  std::deque<FrameInFlight> framesInFlight_;
+
+  // IContext::getFrameStats()
+  lvk::FrameStats frameStats_;
+  uint64_t lastFrameEndTimeNs_ = 0;
+  mutable std::mutex frameStatsMutex_;
+
+  // sparse page updates are batched until the next graphics queue submit (see VulkanContext::updateTexturePages())
+  struct PendingTexturePages {
+    VkImage image = VK_NULL_HANDLE;
+    std::vector<VkSparseImageMemoryBind> binds;
+    std::vector<VkSparseMemoryBind> opaqueBinds; // mip tails
+  };
+  std::vector<PendingTexturePages> pendingTexturePages_;
+  std::vector<lvk::VulkanImage::SparsePage> releasedTexturePages_; // freed after their unbinding has been executed
+  std::mutex texturePagesMutex_;
+  SparsePageBlocks sparsePageBlocks_; // non-VMA page memory; has its own mutex because pages are also freed by deferred tasks
+#if defined(LVK_WITH_TRACY)
+  uint8_t tracyGpuContext_ = 0;
+  uint16_t tracyNextQueryId_ = 0;
+#endif // LVK_WITH_TRACY
+};
 
-  acquireSemaphore_ = lvk::createSemaphore(device_, "Semaphore: swapchain-acquire");
+} // namespace lvk
 
-  LVK_ASSERT_MSG(ctx.vkSurface_ != VK_NULL_HANDLE,
-                 "You are trying to create a swapchain but your OS surface is empty. Did you want to "
-                 "create an offscreen rendering context? If so, set 'width' and 'height' to 0 when you "
-                 "create your lvk::IContext");
+lvk::VulkanBuffer::VulkanBuffer(lvk::VulkanContext* ctx,
+                                VkDevice device,
+                                VkDeviceSize bufferSize,
+                                VkBufferUsageFlags usageFlags,
+                                VkMemoryPropertyFlags memFlags,
+                                const char* debugName) :
+  ctx_(ctx), device_(device), bufferSize_(bufferSize), vkUsageFlags_(usageFlags), vkMemFlags_(memFlags) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
 
-  VkBool32 queueFamilySupportsPresentation = VK_FALSE;
-  VK_ASSERT(vkGetPhysicalDeviceSurfaceSupportKHR(
-      ctx.getVkPhysicalDevice(), ctx.deviceQueues_.graphicsQueueFamilyIndex, ctx.vkSurface_, &queueFamilySupportsPresentation));
-  LVK_ASSERT_MSG(queueFamilySupportsPresentation == VK_TRUE, "The queue family used with the swapchain does not support presentation");
+  LVK_ASSERT(ctx);
+  LVK_ASSERT(bufferSize > 0);
 
-  auto chooseSwapImageCount = [](const VkSurfaceCapabilitiesKHR& caps) -> uint32_t {
-    const uint32_t desired = caps.minImageCount + 1;
-    const bool exceeded = caps.maxImageCount > 0 && desired > caps.maxImageCount;
-    return exceeded ? caps.maxImageCount : desired;
+  // shader-accessible buffers are shared with async compute (via buffer device addresses), and transfer-destination buffers with the
+  // transfer queue (uploadAsync()), without ownership transfers
+  uint32_t families[LVK_ARRAY_NUM_ELEMENTS(DeviceQueues::uniqueFamilyIndices)] = {};
+  const uint32_t numFamilies = getSharingQueueFamilies(
+      ctx->deviceQueues_,
+      usageFlags & (VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
+      usageFlags & VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      families);
+  const bool isConcurrent = numFamilies > 1;
+
+  const VkBufferCreateInfo ci = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .size = bufferSize,
+      .usage = usageFlags,
+      .sharingMode = isConcurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = isConcurrent ? numFamilies : 0u,
+      .pQueueFamilyIndices = isConcurrent ? families : nullptr,
   };
 
-  auto chooseSwapPresentMode = [](const std::vector<VkPresentModeKHR>& modes) -> VkPresentModeKHR {
-#if defined(__linux__)
-    if (std::find(modes.cbegin(), modes.cend(), VK_PRESENT_MODE_IMMEDIATE_KHR) != modes.cend()) {
-      return VK_PRESENT_MODE_IMMEDIATE_KHR;
-    }
-#endif // __linux__
-    if (std::find(modes.cbegin(), modes.cend(), VK_PRESENT_MODE_MAILBOX_KHR) != modes.cend()) {
-      return VK_PRESENT_MODE_MAILBOX_KHR;
+  if (LVK_VULKAN_USE_VMA) {
+    // Initialize VmaAllocation Info
+    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+      vmaAllocInfo_.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+      vmaAllocInfo_.preferredFlags = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+      vmaAllocInfo_.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
     }
-    return VK_PRESENT_MODE_FIFO_KHR;
-  };
 
-  auto chooseUsageFlags = [](VkPhysicalDevice pd, VkSurfaceKHR surface, VkFormat format) -> VkImageUsageFlags {
-    VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+      // Check if coherent buffer is available.
+      VK_ASSERT(ctx_->vkDT_.vkCreateBuffer(device_, &ci, nullptr, &vkBuffer_));
+      VkMemoryRequirements requirements = {};
+      ctx_->vkDT_.vkGetBufferMemoryRequirements(device_, vkBuffer_, &requirements);
+      ctx_->vkDT_.vkDestroyBuffer(device, vkBuffer_, nullptr);
+      vkBuffer_ = VK_NULL_HANDLE;
 
-    VkSurfaceCapabilitiesKHR caps = {};
-    VK_ASSERT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(pd, surface, &caps));
+      if (requirements.memoryTypeBits & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+        vmaAllocInfo_.requiredFlags |= VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        isCoherentMemory_ = true;
+      }
+    }
 
-    VkFormatProperties props = {};
-    vkGetPhysicalDeviceFormatProperties(pd, format, &props);
+    vmaAllocInfo_.usage = VMA_MEMORY_USAGE_AUTO;
 
-    const bool isStorageSupported = (caps.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) > 0;
-    const bool isTilingOptimalSupported = (props.optimalTilingFeatures & VK_IMAGE_USAGE_STORAGE_BIT) > 0;
+    vmaCreateBuffer((VmaAllocator)ctx_->getVmaAllocator(), &ci, &vmaAllocInfo_, &vkBuffer_, &vmaAllocation_, nullptr);
 
-    if (isStorageSupported && isTilingOptimalSupported) {
-      usageFlags |= VK_IMAGE_USAGE_STORAGE_BIT;
+    // handle memory-mapped buffers
+    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+      vmaMapMemory((VmaAllocator)ctx_->getVmaAllocator(), vmaAllocation_, &mappedPtr_);
     }
+  } else {
+    // create buffer
+    VK_ASSERT(ctx_->vkDT_.vkCreateBuffer(device_, &ci, nullptr, &vkBuffer_));
 
-    return usageFlags;
-  };
-
-  const VkImageUsageFlags usageFlags = chooseUsageFlags(ctx.getVkPhysicalDevice(), ctx.vkSurface_, surfaceFormat_.format);
-  const bool isCompositeAlphaOpaqueSupported = (ctx.deviceSurfaceCaps_.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR) != 0;
-  const VkSwapchainCreateInfoKHR ci = {
-      .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-      .surface = ctx.vkSurface_,
-      .minImageCount = chooseSwapImageCount(ctx.deviceSurfaceCaps_),
-      .imageFormat = surfaceFormat_.format,
-      .imageColorSpace = surfaceFormat_.colorSpace,
-      .imageExtent = {.width = width, .height = height},
-      .imageArrayLayers = 1,
-      .imageUsage = usageFlags,
-      .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
-      .queueFamilyIndexCount = 1,
-      .pQueueFamilyIndices = &ctx.deviceQueues_.graphicsQueueFamilyIndex,
-#if defined(ANDROID)
-      .preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
-#else
-      .preTransform = ctx.deviceSurfaceCaps_.currentTransform,
-#endif
-      .compositeAlpha = isCompositeAlphaOpaqueSupported ? VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR : VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
-      .presentMode = chooseSwapPresentMode(ctx.devicePresentModes_),
-      .clipped = VK_TRUE,
-      .oldSwapchain = VK_NULL_HANDLE,
-  };
-  VK_ASSERT(vkCreateSwapchainKHR(device_, &ci, nullptr, &swapchain_));
+    // back the buffer with some memory
+    {
+      VkMemoryRequirements requirements = {};
+      ctx_->vkDT_.vkGetBufferMemoryRequirements(device_, vkBuffer_, &requirements);
+      if (requirements.memoryTypeBits & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+        isCoherentMemory_ = true;
+      }
 
-  VkImage swapchainImages[LVK_MAX_SWAPCHAIN_IMAGES];
-  VK_ASSERT(vkGetSwapchainImagesKHR(device_, swapchain_, &numSwapchainImages_, nullptr));
-  if (numSwapchainImages_ > LVK_MAX_SWAPCHAIN_IMAGES) {
-    LVK_ASSERT(numSwapchainImages_ <= LVK_MAX_SWAPCHAIN_IMAGES);
-    numSwapchainImages_ = LVK_MAX_SWAPCHAIN_IMAGES;
-  }
-  VK_ASSERT(vkGetSwapchainImagesKHR(device_, swapchain_, &numSwapchainImages_, swapchainImages));
+      VK_ASSERT(lvk::allocateMemory(ctx_->vkDT_, ctx_->getVkPhysicalDevice(), device_, &requirements, memFlags, &vkMemory_));
+      VK_ASSERT(ctx_->vkDT_.vkBindBufferMemory(device_, vkBuffer_, vkMemory_, 0));
+    }
 
-  LVK_ASSERT(numSwapchainImages_ > 0);
+    // handle memory-mapped buffers
+    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+      VK_ASSERT(ctx_->vkDT_.vkMapMemory(device_, vkMemory_, 0, bufferSize_, 0, &mappedPtr_));
+    }
+  }
 
-  char debugNameImage[256] = {0};
-  char debugNameImageView[256] = {0};
+  LVK_ASSERT(vkBuffer_ != VK_NULL_HANDLE);
 
-  // create images, image views and framebuffers
-  for (uint32_t i = 0; i < numSwapchainImages_; i++) {
-    snprintf(debugNameImage, sizeof(debugNameImage) - 1, "Image: swapchain %u", i);
-    snprintf(debugNameImageView, sizeof(debugNameImageView) - 1, "Image View: swapchain %u", i);
-    std::shared_ptr<VulkanImage> image = std::make_shared<VulkanImage>(ctx_,
-                                                                       device_,
-                                                                       swapchainImages[i],
-                                                                       usageFlags,
-                                                                       surfaceFormat_.format,
-                                                                       VkExtent3D{.width = width_, .height = height_, .depth = 1},
-                                                                       debugNameImage);
-    VkImageView imageView = image->createImageView(
-        VK_IMAGE_VIEW_TYPE_2D, surfaceFormat_.format, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1, {}, debugNameImageView);
-    swapchainTextures_[i] = ctx_.texturesPool_.create(VulkanTexture(std::move(image), std::move(imageView)));
-  }
-}
+  // set debug name
+  VK_ASSERT(lvk::setDebugObjectName(ctx_->vkDT_, device_, VK_OBJECT_TYPE_BUFFER, (uint64_t)vkBuffer_, debugName));
 
-lvk::VulkanSwapchain::~VulkanSwapchain() {
-  for (TextureHandle handle : swapchainTextures_) {
-    ctx_.texturesPool_.destroy(handle);
-  }
-  if (acquireFence_ != VK_NULL_HANDLE) {
-    vkWaitForFences(device_, 1, &acquireFence_, VK_TRUE, UINT64_MAX);
-    vkDestroyFence(device_, acquireFence_, nullptr);
+  // handle shader access
+  if (usageFlags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+    const VkBufferDeviceAddressInfo ai = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+        .buffer = vkBuffer_,
+    };
+    vkDeviceAddress_ = ctx_->vkDT_.vkGetBufferDeviceAddress(device_, &ai);
+    LVK_ASSERT(vkDeviceAddress_);
   }
-  vkDestroySwapchainKHR(device_, swapchain_, nullptr);
-  vkDestroySemaphore(device_, acquireSemaphore_, nullptr);
 }
 
-VkImage lvk::VulkanSwapchain::getCurrentVkImage() const {
-  if (LVK_VERIFY(currentImageIndex_ < numSwapchainImages_)) {
-    lvk::VulkanTexture* tex = ctx_.texturesPool_.get(swapchainTextures_[currentImageIndex_]);
-    return tex->image_->vkImage_;
-  }
-  return VK_NULL_HANDLE;
-}
+lvk::VulkanBuffer::~VulkanBuffer() {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
 
-VkImageView lvk::VulkanSwapchain::getCurrentVkImageView() const {
-  if (LVK_VERIFY(currentImageIndex_ < numSwapchainImages_)) {
-    lvk::VulkanTexture* tex = ctx_.texturesPool_.get(swapchainTextures_[currentImageIndex_]);
-    return tex->imageView_;
+  if (!ctx_) {
+    return;
   }
-  return VK_NULL_HANDLE;
-}
-
-lvk::TextureHandle lvk::VulkanSwapchain::getCurrentTexture() {
-  LVK_PROFILER_FUNCTION();
 
-  if (getNextImage_) {
-    // Our first submit handle can be still waiting on the previous `acquireSemaphore`.
-    //   vkAcquireNextImageKHR():  Semaphore must not have any pending operations. The Vulkan spec states:
-    //   If semaphore is not VK_NULL_HANDLE it must not have any uncompleted signal or wait operations pending
-    //   (https://vulkan.lunarg.com/doc/view/1.3.275.0/windows/1.3-extensions/vkspec.html#VUID-vkAcquireNextImageKHR-semaphore-01779)
-    if (acquireFence_ == VK_NULL_HANDLE) {
-      acquireFence_ = lvk::createFence(device_, "Fence: swapchain-acquire");
-    } else {
-      vkWaitForFences(device_, 1, &acquireFence_, VK_TRUE, UINT64_MAX);
-      vkResetFences(device_, 1, &acquireFence_);
+  if (LVK_VULKAN_USE_VMA) {
+    if (mappedPtr_) {
+      vmaUnmapMemory((VmaAllocator)ctx_->getVmaAllocator(), vmaAllocation_);
     }
-    // when timeout is set to UINT64_MAX, we wait until the next image has been acquired
-    VkResult r = vkAcquireNextImageKHR(device_, swapchain_, UINT64_MAX, acquireSemaphore_, acquireFence_, &currentImageIndex_);
-    if (r != VK_SUCCESS && r != VK_SUBOPTIMAL_KHR && r != VK_ERROR_OUT_OF_DATE_KHR) {
-      VK_ASSERT(r);
+    ctx_->deferredTask(std::packaged_task<void()>([vma = ctx_->getVmaAllocator(), buffer = vkBuffer_, allocation = vmaAllocation_]() {
+      vmaDestroyBuffer((VmaAllocator)vma, buffer, allocation);
+    }));
+  } else {
+    if (mappedPtr_) {
+      ctx_->vkDT_.vkUnmapMemory(device_, vkMemory_);
     }
-    getNextImage_ = false;
-    ctx_.immediate_->waitSemaphore(acquireSemaphore_);
-  }
-
-  if (LVK_VERIFY(currentImageIndex_ < numSwapchainImages_)) {
-    return swapchainTextures_[currentImageIndex_];
+    ctx_->deferredTask(std::packaged_task<void()>([&vkDT = ctx_->vkDT_, device = device_, buffer = vkBuffer_, memory = vkMemory_]() {
+      vkDT.vkDestroyBuffer(device, buffer, nullptr);
+      vkDT.vkFreeMemory(device, memory, nullptr);
+    }));
   }
-
-  return {};
 }
 
-const VkSurfaceFormatKHR& lvk::VulkanSwapchain::getSurfaceFormat() const {
-  return surfaceFormat_;
+lvk::VulkanBuffer::VulkanBuffer(VulkanBuffer&& other) :
+  ctx_(other.ctx_),
+  device_(other.device_),
+  vkBuffer_(other.vkBuffer_),
+  vkMemory_(other.vkMemory_),
+  vmaAllocInfo_(other.vmaAllocInfo_),
+  vmaAllocation_(other.vmaAllocation_),
+  vkDeviceAddress_(other.vkDeviceAddress_),
+  bufferSize_(other.bufferSize_),
+  vkUsageFlags_(other.vkUsageFlags_),
+  vkMemFlags_(other.vkMemFlags_),
+  mappedPtr_(other.mappedPtr_) {
+  other.ctx_ = nullptr;
 }
 
-uint32_t lvk::VulkanSwapchain::getNumSwapchainImages() const {
-  return numSwapchainImages_;
+lvk::VulkanBuffer& lvk::VulkanBuffer::operator=(VulkanBuffer&& other) {
+  std::swap(ctx_, other.ctx_);
+  std::swap(device_, other.device_);
+  std::swap(vkBuffer_, other.vkBuffer_);
+  std::swap(vkMemory_, other.vkMemory_);
+  std::swap(vmaAllocInfo_, other.vmaAllocInfo_);
+  std::swap(vmaAllocation_, other.vmaAllocation_);
+  std::swap(vkDeviceAddress_, other.vkDeviceAddress_);
+  std::swap(bufferSize_, other.bufferSize_);
+  std::swap(vkUsageFlags_, other.vkUsageFlags_);
+  std::swap(vkMemFlags_, other.vkMemFlags_);
+  std::swap(mappedPtr_, other.mappedPtr_);
+  return *this;
 }
 
-lvk::Result lvk::VulkanSwapchain::present(VkSemaphore waitSemaphore) {
-  LVK_PROFILER_FUNCTION();
-
-  LVK_PROFILER_ZONE("vkQueuePresent()", LVK_PROFILER_COLOR_PRESENT);
-  const VkPresentInfoKHR pi = {
-      .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-      .waitSemaphoreCount = 1,
-      .pWaitSemaphores = &waitSemaphore,
-      .swapchainCount = 1u,
-      .pSwapchains = &swapchain_,
-      .pImageIndices = &currentImageIndex_,
-  };
-  VkResult r = vkQueuePresentKHR(graphicsQueue_, &pi);
-  if (r != VK_SUCCESS && r != VK_SUBOPTIMAL_KHR && r != VK_ERROR_OUT_OF_DATE_KHR) {
-    VK_ASSERT(r);
+void lvk::VulkanBuffer::flushMappedMemory(VkDeviceSize offset, VkDeviceSize size) const {
+  if (!LVK_VERIFY(isMapped())) {
+    return;
   }
-  LVK_PROFILER_ZONE_END();
-
-  // Ready to call acquireNextImage() on the next getCurrentVulkanTexture();
-  getNextImage_ = true;
-
-  LVK_PROFILER_FRAME(nullptr);
 
-  return Result();
+  if (LVK_VULKAN_USE_VMA) {
+    vmaFlushAllocation((VmaAllocator)ctx_->getVmaAllocator(), vmaAllocation_, offset, size);
+  } else {
+    const VkMappedMemoryRange range = {
+        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+        .memory = vkMemory_,
+        .offset = offset,
+        .size = size,
+    };
+    ctx_->vkDT_.vkFlushMappedMemoryRanges(device_, 1, &range);
+  }
 }
 
-lvk::VulkanImmediateCommands::VulkanImmediateCommands(VkDevice device, uint32_t queueFamilyIndex, const char* debugName) :
-  device_(device), queueFamilyIndex_(queueFamilyIndex), debugName_(debugName) {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
-
-  vkGetDeviceQueue(device, queueFamilyIndex, 0, &queue_);
-
-  const VkCommandPoolCreateInfo ci = {
-      .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-      .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
-      .queueFamilyIndex = queueFamilyIndex,
-  };
-  VK_ASSERT(vkCreateCommandPool(device, &ci, nullptr, &commandPool_));
-  lvk::setDebugObjectName(device, VK_OBJECT_TYPE_COMMAND_POOL, (uint64_t)commandPool_, debugName);
-
-  const VkCommandBufferAllocateInfo ai = {
-      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-      .commandPool = commandPool_,
-      .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-      .commandBufferCount = 1,
-  };
+void lvk::VulkanBuffer::invalidateMappedMemory(VkDeviceSize offset, VkDeviceSize size) const {
+  if (!LVK_VERIFY(isMapped())) {
+    return;
+  }
 
-  for (uint32_t i = 0; i != kMaxCommandBuffers; i++) {
-    auto& buf = buffers_[i];
-    char fenceName[256] = {0};
-    char semaphoreName[256] = {0};
-    if (debugName) {
-      snprintf(fenceName, sizeof(fenceName) - 1, "Fence: %s (cmdbuf %u)", debugName, i);
-      snprintf(semaphoreName, sizeof(semaphoreName) - 1, "Semaphore: %s (cmdbuf %u)", debugName, i);
-    }
-    buf.semaphore_ = lvk::createSemaphore(device, semaphoreName);
-    buf.fence_ = lvk::createFence(device, fenceName);
-    VK_ASSERT(vkAllocateCommandBuffers(device, &ai, &buf.cmdBufAllocated_));
-    buffers_[i].handle_.bufferIndex_ = i;
+  if (LVK_VULKAN_USE_VMA) {
+    vmaInvalidateAllocation(static_cast<VmaAllocator>(ctx_->getVmaAllocator()), vmaAllocation_, offset, size);
+  } else {
+    const VkMappedMemoryRange range = {
+        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+        .memory = vkMemory_,
+        .offset = offset,
+        .size = size,
+    };
+    ctx_->vkDT_.vkInvalidateMappedMemoryRanges(device_, 1, &range);
   }
 }
 
-lvk::VulkanImmediateCommands::~VulkanImmediateCommands() {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
-
-  waitAll();
+void lvk::VulkanBuffer::getBufferSubData(size_t offset, size_t size, void* data) {
+  // only host-visible buffers can be downloaded this way
+  LVK_ASSERT(mappedPtr_);
 
-  for (auto& buf : buffers_) {
-    // lifetimes of all VkFence objects are managed explicitly we do not use deferredTask() for them
-    vkDestroyFence(device_, buf.fence_, nullptr);
-    vkDestroySemaphore(device_, buf.semaphore_, nullptr);
+  if (!mappedPtr_) {
+    return;
   }
 
-  vkDestroyCommandPool(device_, commandPool_, nullptr);
-}
+  LVK_ASSERT(offset + size <= bufferSize_);
 
-void lvk::VulkanImmediateCommands::purge() {
-  LVK_PROFILER_FUNCTION();
+  if (!isCoherentMemory_) {
+    invalidateMappedMemory(offset, size);
+  }
 
-  for (CommandBufferWrapper& buf : buffers_) {
-    if (buf.cmdBuf_ == VK_NULL_HANDLE || buf.isEncoding_) {
-      continue;
-    }
+  const uint8_t* src = static_cast<uint8_t*>(mappedPtr_) + offset;
+  memcpy(data, src, size);
+}
 
-    const VkResult result = vkWaitForFences(device_, 1, &buf.fence_, VK_TRUE, 0);
+void lvk::VulkanBuffer::bufferSubData(size_t offset, size_t size, const void* data) {
+  // only host-visible buffers can be uploaded this way
+  LVK_ASSERT(mappedPtr_);
 
-    if (result == VK_SUCCESS) {
-      VK_ASSERT(vkResetCommandBuffer(buf.cmdBuf_, VkCommandBufferResetFlags{0}));
-      VK_ASSERT(vkResetFences(device_, 1, &buf.fence_));
-      buf.cmdBuf_ = VK_NULL_HANDLE;
-      numAvailableCommandBuffers_++;
-    } else {
-      if (result != VK_TIMEOUT) {
-        VK_ASSERT(result);
-      }
-    }
+  if (!mappedPtr_) {
+    return;
   }
-}
 
-const lvk::VulkanImmediateCommands::CommandBufferWrapper& lvk::VulkanImmediateCommands::acquire() {
-  LVK_PROFILER_FUNCTION();
+  LVK_ASSERT(offset + size <= bufferSize_);
 
-  if (!numAvailableCommandBuffers_) {
-    purge();
+  if (data) {
+    memcpy((uint8_t*)mappedPtr_ + offset, data, size);
+  } else {
+    memset((uint8_t*)mappedPtr_ + offset, 0, size);
   }
 
-  while (!numAvailableCommandBuffers_) {
-    LLOGL("Waiting for command buffers...\n");
-    LVK_PROFILER_ZONE("Waiting for command buffers...", LVK_PROFILER_COLOR_WAIT);
-    purge();
-    LVK_PROFILER_ZONE_END();
+  if (!isCoherentMemory_) {
+    flushMappedMemory(offset, size);
   }
+}
 
-  VulkanImmediateCommands::CommandBufferWrapper* current = nullptr;
-
-  // we are ok with any available buffer
-  for (auto& buf : buffers_) {
-    if (buf.cmdBuf_ == VK_NULL_HANDLE) {
-      current = &buf;
-      break;
-    }
-  }
-
-  // make clang happy
-  assert(current);
+lvk::VulkanImage::VulkanImage(lvk::VulkanContext& ctx,
+                              VkDevice device,
+                              VkImage image,
+                              VkImageUsageFlags usageFlags,
+                              VkFormat imageFormat,
+                              VkExtent3D extent,
+                              const char* debugName) :
+  ctx_(ctx),
+  vkDevice_(device),
+  vkImage_(image),
+  vkUsageFlags_(usageFlags),
+  isSwapchainImage_(true),
+  vkExtent_(extent),
+  vkType_(VK_IMAGE_TYPE_2D),
+  vkImageFormat_(imageFormat),
+  isDepthFormat_(isDepthFormat(imageFormat)),
+  isStencilFormat_(isStencilFormat(imageFormat)) {
+  VK_ASSERT(lvk::setDebugObjectName(ctx_.vkDT_, vkDevice_, VK_OBJECT_TYPE_IMAGE, (uint64_t)vkImage_, debugName));
+}
 
-  LVK_ASSERT_MSG(numAvailableCommandBuffers_, "No available command buffers");
-  LVK_ASSERT_MSG(current, "No available command buffers");
-  LVK_ASSERT(current->cmdBufAllocated_ != VK_NULL_HANDLE);
+lvk::VulkanImage::VulkanImage(lvk::VulkanContext& ctx,
+                              VkDevice device,
+                              VkExtent3D extent,
+                              VkImageType type,
+                              VkFormat format,
+                              uint32_t numLevels,
+                              uint32_t numLayers,
+                              VkImageTiling tiling,
+                              VkImageUsageFlags usageFlags,
+                              VkMemoryPropertyFlags memFlags,
+                              VkImageCreateFlags createFlags,
+                              VkSampleCountFlagBits samples,
+                              const char* debugName,
+                              const std::shared_ptr<VulkanImage>& aliasOf,
+                              lvk::Result* outResult) :
+  ctx_(ctx),
+  vkDevice_(device),
+  vkUsageFlags_(usageFlags),
+  vkExtent_(extent),
+  vkType_(type),
+  vkImageFormat_(format),
+  numLevels_(numLevels),
+  numLayers_(numLayers),
+  vkSamples_(samples),
+  isDepthFormat_(isDepthFormat(format)),
+  isStencilFormat_(isStencilFormat(format)),
+  isMutableFormat_((createFlags & VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT) != 0),
+  isCubeCompatible_((createFlags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT) != 0) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
 
-  current->handle_.submitId_ = submitCounter_;
-  numAvailableCommandBuffers_--;
+  LVK_ASSERT_MSG(numLevels_ > 0, "The image must contain at least one mip-level");
+  LVK_ASSERT_MSG(numLayers_ > 0, "The image must contain at least one layer");
+  LVK_ASSERT_MSG(vkImageFormat_ != VK_FORMAT_UNDEFINED, "Invalid VkFormat value");
+  LVK_ASSERT_MSG(vkSamples_ > 0, "The image must contain at least one sample");
+  LVK_ASSERT(extent.width > 0);
+  LVK_ASSERT(extent.height > 0);
+  LVK_ASSERT(extent.depth > 0);
 
-  current->cmdBuf_ = current->cmdBufAllocated_;
-  current->isEncoding_ = true;
-  const VkCommandBufferBeginInfo bi = {
-      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  // sampled and storage images are shared with async compute and the transfer queue without ownership transfers; attachment-only
+  // and transient images stay exclusive to the graphics queue to keep framebuffer compression
+  const bool isShaderAccessible = (usageFlags & (VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT)) != 0;
+  isTransferQueueShared_ = isShaderAccessible && (usageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+  uint32_t families[LVK_ARRAY_NUM_ELEMENTS(DeviceQueues::uniqueFamilyIndices)] = {};
+  const uint32_t numFamilies = getSharingQueueFamilies(ctx_.deviceQueues_, isShaderAccessible, isTransferQueueShared_, families);
+  const bool isConcurrent = numFamilies > 1;
+
+  // listing the view formats of mutable-format images keeps framebuffer compression enabled on some GPUs
+  const VkFormat viewFormats[] = {vkImageFormat_, getSRGBAliasVkFormat(vkImageFormat_)};
+  const VkImageFormatListCreateInfo ciFormatList = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_LIST_CREATE_INFO,
+      .viewFormatCount = (uint32_t)LVK_ARRAY_NUM_ELEMENTS(viewFormats),
+      .pViewFormats = viewFormats,
   };
-  VK_ASSERT(vkBeginCommandBuffer(current->cmdBuf_, &bi));
+  LVK_ASSERT(!isMutableFormat_ || viewFormats[1] != VK_FORMAT_UNDEFINED);
 
-  return *current;
-}
+  const VkImageCreateInfo ci = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .pNext = isMutableFormat_ ? &ciFormatList : nullptr,
+      .flags = createFlags,
+      .imageType = type,
+      .format = vkImageFormat_,
+      .extent = vkExtent_,
+      .mipLevels = numLevels_,
+      .arrayLayers = numLayers_,
+      .samples = samples,
+      .tiling = tiling,
+      .usage = usageFlags,
+      .sharingMode = isConcurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = isConcurrent ? numFamilies : 0u,
+      .pQueueFamilyIndices = isConcurrent ? families : nullptr,
+      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  };
 
-void lvk::VulkanImmediateCommands::wait(const SubmitHandle handle) {
-  if (isReady(handle)) {
-    return;
-  }
+  if (createFlags & VK_IMAGE_CREATE_SPARSE_BINDING_BIT) {
+    // no memory is bound here: pages are committed by VulkanContext::updateTexturePages()
+    LVK_ASSERT_MSG(!aliasOf && !(memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT), "Sparse images cannot be aliased or host-visible");
 
-  if (!LVK_VERIFY(!buffers_[handle.bufferIndex_].isEncoding_)) {
-    // we are waiting for a buffer which has not been submitted - this is probably a logic error somewhere in the calling code
-    return;
-  }
+    VK_ASSERT(ctx_.vkDT_.vkCreateImage(vkDevice_, &ci, nullptr, &vkImage_));
 
-  VK_ASSERT(vkWaitForFences(device_, 1, &buffers_[handle.bufferIndex_].fence_, VK_TRUE, UINT64_MAX));
+    ctx_.vkDT_.vkGetImageMemoryRequirements(device, vkImage_, &sparseMemoryRequirements_);
 
-  purge();
-}
+    uint32_t numRequirements = 0;
+    ctx_.vkDT_.vkGetImageSparseMemoryRequirements(device, vkImage_, &numRequirements, nullptr);
+    std::vector<VkSparseImageMemoryRequirements> requirements(numRequirements);
+    ctx_.vkDT_.vkGetImageSparseMemoryRequirements(device, vkImage_, &numRequirements, requirements.data());
 
-void lvk::VulkanImmediateCommands::waitAll() {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_WAIT);
+    const VkImageAspectFlags aspect = getImageAspectFlags();
 
-  VkFence fences[kMaxCommandBuffers];
+    bool isSupported = false;
 
-  uint32_t numFences = 0;
+    for (const VkSparseImageMemoryRequirements& r : requirements) {
+      if (r.formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT) {
+        // the metadata aspect would have to be bound as well
+        isSupported = false;
+        break;
+      }
+      if (r.formatProperties.aspectMask & aspect) {
+        sparseRequirements_ = r;
+        isSupported = true;
+      }
+    }
 
-  for (const auto& buf : buffers_) {
-    if (buf.cmdBuf_ != VK_NULL_HANDLE && !buf.isEncoding_) {
-      fences[numFences++] = buf.fence_;
+    if (!isSupported) {
+      // VulkanContext::createImage() reports the error
+      ctx_.vkDT_.vkDestroyImage(vkDevice_, vkImage_, nullptr);
+      vkImage_ = VK_NULL_HANDLE;
+      return;
     }
-  }
 
-  if (numFences) {
-    VK_ASSERT(vkWaitForFences(device_, numFences, fences, VK_TRUE, UINT64_MAX));
-  }
+    isSparse_ = true;
+  } else if (aliasOf) {
+    // bind to the memory of another image; the image which owns the memory is kept alive by `aliasOf_`
+    const std::shared_ptr<VulkanImage>& owner = aliasOf->aliasOf_ ? aliasOf->aliasOf_ : aliasOf;
 
-  purge();
-}
+    LVK_ASSERT_MSG(!(memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !owner->mappedPtr_, "Host-visible images cannot be aliased");
 
-bool lvk::VulkanImmediateCommands::isReady(const SubmitHandle handle, bool fastCheckNoVulkan) const {
-  LVK_ASSERT(handle.bufferIndex_ < kMaxCommandBuffers);
+    VK_ASSERT(ctx_.vkDT_.vkCreateImage(vkDevice_, &ci, nullptr, &vkImage_));
 
-  if (handle.empty()) {
-    // a null handle
-    return true;
-  }
+    VkMemoryRequirements memRequirements;
+    ctx_.vkDT_.vkGetImageMemoryRequirements(device, vkImage_, &memRequirements);
 
-  const CommandBufferWrapper& buf = buffers_[handle.bufferIndex_];
+    VkDeviceSize memSize = owner->vkMemorySize_;
+    VkDeviceSize memOffset = 0; // the owner has a dedicated VkDeviceMemory
+    uint32_t memTypeIndex = owner->vkMemoryTypeIndex_;
 
-  if (buf.cmdBuf_ == VK_NULL_HANDLE) {
-    // already recycled and not yet reused
-    return true;
-  }
+    if (LVK_VULKAN_USE_VMA) {
+      // vmaBindImageMemory() binds at the offset of the allocation inside its VkDeviceMemory block
+      VmaAllocationInfo info = {};
+      vmaGetAllocationInfo((VmaAllocator)ctx_.getVmaAllocator(), owner->vmaAllocation_, &info);
+      memSize = info.size;
+      memOffset = info.offset;
+      memTypeIndex = info.memoryType;
+    }
 
-  if (buf.handle_.submitId_ != handle.submitId_) {
-    // already recycled and reused by another command buffer
-    return true;
-  }
+    const char* error = nullptr;
 
-  if (fastCheckNoVulkan) {
-    // do not ask the Vulkan API about it, just let it retire naturally (when submitId for this bufferIndex gets incremented)
-    return false;
-  }
+    if (!(memRequirements.memoryTypeBits & (1u << memTypeIndex))) {
+      error = "The memory type of the aliased texture is not compatible with this texture";
+    } else if (memOffset % memRequirements.alignment) {
+      error = "The memory of the aliased texture is not aligned for this texture";
+    } else if (memRequirements.size > memSize) {
+      error = "The texture does not fit into the memory it should alias";
+    }
 
-  return vkWaitForFences(device_, 1, &buf.fence_, VK_TRUE, 0) == VK_SUCCESS;
-}
+    if (error) {
+      // not a programming error: the frame graph probes memory blocks this way
+      Result::setResult(outResult, Result::Code::ArgumentOutOfRange, error);
+      ctx_.vkDT_.vkDestroyImage(vkDevice_, vkImage_, nullptr);
+      vkImage_ = VK_NULL_HANDLE;
+      return;
+    }
 
-lvk::SubmitHandle lvk::VulkanImmediateCommands::submit(const CommandBufferWrapper& wrapper) {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_SUBMIT);
-  LVK_ASSERT(wrapper.isEncoding_);
-  VK_ASSERT(vkEndCommandBuffer(wrapper.cmdBuf_));
+    if (LVK_VULKAN_USE_VMA) {
+      VK_ASSERT(vmaBindImageMemory((VmaAllocator)ctx_.getVmaAllocator(), owner->vmaAllocation_, vkImage_));
+    } else {
+      VK_ASSERT(ctx_.vkDT_.vkBindImageMemory(vkDevice_, vkImage_, owner->vkMemory_, 0));
+    }
 
-  const VkPipelineStageFlags waitStageMasks[] = {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
-  VkSemaphore waitSemaphores[] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
-  uint32_t numWaitSemaphores = 0;
-  if (waitSemaphore_) {
-    waitSemaphores[numWaitSemaphores++] = waitSemaphore_;
-  }
-  if (lastSubmitSemaphore_) {
-    waitSemaphores[numWaitSemaphores++] = lastSubmitSemaphore_;
-  }
+    aliasOf_ = owner;
+  } else if (LVK_VULKAN_USE_VMA) {
+    if (memFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) {
+      vmaAllocInfo_.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+    } else {
+      vmaAllocInfo_.usage = memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ? VMA_MEMORY_USAGE_CPU_TO_GPU : VMA_MEMORY_USAGE_AUTO;
+    }
+    VkResult result = vmaCreateImage((VmaAllocator)ctx_.getVmaAllocator(), &ci, &vmaAllocInfo_, &vkImage_, &vmaAllocation_, nullptr);
 
-  LVK_PROFILER_ZONE("vkQueueSubmit()", LVK_PROFILER_COLOR_SUBMIT);
-#if LVK_VULKAN_PRINT_COMMANDS
-  LLOGL("%p vkQueueSubmit()\n\n", wrapper.cmdBuf_);
-#endif // LVK_VULKAN_PRINT_COMMANDS
-  const VkSubmitInfo si = {
-      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-      .waitSemaphoreCount = numWaitSemaphores,
-      .pWaitSemaphores = numWaitSemaphores ? waitSemaphores : nullptr,
-      .pWaitDstStageMask = waitStageMasks,
-      .commandBufferCount = 1u,
-      .pCommandBuffers = &wrapper.cmdBuf_,
-      .signalSemaphoreCount = 1u,
-      .pSignalSemaphores = &wrapper.semaphore_,
-  };
-  VK_ASSERT(vkQueueSubmit(queue_, 1u, &si, wrapper.fence_));
-  LVK_PROFILER_ZONE_END();
+    if (!LVK_VERIFY(result == VK_SUCCESS)) {
+      LLOGW("failed: error result: %d, memflags: %d,  imageformat: %d\n", result, memFlags, vkImageFormat_);
+    }
 
-  lastSubmitSemaphore_ = wrapper.semaphore_;
-  lastSubmitHandle_ = wrapper.handle_;
-  waitSemaphore_ = VK_NULL_HANDLE;
+    // handle memory-mapped buffers
+    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+      vmaMapMemory((VmaAllocator)ctx_.getVmaAllocator(), vmaAllocation_, &mappedPtr_);
+    }
+  } else {
+    // create image
+    VK_ASSERT(ctx_.vkDT_.vkCreateImage(vkDevice_, &ci, nullptr, &vkImage_));
 
-  // reset
-  const_cast<CommandBufferWrapper&>(wrapper).isEncoding_ = false;
-  submitCounter_++;
+    // back the image with some memory
+    {
+      VkMemoryRequirements memRequirements;
+      ctx_.vkDT_.vkGetImageMemoryRequirements(device, vkImage_, &memRequirements);
+
+      VK_ASSERT(lvk::allocateMemory(ctx_.vkDT_, ctx.getVkPhysicalDevice(), vkDevice_, &memRequirements, memFlags, &vkMemory_));
+      VK_ASSERT(ctx_.vkDT_.vkBindImageMemory(vkDevice_, vkImage_, vkMemory_, 0));
+
+      vkMemorySize_ = memRequirements.size;
+      vkMemoryTypeIndex_ = lvk::findMemoryType(ctx.getVkPhysicalDevice(), memRequirements.memoryTypeBits, memFlags);
+    }
 
-  if (!submitCounter_) {
-    // skip the 0 value - when uint32_t wraps around (null SubmitHandle)
-    submitCounter_++;
+    // handle memory-mapped images
+    if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+      VK_ASSERT(ctx_.vkDT_.vkMapMemory(vkDevice_, vkMemory_, 0, VK_WHOLE_SIZE, 0, &mappedPtr_));
+    }
   }
 
-  return lastSubmitHandle_;
+  VK_ASSERT(lvk::setDebugObjectName(ctx_.vkDT_, vkDevice_, VK_OBJECT_TYPE_IMAGE, (uint64_t)vkImage_, debugName));
+
+  // Get physical device's properties for the image's format
+  vkGetPhysicalDeviceFormatProperties(ctx.getVkPhysicalDevice(), vkImageFormat_, &vkFormatProperties_);
 }
 
-void lvk::VulkanImmediateCommands::waitSemaphore(VkSemaphore semaphore) {
-  LVK_ASSERT(waitSemaphore_ == VK_NULL_HANDLE);
+lvk::VulkanImage::~VulkanImage() {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
 
-  waitSemaphore_ = semaphore;
+  if (!isSwapchainImage_) {
+    if (isSparse_) {
+      // pending page updates of this image are dropped; the memory of its resident pages is freed here
+      std::lock_guard lock(ctx_.pimpl_->texturePagesMutex_);
+      std::erase_if(ctx_.pimpl_->pendingTexturePages_, [image = vkImage_](const auto& p) { return p.image == image; });
+    }
+    if (!sparsePages_.empty()) {
+      std::vector<SparsePage> pages;
+      pages.reserve(sparsePages_.size());
+      for (const auto& p : sparsePages_) {
+        pages.push_back(p.second);
+      }
+      ctx_.deferredTask(std::packaged_task<void()>([vma = ctx_.getVmaAllocator(),
+                                                    &vkDT = ctx_.vkDT_,
+                                                    device = vkDevice_,
+                                                    blocks = &ctx_.pimpl_->sparsePageBlocks_,
+                                                    pages = std::move(pages)]() {
+        for (const SparsePage& page : pages) {
+          freeSparsePage((VmaAllocator)vma, vkDT, device, blocks, page);
+        }
+      }));
+    }
+    if (LVK_VULKAN_USE_VMA) {
+      if (mappedPtr_) {
+        vmaUnmapMemory((VmaAllocator)ctx_.getVmaAllocator(), vmaAllocation_);
+      }
+      ctx_.deferredTask(std::packaged_task<void()>([vma = ctx_.getVmaAllocator(), image = vkImage_, allocation = vmaAllocation_]() {
+        vmaDestroyImage((VmaAllocator)vma, image, allocation);
+      }));
+    } else {
+      if (mappedPtr_) {
+        ctx_.vkDT_.vkUnmapMemory(vkDevice_, vkMemory_);
+      }
+      ctx_.deferredTask(std::packaged_task<void()>([&vkDT = ctx_.vkDT_, device = vkDevice_, image = vkImage_, memory = vkMemory_]() {
+        vkDT.vkDestroyImage(device, image, nullptr);
+        if (memory != VK_NULL_HANDLE) {
+          vkDT.vkFreeMemory(device, memory, nullptr);
+        }
+      }));
+    }
+  }
 }
 
-VkSemaphore lvk::VulkanImmediateCommands::acquireLastSubmitSemaphore() {
-  return std::exchange(lastSubmitSemaphore_, VK_NULL_HANDLE);
-}
+VkImageView lvk::VulkanImage::createImageView(VkImageViewType type,
+                                              VkFormat format,
+                                              VkImageAspectFlags aspectMask,
+                                              uint32_t baseLevel,
+                                              uint32_t numLevels,
+                                              uint32_t baseLayer,
+                                              uint32_t numLayers,
+                                              const VkComponentMapping mapping,
+                                              const char* debugName) const {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
 
-VkFence lvk::VulkanImmediateCommands::getVkFence(lvk::SubmitHandle handle) const {
-  if (handle.empty()) {
-    return VK_NULL_HANDLE;
-  }
+  // sRGB formats do not support storage images: views of mutable-format storage images (VK_IMAGE_CREATE_EXTENDED_USAGE_BIT)
+  // inherit all usages of the image unless restricted
+  const VkImageViewUsageCreateInfo ciUsage = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO,
+      .usage = vkUsageFlags_ & ~VK_IMAGE_USAGE_STORAGE_BIT,
+  };
+  const bool isRestrictedUsage = isMutableFormat_ && isStorageImage() && isSRGBVkFormat(format);
 
-  return buffers_[handle.bufferIndex_].fence_;
-}
+  const VkImageViewCreateInfo ci = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      .pNext = isRestrictedUsage ? &ciUsage : nullptr,
+      .image = vkImage_,
+      .viewType = type,
+      .format = format,
+      .components = mapping,
+      .subresourceRange = {aspectMask, baseLevel, numLevels ? numLevels : numLevels_, baseLayer, numLayers},
+  };
+  VkImageView vkView = VK_NULL_HANDLE;
+  VK_ASSERT(ctx_.vkDT_.vkCreateImageView(vkDevice_, &ci, nullptr, &vkView));
+  VK_ASSERT(lvk::setDebugObjectName(ctx_.vkDT_, vkDevice_, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)vkView, debugName));
 
-lvk::SubmitHandle lvk::VulkanImmediateCommands::getLastSubmitHandle() const {
-  return lastSubmitHandle_;
+  return vkView;
 }
 
-lvk::VulkanPipelineBuilder::VulkanPipelineBuilder() :
-  vertexInputState_(VkPipelineVertexInputStateCreateInfo{
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-      .vertexBindingDescriptionCount = 0,
-      .pVertexBindingDescriptions = nullptr,
-      .vertexAttributeDescriptionCount = 0,
-      .pVertexAttributeDescriptions = nullptr,
-  }),
-  inputAssembly_({
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-      .flags = 0,
-      .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-      .primitiveRestartEnable = VK_FALSE,
-  }),
-  tessellationState_({
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO,
-      .flags = 0,
-      .patchControlPoints = 0,
-  }),
-  rasterizationState_({
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-      .flags = 0,
-      .depthClampEnable = VK_FALSE,
-      .rasterizerDiscardEnable = VK_FALSE,
-      .polygonMode = VK_POLYGON_MODE_FILL,
-      .cullMode = VK_CULL_MODE_NONE,
-      .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
-      .depthBiasEnable = VK_FALSE,
-      .depthBiasConstantFactor = 0.0f,
-      .depthBiasClamp = 0.0f,
-      .depthBiasSlopeFactor = 0.0f,
-      .lineWidth = 1.0f,
-  }),
-  multisampleState_({
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-      .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+void lvk::VulkanImage::transitionLayout(VkCommandBuffer commandBuffer,
+                                        VkImageLayout newImageLayout,
+                                        VkPipelineStageFlags srcStageMask,
+                                        VkPipelineStageFlags dstStageMask,
+                                        const VkImageSubresourceRange& subresourceRange) const {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_BARRIER);
+
+  VkAccessFlags srcAccessMask = 0;
+  VkAccessFlags dstAccessMask = 0;
+
+  if (vkImageLayout_ == VK_IMAGE_LAYOUT_UNDEFINED) {
+    // we do not need to wait for any previous operations in this case
+    srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+  }
+
+  const VkPipelineStageFlags doNotRequireAccessMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT |
+                                                      VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  VkPipelineStageFlags srcRemainingMask = srcStageMask & ~doNotRequireAccessMask;
+  VkPipelineStageFlags dstRemainingMask = dstStageMask & ~doNotRequireAccessMask;
+
+  if (srcStageMask & VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT) {
+    srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    srcRemainingMask &= ~VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+  }
+  if (srcStageMask & VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT) {
+    srcAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    srcRemainingMask &= ~VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  }
+  if (srcStageMask & VK_PIPELINE_STAGE_TRANSFER_BIT) {
+    srcAccessMask |= VK_ACCESS_TRANSFER_WRITE_BIT;
+    srcRemainingMask &= ~VK_PIPELINE_STAGE_TRANSFER_BIT;
+  }
+  if (srcStageMask & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) {
+    srcAccessMask |= VK_ACCESS_SHADER_WRITE_BIT;
+    srcRemainingMask &= ~VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  }
+  if (srcStageMask & VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT) {
+    srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    srcRemainingMask &= ~VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+  }
+
+  LVK_ASSERT_MSG(srcRemainingMask == 0, "Automatic access mask deduction is not implemented (yet) for this srcStageMask");
+
+  if (dstStageMask & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) {
+    dstAccessMask |= VK_ACCESS_SHADER_READ_BIT;
+    dstAccessMask |= VK_ACCESS_SHADER_WRITE_BIT;
+    dstRemainingMask &= ~VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  }
+  if (dstStageMask & VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT) {
+    dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dstRemainingMask &= ~VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+  }
+  if (dstStageMask & VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT) {
+    dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dstRemainingMask &= ~VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+  }
+  if (dstStageMask & VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT) {
+    dstAccessMask |= VK_ACCESS_SHADER_READ_BIT;
+    dstAccessMask |= VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+    dstRemainingMask &= ~VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+  }
+  if (dstStageMask & VK_PIPELINE_STAGE_TRANSFER_BIT) {
+    dstAccessMask |= VK_ACCESS_TRANSFER_READ_BIT;
+    dstRemainingMask &= ~VK_PIPELINE_STAGE_TRANSFER_BIT;
+  }
+
+  LVK_ASSERT_MSG(dstRemainingMask == 0, "Automatic access mask deduction is not implemented (yet) for this dstStageMask");
+
+  lvk::imageMemoryBarrier(ctx_.vkDT_,
+                          commandBuffer,
+                          vkImage_,
+                          srcAccessMask,
+                          dstAccessMask,
+                          vkImageLayout_,
+                          newImageLayout,
+                          srcStageMask,
+                          dstStageMask,
+                          subresourceRange,
+                          ctx_.frameCounters_);
+
+  vkImageLayout_ = newImageLayout;
+}
+
+VkImageAspectFlags lvk::VulkanImage::getImageAspectFlags() const {
+  VkImageAspectFlags flags = 0;
+
+  flags |= isDepthFormat_ ? VK_IMAGE_ASPECT_DEPTH_BIT : 0;
+  flags |= isStencilFormat_ ? VK_IMAGE_ASPECT_STENCIL_BIT : 0;
+  flags |= !(isDepthFormat_ || isStencilFormat_) ? VK_IMAGE_ASPECT_COLOR_BIT : 0;
+
+  return flags;
+}
+
+void lvk::VulkanImage::generateMipmap(VkCommandBuffer commandBuffer) const {
+  LVK_PROFILER_FUNCTION();
+
+  // Check if device supports downscaling for color or depth/stencil buffer based on image format
+  {
+    const uint32_t formatFeatureMask = (VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT);
+
+    const bool hardwareDownscalingSupported = (vkFormatProperties_.optimalTilingFeatures & formatFeatureMask) == formatFeatureMask;
+
+    if (!LVK_VERIFY(hardwareDownscalingSupported)) {
+      LVK_ASSERT_MSG(false, "Doesn't support hardware downscaling of this image format: {}");
+      return;
+    }
+  }
+
+  // Choose linear filter for color formats if supported by the device, else use nearest filter
+  // Choose nearest filter by default for depth/stencil formats
+  const VkFilter blitFilter = [](bool isDepthOrStencilFormat, bool imageFilterLinear) {
+    if (isDepthOrStencilFormat) {
+      return VK_FILTER_NEAREST;
+    }
+    if (imageFilterLinear) {
+      return VK_FILTER_LINEAR;
+    }
+    return VK_FILTER_NEAREST;
+  }(isDepthFormat_ || isStencilFormat_, vkFormatProperties_.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+
+  const VkImageAspectFlags imageAspectFlags = getImageAspectFlags();
+
+  const VkDebugUtilsLabelEXT utilsLabel = {
+      .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+      .pLabelName = "Generate mipmaps",
+      .color = {1.0f, 0.75f, 1.0f, 1.0f},
+  };
+  ctx_.vkDT_.vkCmdBeginDebugUtilsLabelEXT(commandBuffer, &utilsLabel);
+
+  const VkImageLayout originalImageLayout = vkImageLayout_;
+
+  LVK_ASSERT(originalImageLayout != VK_IMAGE_LAYOUT_UNDEFINED);
+
+  // 0: Transition the first level and all layers into VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+  transitionLayout(commandBuffer,
+                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                   VK_PIPELINE_STAGE_TRANSFER_BIT,
+                   VkImageSubresourceRange{imageAspectFlags, 0, 1, 0, numLayers_});
+
+  for (uint32_t layer = 0; layer < numLayers_; ++layer) {
+    int32_t mipWidth = (int32_t)vkExtent_.width;
+    int32_t mipHeight = (int32_t)vkExtent_.height;
+
+    for (uint32_t i = 1; i < numLevels_; ++i) {
+      // 1: Transition the i-th level to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL; it will be copied into from the (i-1)-th layer
+      lvk::imageMemoryBarrier(ctx_.vkDT_,
+                              commandBuffer,
+                              vkImage_,
+                              0, /* srcAccessMask */
+                              VK_ACCESS_TRANSFER_WRITE_BIT, // dstAccessMask
+                              VK_IMAGE_LAYOUT_UNDEFINED, // oldImageLayout
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // newImageLayout
+                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // srcStageMask
+                              VK_PIPELINE_STAGE_TRANSFER_BIT, // dstStageMask
+                              VkImageSubresourceRange{imageAspectFlags, i, 1, layer, 1},
+                              ctx_.frameCounters_);
+
+      const int32_t nextLevelWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+      const int32_t nextLevelHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+
+      const VkOffset3D srcOffsets[2] = {
+          VkOffset3D{0, 0, 0},
+          VkOffset3D{mipWidth, mipHeight, 1},
+      };
+      const VkOffset3D dstOffsets[2] = {
+          VkOffset3D{0, 0, 0},
+          VkOffset3D{nextLevelWidth, nextLevelHeight, 1},
+      };
+
+      // 2: Blit the image from the prev mip-level (i-1) (VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) to the current mip-level (i)
+      // (VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+#if LVK_VULKAN_PRINT_COMMANDS
+      LLOGL("%p vkCmdBlitImage()\n", commandBuffer);
+#endif // LVK_VULKAN_PRINT_COMMANDS
+      const VkImageBlit blit = {
+          .srcSubresource = VkImageSubresourceLayers{imageAspectFlags, i - 1, layer, 1},
+          .srcOffsets = {srcOffsets[0], srcOffsets[1]},
+          .dstSubresource = VkImageSubresourceLayers{imageAspectFlags, i, layer, 1},
+          .dstOffsets = {dstOffsets[0], dstOffsets[1]},
+      };
+      ctx_.vkDT_.vkCmdBlitImage(commandBuffer,
+                                vkImage_,
+                                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                vkImage_,
+                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                1,
+                                &blit,
+                                blitFilter);
+      // 3: Transition i-th level to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL as it will be read from in
+      // the next iteration
+      lvk::imageMemoryBarrier(ctx_.vkDT_,
+                              commandBuffer,
+                              vkImage_,
+                              VK_ACCESS_TRANSFER_WRITE_BIT, /* srcAccessMask */
+                              VK_ACCESS_TRANSFER_READ_BIT, /* dstAccessMask */
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, /* oldImageLayout */
+                              VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, /* newImageLayout */
+                              VK_PIPELINE_STAGE_TRANSFER_BIT, /* srcStageMask */
+                              VK_PIPELINE_STAGE_TRANSFER_BIT /* dstStageMask */,
+                              VkImageSubresourceRange{imageAspectFlags, i, 1, layer, 1},
+                              ctx_.frameCounters_);
+
+      // Compute the size of the next mip level
+      mipWidth = nextLevelWidth;
+      mipHeight = nextLevelHeight;
+    }
+  }
+
+  // 4: Transition all levels and layers (faces) to their final layout
+  lvk::imageMemoryBarrier(ctx_.vkDT_,
+                          commandBuffer,
+                          vkImage_,
+                          VK_ACCESS_TRANSFER_WRITE_BIT, // srcAccessMask
+                          0, // dstAccessMask
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // oldImageLayout
+                          originalImageLayout, // newImageLayout
+                          VK_PIPELINE_STAGE_TRANSFER_BIT, // srcStageMask
+                          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, // dstStageMask
+                          VkImageSubresourceRange{imageAspectFlags, 0, numLevels_, 0, numLayers_},
+                          ctx_.frameCounters_);
+  ctx_.vkDT_.vkCmdEndDebugUtilsLabelEXT(commandBuffer);
+
+  vkImageLayout_ = originalImageLayout;
+}
+
+bool lvk::VulkanImage::isDepthFormat(VkFormat format) {
+  return (format == VK_FORMAT_D16_UNORM) || (format == VK_FORMAT_X8_D24_UNORM_PACK32) || (format == VK_FORMAT_D32_SFLOAT) ||
+         (format == VK_FORMAT_D16_UNORM_S8_UINT) || (format == VK_FORMAT_D24_UNORM_S8_UINT) || (format == VK_FORMAT_D32_SFLOAT_S8_UINT);
+}
+
+bool lvk::VulkanImage::isStencilFormat(VkFormat format) {
+  return (format == VK_FORMAT_S8_UINT) || (format == VK_FORMAT_D16_UNORM_S8_UINT) || (format == VK_FORMAT_D24_UNORM_S8_UINT) ||
+         (format == VK_FORMAT_D32_SFLOAT_S8_UINT);
+}
+
+lvk::VulkanTexture::VulkanTexture(std::shared_ptr<VulkanImage> image, VkImageView imageView, VkFormat viewFormat) :
+  image_(std::move(image)), imageView_(imageView) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
+
+  LVK_ASSERT(image_.get());
+  LVK_ASSERT(imageView_ != VK_NULL_HANDLE);
+
+  isStorageView_ = image_->isStorageImage() &&
+                   !(image_->isMutableFormat_ && isSRGBVkFormat(viewFormat != VK_FORMAT_UNDEFINED ? viewFormat : image_->vkImageFormat_));
+}
+
+lvk::VulkanTexture::~VulkanTexture() {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
+
+  if (image_) {
+    lvk::VulkanContext& ctx = image_->ctx_;
+    ctx.deferredTask(std::packaged_task<void()>([&vkDT = ctx.vkDT_, device = ctx.getVkDevice(), imageView = imageView_]() {
+      vkDT.vkDestroyImageView(device, imageView, nullptr);
+    }));
+    for (size_t i = 0; i != LVK_MAX_MIP_LEVELS; i++) {
+      for (size_t j = 0; j != LVK_ARRAY_NUM_ELEMENTS(imageViewForFramebuffer_[0]); j++) {
+        VkImageView v = imageViewForFramebuffer_[i][j];
+        if (v != VK_NULL_HANDLE) {
+          ctx.deferredTask(std::packaged_task<void()>(
+              [&vkDT = ctx.vkDT_, device = ctx.getVkDevice(), imageView = v]() { vkDT.vkDestroyImageView(device, imageView, nullptr); }));
+        }
+      }
+    }
+  }
+}
+
+lvk::VulkanTexture::VulkanTexture(VulkanTexture&& other) {
+  std::swap(image_, other.image_);
+  std::swap(imageView_, other.imageView_);
+  std::swap(isStorageView_, other.isStorageView_);
+  for (size_t i = 0; i != LVK_MAX_MIP_LEVELS; i++) {
+    for (size_t j = 0; j != LVK_ARRAY_NUM_ELEMENTS(imageViewForFramebuffer_[0]); j++) {
+      std::swap(imageViewForFramebuffer_[i][j], other.imageViewForFramebuffer_[i][j]);
+    }
+  }
+}
+
+lvk::VulkanTexture& lvk::VulkanTexture::operator=(VulkanTexture&& other) {
+  std::swap(image_, other.image_);
+  std::swap(imageView_, other.imageView_);
+  std::swap(isStorageView_, other.isStorageView_);
+  for (size_t i = 0; i != LVK_MAX_MIP_LEVELS; i++) {
+    for (size_t j = 0; j != LVK_ARRAY_NUM_ELEMENTS(imageViewForFramebuffer_[0]); j++) {
+      std::swap(imageViewForFramebuffer_[i][j], other.imageViewForFramebuffer_[i][j]);
+    }
+  }
+  return *this;
+}
+
+VkImageView lvk::VulkanTexture::getOrCreateVkImageViewForFramebuffer(uint8_t level, uint16_t layer) {
+  LVK_ASSERT(image_ != nullptr);
+  LVK_ASSERT(level < LVK_MAX_MIP_LEVELS);
+  LVK_ASSERT(layer < LVK_ARRAY_NUM_ELEMENTS(imageViewForFramebuffer_[0]));
+
+  if (!image_ || level >= LVK_MAX_MIP_LEVELS) {
+    return VK_NULL_HANDLE;
+  }
+
+  if (imageViewForFramebuffer_[level][layer] != VK_NULL_HANDLE) {
+    return imageViewForFramebuffer_[level][layer];
+  }
+
+  imageViewForFramebuffer_[level][layer] =
+      image_->createImageView(VK_IMAGE_VIEW_TYPE_2D, image_->vkImageFormat_, image_->getImageAspectFlags(), level, 1u, layer, 1u);
+
+  return imageViewForFramebuffer_[level][layer];
+}
+
+lvk::VulkanSwapchain::VulkanSwapchain(VulkanContext& ctx, uint32_t width, uint32_t height) :
+  ctx_(ctx), device_(ctx.vkDevice_), graphicsQueue_(ctx.deviceQueues_.graphicsQueue), width_(width), height_(height) {
+  surfaceFormat_ = chooseSwapSurfaceFormat(ctx.deviceSurfaceFormats_, ctx.config_.swapChainColorSpace);
+
+  acquireSemaphore_ = lvk::createSemaphore(ctx_.vkDT_, device_, "Semaphore: swapchain-acquire");
+
+  LVK_ASSERT_MSG(ctx.vkSurface_ != VK_NULL_HANDLE,
+                 "You are trying to create a swapchain but your OS surface is empty. Did you want to "
+                 "create an offscreen rendering context? If so, set 'width' and 'height' to 0 when you "
+                 "create your lvk::IContext");
+
+  VkBool32 queueFamilySupportsPresentation = VK_FALSE;
+  VK_ASSERT(ctx.vkIT_.vkGetPhysicalDeviceSurfaceSupportKHR(
+      ctx.getVkPhysicalDevice(), ctx.deviceQueues_.graphicsQueueFamilyIndex, ctx.vkSurface_, &queueFamilySupportsPresentation));
+  LVK_ASSERT_MSG(queueFamilySupportsPresentation == VK_TRUE, "The queue family used with the swapchain does not support presentation");
+
+  auto chooseSwapImageCount = [](const VkSurfaceCapabilitiesKHR& caps) -> uint32_t {
+    const uint32_t desired = caps.minImageCount + 1;
+    const bool exceeded = caps.maxImageCount > 0 && desired > caps.maxImageCount;
+    return exceeded ? caps.maxImageCount : desired;
+  };
+
+  auto chooseSwapPresentMode = [](const std::vector<VkPresentModeKHR>& modes, lvk::PresentMode mode) -> VkPresentModeKHR {
+    auto isSupported = [&modes](VkPresentModeKHR m) { return std::find(modes.cbegin(), modes.cend(), m) != modes.cend(); };
+    if (mode != lvk::PresentMode_Default) {
+      const VkPresentModeKHR requested = presentModeToVkPresentMode(mode);
+      if (isSupported(requested)) {
+        return requested;
+      }
+      LLOGW("The requested present mode is not supported by the surface, falling back to FIFO\n");
+      return VK_PRESENT_MODE_FIFO_KHR;
+    }
+#if defined(__linux__)
+    if (isSupported(VK_PRESENT_MODE_IMMEDIATE_KHR)) {
+      return VK_PRESENT_MODE_IMMEDIATE_KHR;
+    }
+#endif // __linux__
+    if (isSupported(VK_PRESENT_MODE_MAILBOX_KHR)) {
+      return VK_PRESENT_MODE_MAILBOX_KHR;
+    }
+    return VK_PRESENT_MODE_FIFO_KHR;
+  };
+
+  auto chooseUsageFlags = [&vkIT = ctx.vkIT_](VkPhysicalDevice pd, VkSurfaceKHR surface, VkFormat format) -> VkImageUsageFlags {
+    VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+    VkSurfaceCapabilitiesKHR caps = {};
+    VK_ASSERT(vkIT.vkGetPhysicalDeviceSurfaceCapabilitiesKHR(pd, surface, &caps));
+
+    VkFormatProperties props = {};
+    vkGetPhysicalDeviceFormatProperties(pd, format, &props);
+
+    const bool isStorageSupported = (caps.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) > 0;
+    const bool isTilingOptimalSupported = (props.optimalTilingFeatures & VK_IMAGE_USAGE_STORAGE_BIT) > 0;
+
+    if (isStorageSupported && isTilingOptimalSupported) {
+      usageFlags |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+
+    return usageFlags;
+  };
+
+  const VkImageUsageFlags usageFlags = chooseUsageFlags(ctx.getVkPhysicalDevice(), ctx.vkSurface_, surfaceFormat_.format);
+  const bool isCompositeAlphaOpaqueSupported = (ctx.deviceSurfaceCaps_.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR) != 0;
+  const VkSwapchainCreateInfoKHR ci = {
+      .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+      .surface = ctx.vkSurface_,
+      .minImageCount = chooseSwapImageCount(ctx.deviceSurfaceCaps_),
+      .imageFormat = surfaceFormat_.format,
+      .imageColorSpace = surfaceFormat_.colorSpace,
+      .imageExtent = {.width = width, .height = height},
+      .imageArrayLayers = 1,
+      .imageUsage = usageFlags,
+      .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = 1,
+      .pQueueFamilyIndices = &ctx.deviceQueues_.graphicsQueueFamilyIndex,
+#if defined(ANDROID)
+      .preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
+#else
+      .preTransform = ctx.deviceSurfaceCaps_.currentTransform,
+#endif
+      .compositeAlpha = isCompositeAlphaOpaqueSupported ? VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR : VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
+      .presentMode = chooseSwapPresentMode(ctx.devicePresentModes_, ctx.config_.presentMode),
+      .clipped = VK_TRUE,
+      .oldSwapchain = VK_NULL_HANDLE,
+  };
+  VK_ASSERT(ctx_.vkDT_.vkCreateSwapchainKHR(device_, &ci, nullptr, &swapchain_));
+
+  firstPresentId_ = ctx.lastPresentId_ + 1;
+
+  VkImage swapchainImages[LVK_MAX_SWAPCHAIN_IMAGES];
+  VK_ASSERT(ctx_.vkDT_.vkGetSwapchainImagesKHR(device_, swapchain_, &numSwapchainImages_, nullptr));
+  if (numSwapchainImages_ > LVK_MAX_SWAPCHAIN_IMAGES) {
+    LVK_ASSERT(numSwapchainImages_ <= LVK_MAX_SWAPCHAIN_IMAGES);
+    numSwapchainImages_ = LVK_MAX_SWAPCHAIN_IMAGES;
+  }
+  VK_ASSERT(ctx_.vkDT_.vkGetSwapchainImagesKHR(device_, swapchain_, &numSwapchainImages_, swapchainImages));
+
+  LVK_ASSERT(numSwapchainImages_ > 0);
+
+  char debugNameImage[256] = {0};
+  char debugNameImageView[256] = {0};
+
+  // create images, image views and framebuffers
+  for (uint32_t i = 0; i < numSwapchainImages_; i++) {
+    snprintf(debugNameImage, sizeof(debugNameImage) - 1, "Image: swapchain %u", i);
+    snprintf(debugNameImageView, sizeof(debugNameImageView) - 1, "Image View: swapchain %u", i);
+    std::shared_ptr<VulkanImage> image = std::make_shared<VulkanImage>(ctx_,
+                                                                       device_,
+                                                                       swapchainImages[i],
+                                                                       usageFlags,
+                                                                       surfaceFormat_.format,
+                                                                       VkExtent3D{.width = width_, .height = height_, .depth = 1},
+                                                                       debugNameImage);
+    VkImageView imageView = image->createImageView(
+        VK_IMAGE_VIEW_TYPE_2D, surfaceFormat_.format, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1, {}, debugNameImageView);
+    swapchainTextures_[i] = ctx_.texturesPool_.create(VulkanTexture(std::move(image), std::move(imageView)));
+  }
+}
+
+lvk::VulkanSwapchain::~VulkanSwapchain() {
+  for (TextureHandle handle : swapchainTextures_) {
+    ctx_.texturesPool_.destroy(handle);
+  }
+  if (acquireFence_ != VK_NULL_HANDLE) {
+    ctx_.vkDT_.vkWaitForFences(device_, 1, &acquireFence_, VK_TRUE, UINT64_MAX);
+    ctx_.vkDT_.vkDestroyFence(device_, acquireFence_, nullptr);
+  }
+  ctx_.vkDT_.vkDestroySwapchainKHR(device_, swapchain_, nullptr);
+  ctx_.vkDT_.vkDestroySemaphore(device_, acquireSemaphore_, nullptr);
+}
+
+VkImage lvk::VulkanSwapchain::getCurrentVkImage() const {
+  if (LVK_VERIFY(currentImageIndex_ < numSwapchainImages_)) {
+    lvk::VulkanTexture* tex = ctx_.texturesPool_.get(swapchainTextures_[currentImageIndex_]);
+    return tex->image_->vkImage_;
+  }
+  return VK_NULL_HANDLE;
+}
+
+VkImageView lvk::VulkanSwapchain::getCurrentVkImageView() const {
+  if (LVK_VERIFY(currentImageIndex_ < numSwapchainImages_)) {
+    lvk::VulkanTexture* tex = ctx_.texturesPool_.get(swapchainTextures_[currentImageIndex_]);
+    return tex->imageView_;
+  }
+  return VK_NULL_HANDLE;
+}
+
+lvk::TextureHandle lvk::VulkanSwapchain::getCurrentTexture() {
+  LVK_PROFILER_FUNCTION();
+
+  if (getNextImage_) {
+    // Our first submit handle can be still waiting on the previous `acquireSemaphore`.
+    //   vkAcquireNextImageKHR():  Semaphore must not have any pending operations. The Vulkan spec states:
+    //   If semaphore is not VK_NULL_HANDLE it must not have any uncompleted signal or wait operations pending
+    //   (https://vulkan.lunarg.com/doc/view/1.3.275.0/windows/1.3-extensions/vkspec.html#VUID-vkAcquireNextImageKHR-semaphore-01779)
+    ScopedHostWait hostWait(&ctx_.frameCounters_, lvk::HostWait_SwapchainAcquire);
+    if (acquireFence_ == VK_NULL_HANDLE) {
+      acquireFence_ = lvk::createFence(ctx_.vkDT_, device_, "Fence: swapchain-acquire");
+    } else {
+      ctx_.vkDT_.vkWaitForFences(device_, 1, &acquireFence_, VK_TRUE, UINT64_MAX);
+      ctx_.vkDT_.vkResetFences(device_, 1, &acquireFence_);
+    }
+    // when timeout is set to UINT64_MAX, we wait until the next image has been acquired
+    VkResult r = ctx_.vkDT_.vkAcquireNextImageKHR(device_, swapchain_, UINT64_MAX, acquireSemaphore_, acquireFence_, &currentImageIndex_);
+    if (r != VK_SUCCESS && r != VK_SUBOPTIMAL_KHR && r != VK_ERROR_OUT_OF_DATE_KHR) {
+      VK_ASSERT(r);
+    }
+    getNextImage_ = false;
+    ctx_.immediate_->waitSemaphore(acquireSemaphore_);
+  }
+
+  if (LVK_VERIFY(currentImageIndex_ < numSwapchainImages_)) {
+    return swapchainTextures_[currentImageIndex_];
+  }
+
+  return {};
+}
+
+const VkSurfaceFormatKHR& lvk::VulkanSwapchain::getSurfaceFormat() const {
+  return surfaceFormat_;
+}
+
+uint32_t lvk::VulkanSwapchain::getNumSwapchainImages() const {
+  return numSwapchainImages_;
+}
+
+lvk::Result lvk::VulkanSwapchain::present(VkSemaphore waitSemaphore, uint64_t presentId) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_PROFILER_ZONE("vkQueuePresent()", LVK_PROFILER_COLOR_PRESENT);
+  const VkPresentIdKHR presentIdInfo = {
+      .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+      .swapchainCount = 1u,
+      .pPresentIds = &presentId,
+  };
+  const VkPresentInfoKHR pi = {
+      .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+      .pNext = ctx_.hasPresentWait_ ? &presentIdInfo : nullptr,
+      .waitSemaphoreCount = 1,
+      .pWaitSemaphores = &waitSemaphore,
+      .swapchainCount = 1u,
+      .pSwapchains = &swapchain_,
+      .pImageIndices = &currentImageIndex_,
+  };
+  VkResult r = ctx_.vkDT_.vkQueuePresentKHR(graphicsQueue_, &pi);
+  if (r != VK_SUCCESS && r != VK_SUBOPTIMAL_KHR && r != VK_ERROR_OUT_OF_DATE_KHR) {
+    VK_ASSERT(r);
+  }
+  LVK_PROFILER_ZONE_END();
+
+  // Ready to call acquireNextImage() on the next getCurrentVulkanTexture();
+  getNextImage_ = true;
+
+  LVK_PROFILER_FRAME(nullptr);
+
+  return Result();
+}
+
+bool lvk::VulkanSwapchain::waitForPresent(uint64_t presentId, uint64_t timeoutNs) const {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_WAIT);
+
+  if (!ctx_.hasPresentWait_) {
+    return false;
+  }
+
+  if (presentId < firstPresentId_) {
+    // presented by a previous swapchain
+    return true;
+  }
+
+  const VkResult r = ctx_.vkDT_.vkWaitForPresentKHR(device_, swapchain_, presentId, timeoutNs);
+
+  if (r != VK_SUCCESS && r != VK_TIMEOUT && r != VK_SUBOPTIMAL_KHR && r != VK_ERROR_OUT_OF_DATE_KHR) {
+    VK_ASSERT(r);
+  }
+
+  return r == VK_SUCCESS || r == VK_SUBOPTIMAL_KHR;
+}
+
+lvk::VulkanImmediateCommands::VulkanImmediateCommands(const VulkanDeviceTable& vkDT,
+                                                      VkDevice device,
+                                                      uint32_t queueFamilyIndex,
+                                                      const char* debugName,
+                                                      lvk::QueueType queueType,
+                                                      VulkanFrameCounters* counters) :
+  vkDT_(vkDT), device_(device), queueFamilyIndex_(queueFamilyIndex), queueType_(queueType), debugName_(debugName), counters_(counters) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
+
+  vkDT_.vkGetDeviceQueue(device, queueFamilyIndex, 0, &queue_);
+
+  {
+    char timelineName[256] = {0};
+    if (debugName) {
+      snprintf(timelineName, sizeof(timelineName) - 1, "Semaphore: %s (timeline)", debugName);
+    }
+    timelineSemaphore_ = lvk::createSemaphoreTimeline(vkDT_, device, timelineValue_, timelineName);
+  }
+
+  const VkCommandPoolCreateInfo ci = {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+      .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+      .queueFamilyIndex = queueFamilyIndex,
+  };
+
+  for (uint32_t i = 0; i != kMaxCommandBuffers; i++) {
+    auto& buf = buffers_[i];
+    char semaphoreName[256] = {0};
+    char poolName[256] = {0};
+    if (debugName) {
+      snprintf(semaphoreName, sizeof(semaphoreName) - 1, "Semaphore: %s (cmdbuf %u)", debugName, i);
+      snprintf(poolName, sizeof(poolName) - 1, "Command Pool: %s (cmdbuf %u)", debugName, i);
+    }
+    // VkCommandPool is externally synchronized - a pool per command buffer lets us record on any thread without locking
+    VK_ASSERT(vkDT_.vkCreateCommandPool(device, &ci, nullptr, &buf.commandPool_));
+    lvk::setDebugObjectName(vkDT_, device, VK_OBJECT_TYPE_COMMAND_POOL, (uint64_t)buf.commandPool_, poolName);
+    const VkCommandBufferAllocateInfo ai = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = buf.commandPool_,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+    buf.semaphore_ = lvk::createSemaphore(vkDT_, device, semaphoreName);
+    VK_ASSERT(vkDT_.vkAllocateCommandBuffers(device, &ai, &buf.cmdBufAllocated_));
+    buffers_[i].handle_.bufferIndex_ = i;
+    buffers_[i].handle_.queueType_ = queueType;
+  }
+}
+
+lvk::VulkanImmediateCommands::~VulkanImmediateCommands() {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
+
+  waitAll();
+
+  for (auto& buf : buffers_) {
+    vkDT_.vkDestroySemaphore(device_, buf.semaphore_, nullptr);
+    vkDT_.vkDestroyCommandPool(device_, buf.commandPool_, nullptr);
+  }
+  vkDT_.vkDestroySemaphore(device_, timelineSemaphore_, nullptr);
+}
+
+uint64_t lvk::VulkanImmediateCommands::getTimelineValueLocked(SubmitHandle handle) const {
+  // `submitId_` holds the lower 32 bits of the timeline value; restore the upper bits relative to the last submitted value
+  return timelineValue_ - uint32_t(uint32_t(timelineValue_) - handle.submitId_);
+}
+
+uint64_t lvk::VulkanImmediateCommands::updateCompletedValueLocked() const {
+  uint64_t value = 0;
+  VK_ASSERT(vkDT_.vkGetSemaphoreCounterValue(device_, timelineSemaphore_, &value));
+  completedValue_ = std::max(completedValue_, value);
+  return completedValue_;
+}
+
+void lvk::VulkanImmediateCommands::purge() {
+  LVK_PROFILER_FUNCTION();
+
+  // one query retires all the completed command buffers
+  const uint64_t completedValue = updateCompletedValueLocked();
+
+  for (CommandBufferWrapper& buf : buffers_) {
+    if (buf.cmdBuf_ == VK_NULL_HANDLE || buf.isEncoding_ || buf.timelineValue_ > completedValue) {
+      continue;
+    }
+    VK_ASSERT(vkDT_.vkResetCommandPool(device_, buf.commandPool_, VkCommandPoolResetFlags{0}));
+    buf.cmdBuf_ = VK_NULL_HANDLE;
+    numAvailableCommandBuffers_++;
+  }
+}
+
+const lvk::VulkanImmediateCommands::CommandBufferWrapper& lvk::VulkanImmediateCommands::acquire() {
+  LVK_PROFILER_FUNCTION();
+
+  std::lock_guard lock(mutex_);
+
+  if (!numAvailableCommandBuffers_) {
+    purge();
+  }
+
+  if (!numAvailableCommandBuffers_) {
+    ScopedHostWait hostWait(counters_, lvk::HostWait_CommandBuffers);
+    while (!numAvailableCommandBuffers_) {
+      LLOGL("Waiting for command buffers...\n");
+      LVK_PROFILER_ZONE("Waiting for command buffers...", LVK_PROFILER_COLOR_WAIT);
+      purge();
+      LVK_PROFILER_ZONE_END();
+    }
+  }
+
+  VulkanImmediateCommands::CommandBufferWrapper* current = nullptr;
+
+  // we are ok with any available buffer
+  for (auto& buf : buffers_) {
+    if (buf.cmdBuf_ == VK_NULL_HANDLE) {
+      current = &buf;
+      break;
+    }
+  }
+
+  // make clang happy
+  assert(current);
+
+  LVK_ASSERT_MSG(numAvailableCommandBuffers_, "No available command buffers");
+  LVK_ASSERT_MSG(current, "No available command buffers");
+  LVK_ASSERT(current->cmdBufAllocated_ != VK_NULL_HANDLE);
+
+  numAvailableCommandBuffers_--;
+
+  current->cmdBuf_ = current->cmdBufAllocated_;
+  current->isEncoding_ = true;
+  const VkCommandBufferBeginInfo bi = {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  VK_ASSERT(vkDT_.vkBeginCommandBuffer(current->cmdBuf_, &bi));
+
+  return *current;
+}
+
+void lvk::VulkanImmediateCommands::wait(const SubmitHandle handle, lvk::HostWait reason) {
+  uint64_t value = 0;
+  {
+    std::lock_guard lock(mutex_);
+
+    if (isReadyLocked(handle, false)) {
+      return;
+    }
+
+    value = getTimelineValueLocked(handle);
+  }
+
+  // do not hold the lock while waiting - other threads can acquire command buffers in the meantime
+  const VkSemaphoreWaitInfo waitInfo = {
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+      .semaphoreCount = 1,
+      .pSemaphores = &timelineSemaphore_,
+      .pValues = &value,
+  };
+  {
+    ScopedHostWait hostWait(counters_, reason);
+    VK_ASSERT(vkDT_.vkWaitSemaphores(device_, &waitInfo, UINT64_MAX));
+  }
+
+  std::lock_guard lock(mutex_);
+
+  purge();
+}
+
+void lvk::VulkanImmediateCommands::waitAll() {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_WAIT);
+
+  std::lock_guard lock(mutex_);
+
+  const VkSemaphoreWaitInfo waitInfo = {
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+      .semaphoreCount = 1,
+      .pSemaphores = &timelineSemaphore_,
+      .pValues = &timelineValue_,
+  };
+  {
+    ScopedHostWait hostWait(counters_, lvk::HostWait_Submit);
+    VK_ASSERT(vkDT_.vkWaitSemaphores(device_, &waitInfo, UINT64_MAX));
+  }
+
+  purge();
+}
+
+bool lvk::VulkanImmediateCommands::isReady(const SubmitHandle handle, bool fastCheckNoVulkan) const {
+  std::lock_guard lock(mutex_);
+
+  return isReadyLocked(handle, fastCheckNoVulkan);
+}
+
+bool lvk::VulkanImmediateCommands::isReadyLocked(const SubmitHandle handle, bool fastCheckNoVulkan) const {
+  LVK_ASSERT(handle.bufferIndex_ < kMaxCommandBuffers);
+  LVK_ASSERT_MSG(handle.empty() || handle.queueType_ == queueType_, "The submit handle belongs to a different queue");
+
+  if (handle.empty()) {
+    // a null handle
+    return true;
+  }
+
+  const uint64_t value = getTimelineValueLocked(handle);
+
+  if (value <= completedValue_) {
+    return true;
+  }
+
+  if (fastCheckNoVulkan) {
+    // do not ask the Vulkan API about it, just let it retire naturally (when the next purge() updates the completed value)
+    return false;
+  }
+
+  return value <= updateCompletedValueLocked();
+}
+
+lvk::SubmitHandle lvk::VulkanImmediateCommands::submit(const CommandBufferWrapper& wrapper) {
+  const CommandBufferWrapper* wrappers[] = {&wrapper};
+
+  return submit(wrappers, 1);
+}
+
+lvk::SubmitHandle lvk::VulkanImmediateCommands::submit(const CommandBufferWrapper* const* wrappers,
+                                                       uint32_t numWrappers,
+                                                       const VkSemaphore* waitTimelineSemaphores,
+                                                       const uint64_t* waitTimelineValues,
+                                                       uint32_t numWaitTimelineSemaphores) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_SUBMIT);
+  LVK_ASSERT(wrappers);
+  LVK_ASSERT(numWrappers && numWrappers <= kMaxCommandBuffers);
+
+  std::lock_guard lock(mutex_);
+
+  // the last command buffer owns the binary semaphore for the entire batch
+  const CommandBufferWrapper& last = *wrappers[numWrappers - 1];
+
+  VkCommandBuffer cmdBufs[kMaxCommandBuffers];
+
+  // timeline values are assigned in the submission order; skip values with zero lower bits (null SubmitHandle)
+  uint64_t signalValue = timelineValue_ + 1;
+  if (!uint32_t(signalValue)) {
+    signalValue++;
+  }
+
+  for (uint32_t i = 0; i != numWrappers; i++) {
+    CommandBufferWrapper& wrapper = const_cast<CommandBufferWrapper&>(*wrappers[i]);
+    LVK_ASSERT(wrapper.isEncoding_);
+    VK_ASSERT(vkDT_.vkEndCommandBuffer(wrapper.cmdBuf_));
+    wrapper.timelineValue_ = signalValue;
+    wrapper.handle_.submitId_ = uint32_t(signalValue);
+    cmdBufs[i] = wrapper.cmdBuf_;
+  }
+
+  constexpr uint32_t kMaxWaitSemaphores = 3 + kMaxCommandBuffers;
+
+  LVK_ASSERT(numWaitTimelineSemaphores <= kMaxCommandBuffers);
+
+  VkPipelineStageFlags waitStageMasks[kMaxWaitSemaphores];
+  VkSemaphore waitSemaphores[kMaxWaitSemaphores];
+  uint64_t waitValues[kMaxWaitSemaphores]; // ignored for binary semaphores
+  uint32_t numWaitSemaphores = 0;
+  if (waitSemaphore_) {
+    waitValues[numWaitSemaphores] = 0;
+    waitSemaphores[numWaitSemaphores++] = waitSemaphore_;
+  }
+  if (lastSubmitSemaphore_) {
+    waitValues[numWaitSemaphores] = 0;
+    waitSemaphores[numWaitSemaphores++] = lastSubmitSemaphore_;
+  }
+  if (waitBindSparseValue_) {
+    waitValues[numWaitSemaphores] = waitBindSparseValue_;
+    waitSemaphores[numWaitSemaphores++] = timelineSemaphore_;
+  }
+  for (uint32_t i = 0; i != numWaitTimelineSemaphores; i++) {
+    waitValues[numWaitSemaphores] = waitTimelineValues[i];
+    waitSemaphores[numWaitSemaphores++] = waitTimelineSemaphores[i];
+  }
+  for (uint32_t i = 0; i != numWaitSemaphores; i++) {
+    waitStageMasks[i] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  }
+
+  // the binary semaphore is used for presentation and chaining submits; the timeline semaphore retires command buffers
+  const VkSemaphore signalSemaphores[] = {last.semaphore_, timelineSemaphore_};
+  const uint64_t signalValues[] = {0, signalValue}; // the binary semaphore value is ignored
+
+  const VkTimelineSemaphoreSubmitInfo tsi = {
+      .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+      .waitSemaphoreValueCount = numWaitSemaphores,
+      .pWaitSemaphoreValues = numWaitSemaphores ? waitValues : nullptr,
+      .signalSemaphoreValueCount = LVK_ARRAY_NUM_ELEMENTS(signalValues),
+      .pSignalSemaphoreValues = signalValues,
+  };
+
+  LVK_PROFILER_ZONE("vkQueueSubmit()", LVK_PROFILER_COLOR_SUBMIT);
+#if LVK_VULKAN_PRINT_COMMANDS
+  LLOGL("%p vkQueueSubmit() - %u command buffer(s)\n\n", last.cmdBuf_, numWrappers);
+#endif // LVK_VULKAN_PRINT_COMMANDS
+  const VkSubmitInfo si = {
+      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext = &tsi,
+      .waitSemaphoreCount = numWaitSemaphores,
+      .pWaitSemaphores = numWaitSemaphores ? waitSemaphores : nullptr,
+      .pWaitDstStageMask = numWaitSemaphores ? waitStageMasks : nullptr,
+      .commandBufferCount = numWrappers,
+      .pCommandBuffers = cmdBufs,
+      .signalSemaphoreCount = LVK_ARRAY_NUM_ELEMENTS(signalSemaphores),
+      .pSignalSemaphores = signalSemaphores,
+  };
+  VK_ASSERT(vkDT_.vkQueueSubmit(queue_, 1u, &si, VK_NULL_HANDLE));
+  LVK_PROFILER_ZONE_END();
+
+  if (counters_) {
+    counters_->numSubmits++;
+  }
+
+  timelineValue_ = signalValue;
+  lastSubmitSemaphore_ = last.semaphore_;
+  lastSubmitHandle_ = last.handle_;
+  waitSemaphore_ = VK_NULL_HANDLE;
+  waitBindSparseValue_ = 0;
+
+  // reset
+  for (uint32_t i = 0; i != numWrappers; i++) {
+    const_cast<CommandBufferWrapper*>(wrappers[i])->isEncoding_ = false;
+  }
+
+  return lastSubmitHandle_;
+}
+
+void lvk::VulkanImmediateCommands::waitSemaphore(VkSemaphore semaphore) {
+  std::lock_guard lock(mutex_);
+
+  LVK_ASSERT(waitSemaphore_ == VK_NULL_HANDLE);
+
+  waitSemaphore_ = semaphore;
+}
+
+uint64_t lvk::VulkanImmediateCommands::bindSparse(const VkSparseImageMemoryBindInfo* imageBinds,
+                                                  uint32_t numImageBinds,
+                                                  const VkSparseImageOpaqueMemoryBindInfo* opaqueBinds,
+                                                  uint32_t numOpaqueBinds) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_SUBMIT);
+
+  std::lock_guard lock(mutex_);
+
+  // the bind operation takes a value on the timeline (no command buffer is retired by it)
+  const uint64_t waitValue = timelineValue_;
+  uint64_t signalValue = timelineValue_ + 1;
+  if (!uint32_t(signalValue)) {
+    signalValue++;
+  }
+
+  const VkTimelineSemaphoreSubmitInfo tsi = {
+      .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+      .waitSemaphoreValueCount = waitValue ? 1u : 0u,
+      .pWaitSemaphoreValues = waitValue ? &waitValue : nullptr,
+      .signalSemaphoreValueCount = 1,
+      .pSignalSemaphoreValues = &signalValue,
+  };
+  const VkBindSparseInfo bi = {
+      .sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO,
+      .pNext = &tsi,
+      .waitSemaphoreCount = waitValue ? 1u : 0u,
+      .pWaitSemaphores = waitValue ? &timelineSemaphore_ : nullptr,
+      .imageOpaqueBindCount = numOpaqueBinds,
+      .pImageOpaqueBinds = opaqueBinds,
+      .imageBindCount = numImageBinds,
+      .pImageBinds = imageBinds,
+      .signalSemaphoreCount = 1,
+      .pSignalSemaphores = &timelineSemaphore_,
+  };
+  VK_ASSERT(vkDT_.vkQueueBindSparse(queue_, 1, &bi, VK_NULL_HANDLE));
+
+  timelineValue_ = signalValue;
+  waitBindSparseValue_ = signalValue;
+
+  return signalValue;
+}
+
+VkSemaphore lvk::VulkanImmediateCommands::acquireLastSubmitSemaphore() {
+  std::lock_guard lock(mutex_);
+
+  return std::exchange(lastSubmitSemaphore_, VK_NULL_HANDLE);
+}
+
+uint64_t lvk::VulkanImmediateCommands::getTimelineValue(SubmitHandle handle) const {
+  std::lock_guard lock(mutex_);
+
+  if (isReadyLocked(handle, true)) {
+    return 0;
+  }
+
+  return getTimelineValueLocked(handle);
+}
+
+lvk::SubmitHandle lvk::VulkanImmediateCommands::getLastSubmitHandle() const {
+  std::lock_guard lock(mutex_);
+
+  return lastSubmitHandle_;
+}
+
+lvk::VulkanPipelineBuilder::VulkanPipelineBuilder() :
+  vertexInputState_(VkPipelineVertexInputStateCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+      .vertexBindingDescriptionCount = 0,
+      .pVertexBindingDescriptions = nullptr,
+      .vertexAttributeDescriptionCount = 0,
+      .pVertexAttributeDescriptions = nullptr,
+  }),
+  inputAssembly_({
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+      .flags = 0,
+      .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+      .primitiveRestartEnable = VK_FALSE,
+  }),
+  tessellationState_({
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO,
+      .flags = 0,
+      .patchControlPoints = 0,
+  }),
+  rasterizationState_({
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+      .flags = 0,
+      .depthClampEnable = VK_FALSE,
+      .rasterizerDiscardEnable = VK_FALSE,
+      .polygonMode = VK_POLYGON_MODE_FILL,
+      .cullMode = VK_CULL_MODE_NONE,
+      .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+      .depthBiasEnable = VK_FALSE,
+      .depthBiasConstantFactor = 0.0f,
+      .depthBiasClamp = 0.0f,
+      .depthBiasSlopeFactor = 0.0f,
+      .lineWidth = 1.0f,
+  }),
+  multisampleState_({
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+      .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
       .sampleShadingEnable = VK_FALSE,
       .minSampleShading = 1.0f,
       .pSampleMask = nullptr,
@@ -1850,2246 +3081,4535 @@ lvk::VulkanPipelineBuilder::VulkanPipelineBuilder() :
       .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
       .pNext = NULL,
       .flags = 0,
-      .depthTestEnable = VK_FALSE,
-      .depthWriteEnable = VK_FALSE,
-      .depthCompareOp = VK_COMPARE_OP_LESS,
-      .depthBoundsTestEnable = VK_FALSE,
-      .stencilTestEnable = VK_FALSE,
-      .front =
-          {
-              .failOp = VK_STENCIL_OP_KEEP,
-              .passOp = VK_STENCIL_OP_KEEP,
-              .depthFailOp = VK_STENCIL_OP_KEEP,
-              .compareOp = VK_COMPARE_OP_NEVER,
-              .compareMask = 0,
-              .writeMask = 0,
-              .reference = 0,
-          },
-      .back =
-          {
-              .failOp = VK_STENCIL_OP_KEEP,
-              .passOp = VK_STENCIL_OP_KEEP,
-              .depthFailOp = VK_STENCIL_OP_KEEP,
-              .compareOp = VK_COMPARE_OP_NEVER,
-              .compareMask = 0,
-              .writeMask = 0,
-              .reference = 0,
-          },
-      .minDepthBounds = 0.0f,
-      .maxDepthBounds = 1.0f,
-  }) {}
+      .depthTestEnable = VK_FALSE,
+      .depthWriteEnable = VK_FALSE,
+      .depthCompareOp = VK_COMPARE_OP_LESS,
+      .depthBoundsTestEnable = VK_FALSE,
+      .stencilTestEnable = VK_FALSE,
+      .front =
+          {
+              .failOp = VK_STENCIL_OP_KEEP,
+              .passOp = VK_STENCIL_OP_KEEP,
+              .depthFailOp = VK_STENCIL_OP_KEEP,
+              .compareOp = VK_COMPARE_OP_NEVER,
+              .compareMask = 0,
+              .writeMask = 0,
+              .reference = 0,
+          },
+      .back =
+          {
+              .failOp = VK_STENCIL_OP_KEEP,
+              .passOp = VK_STENCIL_OP_KEEP,
+              .depthFailOp = VK_STENCIL_OP_KEEP,
+              .compareOp = VK_COMPARE_OP_NEVER,
+              .compareMask = 0,
+              .writeMask = 0,
+              .reference = 0,
+          },
+      .minDepthBounds = 0.0f,
+      .maxDepthBounds = 1.0f,
+  }) {}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::dynamicState(VkDynamicState state) {
+  LVK_ASSERT(numDynamicStates_ < LVK_MAX_DYNAMIC_STATES);
+  dynamicStates_[numDynamicStates_++] = state;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::primitiveTopology(VkPrimitiveTopology topology) {
+  inputAssembly_.topology = topology;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::rasterizationSamples(VkSampleCountFlagBits samples) {
+  multisampleState_.rasterizationSamples = samples;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::cullMode(VkCullModeFlags mode) {
+  rasterizationState_.cullMode = mode;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::frontFace(VkFrontFace mode) {
+  rasterizationState_.frontFace = mode;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::polygonMode(VkPolygonMode mode) {
+  rasterizationState_.polygonMode = mode;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::vertexInputState(const VkPipelineVertexInputStateCreateInfo& state) {
+  vertexInputState_ = state;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::colorAttachments(const VkPipelineColorBlendAttachmentState* states,
+                                                                         const VkFormat* formats,
+                                                                         uint32_t numColorAttachments) {
+  LVK_ASSERT(states);
+  LVK_ASSERT(formats);
+  LVK_ASSERT(numColorAttachments <= LVK_ARRAY_NUM_ELEMENTS(colorBlendAttachmentStates_));
+  LVK_ASSERT(numColorAttachments <= LVK_ARRAY_NUM_ELEMENTS(colorAttachmentFormats_));
+  for (uint32_t i = 0; i != numColorAttachments; i++) {
+    colorBlendAttachmentStates_[i] = states[i];
+    colorAttachmentFormats_[i] = formats[i];
+  }
+  numColorAttachments_ = numColorAttachments;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::depthAttachmentFormat(VkFormat format) {
+  depthAttachmentFormat_ = format;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::stencilAttachmentFormat(VkFormat format) {
+  stencilAttachmentFormat_ = format;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::patchControlPoints(uint32_t numPoints) {
+  tessellationState_.patchControlPoints = numPoints;
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::shaderStage(VkPipelineShaderStageCreateInfo stage) {
+  if (stage.module != VK_NULL_HANDLE) {
+    LVK_ASSERT(numShaderStages_ < LVK_ARRAY_NUM_ELEMENTS(shaderStages_));
+    shaderStages_[numShaderStages_++] = stage;
+  }
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::stencilStateOps(VkStencilFaceFlags faceMask,
+                                                                        VkStencilOp failOp,
+                                                                        VkStencilOp passOp,
+                                                                        VkStencilOp depthFailOp,
+                                                                        VkCompareOp compareOp) {
+  depthStencilState_.stencilTestEnable = depthStencilState_.stencilTestEnable == VK_TRUE || failOp != VK_STENCIL_OP_KEEP ||
+                                                 passOp != VK_STENCIL_OP_KEEP || depthFailOp != VK_STENCIL_OP_KEEP ||
+                                                 compareOp != VK_COMPARE_OP_ALWAYS
+                                             ? VK_TRUE
+                                             : VK_FALSE;
+
+  if (faceMask & VK_STENCIL_FACE_FRONT_BIT) {
+    VkStencilOpState& s = depthStencilState_.front;
+    s.failOp = failOp;
+    s.passOp = passOp;
+    s.depthFailOp = depthFailOp;
+    s.compareOp = compareOp;
+  }
+
+  if (faceMask & VK_STENCIL_FACE_BACK_BIT) {
+    VkStencilOpState& s = depthStencilState_.back;
+    s.failOp = failOp;
+    s.passOp = passOp;
+    s.depthFailOp = depthFailOp;
+    s.compareOp = compareOp;
+  }
+  return *this;
+}
+
+lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::stencilMasks(VkStencilFaceFlags faceMask,
+                                                                     uint32_t compareMask,
+                                                                     uint32_t writeMask,
+                                                                     uint32_t reference) {
+  if (faceMask & VK_STENCIL_FACE_FRONT_BIT) {
+    VkStencilOpState& s = depthStencilState_.front;
+    s.compareMask = compareMask;
+    s.writeMask = writeMask;
+    s.reference = reference;
+  }
+
+  if (faceMask & VK_STENCIL_FACE_BACK_BIT) {
+    VkStencilOpState& s = depthStencilState_.back;
+    s.compareMask = compareMask;
+    s.writeMask = writeMask;
+    s.reference = reference;
+  }
+  return *this;
+}
+
+VkResult lvk::VulkanPipelineBuilder::build(const VulkanDeviceTable& vkDT,
+                                           VkDevice device,
+                                           VkPipelineCache pipelineCache,
+                                           VkPipelineLayout pipelineLayout,
+                                           VkPipeline* outPipeline,
+                                           const char* debugName) noexcept {
+  const VkPipelineDynamicStateCreateInfo dynamicState = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+      .dynamicStateCount = numDynamicStates_,
+      .pDynamicStates = dynamicStates_,
+  };
+  // viewport and scissor can be NULL if the viewport state is dynamic
+  // https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkPipelineViewportStateCreateInfo.html
+  const VkPipelineViewportStateCreateInfo viewportState = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+      .viewportCount = 1,
+      .pViewports = nullptr,
+      .scissorCount = 1,
+      .pScissors = nullptr,
+  };
+  const VkPipelineColorBlendStateCreateInfo colorBlendState = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+      .logicOpEnable = VK_FALSE,
+      .logicOp = VK_LOGIC_OP_COPY,
+      .attachmentCount = numColorAttachments_,
+      .pAttachments = colorBlendAttachmentStates_,
+  };
+  const VkPipelineRenderingCreateInfo renderingInfo = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
+      .pNext = nullptr,
+      .colorAttachmentCount = numColorAttachments_,
+      .pColorAttachmentFormats = colorAttachmentFormats_,
+      .depthAttachmentFormat = depthAttachmentFormat_,
+      .stencilAttachmentFormat = stencilAttachmentFormat_,
+  };
+
+  bool hasMeshStage = false;
+
+  for (uint32_t i = 0; i != numShaderStages_; i++) {
+    hasMeshStage |= shaderStages_[i].stage == VK_SHADER_STAGE_MESH_BIT_EXT;
+  }
+
+  const VkGraphicsPipelineCreateInfo ci = {
+      .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+      .pNext = &renderingInfo,
+      .flags = 0,
+      .stageCount = numShaderStages_,
+      .pStages = shaderStages_,
+      // mesh shading pipelines have no vertex input
+      .pVertexInputState = hasMeshStage ? nullptr : &vertexInputState_,
+      .pInputAssemblyState = hasMeshStage ? nullptr : &inputAssembly_,
+      .pTessellationState = &tessellationState_,
+      .pViewportState = &viewportState,
+      .pRasterizationState = &rasterizationState_,
+      .pMultisampleState = &multisampleState_,
+      .pDepthStencilState = &depthStencilState_,
+      .pColorBlendState = &colorBlendState,
+      .pDynamicState = &dynamicState,
+      .layout = pipelineLayout,
+      .renderPass = VK_NULL_HANDLE,
+      .subpass = 0,
+      .basePipelineHandle = VK_NULL_HANDLE,
+      .basePipelineIndex = -1,
+  };
+
+  const auto result = vkDT.vkCreateGraphicsPipelines(device, pipelineCache, 1, &ci, nullptr, outPipeline);
+
+  if (!LVK_VERIFY(result == VK_SUCCESS)) {
+    return result;
+  }
+
+  numPipelinesCreated_++;
+
+  // set debug name
+  return lvk::setDebugObjectName(vkDT, device, VK_OBJECT_TYPE_PIPELINE, (uint64_t)*outPipeline, debugName);
+}
+
+lvk::CommandBuffer::CommandBuffer(VulkanContext* ctx, lvk::QueueType queue) :
+  ctx_(ctx), wrapper_(&ctx_->getImmediateCommands(queue)->acquire()), queueType_(queue) {}
+
+lvk::CommandBuffer::~CommandBuffer() {
+  // did you forget to call cmdEndRendering()?
+  LVK_ASSERT(!isRendering_);
+}
+
+void lvk::CommandBuffer::transitionToShaderReadOnly(TextureHandle handle) const {
+  LVK_PROFILER_FUNCTION();
+
+  const lvk::VulkanTexture& tex = *ctx_->texturesPool_.get(handle);
+  const lvk::VulkanImage* img = tex.image_.get();
+
+  LVK_ASSERT(!img->isSwapchainImage_);
+
+  // transition only non-multisampled images - MSAA images cannot be accessed from shaders
+  if (img->vkSamples_ == VK_SAMPLE_COUNT_1_BIT) {
+    const VkImageAspectFlags flags = tex.image_->getImageAspectFlags();
+    VkPipelineStageFlags srcStage = 0;
+    if (tex.image_->isSampledImage()) {
+      srcStage |= isDepthOrStencilVkFormat(tex.image_->vkImageFormat_) ? VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+                                                                       : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    }
+    if (tex.image_->isStorageImage()) {
+      srcStage |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
+    // set the result of the previous render pass
+    img->transitionLayout(wrapper_->cmdBuf_,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          srcStage,
+                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, // wait for subsequent
+                                                                                                        // fragment/compute shaders
+                          VkImageSubresourceRange{flags, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
+  }
+}
+
+void lvk::CommandBuffer::cmdBindComputePipeline(lvk::ComputePipelineHandle handle) {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(!handle.empty())) {
+    return;
+  }
+
+  currentPipelineGraphics_ = {};
+  currentPipelineCompute_ = handle;
+
+  VkPipeline pipeline = ctx_->getVkPipeline(handle);
+
+  const lvk::ComputePipelineState* cps = ctx_->computePipelinesPool_.get(handle);
+
+  LVK_ASSERT(cps);
+  LVK_ASSERT(pipeline != VK_NULL_HANDLE);
+
+  stats_.numStateCommands++;
+
+  if (lastPipelineBound_ != pipeline) {
+    lastPipelineBound_ = pipeline;
+    ctx_->vkDT_.vkCmdBindPipeline(wrapper_->cmdBuf_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    if (cps->pipelineLayout_ != pushConstantsLayout_) {
+      pushConstantsValidWords_ = 0; // an incompatible layout disturbs push constants
+    }
+    ctx_->checkAndUpdateDescriptorSets();
+    ctx_->bindDefaultDescriptorSets(wrapper_->cmdBuf_, VK_PIPELINE_BIND_POINT_COMPUTE, cps->pipelineLayout_);
+  } else {
+    stats_.numElidedPipelines++;
+  }
+}
+
+void lvk::CommandBuffer::cmdDispatchThreadGroups(const Dimensions& threadgroupCount, const Dependencies& deps) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(!isRendering_);
+
+  addSubmitDependencies(deps);
+
+  // dedicated compute queues do not support graphics pipeline stages; work from the graphics queue is synchronized via semaphores
+  const VkPipelineStageFlags srcStageBuffers = wrapper_->handle_.queueType_ == lvk::QueueType_Compute
+                                                   ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                                                   : VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+  for (uint32_t i = 0; i != Dependencies::LVK_MAX_SUBMIT_DEPENDENCIES && deps.textures[i]; i++) {
+    useComputeTexture(deps.textures[i]);
+  }
+  for (uint32_t i = 0; i != Dependencies::LVK_MAX_SUBMIT_DEPENDENCIES && deps.buffers[i]; i++) {
+    bufferBarrier(deps.buffers[i], srcStageBuffers, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+  }
+
+  ctx_->vkDT_.vkCmdDispatch(wrapper_->cmdBuf_, threadgroupCount.width, threadgroupCount.height, threadgroupCount.depth);
+}
+
+void lvk::CommandBuffer::cmdPushDebugGroupLabel(const char* label, uint32_t colorRGBA) const {
+  LVK_ASSERT(label);
+
+  if (!label) {
+    return;
+  }
+  const VkDebugUtilsLabelEXT utilsLabel = {
+      .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+      .pNext = nullptr,
+      .pLabelName = label,
+      .color = {float((colorRGBA >> 0) & 0xff) / 255.0f,
+                float((colorRGBA >> 8) & 0xff) / 255.0f,
+                float((colorRGBA >> 16) & 0xff) / 255.0f,
+                float((colorRGBA >> 24) & 0xff) / 255.0f},
+  };
+  ctx_->vkDT_.vkCmdBeginDebugUtilsLabelEXT(wrapper_->cmdBuf_, &utilsLabel);
+
+  gpuProfilerBeginScope(label);
+}
+
+void lvk::CommandBuffer::cmdInsertDebugEventLabel(const char* label, uint32_t colorRGBA) const {
+  LVK_ASSERT(label);
+
+  if (!label) {
+    return;
+  }
+  const VkDebugUtilsLabelEXT utilsLabel = {
+      .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+      .pNext = nullptr,
+      .pLabelName = label,
+      .color = {float((colorRGBA >> 0) & 0xff) / 255.0f,
+                float((colorRGBA >> 8) & 0xff) / 255.0f,
+                float((colorRGBA >> 16) & 0xff) / 255.0f,
+                float((colorRGBA >> 24) & 0xff) / 255.0f},
+  };
+  ctx_->vkDT_.vkCmdInsertDebugUtilsLabelEXT(wrapper_->cmdBuf_, &utilsLabel);
+}
+
+void lvk::CommandBuffer::cmdPopDebugGroupLabel() const {
+  gpuProfilerEndScope();
+
+  ctx_->vkDT_.vkCmdEndDebugUtilsLabelEXT(wrapper_->cmdBuf_);
+}
+
+void lvk::CommandBuffer::gpuProfilerBeginScope(const char* name) const {
+  // timestamps are not guaranteed on transfer queues
+  if (!ctx_->config_.enableGPUProfiler || queueType_ == lvk::QueueType_Transfer) {
+    return;
+  }
+
+  VulkanContextImpl& impl = *ctx_->pimpl_;
+
+  std::lock_guard lock(impl.gpuProfilerMutex_);
+
+  if (gpuProfilerFrame_ == ~0u) {
+    gpuProfilerFrame_ = impl.gpuProfilerCurrentFrame_;
+  }
+
+  VulkanContextImpl::GPUProfilerFrame& frame = impl.gpuProfilerFrames_[gpuProfilerFrame_];
+
+  if (frame.numScopes == frame.scopes.size()) {
+    // keep the stack balanced and drop the scope
+    gpuProfilerScopeStack_.push_back(~0u);
+    return;
+  }
+
+  const uint32_t scope = frame.numScopes++;
+
+  lvk::GPUProfilerScope& s = frame.scopes[scope];
+  s = {
+      .parent = gpuProfilerScopeStack_.empty() ? ~0u : gpuProfilerScopeStack_.back(),
+      .depth = (uint32_t)gpuProfilerScopeStack_.size(),
+  };
+  strncpy(s.name, name, sizeof(s.name) - 1);
+
+  gpuProfilerScopeStack_.push_back(scope);
+
+  ctx_->vkDT_.vkCmdWriteTimestamp(wrapper_->cmdBuf_, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, 2 * scope + 0);
+}
+
+void lvk::CommandBuffer::gpuProfilerEndScope() const {
+  if (gpuProfilerScopeStack_.empty()) {
+    return;
+  }
+
+  const uint32_t scope = gpuProfilerScopeStack_.back();
+
+  gpuProfilerScopeStack_.pop_back();
+
+  if (scope == ~0u) {
+    return;
+  }
+
+  // the query pool cannot be replaced while this command buffer is being recorded: only the oldest frame is reset
+  const VkQueryPool queryPool = ctx_->pimpl_->gpuProfilerFrames_[gpuProfilerFrame_].queryPool;
+
+  ctx_->vkDT_.vkCmdWriteTimestamp(wrapper_->cmdBuf_, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 2 * scope + 1);
+}
+
+void lvk::CommandBuffer::useComputeTexture(TextureHandle handle) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_BARRIER);
+
+  LVK_ASSERT(!handle.empty());
+  lvk::VulkanTexture* tex = ctx_->texturesPool_.get(handle);
+  const lvk::VulkanImage& vkImage = *tex->image_.get();
+  if (!vkImage.isStorageImage()) {
+    LVK_ASSERT_MSG(false, "Did you forget to specify TextureUsageBits::Storage on your texture?");
+    return;
+  }
+
+  // "frame graph" heuristics: if we are already in VK_IMAGE_LAYOUT_GENERAL, wait for the previous
+  // compute shader
+  const VkPipelineStageFlags srcStage = (vkImage.vkImageLayout_ == VK_IMAGE_LAYOUT_GENERAL) ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                                                                                            : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+  vkImage.transitionLayout(
+      wrapper_->cmdBuf_,
+      VK_IMAGE_LAYOUT_GENERAL,
+      srcStage,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VkImageSubresourceRange{vkImage.getImageAspectFlags(), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
+}
+
+void lvk::CommandBuffer::addSubmitDependencies(const Dependencies& deps) {
+  for (uint32_t i = 0; i != Dependencies::LVK_MAX_SUBMIT_DEPENDENCIES; i++) {
+    const SubmitHandle handle = deps.submits[i];
+    // submits to the same queue are already serialized
+    if (handle.empty() || handle.queueType_ == wrapper_->handle_.queueType_) {
+      continue;
+    }
+    if (!LVK_VERIFY(numWaitSubmits_ < kMaxWaitSubmits)) {
+      LLOGW("Too many cross-queue dependencies in one command buffer\n");
+      return;
+    }
+    waitSubmits_[numWaitSubmits_++] = handle;
+  }
+}
+
+void lvk::CommandBuffer::bufferBarrier(BufferHandle handle, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_BARRIER);
+
+  lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(handle);
+
+  VkBufferMemoryBarrier barrier = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer = buf->vkBuffer_,
+      .offset = 0,
+      .size = VK_WHOLE_SIZE,
+  };
+
+  if (dstStage & VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT) {
+    barrier.dstAccessMask |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+  }
+  if (buf->vkUsageFlags_ & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
+    barrier.dstAccessMask |= VK_ACCESS_INDEX_READ_BIT;
+  }
+
+  lvk::bufferMemoryBarrier(ctx_->vkDT_, wrapper_->cmdBuf_, &barrier, 1, srcStage, dstStage, ctx_->frameCounters_);
+}
+
+void lvk::CommandBuffer::cmdPipelineBarrier(const TextureBarrier* textureBarriers,
+                                            uint32_t numTextureBarriers,
+                                            const BufferBarrier* bufferBarriers,
+                                            uint32_t numBufferBarriers) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_BARRIER);
+
+  LVK_ASSERT(!isRendering_);
+  LVK_ASSERT(textureBarriers || !numTextureBarriers);
+  LVK_ASSERT(bufferBarriers || !numBufferBarriers);
+
+  std::vector<VkImageMemoryBarrier2> imageBarriers;
+  std::vector<VkBufferMemoryBarrier2> bufBarriers;
+  imageBarriers.reserve(numTextureBarriers);
+  bufBarriers.reserve(numBufferBarriers);
+
+  for (uint32_t i = 0; i != numTextureBarriers; i++) {
+    const TextureBarrier& b = textureBarriers[i];
+    lvk::VulkanTexture* tex = ctx_->texturesPool_.get(b.texture);
+
+    if (!LVK_VERIFY(tex)) {
+      continue;
+    }
+
+    lvk::VulkanImage& img = *tex->image_.get();
+
+    const VulkanResourceState src = getVulkanResourceState(b.srcUsage);
+    const VulkanResourceState dst = getVulkanResourceState(b.dstUsage);
+
+    LVK_ASSERT_MSG(dst.layout != VK_IMAGE_LAYOUT_UNDEFINED, "TextureBarrier::dstUsage should define an image layout");
+
+    imageBarriers.push_back(VkImageMemoryBarrier2{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = src.stageMask,
+        .srcAccessMask = src.accessMask,
+        .dstStageMask = dst.stageMask,
+        .dstAccessMask = dst.accessMask,
+        .oldLayout = b.discardContents ? VK_IMAGE_LAYOUT_UNDEFINED : img.vkImageLayout_,
+        .newLayout = dst.layout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = img.vkImage_,
+        .subresourceRange = {img.getImageAspectFlags(), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS},
+    });
+
+    img.vkImageLayout_ = dst.layout;
+
+    if (dst.layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL || dst.layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
+      transitionedAttachments_.push_back(b.texture);
+    }
+  }
+
+  for (uint32_t i = 0; i != numBufferBarriers; i++) {
+    const BufferBarrier& b = bufferBarriers[i];
+    const lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(b.buffer);
+
+    if (!LVK_VERIFY(buf)) {
+      continue;
+    }
+
+    const VulkanResourceState src = getVulkanResourceState(b.srcUsage);
+    const VulkanResourceState dst = getVulkanResourceState(b.dstUsage);
+
+    bufBarriers.push_back(VkBufferMemoryBarrier2{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+        .srcStageMask = src.stageMask,
+        .srcAccessMask = src.accessMask,
+        .dstStageMask = dst.stageMask,
+        .dstAccessMask = dst.accessMask,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = buf->vkBuffer_,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE,
+    });
+  }
+
+  if (imageBarriers.empty() && bufBarriers.empty()) {
+    return;
+  }
+
+  const VkDependencyInfo depInfo = {
+      .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+      .bufferMemoryBarrierCount = (uint32_t)bufBarriers.size(),
+      .pBufferMemoryBarriers = bufBarriers.data(),
+      .imageMemoryBarrierCount = (uint32_t)imageBarriers.size(),
+      .pImageMemoryBarriers = imageBarriers.data(),
+  };
+
+  ctx_->frameCounters_.numBarriers++;
+  ctx_->vkDT_.vkCmdPipelineBarrier2(wrapper_->cmdBuf_, &depInfo);
+}
+
+void lvk::CommandBuffer::cmdBeginRendering(const lvk::RenderPass& renderPass, const lvk::Framebuffer& fb, const Dependencies& deps) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(!isRendering_);
+  LVK_ASSERT_MSG(queueType_ == lvk::QueueType_Graphics, "Rendering is supported only by QueueType_Graphics command buffers");
+
+  isRendering_ = true;
+
+  addSubmitDependencies(deps);
+
+  for (uint32_t i = 0; i != Dependencies::LVK_MAX_SUBMIT_DEPENDENCIES && deps.textures[i]; i++) {
+    transitionToShaderReadOnly(deps.textures[i]);
+  }
+  for (uint32_t i = 0; i != Dependencies::LVK_MAX_SUBMIT_DEPENDENCIES && deps.buffers[i]; i++) {
+    VkPipelineStageFlags dstStageFlags = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    if (ctx_->hasMeshShader_) {
+      dstStageFlags |= VK_PIPELINE_STAGE_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT;
+    }
+    const lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(deps.buffers[i]);
+    LVK_ASSERT(buf);
+    if ((buf->vkUsageFlags_ & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) || (buf->vkUsageFlags_ & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)) {
+      dstStageFlags |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    }
+    if (buf->vkUsageFlags_ & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) {
+      dstStageFlags |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    }
+    bufferBarrier(deps.buffers[i], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStageFlags);
+  }
+
+  const uint32_t numFbColorAttachments = fb.getNumColorAttachments();
+  const uint32_t numPassColorAttachments = renderPass.getNumColorAttachments();
+
+  LVK_ASSERT(numPassColorAttachments == numFbColorAttachments);
+
+  framebuffer_ = fb;
+
+  // attachments transitioned by cmdPipelineBarrier() are already synchronized (unless something changed their layouts since then)
+  auto isTransitioned = [this](TextureHandle handle, VkImageLayout layout) -> bool {
+    return std::find(transitionedAttachments_.begin(), transitionedAttachments_.end(), handle) != transitionedAttachments_.end() &&
+           ctx_->texturesPool_.get(handle)->image_->vkImageLayout_ == layout;
+  };
+
+  // transition all the color attachments
+  for (uint32_t i = 0; i != numFbColorAttachments; i++) {
+    if (const auto handle = fb.color[i].texture; handle && !isTransitioned(handle, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)) {
+      lvk::VulkanTexture* colorTex = ctx_->texturesPool_.get(handle);
+      transitionToColorAttachment(wrapper_->cmdBuf_, colorTex);
+    }
+    // handle MSAA
+    if (TextureHandle handle = fb.color[i].resolveTexture; handle && !isTransitioned(handle, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)) {
+      lvk::VulkanTexture* colorResolveTex = ctx_->texturesPool_.get(handle);
+      transitionToColorAttachment(wrapper_->cmdBuf_, colorResolveTex);
+    }
+  }
+  // transition depth-stencil attachment
+  TextureHandle depthTex = fb.depthStencil.texture;
+  if (depthTex && !isTransitioned(depthTex, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)) {
+    lvk::VulkanTexture& vkDepthTex = *ctx_->texturesPool_.get(depthTex);
+    const lvk::VulkanImage* depthImg = vkDepthTex.image_.get();
+    LVK_ASSERT_MSG(depthImg->vkImageFormat_ != VK_FORMAT_UNDEFINED, "Invalid depth attachment format");
+    const VkImageAspectFlags flags = vkDepthTex.image_->getImageAspectFlags();
+    depthImg->transitionLayout(wrapper_->cmdBuf_,
+                               VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                               VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                               VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, // wait for all subsequent
+                                                                                                               // operations
+                               VkImageSubresourceRange{flags, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
+  }
+  // handle MSAA
+  if (TextureHandle handle = fb.depthStencil.resolveTexture;
+      handle && !isTransitioned(handle, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)) {
+    const lvk::VulkanImage* resolveImg = ctx_->texturesPool_.get(handle)->image_.get();
+    const VkImageAspectFlags flags = resolveImg->getImageAspectFlags();
+    // depth-stencil resolves happen in the color attachment output stage
+    resolveImg->transitionLayout(wrapper_->cmdBuf_,
+                                 VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                 VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                 VkImageSubresourceRange{flags, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
+  }
+
+  transitionedAttachments_.clear();
+
+  VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+  uint32_t mipLevel = 0;
+  uint32_t fbWidth = 0;
+  uint32_t fbHeight = 0;
+
+  VkRenderingAttachmentInfo colorAttachments[LVK_MAX_COLOR_ATTACHMENTS];
+
+  for (uint32_t i = 0; i != numFbColorAttachments; i++) {
+    const lvk::Framebuffer::AttachmentDesc& attachment = fb.color[i];
+    LVK_ASSERT(!attachment.texture.empty());
+
+    lvk::VulkanTexture& colorTexture = *ctx_->texturesPool_.get(attachment.texture);
+    const auto& descColor = renderPass.color[i];
+    if (mipLevel && descColor.level) {
+      LVK_ASSERT_MSG(descColor.level == mipLevel, "All color attachments should have the same mip-level");
+    }
+    const VkExtent3D dim = colorTexture.getExtent();
+    if (fbWidth) {
+      LVK_ASSERT_MSG(dim.width == fbWidth, "All attachments should have the save width");
+    }
+    if (fbHeight) {
+      LVK_ASSERT_MSG(dim.height == fbHeight, "All attachments should have the save width");
+    }
+    mipLevel = descColor.level;
+    fbWidth = dim.width;
+    fbHeight = dim.height;
+    samples = colorTexture.image_->vkSamples_;
+    colorAttachments[i] = {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .pNext = nullptr,
+        .imageView = colorTexture.getOrCreateVkImageViewForFramebuffer(descColor.level, descColor.layer),
+        .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .resolveMode = (samples > 1) ? VK_RESOLVE_MODE_AVERAGE_BIT : VK_RESOLVE_MODE_NONE,
+        .resolveImageView = VK_NULL_HANDLE,
+        .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .loadOp = loadOpToVkAttachmentLoadOp(descColor.loadOp),
+        .storeOp = storeOpToVkAttachmentStoreOp(descColor.storeOp),
+        .clearValue =
+            {.color = {.float32 = {descColor.clearColor[0], descColor.clearColor[1], descColor.clearColor[2], descColor.clearColor[3]}}},
+    };
+    // handle MSAA
+    if (descColor.storeOp == StoreOp_MsaaResolve) {
+      LVK_ASSERT(samples > 1);
+      LVK_ASSERT_MSG(!attachment.resolveTexture.empty(), "Framebuffer attachment should contain a resolve texture");
+      lvk::VulkanTexture& colorResolveTexture = *ctx_->texturesPool_.get(attachment.resolveTexture);
+      colorAttachments[i].resolveImageView = colorResolveTexture.getOrCreateVkImageViewForFramebuffer(descColor.level, descColor.layer);
+      colorAttachments[i].resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+  }
+
+  VkRenderingAttachmentInfo depthAttachment = {};
+
+  if (fb.depthStencil.texture) {
+    auto& depthTexture = *ctx_->texturesPool_.get(fb.depthStencil.texture);
+    const RenderPass::AttachmentDesc& descDepth = renderPass.depth;
+    LVK_ASSERT_MSG(descDepth.level == mipLevel, "Depth attachment should have the same mip-level as color attachments");
+    depthAttachment = {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .pNext = nullptr,
+        .imageView = depthTexture.getOrCreateVkImageViewForFramebuffer(descDepth.level, descDepth.layer),
+        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        .resolveMode = VK_RESOLVE_MODE_NONE,
+        .resolveImageView = VK_NULL_HANDLE,
+        .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .loadOp = loadOpToVkAttachmentLoadOp(descDepth.loadOp),
+        .storeOp = storeOpToVkAttachmentStoreOp(descDepth.storeOp),
+        .clearValue = {.depthStencil = {.depth = descDepth.clearDepth, .stencil = descDepth.clearStencil}},
+    };
+    // handle MSAA: VK_RESOLVE_MODE_SAMPLE_ZERO_BIT is the only depth-stencil resolve mode supported by all devices
+    if (descDepth.storeOp == StoreOp_MsaaResolve) {
+      LVK_ASSERT(depthTexture.image_->vkSamples_ > 1);
+      LVK_ASSERT_MSG(!fb.depthStencil.resolveTexture.empty(), "Framebuffer depth attachment should contain a resolve texture");
+      lvk::VulkanTexture& depthResolveTexture = *ctx_->texturesPool_.get(fb.depthStencil.resolveTexture);
+      depthAttachment.resolveMode = VK_RESOLVE_MODE_SAMPLE_ZERO_BIT;
+      depthAttachment.resolveImageView = depthResolveTexture.getOrCreateVkImageViewForFramebuffer(descDepth.level, descDepth.layer);
+      depthAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    }
+    const VkExtent3D dim = depthTexture.getExtent();
+    if (fbWidth) {
+      LVK_ASSERT_MSG(dim.width == fbWidth, "All attachments should have the save width");
+    }
+    if (fbHeight) {
+      LVK_ASSERT_MSG(dim.height == fbHeight, "All attachments should have the save width");
+    }
+    mipLevel = descDepth.level;
+    fbWidth = dim.width;
+    fbHeight = dim.height;
+  }
+
+  const uint32_t width = std::max(fbWidth >> mipLevel, 1u);
+  const uint32_t height = std::max(fbHeight >> mipLevel, 1u);
+  const lvk::Viewport viewport = {0.0f, 0.0f, (float)width, (float)height, 0.0f, +1.0f};
+  const lvk::ScissorRect scissor = {0, 0, width, height};
+
+  VkRenderingAttachmentInfo stencilAttachment = depthAttachment;
+
+  const bool isStencilFormat = renderPass.stencil.loadOp != lvk::LoadOp_Invalid;
+
+  const VkRenderingInfo renderingInfo = {
+      .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .renderArea = {VkOffset2D{(int32_t)scissor.x, (int32_t)scissor.y}, VkExtent2D{scissor.width, scissor.height}},
+      .layerCount = 1,
+      .viewMask = 0,
+      .colorAttachmentCount = numFbColorAttachments,
+      .pColorAttachments = colorAttachments,
+      .pDepthAttachment = depthTex ? &depthAttachment : nullptr,
+      .pStencilAttachment = isStencilFormat ? &stencilAttachment : nullptr,
+  };
+
+  cmdBindViewport(viewport);
+  cmdBindScissorRect(scissor);
+  cmdBindDepthState({});
+
+  ctx_->checkAndUpdateDescriptorSets();
+
+  ctx_->vkDT_.vkCmdSetDepthCompareOp(wrapper_->cmdBuf_, VK_COMPARE_OP_ALWAYS);
+  ctx_->vkDT_.vkCmdSetDepthBiasEnable(wrapper_->cmdBuf_, VK_FALSE);
+
+  // outside of the render pass: timestamps inside multiview render passes take multiple queries
+  gpuProfilerBeginScope(fb.debugName && *fb.debugName ? fb.debugName : "cmdBeginRendering()");
+
+  ctx_->vkDT_.vkCmdBeginRendering(wrapper_->cmdBuf_, &renderingInfo);
+}
+
+void lvk::CommandBuffer::cmdEndRendering() {
+  LVK_ASSERT(isRendering_);
+
+  isRendering_ = false;
+
+  ctx_->vkDT_.vkCmdEndRendering(wrapper_->cmdBuf_);
+
+  gpuProfilerEndScope();
+
+  const uint32_t numFbColorAttachments = framebuffer_.getNumColorAttachments();
+
+  // set image layouts after the render pass
+  for (uint32_t i = 0; i != numFbColorAttachments; i++) {
+    const auto& attachment = framebuffer_.color[i];
+    const VulkanTexture& tex = *ctx_->texturesPool_.get(attachment.texture);
+    // this must match the final layout of the render pass
+    tex.image_->vkImageLayout_ = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  }
+
+  if (framebuffer_.depthStencil.texture) {
+    const VulkanTexture& tex = *ctx_->texturesPool_.get(framebuffer_.depthStencil.texture);
+    // this must match the final layout of the render pass
+    tex.image_->vkImageLayout_ = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+  }
+
+  framebuffer_ = {};
+}
+
+void lvk::CommandBuffer::cmdBindViewport(const Viewport& viewport) {
+  // https://www.saschawillems.de/blog/2019/03/29/flipping-the-vulkan-viewport/
+  const VkViewport vp = {
+      .x = viewport.x, // float x;
+      .y = viewport.height - viewport.y, // float y;
+      .width = viewport.width, // float width;
+      .height = -viewport.height, // float height;
+      .minDepth = viewport.minDepth, // float minDepth;
+      .maxDepth = viewport.maxDepth, // float maxDepth;
+  };
+
+  stats_.numStateCommands++;
+
+  if (hasViewport_ && !memcmp(&viewport_, &vp, sizeof(vp))) {
+    stats_.numElidedViewports++;
+    return;
+  }
+
+  hasViewport_ = true;
+  viewport_ = vp;
+
+  ctx_->vkDT_.vkCmdSetViewport(wrapper_->cmdBuf_, 0, 1, &vp);
+}
+
+void lvk::CommandBuffer::cmdBindScissorRect(const ScissorRect& rect) {
+  const VkRect2D scissor = {
+      VkOffset2D{(int32_t)rect.x, (int32_t)rect.y},
+      VkExtent2D{rect.width, rect.height},
+  };
+
+  stats_.numStateCommands++;
+
+  if (hasScissor_ && !memcmp(&scissor_, &scissor, sizeof(scissor))) {
+    stats_.numElidedScissorRects++;
+    return;
+  }
+
+  hasScissor_ = true;
+  scissor_ = scissor;
+
+  ctx_->vkDT_.vkCmdSetScissor(wrapper_->cmdBuf_, 0, 1, &scissor);
+}
+
+void lvk::CommandBuffer::cmdBindRenderPipeline(lvk::RenderPipelineHandle handle) {
+  if (!LVK_VERIFY(!handle.empty())) {
+    return;
+  }
+
+  currentPipelineGraphics_ = handle;
+  currentPipelineCompute_ = {};
+
+  const lvk::RenderPipelineState* rps = ctx_->renderPipelinesPool_.get(handle);
+
+  LVK_ASSERT(rps);
+
+  const bool hasDepthAttachmentPipeline = rps->desc_.depthFormat != Format_Invalid;
+  const bool hasDepthAttachmentPass = !framebuffer_.depthStencil.texture.empty();
+
+  if (hasDepthAttachmentPipeline != hasDepthAttachmentPass) {
+    LVK_ASSERT(false);
+    LLOGW("Make sure your render pass and render pipeline both have matching depth attachments");
+  }
+
+  VkPipeline pipeline = ctx_->getVkPipeline(handle);
+
+  LVK_ASSERT(pipeline != VK_NULL_HANDLE);
+
+  stats_.numStateCommands++;
+
+  if (lastPipelineBound_ != pipeline) {
+    lastPipelineBound_ = pipeline;
+    ctx_->vkDT_.vkCmdBindPipeline(wrapper_->cmdBuf_, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    if (rps->pipelineLayout_ != pushConstantsLayout_) {
+      pushConstantsValidWords_ = 0; // an incompatible layout disturbs push constants
+    }
+    ctx_->bindDefaultDescriptorSets(wrapper_->cmdBuf_, VK_PIPELINE_BIND_POINT_GRAPHICS, rps->pipelineLayout_);
+  } else {
+    stats_.numElidedPipelines++;
+  }
+}
+
+void lvk::CommandBuffer::cmdBindDepthState(const DepthState& desc) {
+  LVK_PROFILER_FUNCTION();
+
+  stats_.numStateCommands++;
+
+  if (hasDepthState_ && depthState_.compareOp == desc.compareOp && depthState_.isDepthWriteEnabled == desc.isDepthWriteEnabled) {
+    stats_.numElidedDepthStates++;
+    return;
+  }
+
+  hasDepthState_ = true;
+  depthState_ = desc;
+
+  const VkCompareOp op = compareOpToVkCompareOp(desc.compareOp);
+  ctx_->vkDT_.vkCmdSetDepthWriteEnable(wrapper_->cmdBuf_, desc.isDepthWriteEnabled ? VK_TRUE : VK_FALSE);
+  ctx_->vkDT_.vkCmdSetDepthTestEnable(wrapper_->cmdBuf_, op != VK_COMPARE_OP_ALWAYS);
+
+#if defined(ANDROID)
+  // This is a workaround for the issue.
+  // On Android (Mali-G715-Immortalis MC11 v1.r38p1-01eac0.c1a71ccca2acf211eb87c5db5322f569) 
+  // if depth-stencil texture is not set, call of vkCmdSetDepthCompareOp leads to disappearing of all content. 
+  if (!framebuffer_.depthStencil.texture) {
+    hasDepthState_ = false; // the compare op was not set
+    return;
+  }
+#endif
+  ctx_->vkDT_.vkCmdSetDepthCompareOp(wrapper_->cmdBuf_, op);
+}
+
+void lvk::CommandBuffer::cmdBindVertexBuffer(uint32_t index, BufferHandle buffer, uint64_t bufferOffset) {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(!buffer.empty())) {
+    return;
+  }
+
+  lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(buffer);
+
+  LVK_ASSERT(buf->vkUsageFlags_ & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+
+  stats_.numStateCommands++;
+
+  if (index < LVK_ARRAY_NUM_ELEMENTS(vertexBuffers_)) {
+    VertexBufferBinding& binding = vertexBuffers_[index];
+    if (binding.buffer == buf->vkBuffer_ && binding.offset == bufferOffset) {
+      stats_.numElidedVertexBuffers++;
+      return;
+    }
+    binding = {buf->vkBuffer_, bufferOffset};
+  }
+
+  ctx_->vkDT_.vkCmdBindVertexBuffers(wrapper_->cmdBuf_, index, 1, &buf->vkBuffer_, &bufferOffset);
+}
+
+void lvk::CommandBuffer::cmdBindIndexBuffer(BufferHandle indexBuffer, IndexFormat indexFormat, uint64_t indexBufferOffset) {
+  lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(indexBuffer);
+
+  LVK_ASSERT(buf->vkUsageFlags_ & VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+
+  const VkIndexType type = indexFormatToVkIndexType(indexFormat);
+
+  stats_.numStateCommands++;
+
+  if (indexBuffer_ == buf->vkBuffer_ && indexBufferOffset_ == indexBufferOffset && indexType_ == type) {
+    stats_.numElidedIndexBuffers++;
+    return;
+  }
+
+  indexBuffer_ = buf->vkBuffer_;
+  indexBufferOffset_ = indexBufferOffset;
+  indexType_ = type;
+
+  ctx_->vkDT_.vkCmdBindIndexBuffer(wrapper_->cmdBuf_, buf->vkBuffer_, indexBufferOffset, type);
+}
+
+void lvk::CommandBuffer::cmdPushConstants(const void* data, size_t size, size_t offset) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(size % 4 == 0); // VUID-vkCmdPushConstants-size-00369: size must be a multiple of 4
+
+  // check push constant size is within max size
+  const VkPhysicalDeviceLimits& limits = ctx_->getVkPhysicalDeviceProperties().limits;
+  if (!LVK_VERIFY(size + offset <= limits.maxPushConstantsSize)) {
+    LLOGW("Push constants size exceeded %u (max %u bytes)", size + offset, limits.maxPushConstantsSize);
+  }
+
+  if (currentPipelineGraphics_.empty() && currentPipelineCompute_.empty()) {
+    LVK_ASSERT_MSG(false, "No pipeline bound - cannot set push constants");
+    return;
+  }
+
+  const lvk::RenderPipelineState* stateGraphics = ctx_->renderPipelinesPool_.get(currentPipelineGraphics_);
+  const lvk::ComputePipelineState* stateCompute = ctx_->computePipelinesPool_.get(currentPipelineCompute_);
+
+  LVK_ASSERT(stateGraphics || stateCompute);
+
+  VkPipelineLayout layout = stateGraphics ? stateGraphics->pipelineLayout_ : stateCompute->pipelineLayout_;
+  VkShaderStageFlags shaderStageFlags = stateGraphics ? stateGraphics->shaderStageFlags_ : VK_SHADER_STAGE_COMPUTE_BIT;
+
+  stats_.numStateCommands++;
+
+  if (pushConstantsLayout_ != layout || pushConstantsStages_ != shaderStageFlags) {
+    pushConstantsLayout_ = layout;
+    pushConstantsStages_ = shaderStageFlags;
+    pushConstantsValidWords_ = 0;
+  }
+
+  if (size && offset + size <= kMaxTrackedPushConstantsSize) {
+    const uint32_t firstWord = uint32_t(offset / 4);
+    const uint32_t numWords = uint32_t((size + 3) / 4);
+    const uint64_t words = (numWords == 64 ? ~0ull : ((1ull << numWords) - 1)) << firstWord;
+    if ((pushConstantsValidWords_ & words) == words && !memcmp(pushConstants_ + offset, data, size)) {
+      stats_.numElidedPushConstants++;
+      return;
+    }
+    memcpy(pushConstants_ + offset, data, size);
+    pushConstantsValidWords_ |= words;
+  }
+
+  ctx_->vkDT_.vkCmdPushConstants(wrapper_->cmdBuf_, layout, shaderStageFlags, (uint32_t)offset, (uint32_t)size, data);
+}
+
+void lvk::CommandBuffer::cmdDraw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t baseInstance) {
+  LVK_PROFILER_FUNCTION();
+
+  if (vertexCount == 0) {
+    return;
+  }
+
+  ctx_->vkDT_.vkCmdDraw(wrapper_->cmdBuf_, vertexCount, instanceCount, firstVertex, baseInstance);
+}
+
+void lvk::CommandBuffer::cmdDrawIndexed(uint32_t indexCount,
+                                        uint32_t instanceCount,
+                                        uint32_t firstIndex,
+                                        int32_t vertexOffset,
+                                        uint32_t baseInstance) {
+  LVK_PROFILER_FUNCTION();
+
+  if (indexCount == 0) {
+    return;
+  }
+
+  ctx_->vkDT_.vkCmdDrawIndexed(wrapper_->cmdBuf_, indexCount, instanceCount, firstIndex, vertexOffset, baseInstance);
+}
+
+void lvk::CommandBuffer::cmdDrawIndirect(BufferHandle indirectBuffer, size_t indirectBufferOffset, uint32_t drawCount, uint32_t stride) {
+  LVK_PROFILER_FUNCTION();
+
+  lvk::VulkanBuffer* bufIndirect = ctx_->buffersPool_.get(indirectBuffer);
+
+  LVK_ASSERT(bufIndirect);
+
+  ctx_->vkDT_.vkCmdDrawIndirect(
+      wrapper_->cmdBuf_, bufIndirect->vkBuffer_, indirectBufferOffset, drawCount, stride ? stride : sizeof(VkDrawIndirectCommand));
+}
+
+void lvk::CommandBuffer::cmdDrawIndexedIndirect(BufferHandle indirectBuffer,
+                                                size_t indirectBufferOffset,
+                                                uint32_t drawCount,
+                                                uint32_t stride) {
+  LVK_PROFILER_FUNCTION();
+
+  lvk::VulkanBuffer* bufIndirect = ctx_->buffersPool_.get(indirectBuffer);
+
+  LVK_ASSERT(bufIndirect);
+
+  ctx_->vkDT_.vkCmdDrawIndexedIndirect(
+      wrapper_->cmdBuf_, bufIndirect->vkBuffer_, indirectBufferOffset, drawCount, stride ? stride : sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void lvk::CommandBuffer::cmdDrawIndexedIndirectCount(BufferHandle indirectBuffer,
+                                                     size_t indirectBufferOffset,
+                                                     BufferHandle countBuffer,
+                                                     size_t countBufferOffset,
+                                                     uint32_t maxDrawCount,
+                                                     uint32_t stride) {
+  LVK_PROFILER_FUNCTION();
+
+  lvk::VulkanBuffer* bufIndirect = ctx_->buffersPool_.get(indirectBuffer);
+  lvk::VulkanBuffer* bufCount = ctx_->buffersPool_.get(countBuffer);
+
+  LVK_ASSERT(bufIndirect);
+  LVK_ASSERT(bufCount);
+
+  ctx_->vkDT_.vkCmdDrawIndexedIndirectCount(wrapper_->cmdBuf_,
+                                            bufIndirect->vkBuffer_,
+                                            indirectBufferOffset,
+                                            bufCount->vkBuffer_,
+                                            countBufferOffset,
+                                            maxDrawCount,
+                                            stride ? stride : sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void lvk::CommandBuffer::cmdDrawMeshTasks(const Dimensions& threadgroupCount) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(ctx_->hasMeshShader_);
+
+  ctx_->vkDT_.vkCmdDrawMeshTasksEXT(wrapper_->cmdBuf_, threadgroupCount.width, threadgroupCount.height, threadgroupCount.depth);
+}
+
+void lvk::CommandBuffer::cmdDrawMeshTasksIndirect(BufferHandle indirectBuffer,
+                                                  size_t indirectBufferOffset,
+                                                  uint32_t drawCount,
+                                                  uint32_t stride) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(ctx_->hasMeshShader_);
+
+  lvk::VulkanBuffer* bufIndirect = ctx_->buffersPool_.get(indirectBuffer);
+
+  LVK_ASSERT(bufIndirect);
+
+  ctx_->vkDT_.vkCmdDrawMeshTasksIndirectEXT(wrapper_->cmdBuf_,
+                                            bufIndirect->vkBuffer_,
+                                            indirectBufferOffset,
+                                            drawCount,
+                                            stride ? stride : sizeof(VkDrawMeshTasksIndirectCommandEXT));
+}
+
+void lvk::CommandBuffer::cmdDrawMeshTasksIndirectCount(BufferHandle indirectBuffer,
+                                                       size_t indirectBufferOffset,
+                                                       BufferHandle countBuffer,
+                                                       size_t countBufferOffset,
+                                                       uint32_t maxDrawCount,
+                                                       uint32_t stride) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(ctx_->hasMeshShader_);
+
+  lvk::VulkanBuffer* bufIndirect = ctx_->buffersPool_.get(indirectBuffer);
+  lvk::VulkanBuffer* bufCount = ctx_->buffersPool_.get(countBuffer);
+
+  LVK_ASSERT(bufIndirect);
+  LVK_ASSERT(bufCount);
+
+  ctx_->vkDT_.vkCmdDrawMeshTasksIndirectCountEXT(wrapper_->cmdBuf_,
+                                                 bufIndirect->vkBuffer_,
+                                                 indirectBufferOffset,
+                                                 bufCount->vkBuffer_,
+                                                 countBufferOffset,
+                                                 maxDrawCount,
+                                                 stride ? stride : sizeof(VkDrawMeshTasksIndirectCommandEXT));
+}
+
+void lvk::CommandBuffer::cmdSetBlendColor(const float color[4]) {
+  ctx_->vkDT_.vkCmdSetBlendConstants(wrapper_->cmdBuf_, color);
+}
+
+void lvk::CommandBuffer::cmdSetDepthBias(float depthBias, float slopeScale, float clamp) {
+  ctx_->vkDT_.vkCmdSetDepthBias(wrapper_->cmdBuf_, depthBias, clamp, slopeScale);
+  ctx_->vkDT_.vkCmdSetDepthBiasEnable(wrapper_->cmdBuf_, depthBias != 0);
+}
+
+void lvk::CommandBuffer::cmdResetQueryPool(QueryPoolHandle pool, uint32_t firstQuery, uint32_t queryCount) {
+  VkQueryPool vkPool = *ctx_->queriesPool_.get(pool);
+
+  ctx_->vkDT_.vkCmdResetQueryPool(wrapper_->cmdBuf_, vkPool, firstQuery, queryCount);
+}
+
+void lvk::CommandBuffer::cmdWriteTimestamp(QueryPoolHandle pool, uint32_t query) {
+  VkQueryPool vkPool = *ctx_->queriesPool_.get(pool);
+
+  ctx_->vkDT_.vkCmdWriteTimestamp(wrapper_->cmdBuf_, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkPool, query);
+}
+
+void lvk::CommandBuffer::cmdCopyBuffer(BufferHandle src, size_t srcOffset, BufferHandle dst, size_t dstOffset, size_t size) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(!isRendering_);
+
+  const lvk::VulkanBuffer* srcBuf = ctx_->buffersPool_.get(src);
+  const lvk::VulkanBuffer* dstBuf = ctx_->buffersPool_.get(dst);
+
+  if (!LVK_VERIFY(srcBuf && dstBuf)) {
+    return;
+  }
+
+  LVK_ASSERT_MSG(srcBuf->vkUsageFlags_ & VK_BUFFER_USAGE_TRANSFER_SRC_BIT, "The source buffer should have StorageType_Device or StorageType_HostVisible");
+  LVK_ASSERT_MSG(dstBuf->vkUsageFlags_ & VK_BUFFER_USAGE_TRANSFER_DST_BIT, "The destination buffer should have BufferUsageBits_Storage");
+  LVK_ASSERT(srcOffset + size <= srcBuf->bufferSize_);
+  LVK_ASSERT(dstOffset + size <= dstBuf->bufferSize_);
+
+  // wait for all previous writes into the source buffer and all previous accesses to the destination range
+  const VkBufferMemoryBarrier barriersBefore[] = {
+      {
+          .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+          .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+          .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .buffer = srcBuf->vkBuffer_,
+          .offset = srcOffset,
+          .size = size,
+      },
+      {
+          .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+          .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+          .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .buffer = dstBuf->vkBuffer_,
+          .offset = dstOffset,
+          .size = size,
+      },
+  };
+  lvk::bufferMemoryBarrier(ctx_->vkDT_,
+                           wrapper_->cmdBuf_,
+                           barriersBefore,
+                           LVK_ARRAY_NUM_ELEMENTS(barriersBefore),
+                           VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           ctx_->frameCounters_);
+
+  const VkBufferCopy copy = {
+      .srcOffset = srcOffset,
+      .dstOffset = dstOffset,
+      .size = size,
+  };
+  ctx_->vkDT_.vkCmdCopyBuffer(wrapper_->cmdBuf_, srcBuf->vkBuffer_, dstBuf->vkBuffer_, 1, &copy);
+
+  // make the result visible to the host and to subsequent commands
+  const VkBufferMemoryBarrier barrierAfter = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_HOST_READ_BIT | VK_ACCESS_MEMORY_READ_BIT,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer = dstBuf->vkBuffer_,
+      .offset = dstOffset,
+      .size = size,
+  };
+  lvk::bufferMemoryBarrier(ctx_->vkDT_,
+                           wrapper_->cmdBuf_,
+                           &barrierAfter,
+                           1,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                           ctx_->frameCounters_);
+}
+
+void lvk::CommandBuffer::cmdFillBuffer(BufferHandle buffer, size_t offset, size_t size, uint32_t value) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(!isRendering_);
+
+  const lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(buffer);
+
+  if (!LVK_VERIFY(buf)) {
+    return;
+  }
+
+  LVK_ASSERT_MSG(buf->vkUsageFlags_ & VK_BUFFER_USAGE_TRANSFER_DST_BIT, "The destination buffer should have BufferUsageBits_Storage");
+  LVK_ASSERT_MSG((offset & 3) == 0 && (size & 3) == 0, "The offset and size should be multiples of 4");
+  LVK_ASSERT(offset + size <= buf->bufferSize_);
+
+  // wait for all previous accesses to the buffer (e.g. indirect draws of the previous frame)
+  const VkBufferMemoryBarrier barrierBefore = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer = buf->vkBuffer_,
+      .offset = offset,
+      .size = size,
+  };
+  lvk::bufferMemoryBarrier(ctx_->vkDT_,
+                           wrapper_->cmdBuf_,
+                           &barrierBefore,
+                           1,
+                           VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           ctx_->frameCounters_);
+
+  ctx_->vkDT_.vkCmdFillBuffer(wrapper_->cmdBuf_, buf->vkBuffer_, offset, size, value);
+
+  const VkBufferMemoryBarrier barrierAfter = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer = buf->vkBuffer_,
+      .offset = offset,
+      .size = size,
+  };
+  lvk::bufferMemoryBarrier(ctx_->vkDT_,
+                           wrapper_->cmdBuf_,
+                           &barrierAfter,
+                           1,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                           ctx_->frameCounters_);
+}
+
+void lvk::CommandBuffer::cmdCopyTextureToBuffer(TextureHandle src, const TextureRangeDesc& range, BufferHandle dst, size_t dstOffset) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(!isRendering_);
+
+  const lvk::VulkanTexture* tex = ctx_->texturesPool_.get(src);
+  const lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(dst);
+
+  if (!LVK_VERIFY(tex && buf)) {
+    return;
+  }
+
+  const lvk::VulkanImage& img = *tex->image_.get();
+
+  if (!LVK_VERIFY(validateRange(tex->getExtent(), img.numLevels_, range).isOk())) {
+    return;
+  }
+
+  LVK_ASSERT_MSG(buf->vkUsageFlags_ & VK_BUFFER_USAGE_TRANSFER_DST_BIT, "The destination buffer should have BufferUsageBits_Storage");
+  LVK_ASSERT_MSG(img.vkImageLayout_ != VK_IMAGE_LAYOUT_UNDEFINED, "The texture has no content");
+  LVK_ASSERT_MSG(range.numMipLevels == 1, "Only one mip-level can be copied at a time");
+
+  const uint32_t numLayers = std::max(range.numLayers, 1u);
+  const VkImageSubresourceRange subresource = {img.getImageAspectFlags(), range.mipLevel, 1, range.layer, numLayers};
+
+  const lvk::Format format = vkFormatToFormat(img.vkImageFormat_);
+  const lvk::Dimensions block = lvk::getTextureBlockDimensions(format);
+  // bytes per texel for uncompressed formats, bytes per block for compressed formats
+  const uint32_t bytesPerBlock = lvk::getTextureBytesPerLayer(1, 1, format, 0);
+  const VkExtent3D mipExtent = {
+      std::max(img.vkExtent_.width >> range.mipLevel, 1u), std::max(img.vkExtent_.height >> range.mipLevel, 1u), 1u};
+
+  // vkCmdCopyImageToBuffer(): bufferOffset is a multiple of the texel block size (and of 4 for depth/stencil formats)
+  const uint32_t offsetAlignment = img.isDepthFormat_ || img.isStencilFormat_ ? std::lcm(bytesPerBlock, 4u) : bytesPerBlock;
+
+  if (!LVK_VERIFY(dstOffset % offsetAlignment == 0)) {
+    LLOGW("cmdCopyTextureToBuffer(): dstOffset %zu is not a multiple of %u\n", dstOffset, offsetAlignment);
+    return;
+  }
+
+  // compressed images are copied in whole blocks: the region starts on a block boundary and ends on one or on the mip-level edge
+  const bool isBlockAligned = range.x % block.width == 0 && range.y % block.height == 0 &&
+                              (range.dimensions.width % block.width == 0 || range.x + range.dimensions.width == mipExtent.width) &&
+                              (range.dimensions.height % block.height == 0 || range.y + range.dimensions.height == mipExtent.height);
+
+  if (!LVK_VERIFY(isBlockAligned)) {
+    LLOGW("cmdCopyTextureToBuffer(): the range is not aligned to %ux%u compressed blocks\n", block.width, block.height);
+    return;
+  }
+
+  const size_t copySize = (size_t)lvk::getTextureBytesPerLayer(range.dimensions.width, range.dimensions.height, format, 0) *
+                          range.dimensions.depth * numLayers;
+
+  if (!LVK_VERIFY(dstOffset + copySize <= buf->bufferSize_)) {
+    LLOGW("cmdCopyTextureToBuffer(): the destination buffer is too small\n");
+    return;
+  }
+
+  // 1. Wait for all previous writes and transition into VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+  lvk::imageMemoryBarrier(ctx_->vkDT_,
+                          wrapper_->cmdBuf_,
+                          img.vkImage_,
+                          VK_ACCESS_MEMORY_WRITE_BIT,
+                          VK_ACCESS_TRANSFER_READ_BIT,
+                          img.vkImageLayout_,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          subresource,
+                          ctx_->frameCounters_);
+
+  // 2. Copy the pixel data into the buffer
+  const VkBufferImageCopy copy = {
+      .bufferOffset = dstOffset,
+      .bufferRowLength = 0,
+      .bufferImageHeight = 0,
+      .imageSubresource = VkImageSubresourceLayers{subresource.aspectMask, range.mipLevel, range.layer, numLayers},
+      .imageOffset = {.x = (int32_t)range.x, .y = (int32_t)range.y, .z = (int32_t)range.z},
+      .imageExtent = {.width = range.dimensions.width, .height = range.dimensions.height, .depth = range.dimensions.depth},
+  };
+  ctx_->vkDT_.vkCmdCopyImageToBuffer(wrapper_->cmdBuf_, img.vkImage_, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buf->vkBuffer_, 1, &copy);
+
+  // 3. Transition back to the tracked image layout
+  lvk::imageMemoryBarrier(ctx_->vkDT_,
+                          wrapper_->cmdBuf_,
+                          img.vkImage_,
+                          0,
+                          VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          img.vkImageLayout_,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                          subresource,
+                          ctx_->frameCounters_);
+
+  // 4. Make the result visible to the host
+  const VkBufferMemoryBarrier barrier = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_HOST_READ_BIT | VK_ACCESS_MEMORY_READ_BIT,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer = buf->vkBuffer_,
+      .offset = dstOffset,
+      .size = VK_WHOLE_SIZE,
+  };
+  lvk::bufferMemoryBarrier(ctx_->vkDT_,
+                           wrapper_->cmdBuf_,
+                           &barrier,
+                           1,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                           ctx_->frameCounters_);
+}
+
+lvk::VulkanStagingDevice::VulkanStagingDevice(VulkanContext& ctx) : ctx_(ctx) {
+  LVK_PROFILER_FUNCTION();
+
+  const auto& limits = ctx_.getVkPhysicalDeviceProperties().limits;
+
+  // use default value of 128Mb clamped to the max limits
+  maxBufferSize_ = std::min(limits.maxStorageBufferRange, 128u * 1024u * 1024u);
+
+  LVK_ASSERT(minBufferSize_ <= maxBufferSize_);
+}
+
+const lvk::VulkanImmediateCommands::CommandBufferWrapper& lvk::VulkanStagingDevice::getPendingCommandBuffer(lvk::QueueType queue) {
+  std::lock_guard lock(mutex_);
+
+  if (!pending_[queue]) {
+    pending_[queue] = &ctx_.getImmediateCommands(queue)->acquire();
+  }
+
+  return *pending_[queue];
+}
+
+bool lvk::VulkanStagingDevice::isDedicatedTransferQueue(lvk::QueueType queue) const {
+  return queue == lvk::QueueType_Transfer && ctx_.transferImmediate_;
+}
+
+lvk::SubmitHandle lvk::VulkanStagingDevice::flush(lvk::QueueType queue) {
+  std::lock_guard lock(mutex_);
+
+  if (!pending_[queue]) {
+    return {};
+  }
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::dynamicState(VkDynamicState state) {
-  LVK_ASSERT(numDynamicStates_ < LVK_MAX_DYNAMIC_STATES);
-  dynamicStates_[numDynamicStates_++] = state;
-  return *this;
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_SUBMIT);
+
+  // uploads into sparse textures need their pages to be bound first (on the graphics queue)
+  uint64_t bindSparseValue = 0;
+  std::vector<VulkanImage::SparsePage> releasedPages = ctx_.flushTexturePages(&bindSparseValue);
+
+  VulkanImmediateCommands* immediate = ctx_.getImmediateCommands(queue);
+
+  const bool waitForBind = bindSparseValue && immediate != ctx_.immediate_.get();
+  const VkSemaphore bindSemaphore = ctx_.immediate_->getTimelineSemaphore();
+  const VulkanImmediateCommands::CommandBufferWrapper* wrappers[] = {pending_[queue]};
+
+  const SubmitHandle handle = immediate->submit(
+      wrappers, 1, waitForBind ? &bindSemaphore : nullptr, waitForBind ? &bindSparseValue : nullptr, waitForBind ? 1u : 0u);
+
+  ctx_.freeTexturePages(std::move(releasedPages), handle);
+
+  onSubmitted(queue, handle);
+
+  return handle;
+}
+
+void lvk::VulkanStagingDevice::flushUploadsTo(uint64_t vkBufferOrImage) {
+  std::lock_guard lock(mutex_);
+
+  for (uint32_t queue = 0; queue != lvk::QueueType_Num; queue++) {
+    const std::vector<uint64_t>& targets = pendingTargets_[queue];
+    if (std::find(targets.begin(), targets.end(), vkBufferOrImage) != targets.end()) {
+      flush((lvk::QueueType)queue);
+    }
+  }
+}
+
+void lvk::VulkanStagingDevice::onSubmitted(lvk::QueueType queue, SubmitHandle handle) {
+  std::lock_guard lock(mutex_);
+
+  pending_[queue] = nullptr;
+  pendingTargets_[queue].clear();
+
+  // pending regions of different queues can be interleaved in the ring; mapped regions are not copied until they are committed
+  for (MemoryRegionDesc& r : regions_) {
+    if (r.handle_.empty() && r.queue_ == queue && !r.isMapped_) {
+      r.handle_ = handle;
+    }
+  }
+}
+
+lvk::Result lvk::VulkanStagingDevice::bufferSubData(VulkanBuffer& buffer,
+                                                    size_t dstOffset,
+                                                    size_t size,
+                                                    const void* data,
+                                                    lvk::QueueType queue) {
+  LVK_PROFILER_FUNCTION();
+
+  std::lock_guard lock(mutex_);
+
+  if (buffer.isMapped()) {
+    buffer.bufferSubData(dstOffset, size, data);
+    return Result();
+  }
+
+  while (size) {
+    // get next staging buffer free offset
+    const MemoryRegionDesc desc = allocate((uint32_t)std::min(size, size_t(maxBufferSize_)), true, queue);
+    const uint32_t chunkSize = std::min((uint32_t)size, desc.size_);
+
+    if (!chunkSize) {
+      // the chunks recorded so far are uploaded
+      return Result(Result::Code::RuntimeError, "The staging buffer is blocked by an uncommitted IContext::mapForUpload()");
+    }
+
+    lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+
+    // copy data into staging buffer
+    stagingBuffer->bufferSubData(desc.offset_, chunkSize, data);
+
+    // do the transfer
+    recordBufferCopy(buffer, dstOffset, desc.offset_, chunkSize, queue);
+
+    size -= chunkSize;
+    data = (uint8_t*)data + chunkSize;
+    dstOffset += chunkSize;
+  }
+
+  return Result();
+}
+
+void lvk::VulkanStagingDevice::recordBufferCopy(VulkanBuffer& buffer,
+                                                size_t dstOffset,
+                                                uint32_t srcOffset,
+                                                uint32_t size,
+                                                lvk::QueueType queue) {
+  std::lock_guard lock(mutex_);
+
+  lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+
+  const VkBufferCopy copy = {
+      .srcOffset = srcOffset,
+      .dstOffset = dstOffset,
+      .size = size,
+  };
+
+  auto& wrapper = getPendingCommandBuffer(queue);
+  pendingTargets_[queue].push_back((uint64_t)buffer.vkBuffer_);
+  ctx_.vkDT_.vkCmdCopyBuffer(wrapper.cmdBuf_, stagingBuffer->vkBuffer_, buffer.vkBuffer_, 1, &copy);
+  VkBufferMemoryBarrier barrier = {
+      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT, // other uploads in the same batch can write into this buffer
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer = buffer.vkBuffer_,
+      .offset = dstOffset,
+      .size = size,
+  };
+  const bool isTransferQueue = isDedicatedTransferQueue(queue);
+  VkPipelineStageFlags dstMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  if (isTransferQueue) {
+    // transfer queues do not support graphics stages; the consumer waits on the timeline semaphore of this submit
+    dstMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  } else {
+    // the same queue as the consumer: this barrier is the only thing which makes the copy visible
+    barrier.dstAccessMask |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+  }
+  if (!isTransferQueue && (buffer.vkUsageFlags_ & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT)) {
+    dstMask |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    barrier.dstAccessMask |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+  }
+  if (!isTransferQueue && (buffer.vkUsageFlags_ & VK_BUFFER_USAGE_INDEX_BUFFER_BIT)) {
+    dstMask |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    barrier.dstAccessMask |= VK_ACCESS_INDEX_READ_BIT;
+  }
+  if (!isTransferQueue && (buffer.vkUsageFlags_ & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)) {
+    dstMask |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    barrier.dstAccessMask |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+  }
+  lvk::bufferMemoryBarrier(ctx_.vkDT_, wrapper.cmdBuf_, &barrier, 1, VK_PIPELINE_STAGE_TRANSFER_BIT, dstMask, ctx_.frameCounters_);
+}
+
+lvk::Result lvk::VulkanStagingDevice::imageData2D(VulkanImage& image,
+                                                  const VkRect2D& imageRegion,
+                                                  uint32_t baseMipLevel,
+                                                  uint32_t numMipLevels,
+                                                  uint32_t layer,
+                                                  uint32_t numLayers,
+                                                  VkFormat format,
+                                                  const void* data,
+                                                  lvk::QueueType queue) {
+  LVK_PROFILER_FUNCTION();
+
+  std::lock_guard lock(mutex_);
+
+  const uint32_t storageSize = getImageData2DSize(image, baseMipLevel, numMipLevels, numLayers, format);
+
+  // no support for copying image in multiple smaller chunk sizes
+  const MemoryRegionDesc desc = allocate(storageSize, false, queue);
+
+  if (desc.size_ < storageSize) {
+    return Result(Result::Code::RuntimeError, "The staging buffer is blocked by an uncommitted IContext::mapForUpload()");
+  }
+
+  lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+
+  stagingBuffer->bufferSubData(desc.offset_, storageSize, data);
+
+  recordImageCopy2D(image, imageRegion, baseMipLevel, numMipLevels, layer, numLayers, format, desc.offset_, queue);
+
+  return Result();
+}
+
+uint32_t lvk::VulkanStagingDevice::getImageData2DSize(const VulkanImage& image,
+                                                      uint32_t baseMipLevel,
+                                                      uint32_t numMipLevels,
+                                                      uint32_t numLayers,
+                                                      VkFormat format) {
+  const Format texFormat(vkFormatToFormat(format));
+
+  // find the storage size for all mip-levels being uploaded
+  uint32_t layerStorageSize = 0;
+  for (uint32_t i = 0; i < numMipLevels; ++i) {
+    layerStorageSize += lvk::getTextureBytesPerLayer(image.vkExtent_.width, image.vkExtent_.height, texFormat, baseMipLevel + i);
+  }
+  return layerStorageSize * numLayers;
+}
+
+void lvk::VulkanStagingDevice::recordImageCopy2D(VulkanImage& image,
+                                                 const VkRect2D& imageRegion,
+                                                 uint32_t baseMipLevel,
+                                                 uint32_t numMipLevels,
+                                                 uint32_t layer,
+                                                 uint32_t numLayers,
+                                                 VkFormat format,
+                                                 uint32_t srcOffset,
+                                                 lvk::QueueType queue) {
+  std::lock_guard lock(mutex_);
+
+  LVK_ASSERT(numMipLevels <= LVK_MAX_MIP_LEVELS);
+
+  // divide the width and height by 2 until we get to the size of level 'baseMipLevel'
+  const uint32_t width = std::max(image.vkExtent_.width >> baseMipLevel, 1u);
+  const uint32_t height = std::max(image.vkExtent_.height >> baseMipLevel, 1u);
+
+  const Format texFormat(vkFormatToFormat(format));
+
+  LVK_ASSERT_MSG(!imageRegion.offset.x && !imageRegion.offset.y && imageRegion.extent.width == width && imageRegion.extent.height == height,
+                 "Uploading mip-levels with an image region that is smaller than the base mip level is not supported");
+
+  auto& wrapper = getPendingCommandBuffer(queue);
+  pendingTargets_[queue].push_back((uint64_t)image.vkImage_);
+
+  // transfer queues do not support shader stages; the consumer waits on the timeline semaphore of this submit
+  const bool isTransferQueue = isDedicatedTransferQueue(queue);
+
+  lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+
+  uint32_t offset = 0;
+
+  // https://registry.khronos.org/KTX/specs/1.0/ktxspec.v1.html
+  for (uint32_t mipLevel = 0; mipLevel < numMipLevels; ++mipLevel) {
+    for (uint32_t layer = 0; layer != numLayers; layer++) {
+      const auto currentMipLevel = baseMipLevel + mipLevel;
+
+      LVK_ASSERT(currentMipLevel < image.numLevels_);
+      LVK_ASSERT(mipLevel < image.numLevels_);
+
+      // 1. Transition initial image layout into TRANSFER_DST_OPTIMAL
+      lvk::imageMemoryBarrier(ctx_.vkDT_,
+                              wrapper.cmdBuf_,
+                              image.vkImage_,
+                              0,
+                              VK_ACCESS_TRANSFER_WRITE_BIT,
+                              VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, currentMipLevel, 1, layer, 1},
+                              ctx_.frameCounters_);
+
+#if LVK_VULKAN_PRINT_COMMANDS
+      LLOGL("%p vkCmdCopyBufferToImage()\n", wrapper.cmdBuf_);
+#endif // LVK_VULKAN_PRINT_COMMANDS
+      // 2. Copy the pixel data from the staging buffer into the image
+      const VkRect2D region = {
+          .offset = {.x = imageRegion.offset.x >> mipLevel, .y = imageRegion.offset.y >> mipLevel},
+          .extent = {.width = std::max(1u, imageRegion.extent.width >> mipLevel),
+                     .height = std::max(1u, imageRegion.extent.height >> mipLevel)},
+      };
+      const VkBufferImageCopy copy = {
+          // the offset for this level is at the start of all mip-levels plus the size of all previous mip-levels being uploaded
+          .bufferOffset = srcOffset + offset,
+          .bufferRowLength = 0,
+          .bufferImageHeight = 0,
+          .imageSubresource = VkImageSubresourceLayers{VK_IMAGE_ASPECT_COLOR_BIT, currentMipLevel, layer, 1},
+          .imageOffset = {.x = region.offset.x, .y = region.offset.y, .z = 0},
+          .imageExtent = {.width = region.extent.width, .height = region.extent.height, .depth = 1u},
+      };
+      ctx_.vkDT_.vkCmdCopyBufferToImage(
+          wrapper.cmdBuf_, stagingBuffer->vkBuffer_, image.vkImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+      // 3. Transition TRANSFER_DST_OPTIMAL into SHADER_READ_ONLY_OPTIMAL
+      lvk::imageMemoryBarrier(ctx_.vkDT_,
+                              wrapper.cmdBuf_,
+                              image.vkImage_,
+                              VK_ACCESS_TRANSFER_WRITE_BIT,
+                              isTransferQueue ? 0 : VK_ACCESS_SHADER_READ_BIT,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              isTransferQueue ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                              VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, currentMipLevel, 1, layer, 1},
+                              ctx_.frameCounters_);
+
+      offset += lvk::getTextureBytesPerLayer(image.vkExtent_.width, image.vkExtent_.height, texFormat, currentMipLevel);
+    }
+  }
+
+  image.vkImageLayout_ = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
+lvk::Result lvk::VulkanStagingDevice::imageData3D(VulkanImage& image,
+                                                  const VkOffset3D& offset,
+                                                  const VkExtent3D& extent,
+                                                  VkFormat format,
+                                                  const void* data,
+                                                  lvk::QueueType queue) {
+  LVK_PROFILER_FUNCTION();
+
+  std::lock_guard lock(mutex_);
+  const uint32_t storageSize = extent.width * extent.height * extent.depth * getBytesPerPixel(format);
+
+  // no support for copying image in multiple smaller chunk sizes
+  const MemoryRegionDesc desc = allocate(storageSize, false, queue);
+
+  if (desc.size_ < storageSize) {
+    return Result(Result::Code::RuntimeError, "The staging buffer is blocked by an uncommitted IContext::mapForUpload()");
+  }
+
+  lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+
+  // 1. Copy the pixel data into the host visible staging buffer
+  stagingBuffer->bufferSubData(desc.offset_, storageSize, data);
+
+  recordImageCopy3D(image, offset, extent, desc.offset_, queue);
+
+  return Result();
+}
+
+void lvk::VulkanStagingDevice::recordImageCopy3D(VulkanImage& image,
+                                                 const VkOffset3D& offset,
+                                                 const VkExtent3D& extent,
+                                                 uint32_t srcOffset,
+                                                 lvk::QueueType queue) {
+  std::lock_guard lock(mutex_);
+
+  LVK_ASSERT_MSG(image.numLevels_ == 1, "Can handle only 3D images with exactly 1 mip-level");
+  LVK_ASSERT_MSG((offset.x == 0) && (offset.y == 0) && (offset.z == 0), "Can upload only full-size 3D images");
+
+  lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+
+  auto& wrapper = getPendingCommandBuffer(queue);
+  pendingTargets_[queue].push_back((uint64_t)image.vkImage_);
+
+  // transfer queues do not support shader stages; the consumer waits on the timeline semaphore of this submit
+  const bool isTransferQueue = isDedicatedTransferQueue(queue);
+
+  // 1. Transition initial image layout into TRANSFER_DST_OPTIMAL
+  lvk::imageMemoryBarrier(ctx_.vkDT_,
+                          wrapper.cmdBuf_,
+                          image.vkImage_,
+                          0,
+                          VK_ACCESS_TRANSFER_WRITE_BIT,
+                          VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+                          ctx_.frameCounters_);
+
+  // 2. Copy the pixel data from the staging buffer into the image
+  const VkBufferImageCopy copy = {
+      .bufferOffset = srcOffset,
+      .bufferRowLength = 0,
+      .bufferImageHeight = 0,
+      .imageSubresource = VkImageSubresourceLayers{VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      .imageOffset = offset,
+      .imageExtent = extent,
+  };
+  ctx_.vkDT_.vkCmdCopyBufferToImage(
+      wrapper.cmdBuf_, stagingBuffer->vkBuffer_, image.vkImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+  // 3. Transition TRANSFER_DST_OPTIMAL into SHADER_READ_ONLY_OPTIMAL
+  lvk::imageMemoryBarrier(ctx_.vkDT_,
+                          wrapper.cmdBuf_,
+                          image.vkImage_,
+                          VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                          isTransferQueue ? 0 : VK_ACCESS_SHADER_READ_BIT,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          isTransferQueue ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                          VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+                          ctx_.frameCounters_);
+
+  image.vkImageLayout_ = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 }
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::primitiveTopology(VkPrimitiveTopology topology) {
-  inputAssembly_.topology = topology;
-  return *this;
+lvk::Result lvk::VulkanStagingDevice::getImageData(VulkanImage& image,
+                                                   const VkOffset3D& offset,
+                                                   const VkExtent3D& extent,
+                                                   VkImageSubresourceRange range,
+                                                   VkFormat format,
+                                                   void* outData) {
+  std::lock_guard lock(mutex_);
+
+  LVK_ASSERT(image.vkImageLayout_ != VK_IMAGE_LAYOUT_UNDEFINED);
+  LVK_ASSERT(range.layerCount == 1);
+
+  const uint32_t rowSize = extent.width * getBytesPerPixel(format);
+
+  // the image can be larger than the staging buffer - copy it in chunks of whole rows
+  const uint32_t maxRowsPerChunk = std::max((maxBufferSize_ & ~15u) / rowSize, 1u);
+
+  // the readback is recorded after all pending uploads
+  auto& wrapper1 = getPendingCommandBuffer();
+
+  // 1. Transition to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+  lvk::imageMemoryBarrier(ctx_.vkDT_,
+                          wrapper1.cmdBuf_,
+                          image.vkImage_,
+                          0, // srcAccessMask
+                          VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, // dstAccessMask
+                          image.vkImageLayout_,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, // wait for all previous operations
+                          VK_PIPELINE_STAGE_TRANSFER_BIT, // dstStageMask
+                          range,
+                          ctx_.frameCounters_);
+
+  uint8_t* dst = static_cast<uint8_t*>(outData);
+
+  Result result;
+
+  for (uint32_t z = 0; z != extent.depth && result.isOk(); z++) {
+    for (uint32_t y = 0; y < extent.height;) {
+      const uint32_t numRows = std::min(extent.height - y, maxRowsPerChunk);
+      const uint32_t chunkSize = numRows * rowSize;
+
+      const MemoryRegionDesc desc = allocate(chunkSize, false);
+
+      if (desc.size_ < chunkSize) {
+        // still transition the image back below
+        result = Result(Result::Code::RuntimeError, "The staging buffer is blocked by an uncommitted IContext::mapForUpload()");
+        break;
+      }
+
+      lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+
+      // 2. Copy the pixel data from the image into the staging buffer
+      const VkBufferImageCopy copy = {
+          .bufferOffset = desc.offset_,
+          .bufferRowLength = 0,
+          .bufferImageHeight = numRows,
+          .imageSubresource =
+              VkImageSubresourceLayers{
+                  .aspectMask = range.aspectMask,
+                  .mipLevel = range.baseMipLevel,
+                  .baseArrayLayer = range.baseArrayLayer,
+                  .layerCount = range.layerCount,
+              },
+          .imageOffset = {.x = offset.x, .y = offset.y + (int32_t)y, .z = offset.z + (int32_t)z},
+          .imageExtent = {.width = extent.width, .height = numRows, .depth = 1u},
+      };
+      ctx_.vkDT_.vkCmdCopyImageToBuffer(
+          getPendingCommandBuffer().cmdBuf_, image.vkImage_, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer->vkBuffer_, 1, &copy);
+
+      // the region can be reused as soon as the GPU is done with it, so every chunk is consumed before the next allocation
+      ctx_.immediate_->wait(flush());
+
+      if (!stagingBuffer->isCoherentMemory_) {
+        stagingBuffer->invalidateMappedMemory(desc.offset_, desc.size_);
+      }
+
+      // 3. Copy data from staging buffer into data
+      memcpy(dst, stagingBuffer->getMappedPtr() + desc.offset_, chunkSize);
+
+      dst += chunkSize;
+      y += numRows;
+    }
+  }
+
+  // 4. Transition back to the initial image layout (no need to wait - it will be submitted with the next batch)
+  auto& wrapper2 = getPendingCommandBuffer();
+  pendingTargets_[lvk::QueueType_Graphics].push_back((uint64_t)image.vkImage_);
+
+  lvk::imageMemoryBarrier(ctx_.vkDT_,
+                          wrapper2.cmdBuf_,
+                          image.vkImage_,
+                          VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, // srcAccessMask
+                          0, // dstAccessMask
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          image.vkImageLayout_,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT, // srcStageMask
+                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // dstStageMask
+                          range,
+                          ctx_.frameCounters_);
+
+  return result;
 }
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::rasterizationSamples(VkSampleCountFlagBits samples) {
-  multisampleState_.rasterizationSamples = samples;
-  return *this;
-}
+void lvk::VulkanStagingDevice::ensureStagingBufferSize(uint32_t sizeNeeded) {
+  LVK_PROFILER_FUNCTION();
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::cullMode(VkCullModeFlags mode) {
-  rasterizationState_.cullMode = mode;
-  return *this;
-}
+  const uint32_t alignedSize = std::max(getAlignedSize(sizeNeeded), minBufferSize_);
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::frontFace(VkFrontFace mode) {
-  rasterizationState_.frontFace = mode;
-  return *this;
-}
+  sizeNeeded = alignedSize < maxBufferSize_ ? alignedSize : maxBufferSize_;
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::polygonMode(VkPolygonMode mode) {
-  rasterizationState_.polygonMode = mode;
-  return *this;
-}
+  if (!stagingBuffer_.empty()) {
+    const bool isEnoughSize = sizeNeeded <= stagingBufferSize_;
+    const bool isMaxSize = stagingBufferSize_ == maxBufferSize_;
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::vertexInputState(const VkPipelineVertexInputStateCreateInfo& state) {
-  vertexInputState_ = state;
-  return *this;
-}
+    // mapped regions are being written by the application
+    if (isEnoughSize || isMaxSize || numMappedRegions_) {
+      return;
+    }
+  }
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::colorAttachments(const VkPipelineColorBlendAttachmentState* states,
-                                                                         const VkFormat* formats,
-                                                                         uint32_t numColorAttachments) {
-  LVK_ASSERT(states);
-  LVK_ASSERT(formats);
-  LVK_ASSERT(numColorAttachments <= LVK_ARRAY_NUM_ELEMENTS(colorBlendAttachmentStates_));
-  LVK_ASSERT(numColorAttachments <= LVK_ARRAY_NUM_ELEMENTS(colorAttachmentFormats_));
-  for (uint32_t i = 0; i != numColorAttachments; i++) {
-    colorBlendAttachmentStates_[i] = states[i];
-    colorAttachmentFormats_[i] = formats[i];
+  // pending uploads might reference the previous staging buffer
+  flush(lvk::QueueType_Graphics);
+  flush(lvk::QueueType_Transfer);
+  waitAndReset();
+
+  // deallocate the previous staging buffer
+  stagingBuffer_ = nullptr;
+
+  // if the combined size of the new staging buffer and the existing one is larger than the limit imposed by some architectures on buffers
+  // that are device and host visible, we need to wait for the current buffer to be destroyed before we can allocate a new one
+  if ((sizeNeeded + stagingBufferSize_) > maxBufferSize_) {
+    ctx_.waitDeferredTasks();
   }
-  numColorAttachments_ = numColorAttachments;
-  return *this;
-}
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::depthAttachmentFormat(VkFormat format) {
-  depthAttachmentFormat_ = format;
-  return *this;
-}
+  stagingBufferSize_ = sizeNeeded;
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::stencilAttachmentFormat(VkFormat format) {
-  stencilAttachmentFormat_ = format;
-  return *this;
-}
+  char debugName[256] = {0};
+  snprintf(debugName, sizeof(debugName) - 1, "Buffer: staging buffer %u", stagingBufferCounter_++);
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::patchControlPoints(uint32_t numPoints) {
-  tessellationState_.patchControlPoints = numPoints;
-  return *this;
+  stagingBuffer_ = {&ctx_,
+                    ctx_.createBuffer(stagingBufferSize_,
+                                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                      nullptr,
+                                      debugName)};
+  LVK_ASSERT(!stagingBuffer_.empty());
+
+  regions_.clear();
+  head_ = 0;
 }
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::shaderStage(VkPipelineShaderStageCreateInfo stage) {
-  if (stage.module != VK_NULL_HANDLE) {
-    LVK_ASSERT(numShaderStages_ < LVK_ARRAY_NUM_ELEMENTS(shaderStages_));
-    shaderStages_[numShaderStages_++] = stage;
+lvk::VulkanStagingDevice::MemoryRegionDesc lvk::VulkanStagingDevice::allocate(uint32_t size, bool allowPartial, lvk::QueueType queue) {
+  LVK_PROFILER_FUNCTION();
+
+  const uint32_t alignedSize = getAlignedSize(size);
+
+  ensureStagingBufferSize(alignedSize);
+
+  const uint32_t requestedSize = std::min(alignedSize, stagingBufferSize_);
+
+  LVK_ASSERT_MSG(allowPartial || requestedSize == alignedSize, "The staging buffer is too small");
+
+  // do not split uploads into tiny chunks
+  const uint32_t minPartialSize = std::min(requestedSize, stagingBufferSize_ / 8);
+
+  while (true) {
+    // retire completed regions - the ring is freed in the allocation order, so we only have to look at the oldest ones
+    while (!regions_.empty() && !regions_.front().handle_.empty() &&
+           ctx_.getImmediateCommands(regions_.front().handle_)->isReady(regions_.front().handle_)) {
+      regions_.pop_front();
+    }
+
+    if (regions_.empty()) {
+      head_ = 0;
+    }
+
+    // find the largest contiguous free range starting at `head_` or at the beginning of the ring
+    const uint32_t tail = regions_.empty() ? stagingBufferSize_ : regions_.front().offset_;
+
+    uint32_t offset = head_;
+    uint32_t available = 0;
+
+    if (regions_.empty() || head_ > tail) {
+      available = stagingBufferSize_ - head_;
+      if (available < requestedSize && tail > available) {
+        // wrap around
+        offset = 0;
+        available = tail;
+      }
+    } else if (head_ < tail) {
+      available = tail - head_;
+    }
+
+    if (available >= requestedSize || (allowPartial && available >= minPartialSize && available)) {
+      const MemoryRegionDesc desc = {
+          .offset_ = offset,
+          .size_ = std::min(requestedSize, available),
+          .queue_ = queue,
+      };
+      regions_.push_back(desc);
+      head_ = desc.offset_ + desc.size_;
+      ctx_.frameCounters_.stagingBytes += desc.size_;
+      return desc;
+    }
+
+    // the ring is full - wait for the oldest region
+    if (regions_.front().isMapped_) {
+      LLOGW("The staging buffer is blocked by an uncommitted IContext::mapForUpload()\n");
+      return {};
+    }
+    LVK_PROFILER_ZONE("Wait for the staging buffer", LVK_PROFILER_COLOR_WAIT);
+    if (regions_.front().handle_.empty()) {
+      flush(regions_.front().queue_);
+    }
+    ctx_.getImmediateCommands(regions_.front().handle_)->wait(regions_.front().handle_, lvk::HostWait_StagingBuffer);
+    LVK_PROFILER_ZONE_END();
   }
-  return *this;
 }
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::stencilStateOps(VkStencilFaceFlags faceMask,
-                                                                        VkStencilOp failOp,
-                                                                        VkStencilOp passOp,
-                                                                        VkStencilOp depthFailOp,
-                                                                        VkCompareOp compareOp) {
-  depthStencilState_.stencilTestEnable = depthStencilState_.stencilTestEnable == VK_TRUE || failOp != VK_STENCIL_OP_KEEP ||
-                                                 passOp != VK_STENCIL_OP_KEEP || depthFailOp != VK_STENCIL_OP_KEEP ||
-                                                 compareOp != VK_COMPARE_OP_ALWAYS
-                                             ? VK_TRUE
-                                             : VK_FALSE;
+lvk::VulkanStagingDevice::MemoryRegionDesc lvk::VulkanStagingDevice::map(uint32_t size, lvk::QueueType queue) {
+  LVK_PROFILER_FUNCTION();
 
-  if (faceMask & VK_STENCIL_FACE_FRONT_BIT) {
-    VkStencilOpState& s = depthStencilState_.front;
-    s.failOp = failOp;
-    s.passOp = passOp;
-    s.depthFailOp = depthFailOp;
-    s.compareOp = compareOp;
-  }
+  std::lock_guard lock(mutex_);
 
-  if (faceMask & VK_STENCIL_FACE_BACK_BIT) {
-    VkStencilOpState& s = depthStencilState_.back;
-    s.failOp = failOp;
-    s.passOp = passOp;
-    s.depthFailOp = depthFailOp;
-    s.compareOp = compareOp;
+  if (!size || getAlignedSize(size) > maxBufferSize_) {
+    return {};
   }
-  return *this;
-}
 
-lvk::VulkanPipelineBuilder& lvk::VulkanPipelineBuilder::stencilMasks(VkStencilFaceFlags faceMask,
-                                                                     uint32_t compareMask,
-                                                                     uint32_t writeMask,
-                                                                     uint32_t reference) {
-  if (faceMask & VK_STENCIL_FACE_FRONT_BIT) {
-    VkStencilOpState& s = depthStencilState_.front;
-    s.compareMask = compareMask;
-    s.writeMask = writeMask;
-    s.reference = reference;
+  ensureStagingBufferSize(getAlignedSize(size));
+
+  if (getAlignedSize(size) > stagingBufferSize_) {
+    // the staging buffer cannot grow while other mapped regions are being written
+    return {};
   }
 
-  if (faceMask & VK_STENCIL_FACE_BACK_BIT) {
-    VkStencilOpState& s = depthStencilState_.back;
-    s.compareMask = compareMask;
-    s.writeMask = writeMask;
-    s.reference = reference;
+  MemoryRegionDesc desc = allocate(size, false, queue);
+
+  if (!desc.size_) {
+    return {};
   }
-  return *this;
+
+  desc.isMapped_ = true;
+  regions_.back().isMapped_ = true;
+  numMappedRegions_++;
+
+  return desc;
 }
 
-VkResult lvk::VulkanPipelineBuilder::build(VkDevice device,
-                                           VkPipelineCache pipelineCache,
-                                           VkPipelineLayout pipelineLayout,
-                                           VkPipeline* outPipeline,
-                                           const char* debugName) noexcept {
-  const VkPipelineDynamicStateCreateInfo dynamicState = {
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-      .dynamicStateCount = numDynamicStates_,
-      .pDynamicStates = dynamicStates_,
-  };
-  // viewport and scissor can be NULL if the viewport state is dynamic
-  // https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkPipelineViewportStateCreateInfo.html
-  const VkPipelineViewportStateCreateInfo viewportState = {
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-      .viewportCount = 1,
-      .pViewports = nullptr,
-      .scissorCount = 1,
-      .pScissors = nullptr,
-  };
-  const VkPipelineColorBlendStateCreateInfo colorBlendState = {
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-      .logicOpEnable = VK_FALSE,
-      .logicOp = VK_LOGIC_OP_COPY,
-      .attachmentCount = numColorAttachments_,
-      .pAttachments = colorBlendAttachmentStates_,
-  };
-  const VkPipelineRenderingCreateInfo renderingInfo = {
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
-      .pNext = nullptr,
-      .colorAttachmentCount = numColorAttachments_,
-      .pColorAttachmentFormats = colorAttachmentFormats_,
-      .depthAttachmentFormat = depthAttachmentFormat_,
-      .stencilAttachmentFormat = stencilAttachmentFormat_,
-  };
+uint8_t* lvk::VulkanStagingDevice::getMappedPtr(const MemoryRegionDesc& desc) const {
+  const lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
 
-  const VkGraphicsPipelineCreateInfo ci = {
-      .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-      .pNext = &renderingInfo,
-      .flags = 0,
-      .stageCount = numShaderStages_,
-      .pStages = shaderStages_,
-      .pVertexInputState = &vertexInputState_,
-      .pInputAssemblyState = &inputAssembly_,
-      .pTessellationState = &tessellationState_,
-      .pViewportState = &viewportState,
-      .pRasterizationState = &rasterizationState_,
-      .pMultisampleState = &multisampleState_,
-      .pDepthStencilState = &depthStencilState_,
-      .pColorBlendState = &colorBlendState,
-      .pDynamicState = &dynamicState,
-      .layout = pipelineLayout,
-      .renderPass = VK_NULL_HANDLE,
-      .subpass = 0,
-      .basePipelineHandle = VK_NULL_HANDLE,
-      .basePipelineIndex = -1,
-  };
+  return stagingBuffer->getMappedPtr() + desc.offset_;
+}
 
-  const auto result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &ci, nullptr, outPipeline);
+void lvk::VulkanStagingDevice::unmap(const MemoryRegionDesc& desc) {
+  std::lock_guard lock(mutex_);
 
-  if (!LVK_VERIFY(result == VK_SUCCESS)) {
-    return result;
+  for (MemoryRegionDesc& r : regions_) {
+    if (r.isMapped_ && r.offset_ == desc.offset_) {
+      r.isMapped_ = false;
+      numMappedRegions_--;
+      break;
+    }
   }
 
-  numPipelinesCreated_++;
-
-  // set debug name
-  return lvk::setDebugObjectName(device, VK_OBJECT_TYPE_PIPELINE, (uint64_t)*outPipeline, debugName);
+  ctx_.buffersPool_.get(stagingBuffer_)->flushMappedMemory(desc.offset_, desc.size_);
 }
 
-lvk::CommandBuffer::CommandBuffer(VulkanContext* ctx) : ctx_(ctx), wrapper_(&ctx_->immediate_->acquire()) {}
+void lvk::VulkanStagingDevice::waitAndReset() {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_WAIT);
+
+  LVK_ASSERT(!pending_[lvk::QueueType_Graphics] && !pending_[lvk::QueueType_Transfer]);
 
-lvk::CommandBuffer::~CommandBuffer() {
-  // did you forget to call cmdEndRendering()?
-  LVK_ASSERT(!isRendering_);
+  // regions are submitted in order on each queue - it is enough to wait for the newest one per queue
+  SubmitHandle lastHandles[lvk::QueueType_Num] = {};
+
+  for (const MemoryRegionDesc& r : regions_) {
+    lastHandles[r.handle_.queueType_] = r.handle_;
+  }
+  for (const SubmitHandle& h : lastHandles) {
+    ctx_.getImmediateCommands(h)->wait(h, lvk::HostWait_StagingBuffer);
+  }
+
+  regions_.clear();
+  head_ = 0;
 }
 
-void lvk::CommandBuffer::transitionToShaderReadOnly(TextureHandle handle) const {
-  LVK_PROFILER_FUNCTION();
+lvk::VulkanContext::VulkanContext(const lvk::ContextConfig& config, void* window, void* display) : config_(config) {
+  LVK_PROFILER_THREAD("MainThread");
 
-  const lvk::VulkanTexture& tex = *ctx_->texturesPool_.get(handle);
-  const lvk::VulkanImage* img = tex.image_.get();
+  pimpl_ = std::make_unique<VulkanContextImpl>();
 
-  LVK_ASSERT(!img->isSwapchainImage_);
+  // bindless descriptor sets are updated only for the slots which have changed
+  texturesPool_.trackDirtySlots_ = true;
+  samplersPool_.trackDirtySlots_ = true;
 
-  // transition only non-multisampled images - MSAA images cannot be accessed from shaders
-  if (img->vkSamples_ == VK_SAMPLE_COUNT_1_BIT) {
-    const VkImageAspectFlags flags = tex.image_->getImageAspectFlags();
-    VkPipelineStageFlags srcStage = 0;
-    if (tex.image_->isSampledImage()) {
-      srcStage |= isDepthOrStencilVkFormat(tex.image_->vkImageFormat_) ? VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
-                                                                       : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    }
-    if (tex.image_->isStorageImage()) {
-      srcStage |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-    }
-    // set the result of the previous render pass
-    img->transitionLayout(wrapper_->cmdBuf_,
-                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                          srcStage,
-                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, // wait for subsequent
-                                                                                                        // fragment/compute shaders
-                          VkImageSubresourceRange{flags, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
+  if (volkInitialize() != VK_SUCCESS) {
+    LLOGW("volkInitialize() failed\n");
+    exit(255);
+  };
+
+  glslang_initialize_process();
+
+  {
+    std::lock_guard lock(volkMutex);
+    // headless contexts do not enable any surface extensions
+    createInstance(window != nullptr);
+  }
+
+  if (window) {
+    createSurface(window, display);
   }
 }
 
-void lvk::CommandBuffer::cmdBindComputePipeline(lvk::ComputePipelineHandle handle) {
+lvk::VulkanContext::~VulkanContext() {
   LVK_PROFILER_FUNCTION();
 
-  if (!LVK_VERIFY(!handle.empty())) {
+  if (vkDevice_ == VK_NULL_HANDLE) {
+    // only queryDevices() has been used
+    if (vkSurface_ != VK_NULL_HANDLE) {
+      vkIT_.vkDestroySurfaceKHR(vkInstance_, vkSurface_, nullptr);
+    }
+    vkIT_.vkDestroyDebugUtilsMessengerEXT(vkInstance_, vkDebugUtilsMessenger_, nullptr);
+    vkDestroyInstance(vkInstance_, nullptr);
+    glslang_finalize_process();
     return;
   }
 
-  currentPipelineGraphics_ = {};
-  currentPipelineCompute_ = handle;
-
-  VkPipeline pipeline = ctx_->getVkPipeline(handle);
+  waitPipelineCompileJobs();
 
-  const lvk::ComputePipelineState* cps = ctx_->computePipelinesPool_.get(handle);
+  VK_ASSERT(vkDT_.vkDeviceWaitIdle(vkDevice_));
 
-  LVK_ASSERT(cps);
-  LVK_ASSERT(pipeline != VK_NULL_HANDLE);
+  stagingDevice_.reset(nullptr);
+  pimpl_->transientBuffers_.clear();
+  for (const VulkanImage::SparsePage& page : pimpl_->releasedTexturePages_) {
+    freeSparsePage(pimpl_->vma_, vkDT_, vkDevice_, &pimpl_->sparsePageBlocks_, page);
+  }
+  swapchain_.reset(nullptr); // swapchain has to be destroyed prior to Surface
 
-  if (lastPipelineBound_ != pipeline) {
-    lastPipelineBound_ = pipeline;
-    vkCmdBindPipeline(wrapper_->cmdBuf_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
-    ctx_->checkAndUpdateDescriptorSets();
-    ctx_->bindDefaultDescriptorSets(wrapper_->cmdBuf_, VK_PIPELINE_BIND_POINT_COMPUTE, cps->pipelineLayout_);
+  if (shaderModulesPool_.numObjects()) {
+    LLOGW("Leaked %u shader modules\n", shaderModulesPool_.numObjects());
+  }
+  if (renderPipelinesPool_.numObjects()) {
+    LLOGW("Leaked %u render pipelines\n", renderPipelinesPool_.numObjects());
+  }
+  if (computePipelinesPool_.numObjects()) {
+    LLOGW("Leaked %u compute pipelines\n", computePipelinesPool_.numObjects());
+  }
+  if (samplersPool_.numObjects() > 1) {
+    // the dummy value is owned by the context
+    LLOGW("Leaked %u samplers\n", samplersPool_.numObjects() - 1);
+  }
+  if (texturesPool_.numObjects() > 1) {
+    // the dummy value is owned by the context
+    LLOGW("Leaked %u textures\n", texturesPool_.numObjects() - 1);
+  }
+  if (buffersPool_.numObjects()) {
+    LLOGW("Leaked %u buffers\n", buffersPool_.numObjects());
   }
-}
 
-void lvk::CommandBuffer::cmdDispatchThreadGroups(const Dimensions& threadgroupCount, const Dependencies& deps) {
-  LVK_PROFILER_FUNCTION();
+  // manually destroy the dummy sampler
+  vkDT_.vkDestroySampler(vkDevice_, samplersPool_.objects_.front().obj_, nullptr);
+  samplersPool_.clear();
+  computePipelinesPool_.clear();
+  renderPipelinesPool_.clear();
+  shaderModulesPool_.clear();
+  texturesPool_.clear();
 
-  LVK_ASSERT(!isRendering_);
+  waitDeferredTasks();
 
-  for (uint32_t i = 0; i != Dependencies::LVK_MAX_SUBMIT_DEPENDENCIES && deps.textures[i]; i++) {
-    useComputeTexture(deps.textures[i]);
+  pimpl_->sparsePageBlocks_.destroy(vkDT_, vkDevice_);
+
+  transferImmediate_.reset(nullptr);
+  computeImmediate_.reset(nullptr);
+  immediate_.reset(nullptr);
+
+  vkDT_.vkDestroyDescriptorSetLayout(vkDevice_, vkDSL_, nullptr);
+  vkDT_.vkDestroyDescriptorPool(vkDevice_, vkDPool_, nullptr);
+  if (vkSurface_ != VK_NULL_HANDLE) {
+    vkIT_.vkDestroySurfaceKHR(vkInstance_, vkSurface_, nullptr);
   }
-  for (uint32_t i = 0; i != Dependencies::LVK_MAX_SUBMIT_DEPENDENCIES && deps.buffers[i]; i++) {
-    bufferBarrier(
-        deps.buffers[i], VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+  for (const VulkanContextImpl::GPUProfilerFrame& frame : pimpl_->gpuProfilerFrames_) {
+    vkDT_.vkDestroyQueryPool(vkDevice_, frame.queryPool, nullptr);
   }
+  savePipelineCache();
+  vkDT_.vkDestroyPipelineCache(vkDevice_, pipelineCache_, nullptr);
 
-  vkCmdDispatch(wrapper_->cmdBuf_, threadgroupCount.width, threadgroupCount.height, threadgroupCount.depth);
-}
+  // Clean up VMA
+  if (LVK_VULKAN_USE_VMA) {
+    vmaDestroyAllocator(pimpl_->vma_);
+  }
 
-void lvk::CommandBuffer::cmdPushDebugGroupLabel(const char* label, uint32_t colorRGBA) const {
-  LVK_ASSERT(label);
+  // Device has to be destroyed prior to Instance
+  vkDT_.vkDestroyDevice(vkDevice_, nullptr);
 
-  if (!label) {
-    return;
-  }
-  const VkDebugUtilsLabelEXT utilsLabel = {
-      .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
-      .pNext = nullptr,
-      .pLabelName = label,
-      .color = {float((colorRGBA >> 0) & 0xff) / 255.0f,
-                float((colorRGBA >> 8) & 0xff) / 255.0f,
-                float((colorRGBA >> 16) & 0xff) / 255.0f,
-                float((colorRGBA >> 24) & 0xff) / 255.0f},
-  };
-  vkCmdBeginDebugUtilsLabelEXT(wrapper_->cmdBuf_, &utilsLabel);
-}
+  vkIT_.vkDestroyDebugUtilsMessengerEXT(vkInstance_, vkDebugUtilsMessenger_, nullptr);
+  vkDestroyInstance(vkInstance_, nullptr);
 
-void lvk::CommandBuffer::cmdInsertDebugEventLabel(const char* label, uint32_t colorRGBA) const {
-  LVK_ASSERT(label);
+  glslang_finalize_process();
 
-  if (!label) {
-    return;
-  }
-  const VkDebugUtilsLabelEXT utilsLabel = {
-      .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
-      .pNext = nullptr,
-      .pLabelName = label,
-      .color = {float((colorRGBA >> 0) & 0xff) / 255.0f,
-                float((colorRGBA >> 8) & 0xff) / 255.0f,
-                float((colorRGBA >> 16) & 0xff) / 255.0f,
-                float((colorRGBA >> 24) & 0xff) / 255.0f},
-  };
-  vkCmdInsertDebugUtilsLabelEXT(wrapper_->cmdBuf_, &utilsLabel);
+  LLOGL("Vulkan graphics pipelines created: %u\n", VulkanPipelineBuilder::getNumPipelinesCreated());
 }
 
-void lvk::CommandBuffer::cmdPopDebugGroupLabel() const {
-  vkCmdEndDebugUtilsLabelEXT(wrapper_->cmdBuf_);
-}
+lvk::ICommandBuffer& lvk::VulkanContext::acquireCommandBuffer(lvk::QueueType queue) {
+  LVK_PROFILER_FUNCTION();
 
-void lvk::CommandBuffer::useComputeTexture(TextureHandle handle) {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_BARRIER);
+  LVK_ASSERT(queue < lvk::QueueType_Num);
 
-  LVK_ASSERT(!handle.empty());
-  lvk::VulkanTexture* tex = ctx_->texturesPool_.get(handle);
-  const lvk::VulkanImage& vkImage = *tex->image_.get();
-  if (!vkImage.isStorageImage()) {
-    LVK_ASSERT_MSG(false, "Did you forget to specify TextureUsageBits::Storage on your texture?");
-    return;
-  }
+  CommandBuffer cmdBuffer(this, queue);
 
-  // "frame graph" heuristics: if we are already in VK_IMAGE_LAYOUT_GENERAL, wait for the previous
-  // compute shader
-  const VkPipelineStageFlags srcStage = (vkImage.vkImageLayout_ == VK_IMAGE_LAYOUT_GENERAL) ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
-                                                                                            : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-  vkImage.transitionLayout(
-      wrapper_->cmdBuf_,
-      VK_IMAGE_LAYOUT_GENERAL,
-      srcStage,
-      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-      VkImageSubresourceRange{vkImage.getImageAspectFlags(), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
-}
+  const SubmitHandle& h = cmdBuffer.wrapper_->handle_;
 
-void lvk::CommandBuffer::bufferBarrier(BufferHandle handle, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_BARRIER);
+  CommandBuffer& slot = pimpl_->commandBuffers_[h.queueType_][h.bufferIndex_];
 
-  lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(handle);
+  LVK_ASSERT_MSG(!slot.ctx_, "This command buffer slot is still in use");
 
-  VkBufferMemoryBarrier barrier = {
-      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-      .srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
-      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
-      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-      .buffer = buf->vkBuffer_,
-      .offset = 0,
-      .size = VK_WHOLE_SIZE,
-  };
+  slot = std::move(cmdBuffer);
 
-  if (dstStage & VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT) {
-    barrier.dstAccessMask |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
-  }
-  if (buf->vkUsageFlags_ & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
-    barrier.dstAccessMask |= VK_ACCESS_INDEX_READ_BIT;
-  }
+  return slot;
+}
+
+lvk::SubmitHandle lvk::VulkanContext::submit(lvk::ICommandBuffer& commandBuffer, TextureHandle present) {
+  lvk::ICommandBuffer* commandBuffers[] = {&commandBuffer};
 
-  vkCmdPipelineBarrier(wrapper_->cmdBuf_, srcStage, dstStage, VkDependencyFlags{}, 0, nullptr, 1, &barrier, 0, nullptr);
+  return submit(commandBuffers, 1, present);
 }
 
-void lvk::CommandBuffer::cmdBeginRendering(const lvk::RenderPass& renderPass, const lvk::Framebuffer& fb, const Dependencies& deps) {
+lvk::SubmitHandle lvk::VulkanContext::submit(lvk::ICommandBuffer* const* commandBuffers,
+                                             uint32_t numCommandBuffers,
+                                             TextureHandle present) {
   LVK_PROFILER_FUNCTION();
 
-  LVK_ASSERT(!isRendering_);
+  LVK_ASSERT(commandBuffers);
+  LVK_ASSERT(numCommandBuffers && numCommandBuffers <= VulkanImmediateCommands::kMaxCommandBuffers);
 
-  isRendering_ = true;
+  const VulkanImmediateCommands::CommandBufferWrapper* wrappers[VulkanImmediateCommands::kMaxCommandBuffers] = {};
+  CommandBuffer* vkCmdBuffers[VulkanImmediateCommands::kMaxCommandBuffers] = {};
 
-  for (uint32_t i = 0; i != Dependencies::LVK_MAX_SUBMIT_DEPENDENCIES && deps.textures[i]; i++) {
-    transitionToShaderReadOnly(deps.textures[i]);
-  }
-  for (uint32_t i = 0; i != Dependencies::LVK_MAX_SUBMIT_DEPENDENCIES && deps.buffers[i]; i++) {
-    VkPipelineStageFlags dstStageFlags = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    const lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(deps.buffers[i]);
-    LVK_ASSERT(buf);
-    if ((buf->vkUsageFlags_ & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) || (buf->vkUsageFlags_ & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)) {
-      dstStageFlags |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
-    }
-    if (buf->vkUsageFlags_ & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) {
-      dstStageFlags |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
-    }
-    bufferBarrier(deps.buffers[i], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStageFlags);
-  }
+  // the latest timeline value to wait for on every other queue
+  uint64_t waitValues[lvk::QueueType_Num] = {};
 
-  const uint32_t numFbColorAttachments = fb.getNumColorAttachments();
-  const uint32_t numPassColorAttachments = renderPass.getNumColorAttachments();
+  const lvk::QueueType queueType = lvk::QueueType(static_cast<CommandBuffer*>(commandBuffers[0])->wrapper_->handle_.queueType_);
 
-  LVK_ASSERT(numPassColorAttachments == numFbColorAttachments);
+  for (uint32_t i = 0; i != numCommandBuffers; i++) {
+    CommandBuffer* vkCmdBuffer = static_cast<CommandBuffer*>(commandBuffers[i]);
 
-  framebuffer_ = fb;
+    LVK_ASSERT(vkCmdBuffer);
+    LVK_ASSERT(vkCmdBuffer->ctx_);
+    LVK_ASSERT(vkCmdBuffer->wrapper_);
+    LVK_ASSERT_MSG(vkCmdBuffer->wrapper_->handle_.queueType_ == queueType, "All command buffers should belong to the same queue");
 
-  // transition all the color attachments
-  for (uint32_t i = 0; i != numFbColorAttachments; i++) {
-    if (const auto handle = fb.color[i].texture) {
-      lvk::VulkanTexture* colorTex = ctx_->texturesPool_.get(handle);
-      transitionToColorAttachment(wrapper_->cmdBuf_, colorTex);
-    }
-    // handle MSAA
-    if (TextureHandle handle = fb.color[i].resolveTexture) {
-      lvk::VulkanTexture* colorResolveTex = ctx_->texturesPool_.get(handle);
-      transitionToColorAttachment(wrapper_->cmdBuf_, colorResolveTex);
+    vkCmdBuffers[i] = vkCmdBuffer;
+    wrappers[i] = vkCmdBuffer->wrapper_;
+
+    for (uint32_t j = 0; j != vkCmdBuffer->numWaitSubmits_; j++) {
+      const SubmitHandle h = vkCmdBuffer->waitSubmits_[j];
+      waitValues[h.queueType_] = std::max(waitValues[h.queueType_], getImmediateCommands(h)->getTimelineValue(h));
     }
   }
-  // transition depth-stencil attachment
-  TextureHandle depthTex = fb.depthStencil.texture;
-  if (depthTex) {
-    lvk::VulkanTexture& vkDepthTex = *ctx_->texturesPool_.get(depthTex);
-    const lvk::VulkanImage* depthImg = vkDepthTex.image_.get();
-    LVK_ASSERT_MSG(depthImg->vkImageFormat_ != VK_FORMAT_UNDEFINED, "Invalid depth attachment format");
-    const VkImageAspectFlags flags = vkDepthTex.image_->getImageAspectFlags();
-    depthImg->transitionLayout(wrapper_->cmdBuf_,
-                               VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                               VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-                               VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, // wait for all subsequent
-                                                                                                               // operations
-                               VkImageSubresourceRange{flags, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
+
+  VulkanImmediateCommands* immediate = getImmediateCommands(queueType);
+
+  // pending sparse page updates are executed on the graphics queue before every submit; the graphics queue waits for them
+  // implicitly, other queues wait for the bind operation on the graphics timeline
+  uint64_t bindSparseValue = 0;
+  std::vector<VulkanImage::SparsePage> releasedPages = flushTexturePages(&bindSparseValue);
+  if (bindSparseValue && immediate != immediate_.get()) {
+    waitValues[lvk::QueueType_Graphics] = std::max(waitValues[lvk::QueueType_Graphics], bindSparseValue);
   }
 
-  VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
-  uint32_t mipLevel = 0;
-  uint32_t fbWidth = 0;
-  uint32_t fbHeight = 0;
+  // pending uploads go first; uploads recorded on other threads are blocked until they are submitted
+  std::unique_lock stagingLock(stagingDevice_->mutex_);
 
-  VkRenderingAttachmentInfo colorAttachments[LVK_MAX_COLOR_ATTACHMENTS];
+  const bool submitUploads = stagingDevice_->hasPendingUploads(lvk::QueueType_Graphics) && immediate == immediate_.get();
 
-  for (uint32_t i = 0; i != numFbColorAttachments; i++) {
-    const lvk::Framebuffer::AttachmentDesc& attachment = fb.color[i];
-    LVK_ASSERT(!attachment.texture.empty());
+  if (submitUploads) {
+    LVK_ASSERT(numCommandBuffers < VulkanImmediateCommands::kMaxCommandBuffers);
+    memmove(wrappers + 1, wrappers, numCommandBuffers * sizeof(wrappers[0]));
+    wrappers[0] = stagingDevice_->pending_[lvk::QueueType_Graphics];
+  } else if (const SubmitHandle uploads = stagingDevice_->flush(lvk::QueueType_Graphics); !uploads.empty()) {
+    // another queue has to wait for the uploads
+    waitValues[uploads.queueType_] = std::max(waitValues[uploads.queueType_], immediate_->getTimelineValue(uploads));
+  }
 
-    lvk::VulkanTexture& colorTexture = *ctx_->texturesPool_.get(attachment.texture);
-    const auto& descColor = renderPass.color[i];
-    if (mipLevel && descColor.level) {
-      LVK_ASSERT_MSG(descColor.level == mipLevel, "All color attachments should have the same mip-level");
-    }
-    const VkExtent3D dim = colorTexture.getExtent();
-    if (fbWidth) {
-      LVK_ASSERT_MSG(dim.width == fbWidth, "All attachments should have the save width");
-    }
-    if (fbHeight) {
-      LVK_ASSERT_MSG(dim.height == fbHeight, "All attachments should have the save width");
+  VkSemaphore waitSemaphores[lvk::QueueType_Num] = {};
+  uint64_t waitSemaphoreValues[lvk::QueueType_Num] = {};
+  uint32_t numWaitSemaphores = 0;
+
+  for (uint32_t q = 0; q != lvk::QueueType_Num; q++) {
+    if (waitValues[q]) {
+      waitSemaphores[numWaitSemaphores] = getImmediateCommands(lvk::QueueType(q))->getTimelineSemaphore();
+      waitSemaphoreValues[numWaitSemaphores++] = waitValues[q];
     }
-    mipLevel = descColor.level;
-    fbWidth = dim.width;
-    fbHeight = dim.height;
-    samples = colorTexture.image_->vkSamples_;
-    colorAttachments[i] = {
-        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
-        .pNext = nullptr,
-        .imageView = colorTexture.getOrCreateVkImageViewForFramebuffer(descColor.level, descColor.layer),
-        .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        .resolveMode = (samples > 1) ? VK_RESOLVE_MODE_AVERAGE_BIT : VK_RESOLVE_MODE_NONE,
-        .resolveImageView = VK_NULL_HANDLE,
-        .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .loadOp = loadOpToVkAttachmentLoadOp(descColor.loadOp),
-        .storeOp = storeOpToVkAttachmentStoreOp(descColor.storeOp),
-        .clearValue =
-            {.color = {.float32 = {descColor.clearColor[0], descColor.clearColor[1], descColor.clearColor[2], descColor.clearColor[3]}}},
-    };
-    // handle MSAA
-    if (descColor.storeOp == StoreOp_MsaaResolve) {
-      LVK_ASSERT(samples > 1);
-      LVK_ASSERT_MSG(!attachment.resolveTexture.empty(), "Framebuffer attachment should contain a resolve texture");
-      lvk::VulkanTexture& colorResolveTexture = *ctx_->texturesPool_.get(attachment.resolveTexture);
-      colorAttachments[i].resolveImageView = colorResolveTexture.getOrCreateVkImageViewForFramebuffer(descColor.level, descColor.layer);
-      colorAttachments[i].resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  }
+
+  LVK_ASSERT_MSG(!present || queueType == lvk::QueueType_Graphics, "Only graphics command buffers can present");
+
+  if (present) {
+    const lvk::VulkanTexture& tex = *texturesPool_.get(present);
+
+    LVK_ASSERT(tex.image_->isSwapchainImage_);
+
+    // prepare image for presentation the image might be coming from a compute shader
+    const VkPipelineStageFlagBits srcStage = (tex.image_->vkImageLayout_ == VK_IMAGE_LAYOUT_GENERAL)
+                                                 ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                                                 : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    // the last command buffer in the batch is responsible for the presentation
+    tex.image_->transitionLayout(
+        vkCmdBuffers[numCommandBuffers - 1]->wrapper_->cmdBuf_,
+        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        srcStage,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // wait for all subsequent operations
+        VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
+  }
+
+  const bool shouldPresent = hasSwapchain() && present;
+
+  // transient allocations of these command buffers are flushed and retired by this submit
+  std::unique_lock transientLock(pimpl_->transientBuffersMutex_);
+
+  for (uint32_t i = 0; i != numCommandBuffers; i++) {
+    for (const CommandBuffer::TransientRange& r : vkCmdBuffers[i]->transientRanges_) {
+      const lvk::VulkanBuffer* buf = buffersPool_.get(pimpl_->transientBuffers_[r.buffer].buffer);
+      if (!buf->isCoherentMemory_) {
+        buf->flushMappedMemory(r.begin, r.end - r.begin);
+      }
     }
   }
 
-  VkRenderingAttachmentInfo depthAttachment = {};
+  // all command buffers are submitted in a single vkQueueSubmit() in the given order
+  const SubmitHandle handle = immediate->submit(
+      wrappers, numCommandBuffers + (submitUploads ? 1 : 0), waitSemaphores, waitSemaphoreValues, numWaitSemaphores);
 
-  if (fb.depthStencil.texture) {
-    auto& depthTexture = *ctx_->texturesPool_.get(fb.depthStencil.texture);
-    const RenderPass::AttachmentDesc& descDepth = renderPass.depth;
-    LVK_ASSERT_MSG(descDepth.level == mipLevel, "Depth attachment should have the same mip-level as color attachments");
-    depthAttachment = {
-        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
-        .pNext = nullptr,
-        .imageView = depthTexture.getOrCreateVkImageViewForFramebuffer(descDepth.level, descDepth.layer),
-        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        .resolveMode = VK_RESOLVE_MODE_NONE,
-        .resolveImageView = VK_NULL_HANDLE,
-        .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .loadOp = loadOpToVkAttachmentLoadOp(descDepth.loadOp),
-        .storeOp = storeOpToVkAttachmentStoreOp(descDepth.storeOp),
-        .clearValue = {.depthStencil = {.depth = descDepth.clearDepth, .stencil = descDepth.clearStencil}},
-    };
-    const VkExtent3D dim = depthTexture.getExtent();
-    if (fbWidth) {
-      LVK_ASSERT_MSG(dim.width == fbWidth, "All attachments should have the save width");
-    }
-    if (fbHeight) {
-      LVK_ASSERT_MSG(dim.height == fbHeight, "All attachments should have the save width");
+  freeTexturePages(std::move(releasedPages), handle);
+
+  for (uint32_t i = 0; i != numCommandBuffers; i++) {
+    for (const CommandBuffer::TransientRange& r : vkCmdBuffers[i]->transientRanges_) {
+      VulkanContextImpl::TransientBuffer& b = pimpl_->transientBuffers_[r.buffer];
+      LVK_ASSERT(b.numPendingCommandBuffers);
+      b.numPendingCommandBuffers--;
+      b.submits.push_back(handle);
     }
-    mipLevel = descDepth.level;
-    fbWidth = dim.width;
-    fbHeight = dim.height;
+    vkCmdBuffers[i]->transientRanges_.clear();
   }
 
-  const uint32_t width = std::max(fbWidth >> mipLevel, 1u);
-  const uint32_t height = std::max(fbHeight >> mipLevel, 1u);
-  const lvk::Viewport viewport = {0.0f, 0.0f, (float)width, (float)height, 0.0f, +1.0f};
-  const lvk::ScissorRect scissor = {0, 0, width, height};
+  transientLock.unlock();
 
-  VkRenderingAttachmentInfo stencilAttachment = depthAttachment;
+  if (submitUploads) {
+    stagingDevice_->onSubmitted(lvk::QueueType_Graphics, handle);
+  }
 
-  const bool isStencilFormat = renderPass.stencil.loadOp != lvk::LoadOp_Invalid;
+  stagingLock.unlock();
 
-  const VkRenderingInfo renderingInfo = {
-      .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
-      .pNext = nullptr,
-      .flags = 0,
-      .renderArea = {VkOffset2D{(int32_t)scissor.x, (int32_t)scissor.y}, VkExtent2D{scissor.width, scissor.height}},
-      .layerCount = 1,
-      .viewMask = 0,
-      .colorAttachmentCount = numFbColorAttachments,
-      .pColorAttachments = colorAttachments,
-      .pDepthAttachment = depthTex ? &depthAttachment : nullptr,
-      .pStencilAttachment = isStencilFormat ? &stencilAttachment : nullptr,
-  };
+  if (shouldPresent) {
+    ScopedHostWait hostWait(&frameCounters_, lvk::HostWait_Present);
+    swapchain_->present(immediate_->acquireLastSubmitSemaphore(), ++lastPresentId_);
+  }
 
-  cmdBindViewport(viewport);
-  cmdBindScissorRect(scissor);
-  cmdBindDepthState({});
+  if (config_.enableGPUProfiler) {
+    {
+      std::lock_guard lock(pimpl_->gpuProfilerMutex_);
+      for (uint32_t i = 0; i != numCommandBuffers; i++) {
+        if (vkCmdBuffers[i]->gpuProfilerFrame_ != ~0u) {
+          LVK_ASSERT_MSG(vkCmdBuffers[i]->gpuProfilerScopeStack_.empty(), "Unbalanced GPU profiler scopes");
+          pimpl_->gpuProfilerFrames_[vkCmdBuffers[i]->gpuProfilerFrame_].submits.push_back(handle);
+        }
+      }
+    }
+  }
 
-  ctx_->checkAndUpdateDescriptorSets();
+  if (shouldPresent && config_.maxFramesInFlight) {
+    std::deque<VulkanContextImpl::FrameInFlight>& frames = pimpl_->framesInFlight_;
+    frames.push_back({.submit = handle, .presentId = lastPresentId_});
+    while (frames.size() >= config_.maxFramesInFlight) {
+      // pace to the display if possible; the GPU is done with the frame once it is displayed
+      bool isPresented = false;
+      if (hasPresentWait_) {
+        ScopedHostWait hostWait(&frameCounters_, lvk::HostWait_FramesInFlight);
+        isPresented = swapchain_->waitForPresent(frames.front().presentId, kFramesInFlightPresentTimeoutNs);
+      }
+      if (!isPresented) {
+        // the present can be blocked indefinitely (e.g. by a minimized window): wait for the GPU instead
+        immediate_->wait(frames.front().submit, lvk::HostWait_FramesInFlight);
+      }
+      frames.pop_front();
+    }
+  }
 
-  vkCmdSetDepthCompareOp(wrapper_->cmdBuf_, VK_COMPARE_OP_ALWAYS);
-  vkCmdSetDepthBiasEnable(wrapper_->cmdBuf_, VK_FALSE);
+  if (present) {
+    endFrame();
+  }
 
-  vkCmdBeginRendering(wrapper_->cmdBuf_, &renderingInfo);
-}
+  {
+    std::lock_guard lock(pimpl_->commandBufferStatsMutex_);
+    for (uint32_t i = 0; i != numCommandBuffers; i++) {
+      pimpl_->commandBufferStats_ += vkCmdBuffers[i]->stats_;
+    }
+  }
 
-void lvk::CommandBuffer::cmdEndRendering() {
-  LVK_ASSERT(isRendering_);
+  processDeferredTasks();
 
-  isRendering_ = false;
+  // reset
+  for (uint32_t i = 0; i != numCommandBuffers; i++) {
+    vkCmdBuffers[i]->lastSubmitHandle_ = handle;
+    *vkCmdBuffers[i] = {};
+  }
 
-  vkCmdEndRendering(wrapper_->cmdBuf_);
+  return handle;
+}
 
-  const uint32_t numFbColorAttachments = framebuffer_.getNumColorAttachments();
+void lvk::VulkanContext::endFrame() {
+  LVK_PROFILER_FUNCTION();
 
-  // set image layouts after the render pass
-  for (uint32_t i = 0; i != numFbColorAttachments; i++) {
-    const auto& attachment = framebuffer_.color[i];
-    const VulkanTexture& tex = *ctx_->texturesPool_.get(attachment.texture);
-    // this must match the final layout of the render pass
-    tex.image_->vkImageLayout_ = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  if (config_.enableGPUProfiler) {
+    gpuProfilerNextFrame();
   }
 
-  if (framebuffer_.depthStencil.texture) {
-    const VulkanTexture& tex = *ctx_->texturesPool_.get(framebuffer_.depthStencil.texture);
-    // this must match the final layout of the render pass
-    tex.image_->vkImageLayout_ = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+  if (LVK_VULKAN_USE_VMA) {
+    // VMA refreshes its budget estimates once per frame
+    vmaSetCurrentFrameIndex((VmaAllocator)getVmaAllocator(), ++pimpl_->vmaFrameIndex_);
   }
+  checkMemoryBudget();
 
-  framebuffer_ = {};
+  const uint64_t timeNs = getTimeNs();
+  FrameStats stats = frameCounters_.reset();
+  std::lock_guard lock(pimpl_->frameStatsMutex_);
+  stats.frameIndex = pimpl_->frameStats_.frameIndex + 1;
+  stats.cpuFrameTimeMs = pimpl_->lastFrameEndTimeNs_ ? double(timeNs - pimpl_->lastFrameEndTimeNs_) * 1e-6 : 0.0;
+  pimpl_->frameStats_ = stats;
+  pimpl_->lastFrameEndTimeNs_ = timeNs;
 }
 
-void lvk::CommandBuffer::cmdBindViewport(const Viewport& viewport) {
-  // https://www.saschawillems.de/blog/2019/03/29/flipping-the-vulkan-viewport/
-  const VkViewport vp = {
-      .x = viewport.x, // float x;
-      .y = viewport.height - viewport.y, // float y;
-      .width = viewport.width, // float width;
-      .height = -viewport.height, // float height;
-      .minDepth = viewport.minDepth, // float minDepth;
-      .maxDepth = viewport.maxDepth, // float maxDepth;
-  };
-  vkCmdSetViewport(wrapper_->cmdBuf_, 0, 1, &vp);
+void lvk::VulkanContext::wait(SubmitHandle handle) {
+  getImmediateCommands(handle)->wait(handle);
 }
 
-void lvk::CommandBuffer::cmdBindScissorRect(const ScissorRect& rect) {
-  const VkRect2D scissor = {
-      VkOffset2D{(int32_t)rect.x, (int32_t)rect.y},
-      VkExtent2D{rect.width, rect.height},
-  };
-  vkCmdSetScissor(wrapper_->cmdBuf_, 0, 1, &scissor);
+bool lvk::VulkanContext::isReady(SubmitHandle handle) const {
+  return getImmediateCommands(handle)->isReady(handle);
 }
 
-void lvk::CommandBuffer::cmdBindRenderPipeline(lvk::RenderPipelineHandle handle) {
-  if (!LVK_VERIFY(!handle.empty())) {
-    return;
+lvk::Holder<lvk::BufferHandle> lvk::VulkanContext::createBuffer(const BufferDesc& requestedDesc, Result* outResult) {
+  BufferDesc desc = requestedDesc;
+
+  if (!useStaging_ && (desc.storage == StorageType_Device)) {
+    desc.storage = StorageType_HostVisible;
   }
 
-  currentPipelineGraphics_ = handle;
-  currentPipelineCompute_ = {};
+  // Use staging device to transfer data into the buffer when the storage is private to the device. Host-visible buffers can be
+  // sources of cmdCopyBuffer(), i.e. application-managed staging buffers
+  VkBufferUsageFlags usageFlags = (desc.storage == StorageType_Device) ? VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+                                                                       : VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
-  const lvk::RenderPipelineState* rps = ctx_->renderPipelinesPool_.get(handle);
+  if (desc.usage == 0) {
+    Result::setResult(outResult, Result(Result::Code::ArgumentOutOfRange, "Invalid buffer usage"));
+    return {};
+  }
 
-  LVK_ASSERT(rps);
+  if (desc.usage & BufferUsageBits_Index) {
+    usageFlags |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+  }
+  if (desc.usage & BufferUsageBits_Vertex) {
+    usageFlags |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+  }
+  if (desc.usage & BufferUsageBits_Uniform) {
+    usageFlags |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
+  }
 
-  const bool hasDepthAttachmentPipeline = rps->desc_.depthFormat != Format_Invalid;
-  const bool hasDepthAttachmentPass = !framebuffer_.depthStencil.texture.empty();
+  if (desc.usage & BufferUsageBits_Storage) {
+    usageFlags |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
+  }
 
-  if (hasDepthAttachmentPipeline != hasDepthAttachmentPass) {
-    LVK_ASSERT(false);
-    LLOGW("Make sure your render pass and render pipeline both have matching depth attachments");
+  if (desc.usage & BufferUsageBits_Indirect) {
+    usageFlags |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
   }
 
-  VkPipeline pipeline = ctx_->getVkPipeline(handle);
+  const VkMemoryPropertyFlags memFlags = storageTypeToVkMemoryPropertyFlags(desc.storage);
 
-  LVK_ASSERT(pipeline != VK_NULL_HANDLE);
+  Result result;
+  BufferHandle handle = createBuffer(desc.size, usageFlags, memFlags, &result, desc.debugName);
 
-  if (lastPipelineBound_ != pipeline) {
-    lastPipelineBound_ = pipeline;
-    vkCmdBindPipeline(wrapper_->cmdBuf_, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-    ctx_->bindDefaultDescriptorSets(wrapper_->cmdBuf_, VK_PIPELINE_BIND_POINT_GRAPHICS, rps->pipelineLayout_);
+  if (!LVK_VERIFY(result.isOk())) {
+    Result::setResult(outResult, result);
+    return {};
+  }
+
+  if (desc.data) {
+    upload(handle, desc.data, desc.size, 0);
   }
+
+  checkMemoryBudget();
+
+  Result::setResult(outResult, Result());
+
+  return {this, handle};
 }
 
-void lvk::CommandBuffer::cmdBindDepthState(const DepthState& desc) {
+lvk::Holder<lvk::QueryPoolHandle> lvk::VulkanContext::createQueryPool(uint32_t numQueries, const char* debugName, Result* outResult) {
   LVK_PROFILER_FUNCTION();
 
-  const VkCompareOp op = compareOpToVkCompareOp(desc.compareOp);
-  vkCmdSetDepthWriteEnable(wrapper_->cmdBuf_, desc.isDepthWriteEnabled ? VK_TRUE : VK_FALSE);
-  vkCmdSetDepthTestEnable(wrapper_->cmdBuf_, op != VK_COMPARE_OP_ALWAYS);
+  const VkQueryPoolCreateInfo createInfo = {
+      .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+      .flags = 0,
+      .queryType = VK_QUERY_TYPE_TIMESTAMP,
+      .queryCount = numQueries,
+      .pipelineStatistics = 0,
+  };
 
-#if defined(ANDROID)
-  // This is a workaround for the issue.
-  // On Android (Mali-G715-Immortalis MC11 v1.r38p1-01eac0.c1a71ccca2acf211eb87c5db5322f569) 
-  // if depth-stencil texture is not set, call of vkCmdSetDepthCompareOp leads to disappearing of all content. 
-  if (!framebuffer_.depthStencil.texture) {
-    return;
+  VkQueryPool queryPool = VK_NULL_HANDLE;
+  VK_ASSERT(vkDT_.vkCreateQueryPool(vkDevice_, &createInfo, 0, &queryPool));
+
+  if (!queryPool) {
+    Result::setResult(outResult, Result(Result::Code::RuntimeError, "Cannot create QueryPool"));
+    return {};
+  }
+
+  if (debugName && *debugName) {
+    lvk::setDebugObjectName(vkDT_, vkDevice_, VK_OBJECT_TYPE_QUERY_POOL, (uint64_t)queryPool, debugName);
+  }
+
+  lvk::QueryPoolHandle handle = queriesPool_.create(std::move(queryPool));
+
+  if (!LVK_VERIFY(!handle.empty())) {
+    vkDT_.vkDestroyQueryPool(vkDevice_, queryPool, nullptr);
+    Result::setResult(outResult, Result::Code::RuntimeError, "Too many query pools");
+    return {};
+  }
+
+  return {this, handle};
+}
+
+lvk::Holder<lvk::SamplerHandle> lvk::VulkanContext::createSampler(const SamplerStateDesc& desc, Result* outResult) {
+  LVK_PROFILER_FUNCTION();
+
+  Result result;
+
+  SamplerHandle handle =
+      createSampler(samplerStateDescToVkSamplerCreateInfo(desc, getVkPhysicalDeviceProperties().limits), &result, desc.debugName);
+
+  if (!LVK_VERIFY(result.isOk())) {
+    Result::setResult(outResult, Result(Result::Code::RuntimeError, "Cannot create Sampler"));
+    return {};
+  }
+
+  Result::setResult(outResult, result);
+
+  return {this, handle};
+}
+
+lvk::Holder<lvk::TextureHandle> lvk::VulkanContext::createTexture(const TextureDesc& requestedDesc,
+                                                                  const char* debugName,
+                                                                  Result* outResult) {
+  TextureDesc desc(requestedDesc);
+
+  if (debugName && *debugName) {
+    desc.debugName = debugName;
+  }
+
+  const VkFormat vkFormat = lvk::isDepthOrStencilFormat(desc.format) ? getClosestDepthStencilFormat(desc.format)
+                                                                     : formatToVkFormat(desc.format);
+
+  const lvk::TextureType type = desc.type;
+  if (!LVK_VERIFY(type == TextureType_2D || type == TextureType_Cube || type == TextureType_3D)) {
+    LVK_ASSERT_MSG(false, "Only 2D, 3D and Cube textures are supported");
+    Result::setResult(outResult, Result::Code::RuntimeError);
+    return {};
+  }
+
+  if (desc.numMipLevels == 0) {
+    LVK_ASSERT_MSG(false, "The number of mip levels specified must be greater than 0");
+    desc.numMipLevels = 1;
+  }
+
+  if (desc.numSamples > 1 && desc.numMipLevels != 1) {
+    LVK_ASSERT_MSG(false, "The number of mip levels for multisampled images should be 1");
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "The number of mip-levels for multisampled images should be 1");
+    return {};
+  }
+
+  if (desc.numSamples > 1 && type == TextureType_3D) {
+    LVK_ASSERT_MSG(false, "Multisampled 3D images are not supported");
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Multisampled 3D images are not supported");
+    return {};
+  }
+
+  if (!LVK_VERIFY(desc.numMipLevels <= lvk::calcNumMipLevels(desc.dimensions.width, desc.dimensions.height))) {
+    Result::setResult(outResult,
+                      Result::Code::ArgumentOutOfRange,
+                      "The number of specified mip-levels is greater than the maximum possible "
+                      "number of mip-levels.");
+    return {};
   }
-#endif
-  vkCmdSetDepthCompareOp(wrapper_->cmdBuf_, op);
-}
-
-void lvk::CommandBuffer::cmdBindVertexBuffer(uint32_t index, BufferHandle buffer, uint64_t bufferOffset) {
-  LVK_PROFILER_FUNCTION();
 
-  if (!LVK_VERIFY(!buffer.empty())) {
-    return;
+  if (desc.usage == 0) {
+    LVK_ASSERT_MSG(false, "Texture usage flags are not set");
+    desc.usage = lvk::TextureUsageBits_Sampled;
   }
 
-  lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(buffer);
+  const bool isMemoryless = desc.storage == StorageType_Memoryless;
 
-  LVK_ASSERT(buf->vkUsageFlags_ & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+  if (isMemoryless && (desc.usage != lvk::TextureUsageBits_Attachment || desc.data)) {
+    LVK_ASSERT_MSG(false, "Memoryless textures can only be used as attachments");
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Memoryless textures can only be used as attachments");
+    return {};
+  }
 
-  vkCmdBindVertexBuffers(wrapper_->cmdBuf_, index, 1, &buf->vkBuffer_, &bufferOffset);
-}
+  if (desc.isSparse) {
+    if (!hasSparseResidency_ || (type == TextureType_3D && !vkFeatures10_.features.sparseResidencyImage3D)) {
+      Result::setResult(outResult, Result::Code::RuntimeError, "Sparse residency is not supported by the device");
+      return {};
+    }
+    if (!LVK_VERIFY(desc.storage == StorageType_Device && !desc.data && desc.aliasOf.empty() && desc.numSamples <= 1)) {
+      Result::setResult(outResult,
+                        Result::Code::ArgumentOutOfRange,
+                        "Sparse textures should be StorageType_Device without data, aliasing, and multisampling");
+      return {};
+    }
+  }
 
-void lvk::CommandBuffer::cmdBindIndexBuffer(BufferHandle indexBuffer, IndexFormat indexFormat, uint64_t indexBufferOffset) {
-  lvk::VulkanBuffer* buf = ctx_->buffersPool_.get(indexBuffer);
+  std::shared_ptr<lvk::VulkanImage> aliasOf;
 
-  LVK_ASSERT(buf->vkUsageFlags_ & VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+  if (!desc.aliasOf.empty()) {
+    const lvk::VulkanTexture* tex = texturesPool_.get(desc.aliasOf);
+    if (!LVK_VERIFY(tex && desc.storage == StorageType_Device && !tex->image_->isSwapchainImage_)) {
+      Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Only StorageType_Device textures can alias memory");
+      return {};
+    }
+    aliasOf = tex->image_;
+  }
 
-  const VkIndexType type = indexFormatToVkIndexType(indexFormat);
-  vkCmdBindIndexBuffer(wrapper_->cmdBuf_, buf->vkBuffer_, indexBufferOffset, type);
-}
+  /* Use staging device to transfer data into the image when the storage is private to the device */
+  VkImageUsageFlags usageFlags = (desc.storage == StorageType_Device) ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0;
 
-void lvk::CommandBuffer::cmdPushConstants(const void* data, size_t size, size_t offset) {
-  LVK_PROFILER_FUNCTION();
+  if (desc.usage & lvk::TextureUsageBits_Sampled) {
+    usageFlags |= VK_IMAGE_USAGE_SAMPLED_BIT;
+  }
+  if (desc.usage & lvk::TextureUsageBits_Storage) {
+    LVK_ASSERT_MSG(desc.numSamples <= 1, "Storage images cannot be multisampled");
+    usageFlags |= VK_IMAGE_USAGE_STORAGE_BIT;
+  }
+  if (desc.usage & lvk::TextureUsageBits_Attachment) {
+    usageFlags |= lvk::isDepthOrStencilFormat(desc.format) ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+                                                           : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  }
 
-  LVK_ASSERT(size % 4 == 0); // VUID-vkCmdPushConstants-size-00369: size must be a multiple of 4
+  // For now, always set this flag so we can read it back; transient attachments do not allow any other usages
+  usageFlags |= isMemoryless ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
-  // check push constant size is within max size
-  const VkPhysicalDeviceLimits& limits = ctx_->getVkPhysicalDeviceProperties().limits;
-  if (!LVK_VERIFY(size + offset <= limits.maxPushConstantsSize)) {
-    LLOGW("Push constants size exceeded %u (max %u bytes)", size + offset, limits.maxPushConstantsSize);
-  }
+  LVK_ASSERT_MSG(usageFlags != 0, "Invalid usage flags");
 
-  if (currentPipelineGraphics_.empty() && currentPipelineCompute_.empty()) {
-    LVK_ASSERT_MSG(false, "No pipeline bound - cannot set push constants");
-    return;
-  }
+  VkMemoryPropertyFlags memFlags = storageTypeToVkMemoryPropertyFlags(desc.storage);
 
-  const lvk::RenderPipelineState* stateGraphics = ctx_->renderPipelinesPool_.get(currentPipelineGraphics_);
-  const lvk::ComputePipelineState* stateCompute = ctx_->computePipelinesPool_.get(currentPipelineCompute_);
+  if (isMemoryless && !hasMemoryType(vkPhysicalDevice_, memFlags)) {
+    // desktop GPUs do not have lazily allocated memory
+    memFlags = storageTypeToVkMemoryPropertyFlags(StorageType_Device);
+  }
 
-  LVK_ASSERT(stateGraphics || stateCompute);
+  const bool hasDebugName = desc.debugName && *desc.debugName;
 
-  VkPipelineLayout layout = stateGraphics ? stateGraphics->pipelineLayout_ : stateCompute->pipelineLayout_;
-  VkShaderStageFlags shaderStageFlags = stateGraphics ? stateGraphics->shaderStageFlags_ : VK_SHADER_STAGE_COMPUTE_BIT;
+  char debugNameImage[256] = {0};
+  char debugNameImageView[256] = {0};
 
-  vkCmdPushConstants(wrapper_->cmdBuf_, layout, shaderStageFlags, (uint32_t)offset, (uint32_t)size, data);
-}
+  if (hasDebugName) {
+    snprintf(debugNameImage, sizeof(debugNameImage) - 1, "Image: %s", desc.debugName);
+    snprintf(debugNameImageView, sizeof(debugNameImageView) - 1, "Image View: %s", desc.debugName);
+  }
 
-void lvk::CommandBuffer::cmdDraw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t baseInstance) {
-  LVK_PROFILER_FUNCTION();
+  VkImageCreateFlags createFlags = 0;
+  uint32_t arrayLayerCount = static_cast<uint32_t>(desc.numLayers);
+  VkImageViewType imageViewType;
+  VkImageType imageType;
+  VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+  switch (desc.type) {
+  case TextureType_2D:
+    imageViewType = VK_IMAGE_VIEW_TYPE_2D;
+    imageType = VK_IMAGE_TYPE_2D;
+    samples = lvk::getVulkanSampleCountFlags(desc.numSamples);
+    break;
+  case TextureType_3D:
+    imageViewType = VK_IMAGE_VIEW_TYPE_3D;
+    imageType = VK_IMAGE_TYPE_3D;
+    break;
+  case TextureType_Cube:
+    imageViewType = VK_IMAGE_VIEW_TYPE_CUBE;
+    arrayLayerCount *= 6;
+    imageType = VK_IMAGE_TYPE_2D;
+    createFlags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+    break;
+  default:
+    LVK_ASSERT_MSG(false, "Code should NOT be reached");
+    Result::setResult(outResult, Result::Code::RuntimeError, "Unsupported texture type");
+    return {};
+  }
 
-  if (vertexCount == 0) {
-    return;
+  if (desc.isSparse) {
+    createFlags |= VK_IMAGE_CREATE_SPARSE_BINDING_BIT | VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT;
   }
 
-  vkCmdDraw(wrapper_->cmdBuf_, vertexCount, instanceCount, firstVertex, baseInstance);
-}
+  if ((desc.usage & lvk::TextureUsageBits_Storage) && isSRGBVkFormat(vkFormat)) {
+    // sRGB storage textures are written through UNORM views, see TextureViewDesc::format
+    createFlags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+  }
 
-void lvk::CommandBuffer::cmdDrawIndexed(uint32_t indexCount,
-                                        uint32_t instanceCount,
-                                        uint32_t firstIndex,
-                                        int32_t vertexOffset,
-                                        uint32_t baseInstance) {
-  LVK_PROFILER_FUNCTION();
+  Result result;
+  std::shared_ptr<lvk::VulkanImage> image = createImage(imageType,
+                                                        VkExtent3D{desc.dimensions.width, desc.dimensions.height, desc.dimensions.depth},
+                                                        vkFormat,
+                                                        desc.numMipLevels,
+                                                        arrayLayerCount,
+                                                        VK_IMAGE_TILING_OPTIMAL,
+                                                        usageFlags,
+                                                        memFlags,
+                                                        createFlags,
+                                                        samples,
+                                                        &result,
+                                                        debugNameImage,
+                                                        aliasOf);
+  if ((aliasOf || desc.isSparse) && !result.isOk()) {
+    // not fitting into the aliased memory or a format without sparse residency is not a programming error
+    Result::setResult(outResult, result);
+    return {};
+  }
+  if (!LVK_VERIFY(result.isOk())) {
+    Result::setResult(outResult, result);
+    return {};
+  }
+  if (!LVK_VERIFY(image.get())) {
+    Result::setResult(outResult, Result::Code::RuntimeError, "Cannot create VulkanImage");
+    return {};
+  }
 
-  if (indexCount == 0) {
-    return;
+  VkImageAspectFlags aspect = 0;
+  if (image->isDepthFormat_ || image->isStencilFormat_) {
+    if (image->isDepthFormat_) {
+      aspect |= VK_IMAGE_ASPECT_DEPTH_BIT;
+    } else if (image->isStencilFormat_) {
+      aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+  } else {
+    aspect = VK_IMAGE_ASPECT_COLOR_BIT;
   }
 
-  vkCmdDrawIndexed(wrapper_->cmdBuf_, indexCount, instanceCount, firstIndex, vertexOffset, baseInstance);
-}
+  const VkComponentMapping mapping = {
+      .r = VkComponentSwizzle(desc.swizzle.r),
+      .g = VkComponentSwizzle(desc.swizzle.g),
+      .b = VkComponentSwizzle(desc.swizzle.b),
+      .a = VkComponentSwizzle(desc.swizzle.a),
+  };
 
-void lvk::CommandBuffer::cmdDrawIndirect(BufferHandle indirectBuffer, size_t indirectBufferOffset, uint32_t drawCount, uint32_t stride) {
-  LVK_PROFILER_FUNCTION();
+  VkImageView view =
+      image->createImageView(imageViewType, vkFormat, aspect, 0, VK_REMAINING_MIP_LEVELS, 0, arrayLayerCount, mapping, debugNameImageView);
 
-  lvk::VulkanBuffer* bufIndirect = ctx_->buffersPool_.get(indirectBuffer);
+  if (!LVK_VERIFY(view != VK_NULL_HANDLE)) {
+    Result::setResult(outResult, Result::Code::RuntimeError, "Cannot create VkImageView");
+    return {};
+  }
 
-  LVK_ASSERT(bufIndirect);
+  TextureHandle handle = texturesPool_.create(lvk::VulkanTexture(std::move(image), view));
 
-  vkCmdDrawIndirect(
-      wrapper_->cmdBuf_, bufIndirect->vkBuffer_, indirectBufferOffset, drawCount, stride ? stride : sizeof(VkDrawIndirectCommand));
-}
+  if (!LVK_VERIFY(!handle.empty())) {
+    Result::setResult(outResult, Result::Code::RuntimeError, "Too many textures");
+    return {};
+  }
 
-void lvk::CommandBuffer::cmdDrawIndexedIndirect(BufferHandle indirectBuffer,
-                                                size_t indirectBufferOffset,
-                                                uint32_t drawCount,
-                                                uint32_t stride) {
-  LVK_PROFILER_FUNCTION();
+  if (desc.data) {
+    LVK_ASSERT(desc.type == TextureType_2D || desc.type == TextureType_Cube);
+    LVK_ASSERT(desc.dataNumMipLevels <= desc.numMipLevels);
+    const uint32_t numLayers = desc.type == TextureType_Cube ? 6 : 1;
+    Result res = upload(handle, {.dimensions = desc.dimensions, .numLayers = numLayers, .numMipLevels = desc.dataNumMipLevels}, desc.data);
+    if (!res.isOk()) {
+      Result::setResult(outResult, res);
+      return {};
+    }
+  }
 
-  lvk::VulkanBuffer* bufIndirect = ctx_->buffersPool_.get(indirectBuffer);
+  checkMemoryBudget();
 
-  LVK_ASSERT(bufIndirect);
+  Result::setResult(outResult, Result());
 
-  vkCmdDrawIndexedIndirect(
-      wrapper_->cmdBuf_, bufIndirect->vkBuffer_, indirectBufferOffset, drawCount, stride ? stride : sizeof(VkDrawIndexedIndirectCommand));
+  return {this, handle};
 }
 
-void lvk::CommandBuffer::cmdDrawIndexedIndirectCount(BufferHandle indirectBuffer,
-                                                     size_t indirectBufferOffset,
-                                                     BufferHandle countBuffer,
-                                                     size_t countBufferOffset,
-                                                     uint32_t maxDrawCount,
-                                                     uint32_t stride) {
-  LVK_PROFILER_FUNCTION();
-
-  lvk::VulkanBuffer* bufIndirect = ctx_->buffersPool_.get(indirectBuffer);
-  lvk::VulkanBuffer* bufCount = ctx_->buffersPool_.get(countBuffer);
+lvk::Holder<lvk::TextureHandle> lvk::VulkanContext::createTextureView(lvk::TextureHandle texture,
+                                                                      const TextureViewDesc& desc,
+                                                                      const char* debugName,
+                                                                      Result* outResult) {
+  const lvk::VulkanTexture* tex = texturesPool_.get(texture);
 
-  LVK_ASSERT(bufIndirect);
-  LVK_ASSERT(bufCount);
+  if (!LVK_VERIFY(tex && !tex->image_->isSwapchainImage_)) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Invalid texture");
+    return {};
+  }
 
-  vkCmdDrawIndexedIndirectCount(wrapper_->cmdBuf_,
-                                bufIndirect->vkBuffer_,
-                                indirectBufferOffset,
-                                bufCount->vkBuffer_,
-                                countBufferOffset,
-                                maxDrawCount,
-                                stride ? stride : sizeof(VkDrawIndexedIndirectCommand));
-}
+  // the view keeps the image alive
+  std::shared_ptr<lvk::VulkanImage> image = tex->image_;
 
-void lvk::CommandBuffer::cmdSetBlendColor(const float color[4]) {
-  vkCmdSetBlendConstants(wrapper_->cmdBuf_, color);
-}
+  if (!LVK_VERIFY(desc.numMipLevels && desc.numLayers && desc.mipLevel + desc.numMipLevels <= image->numLevels_ &&
+                  desc.layer + desc.numLayers <= image->numLayers_)) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "The view exceeds the mip-levels or layers of the texture");
+    return {};
+  }
 
-void lvk::CommandBuffer::cmdSetDepthBias(float depthBias, float slopeScale, float clamp) {
-  vkCmdSetDepthBias(wrapper_->cmdBuf_, depthBias, clamp, slopeScale);
-  vkCmdSetDepthBiasEnable(wrapper_->cmdBuf_, depthBias != 0);
-}
+  const VkFormat viewFormat = desc.format != Format_Invalid ? formatToVkFormat(desc.format) : image->vkImageFormat_;
 
-void lvk::CommandBuffer::cmdResetQueryPool(QueryPoolHandle pool, uint32_t firstQuery, uint32_t queryCount) {
-  VkQueryPool vkPool = *ctx_->queriesPool_.get(pool);
+  if (viewFormat != image->vkImageFormat_ && !(image->isMutableFormat_ && viewFormat == getSRGBAliasVkFormat(image->vkImageFormat_))) {
+    Result::setResult(outResult,
+                      Result::Code::ArgumentOutOfRange,
+                      "Only storage textures with sRGB formats can be viewed with their UNORM formats (and vice versa)");
+    return {};
+  }
 
-  vkCmdResetQueryPool(wrapper_->cmdBuf_, vkPool, firstQuery, queryCount);
-}
+  VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D;
 
-void lvk::CommandBuffer::cmdWriteTimestamp(QueryPoolHandle pool, uint32_t query) {
-  VkQueryPool vkPool = *ctx_->queriesPool_.get(pool);
+  switch (desc.type) {
+  case TextureType_2D:
+    if (!LVK_VERIFY(image->vkType_ == VK_IMAGE_TYPE_2D)) {
+      Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "2D views require a 2D or cube texture");
+      return {};
+    }
+    viewType = desc.numLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+    break;
+  case TextureType_3D:
+    if (!LVK_VERIFY(image->vkType_ == VK_IMAGE_TYPE_3D && desc.layer == 0 && desc.numLayers == 1)) {
+      Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "3D views require a 3D texture and exactly 1 layer");
+      return {};
+    }
+    viewType = VK_IMAGE_VIEW_TYPE_3D;
+    break;
+  case TextureType_Cube:
+    // `imageCubeArray` is not enabled: only single cube views are allowed
+    if (!LVK_VERIFY(image->isCubeCompatible_ && desc.numLayers == 6)) {
+      Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Cube views require a cube texture and exactly 6 layers");
+      return {};
+    }
+    viewType = VK_IMAGE_VIEW_TYPE_CUBE;
+    break;
+  default:
+    LVK_ASSERT_MSG(false, "Code should NOT be reached");
+    Result::setResult(outResult, Result::Code::RuntimeError, "Unsupported texture view type");
+    return {};
+  }
 
-  vkCmdWriteTimestamp(wrapper_->cmdBuf_, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkPool, query);
-}
+  const VkImageAspectFlags aspect = image->isDepthFormat_     ? VK_IMAGE_ASPECT_DEPTH_BIT
+                                    : image->isStencilFormat_ ? VK_IMAGE_ASPECT_STENCIL_BIT
+                                                              : VK_IMAGE_ASPECT_COLOR_BIT;
 
-lvk::VulkanStagingDevice::VulkanStagingDevice(VulkanContext& ctx) : ctx_(ctx) {
-  LVK_PROFILER_FUNCTION();
+  const VkComponentMapping mapping = {
+      .r = VkComponentSwizzle(desc.swizzle.r),
+      .g = VkComponentSwizzle(desc.swizzle.g),
+      .b = VkComponentSwizzle(desc.swizzle.b),
+      .a = VkComponentSwizzle(desc.swizzle.a),
+  };
 
-  const auto& limits = ctx_.getVkPhysicalDeviceProperties().limits;
+  char debugNameImageView[256] = {0};
 
-  // use default value of 128Mb clamped to the max limits
-  maxBufferSize_ = std::min(limits.maxStorageBufferRange, 128u * 1024u * 1024u);
+  if (debugName && *debugName) {
+    snprintf(debugNameImageView, sizeof(debugNameImageView) - 1, "Image View: %s", debugName);
+  }
 
-  LVK_ASSERT(minBufferSize_ <= maxBufferSize_);
+  VkImageView view = image->createImageView(
+      viewType, viewFormat, aspect, desc.mipLevel, desc.numMipLevels, desc.layer, desc.numLayers, mapping, debugNameImageView);
 
-  immediate_ = std::make_unique<lvk::VulkanImmediateCommands>(
-      ctx_.getVkDevice(), ctx_.deviceQueues_.graphicsQueueFamilyIndex, "VulkanStagingDevice::immediate_");
-}
+  if (!LVK_VERIFY(view != VK_NULL_HANDLE)) {
+    Result::setResult(outResult, Result::Code::RuntimeError, "Cannot create VkImageView");
+    return {};
+  }
 
-void lvk::VulkanStagingDevice::bufferSubData(VulkanBuffer& buffer, size_t dstOffset, size_t size, const void* data) {
-  LVK_PROFILER_FUNCTION();
+  TextureHandle handle = texturesPool_.create(lvk::VulkanTexture(std::move(image), view, viewFormat));
 
-  if (buffer.isMapped()) {
-    buffer.bufferSubData(dstOffset, size, data);
-    return;
+  if (!LVK_VERIFY(!handle.empty())) {
+    Result::setResult(outResult, Result::Code::RuntimeError, "Too many textures");
+    return {};
   }
 
-  lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+  Result::setResult(outResult, Result());
 
-  while (size) {
-    // get next staging buffer free offset
-    MemoryRegionDesc desc = getNextFreeOffset((uint32_t)size);
-    const uint32_t chunkSize = std::min((uint32_t)size, desc.size_);
+  return {this, handle};
+}
 
-    // copy data into staging buffer
-    stagingBuffer->bufferSubData(desc.offset_, chunkSize, data);
+VkPipeline lvk::VulkanContext::getVkPipeline(RenderPipelineHandle handle) {
+  // Pipelines are lazily created while recording command buffers which can happen on multiple threads. The pool is accessed
+  // under the lock, but pipelines are compiled outside of it, so threads do not wait behind each other's compilations.
+  RenderPipelineState snapshot;
+  RenderPipelineShaders shaders;
+  VkDescriptorSetLayout dsl = VK_NULL_HANDLE;
+  {
+    std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-    // do the transfer
-    const VkBufferCopy copy = {
-        .srcOffset = desc.offset_,
-        .dstOffset = dstOffset,
-        .size = chunkSize,
-    };
+    lvk::RenderPipelineState* rps = renderPipelinesPool_.get(handle);
 
-    auto& wrapper = immediate_->acquire();
-    vkCmdCopyBuffer(wrapper.cmdBuf_, stagingBuffer->vkBuffer_, buffer.vkBuffer_, 1, &copy);
-    VkBufferMemoryBarrier barrier = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-        .dstAccessMask = 0,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .buffer = buffer.vkBuffer_,
-        .offset = dstOffset,
-        .size = chunkSize,
-    };
-    VkPipelineStageFlags dstMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-    if (buffer.vkUsageFlags_ & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) {
-      dstMask |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
-      barrier.dstAccessMask |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    if (!rps) {
+      return VK_NULL_HANDLE;
     }
-    if (buffer.vkUsageFlags_ & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
-      dstMask |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
-      barrier.dstAccessMask |= VK_ACCESS_INDEX_READ_BIT;
+
+    if (rps->lastVkDescriptorSetLayout_ != vkDSL_) {
+      deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = getVkDevice(), pipeline = rps->pipeline_]() {
+        vkDT.vkDestroyPipeline(device, pipeline, nullptr);
+      }));
+      deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = getVkDevice(), layout = rps->pipelineLayout_]() {
+        vkDT.vkDestroyPipelineLayout(device, layout, nullptr);
+      }));
+      rps->pipeline_ = VK_NULL_HANDLE;
+      rps->pipelineLayout_ = VK_NULL_HANDLE;
+      rps->lastVkDescriptorSetLayout_ = vkDSL_;
     }
-    if (buffer.vkUsageFlags_ & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT) {
-      dstMask |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
-      barrier.dstAccessMask |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+    if (rps->pipeline_ != VK_NULL_HANDLE) {
+      return rps->pipeline_;
     }
-    vkCmdPipelineBarrier(
-        wrapper.cmdBuf_, VK_PIPELINE_STAGE_TRANSFER_BIT, dstMask, VkDependencyFlags{}, 0, nullptr, 1, &barrier, 0, nullptr);
-    desc.handle_ = immediate_->submit(wrapper);
-    regions_.push_back(desc);
 
-    size -= chunkSize;
-    data = (uint8_t*)data + chunkSize;
-    dstOffset += chunkSize;
+    snapshot = *rps;
+    shaders = getRenderPipelineShaders(rps->desc_);
+    dsl = vkDSL_;
   }
-}
-
-void lvk::VulkanStagingDevice::imageData2D(VulkanImage& image,
-                                           const VkRect2D& imageRegion,
-                                           uint32_t baseMipLevel,
-                                           uint32_t numMipLevels,
-                                           uint32_t layer,
-                                           uint32_t numLayers,
-                                           VkFormat format,
-                                           const void* data) {
-  LVK_PROFILER_FUNCTION();
 
-  LVK_ASSERT(numMipLevels <= LVK_MAX_MIP_LEVELS);
+  VkPipelineLayout layout = VK_NULL_HANDLE;
+  VkShaderStageFlags stageFlags = 0;
+  VkPipeline pipeline = createVkPipeline(snapshot, shaders, dsl, &layout, &stageFlags);
 
-  // divide the width and height by 2 until we get to the size of level 'baseMipLevel'
-  uint32_t width = image.vkExtent_.width >> baseMipLevel;
-  uint32_t height = image.vkExtent_.height >> baseMipLevel;
+  bool isStale = false;
 
-  const Format texFormat(vkFormatToFormat(format));
+  pipeline = installVkPipeline(handle, dsl, pipeline, layout, stageFlags, &isStale);
 
-  LVK_ASSERT_MSG(!imageRegion.offset.x && !imageRegion.offset.y && imageRegion.extent.width == width && imageRegion.extent.height == height,
-                 "Uploading mip-levels with an image region that is smaller than the base mip level is not supported");
+  // a new descriptor set layout has been created while compiling
+  return isStale ? getVkPipeline(handle) : pipeline;
+}
 
-  // find the storage size for all mip-levels being uploaded
-  uint32_t layerStorageSize = 0;
-  for (uint32_t i = 0; i < numMipLevels; ++i) {
-    const uint32_t mipSize = lvk::getTextureBytesPerLayer(image.vkExtent_.width, image.vkExtent_.height, texFormat, i);
-    layerStorageSize += mipSize;
-    width = width <= 1 ? 1 : width >> 1;
-    height = height <= 1 ? 1 : height >> 1;
-  }
-  const uint32_t storageSize = layerStorageSize * numLayers;
+VkPipeline lvk::VulkanContext::installVkPipeline(RenderPipelineHandle handle,
+                                                 VkDescriptorSetLayout dsl,
+                                                 VkPipeline pipeline,
+                                                 VkPipelineLayout layout,
+                                                 VkShaderStageFlags stageFlags,
+                                                 bool* outIsStale) {
+  std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-  ensureStagingBufferSize(storageSize);
+  lvk::RenderPipelineState* rps = renderPipelinesPool_.isValid(handle) ? renderPipelinesPool_.get(handle) : nullptr;
 
-  LVK_ASSERT(storageSize <= stagingBufferSize_);
+  const bool isInstalled = rps && rps->pipeline_ && rps->lastVkDescriptorSetLayout_ == dsl;
 
-  MemoryRegionDesc desc = getNextFreeOffset(storageSize);
-  // No support for copying image in multiple smaller chunk sizes. If we get smaller buffer size than storageSize, we will wait for GPU idle
-  // and get bigger chunk.
-  if (desc.size_ < storageSize) {
-    waitAndReset();
-    desc = getNextFreeOffset(storageSize);
+  // the pipeline might have been destroyed, compiled by another thread, or invalidated by a new descriptor set layout in the meantime
+  if (!rps || dsl != vkDSL_ || isInstalled) {
+    vkDT_.vkDestroyPipeline(vkDevice_, pipeline, nullptr);
+    vkDT_.vkDestroyPipelineLayout(vkDevice_, layout, nullptr);
+    if (outIsStale) {
+      *outIsStale = rps && dsl != vkDSL_;
+    }
+    return rps && dsl == vkDSL_ ? rps->pipeline_ : VK_NULL_HANDLE;
   }
-  LVK_ASSERT(desc.size_ >= storageSize);
 
-  auto& wrapper = immediate_->acquire();
+  if (rps->pipeline_) {
+    deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = vkDevice_, pipeline = rps->pipeline_]() {
+      vkDT.vkDestroyPipeline(device, pipeline, nullptr);
+    }));
+    deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = vkDevice_, layout = rps->pipelineLayout_]() {
+      vkDT.vkDestroyPipelineLayout(device, layout, nullptr);
+    }));
+  }
 
-  lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+  rps->pipeline_ = pipeline;
+  rps->pipelineLayout_ = layout;
+  rps->shaderStageFlags_ = stageFlags;
+  rps->lastVkDescriptorSetLayout_ = dsl;
 
-  stagingBuffer->bufferSubData(desc.offset_, storageSize, data);
+  return pipeline;
+}
 
-  uint32_t offset = 0;
+lvk::RenderPipelineShaders lvk::VulkanContext::getRenderPipelineShaders(const RenderPipelineDesc& desc) const {
+  auto getModule = [this](ShaderModuleHandle handle) {
+    const lvk::ShaderModuleState* sm = shaderModulesPool_.get(handle);
+    return sm ? *sm : lvk::ShaderModuleState{};
+  };
 
-  // https://registry.khronos.org/KTX/specs/1.0/ktxspec.v1.html
-  for (uint32_t mipLevel = 0; mipLevel < numMipLevels; ++mipLevel) {
-    for (uint32_t layer = 0; layer != numLayers; layer++) {
-      const auto currentMipLevel = baseMipLevel + mipLevel;
+  return {
+      .vert = getModule(desc.smVert),
+      .tesc = getModule(desc.smTesc),
+      .tese = getModule(desc.smTese),
+      .geom = getModule(desc.smGeom),
+      .frag = getModule(desc.smFrag),
+      .task = getModule(desc.smTask),
+      .mesh = getModule(desc.smMesh),
+  };
+}
 
-      LVK_ASSERT(currentMipLevel < image.numLevels_);
-      LVK_ASSERT(mipLevel < image.numLevels_);
+VkPipeline lvk::VulkanContext::createVkPipeline(const RenderPipelineState& rps,
+                                                const RenderPipelineShaders& shaders,
+                                                VkDescriptorSetLayout dsl,
+                                                VkPipelineLayout* outLayout,
+                                                VkShaderStageFlags* outStageFlags) const {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
 
-      // 1. Transition initial image layout into TRANSFER_DST_OPTIMAL
-      lvk::imageMemoryBarrier(wrapper.cmdBuf_,
-                              image.vkImage_,
-                              0,
-                              VK_ACCESS_TRANSFER_WRITE_BIT,
-                              VK_IMAGE_LAYOUT_UNDEFINED,
-                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                              VK_PIPELINE_STAGE_TRANSFER_BIT,
-                              VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, currentMipLevel, 1, layer, 1});
+  const uint64_t beginNs = getTimeNs();
 
-#if LVK_VULKAN_PRINT_COMMANDS
-      LLOGL("%p vkCmdCopyBufferToImage()\n", wrapper.cmdBuf_);
-#endif // LVK_VULKAN_PRINT_COMMANDS
-      // 2. Copy the pixel data from the staging buffer into the image
-      const VkRect2D region = {
-          .offset = {.x = imageRegion.offset.x >> mipLevel, .y = imageRegion.offset.y >> mipLevel},
-          .extent = {.width = std::max(1u, imageRegion.extent.width >> mipLevel),
-                     .height = std::max(1u, imageRegion.extent.height >> mipLevel)},
-      };
-      const VkBufferImageCopy copy = {
-          // the offset for this level is at the start of all mip-levels plus the size of all previous mip-levels being uploaded
-          .bufferOffset = desc.offset_ + offset,
-          .bufferRowLength = 0,
-          .bufferImageHeight = 0,
-          .imageSubresource = VkImageSubresourceLayers{VK_IMAGE_ASPECT_COLOR_BIT, currentMipLevel, layer, 1},
-          .imageOffset = {.x = region.offset.x, .y = region.offset.y, .z = 0},
-          .imageExtent = {.width = region.extent.width, .height = region.extent.height, .depth = 1u},
-      };
-      vkCmdCopyBufferToImage(wrapper.cmdBuf_, stagingBuffer->vkBuffer_, image.vkImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+  SCOPE_EXIT {
+    frameCounters_.numPipelineCompiles++;
+    frameCounters_.pipelineCompileTimeNs += getTimeNs() - beginNs;
+  };
 
-      // 3. Transition TRANSFER_DST_OPTIMAL into SHADER_READ_ONLY_OPTIMAL
-      lvk::imageMemoryBarrier(wrapper.cmdBuf_,
-                              image.vkImage_,
-                              VK_ACCESS_TRANSFER_WRITE_BIT,
-                              VK_ACCESS_SHADER_READ_BIT,
-                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                              VK_PIPELINE_STAGE_TRANSFER_BIT,
-                              VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                              VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, currentMipLevel, 1, layer, 1});
+  // build a new Vulkan pipeline
 
-      offset += lvk::getTextureBytesPerLayer(imageRegion.extent.width, imageRegion.extent.height, texFormat, currentMipLevel);
-    }
-  }
+  VkPipelineLayout layout = VK_NULL_HANDLE;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkShaderStageFlags stageFlags = 0;
 
-  image.vkImageLayout_ = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  const RenderPipelineDesc& desc = rps.desc_;
 
-  desc.handle_ = immediate_->submit(wrapper);
-  regions_.push_back(desc);
-}
+  const uint32_t numColorAttachments = desc.getNumColorAttachments();
 
-void lvk::VulkanStagingDevice::imageData3D(VulkanImage& image,
-                                           const VkOffset3D& offset,
-                                           const VkExtent3D& extent,
-                                           VkFormat format,
-                                           const void* data) {
-  LVK_PROFILER_FUNCTION();
-  LVK_ASSERT_MSG(image.numLevels_ == 1, "Can handle only 3D images with exactly 1 mip-level");
-  LVK_ASSERT_MSG((offset.x == 0) && (offset.y == 0) && (offset.z == 0), "Can upload only full-size 3D images");
-  const uint32_t storageSize = extent.width * extent.height * extent.depth * getBytesPerPixel(format);
+  // Not all attachments are valid. We need to create color blend attachments only for active attachments
+  VkPipelineColorBlendAttachmentState colorBlendAttachmentStates[LVK_MAX_COLOR_ATTACHMENTS] = {};
+  VkFormat colorAttachmentFormats[LVK_MAX_COLOR_ATTACHMENTS] = {};
 
-  ensureStagingBufferSize(storageSize);
+  for (uint32_t i = 0; i != numColorAttachments; i++) {
+    const auto& attachment = desc.color[i];
+    LVK_ASSERT(attachment.format != Format_Invalid);
+    colorAttachmentFormats[i] = formatToVkFormat(attachment.format);
+    if (!attachment.blendEnabled) {
+      colorBlendAttachmentStates[i] = VkPipelineColorBlendAttachmentState{
+          .blendEnable = VK_FALSE,
+          .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+          .dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
+          .colorBlendOp = VK_BLEND_OP_ADD,
+          .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+          .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+          .alphaBlendOp = VK_BLEND_OP_ADD,
+          .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+      };
+    } else {
+      colorBlendAttachmentStates[i] = VkPipelineColorBlendAttachmentState{
+          .blendEnable = VK_TRUE,
+          .srcColorBlendFactor = blendFactorToVkBlendFactor(attachment.srcRGBBlendFactor),
+          .dstColorBlendFactor = blendFactorToVkBlendFactor(attachment.dstRGBBlendFactor),
+          .colorBlendOp = blendOpToVkBlendOp(attachment.rgbBlendOp),
+          .srcAlphaBlendFactor = blendFactorToVkBlendFactor(attachment.srcAlphaBlendFactor),
+          .dstAlphaBlendFactor = blendFactorToVkBlendFactor(attachment.dstAlphaBlendFactor),
+          .alphaBlendOp = blendOpToVkBlendOp(attachment.alphaBlendOp),
+          .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+      };
+    }
+  }
 
-  LVK_ASSERT_MSG(storageSize <= stagingBufferSize_, "No support for copying image in multiple smaller chunk sizes");
+  const lvk::ShaderModuleState* vertModule = shaders.vert.sm ? &shaders.vert : nullptr;
+  const lvk::ShaderModuleState* tescModule = shaders.tesc.sm ? &shaders.tesc : nullptr;
+  const lvk::ShaderModuleState* teseModule = shaders.tese.sm ? &shaders.tese : nullptr;
+  const lvk::ShaderModuleState* geomModule = shaders.geom.sm ? &shaders.geom : nullptr;
+  const lvk::ShaderModuleState* fragModule = shaders.frag.sm ? &shaders.frag : nullptr;
+  const lvk::ShaderModuleState* taskModule = shaders.task.sm ? &shaders.task : nullptr;
+  const lvk::ShaderModuleState* meshModule = shaders.mesh.sm ? &shaders.mesh : nullptr;
 
-  // get next staging buffer free offset
-  MemoryRegionDesc desc = getNextFreeOffset(storageSize);
+  LVK_ASSERT_MSG(vertModule || meshModule, "Either a vertex shader or a mesh shader should be provided");
+  LVK_ASSERT_MSG(!meshModule || (!vertModule && !tescModule && !teseModule && !geomModule),
+                 "Mesh shaders cannot be combined with vertex, tessellation, or geometry shaders");
+  LVK_ASSERT_MSG(!taskModule || meshModule, "A task shader requires a mesh shader");
+  LVK_ASSERT(fragModule);
 
-  // No support for copying image in multiple smaller chunk sizes.
-  // If we get smaller buffer size than storageSize, we will wait for GPU idle and get a bigger chunk.
-  if (desc.size_ < storageSize) {
-    waitAndReset();
-    desc = getNextFreeOffset(storageSize);
+  if (tescModule || teseModule || desc.patchControlPoints) {
+    LVK_ASSERT_MSG(tescModule && teseModule, "Both tessellation control and evaluation shaders should be provided");
+    LVK_ASSERT(desc.patchControlPoints > 0 &&
+               desc.patchControlPoints <= vkPhysicalDeviceProperties2_.properties.limits.maxTessellationPatchSize);
   }
 
-  LVK_ASSERT(desc.size_ >= storageSize);
+  const VkPipelineVertexInputStateCreateInfo ciVertexInputState = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+      .vertexBindingDescriptionCount = rps.numBindings_,
+      .pVertexBindingDescriptions = rps.numBindings_ ? rps.vkBindings_ : nullptr,
+      .vertexAttributeDescriptionCount = rps.numAttributes_,
+      .pVertexAttributeDescriptions = rps.numAttributes_ ? rps.vkAttributes_ : nullptr,
+  };
 
-  lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+  VkSpecializationMapEntry entries[SpecializationConstantDesc::LVK_SPECIALIZATION_CONSTANTS_MAX] = {};
 
-  // 1. Copy the pixel data into the host visible staging buffer
-  stagingBuffer->bufferSubData(desc.offset_, storageSize, data);
+  const VkSpecializationInfo si = lvk::getPipelineShaderStageSpecializationInfo(desc.specInfo, entries);
 
-  auto& wrapper = immediate_->acquire();
+  // create pipeline layout
+  {
+#define UPDATE_PUSH_CONSTANT_SIZE(sm, bit)                                  \
+  if (sm) {                                                                 \
+    pushConstantsSize = std::max(pushConstantsSize, sm->pushConstantsSize); \
+    stageFlags |= bit;                                                      \
+  }
+    uint32_t pushConstantsSize = 0;
+    UPDATE_PUSH_CONSTANT_SIZE(vertModule, VK_SHADER_STAGE_VERTEX_BIT);
+    UPDATE_PUSH_CONSTANT_SIZE(tescModule, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT);
+    UPDATE_PUSH_CONSTANT_SIZE(teseModule, VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT);
+    UPDATE_PUSH_CONSTANT_SIZE(geomModule, VK_SHADER_STAGE_GEOMETRY_BIT);
+    UPDATE_PUSH_CONSTANT_SIZE(fragModule, VK_SHADER_STAGE_FRAGMENT_BIT);
+    UPDATE_PUSH_CONSTANT_SIZE(taskModule, VK_SHADER_STAGE_TASK_BIT_EXT);
+    UPDATE_PUSH_CONSTANT_SIZE(meshModule, VK_SHADER_STAGE_MESH_BIT_EXT);
+#undef UPDATE_PUSH_CONSTANT_SIZE
 
-  // 1. Transition initial image layout into TRANSFER_DST_OPTIMAL
-  lvk::imageMemoryBarrier(wrapper.cmdBuf_,
-                          image.vkImage_,
-                          0,
-                          VK_ACCESS_TRANSFER_WRITE_BIT,
-                          VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                          VK_PIPELINE_STAGE_TRANSFER_BIT,
-                          VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
+    // maxPushConstantsSize is guaranteed to be at least 128 bytes
+    // https://www.khronos.org/registry/vulkan/specs/1.3/html/vkspec.html#features-limits
+    // Table 32. Required Limits
+    const VkPhysicalDeviceLimits& limits = getVkPhysicalDeviceProperties().limits;
+    if (!LVK_VERIFY(pushConstantsSize <= limits.maxPushConstantsSize)) {
+      LLOGW("Push constants size exceeded %u (max %u bytes)", pushConstantsSize, limits.maxPushConstantsSize);
+    }
 
-  // 2. Copy the pixel data from the staging buffer into the image
-  const VkBufferImageCopy copy = {
-      .bufferOffset = desc.offset_,
-      .bufferRowLength = 0,
-      .bufferImageHeight = 0,
-      .imageSubresource = VkImageSubresourceLayers{VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-      .imageOffset = offset,
-      .imageExtent = extent,
-  };
-  vkCmdCopyBufferToImage(wrapper.cmdBuf_, stagingBuffer->vkBuffer_, image.vkImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+    // duplicate for MoltenVK
+    const VkDescriptorSetLayout dsls[] = {dsl, dsl, dsl, dsl};
+    const VkPushConstantRange range = {
+        .stageFlags = stageFlags,
+        .offset = 0,
+        .size = pushConstantsSize,
+    };
+    const VkPipelineLayoutCreateInfo ci = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = (uint32_t)LVK_ARRAY_NUM_ELEMENTS(dsls),
+        .pSetLayouts = dsls,
+        .pushConstantRangeCount = pushConstantsSize ? 1u : 0u,
+        .pPushConstantRanges = pushConstantsSize ? &range : nullptr,
+    };
+    VK_ASSERT(vkDT_.vkCreatePipelineLayout(vkDevice_, &ci, nullptr, &layout));
+    char pipelineLayoutName[256] = {0};
+    if (desc.debugName) {
+      snprintf(pipelineLayoutName, sizeof(pipelineLayoutName) - 1, "Pipeline Layout: %s", desc.debugName);
+    }
+    VK_ASSERT(lvk::setDebugObjectName(vkDT_, vkDevice_, VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)layout, pipelineLayoutName));
+  }
 
-  // 3. Transition TRANSFER_DST_OPTIMAL into SHADER_READ_ONLY_OPTIMAL
-  lvk::imageMemoryBarrier(wrapper.cmdBuf_,
-                          image.vkImage_,
-                          VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
-                          VK_ACCESS_SHADER_READ_BIT,
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                          VK_PIPELINE_STAGE_TRANSFER_BIT,
-                          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                          VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
+  lvk::VulkanPipelineBuilder()
+      // from Vulkan 1.0
+      .dynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+      .dynamicState(VK_DYNAMIC_STATE_SCISSOR)
+      .dynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS)
+      .dynamicState(VK_DYNAMIC_STATE_BLEND_CONSTANTS)
+      // from Vulkan 1.3 or VK_EXT_extended_dynamic_state
+      .dynamicState(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE)
+      .dynamicState(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE)
+      .dynamicState(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP)
+      // from Vulkan 1.3 or VK_EXT_extended_dynamic_state2
+      .dynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE)
+      .primitiveTopology(topologyToVkPrimitiveTopology(desc.topology))
+      .rasterizationSamples(getVulkanSampleCountFlags(desc.samplesCount))
+      .polygonMode(polygonModeToVkPolygonMode(desc.polygonMode))
+      .stencilStateOps(VK_STENCIL_FACE_FRONT_BIT,
+                       stencilOpToVkStencilOp(desc.frontFaceStencil.stencilFailureOp),
+                       stencilOpToVkStencilOp(desc.frontFaceStencil.depthStencilPassOp),
+                       stencilOpToVkStencilOp(desc.frontFaceStencil.depthFailureOp),
+                       compareOpToVkCompareOp(desc.frontFaceStencil.stencilCompareOp))
+      .stencilStateOps(VK_STENCIL_FACE_BACK_BIT,
+                       stencilOpToVkStencilOp(desc.backFaceStencil.stencilFailureOp),
+                       stencilOpToVkStencilOp(desc.backFaceStencil.depthStencilPassOp),
+                       stencilOpToVkStencilOp(desc.backFaceStencil.depthFailureOp),
+                       compareOpToVkCompareOp(desc.backFaceStencil.stencilCompareOp))
+      .stencilMasks(VK_STENCIL_FACE_FRONT_BIT, 0xFF, desc.frontFaceStencil.writeMask, desc.frontFaceStencil.readMask)
+      .stencilMasks(VK_STENCIL_FACE_BACK_BIT, 0xFF, desc.backFaceStencil.writeMask, desc.backFaceStencil.readMask)
+      .shaderStage(vertModule
+                       ? lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_VERTEX_BIT, vertModule->sm, desc.entryPointVert, &si)
+                       : VkPipelineShaderStageCreateInfo{.module = VK_NULL_HANDLE})
+      .shaderStage(lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT, fragModule->sm, desc.entryPointFrag, &si))
+      .shaderStage(tescModule ? lvk::getPipelineShaderStageCreateInfo(
+                                    VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, tescModule->sm, desc.entryPointTesc, &si)
+                              : VkPipelineShaderStageCreateInfo{.module = VK_NULL_HANDLE})
+      .shaderStage(teseModule ? lvk::getPipelineShaderStageCreateInfo(
+                                    VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, teseModule->sm, desc.entryPointTese, &si)
+                              : VkPipelineShaderStageCreateInfo{.module = VK_NULL_HANDLE})
+      .shaderStage(geomModule
+                       ? lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_GEOMETRY_BIT, geomModule->sm, desc.entryPointGeom, &si)
+                       : VkPipelineShaderStageCreateInfo{.module = VK_NULL_HANDLE})
+      .shaderStage(taskModule
+                       ? lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_TASK_BIT_EXT, taskModule->sm, desc.entryPointTask, &si)
+                       : VkPipelineShaderStageCreateInfo{.module = VK_NULL_HANDLE})
+      .shaderStage(meshModule
+                       ? lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_MESH_BIT_EXT, meshModule->sm, desc.entryPointMesh, &si)
+                       : VkPipelineShaderStageCreateInfo{.module = VK_NULL_HANDLE})
+      .cullMode(cullModeToVkCullMode(desc.cullMode))
+      .frontFace(windingModeToVkFrontFace(desc.frontFaceWinding))
+      .vertexInputState(ciVertexInputState)
+      .colorAttachments(colorBlendAttachmentStates, colorAttachmentFormats, numColorAttachments)
+      .depthAttachmentFormat(formatToVkFormat(desc.depthFormat))
+      .stencilAttachmentFormat(formatToVkFormat(desc.stencilFormat))
+      .patchControlPoints(desc.patchControlPoints)
+      .build(vkDT_, vkDevice_, pipelineCache_, layout, &pipeline, desc.debugName);
 
-  image.vkImageLayout_ = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  *outLayout = layout;
+  *outStageFlags = stageFlags;
 
-  desc.handle_ = immediate_->submit(wrapper);
-  regions_.push_back(desc);
+  return pipeline;
 }
 
-void lvk::VulkanStagingDevice::getImageData(VulkanImage& image,
-                                            const VkOffset3D& offset,
-                                            const VkExtent3D& extent,
-                                            VkImageSubresourceRange range,
-                                            VkFormat format,
-                                            void* outData) {
-  LVK_ASSERT(image.vkImageLayout_ != VK_IMAGE_LAYOUT_UNDEFINED);
-  LVK_ASSERT(range.layerCount == 1);
-
-  const uint32_t storageSize = extent.width * extent.height * extent.depth * getBytesPerPixel(format);
-
-  LVK_ASSERT(storageSize <= stagingBufferSize_);
-
-  // get next staging buffer free offset
-  MemoryRegionDesc desc = getNextFreeOffset(storageSize);
-
-  // No support for copying image in multiple smaller chunk sizes.
-  // If we get smaller buffer size than storageSize, we will wait for GPU idle and get a bigger chunk.
-  if (desc.size_ < storageSize) {
-    waitAndReset();
-    desc = getNextFreeOffset(storageSize);
-  }
+VkPipeline lvk::VulkanContext::getVkPipeline(ComputePipelineHandle handle) {
+  // see getVkPipeline(RenderPipelineHandle)
+  ComputePipelineState snapshot;
+  ShaderModuleState sm;
+  VkDescriptorSetLayout dsl = VK_NULL_HANDLE;
+  {
+    std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-  LVK_ASSERT(desc.size_ >= storageSize);
+    lvk::ComputePipelineState* cps = computePipelinesPool_.get(handle);
 
-  lvk::VulkanBuffer* stagingBuffer = ctx_.buffersPool_.get(stagingBuffer_);
+    if (!cps) {
+      return VK_NULL_HANDLE;
+    }
 
-  auto& wrapper1 = immediate_->acquire();
+    if (cps->lastVkDescriptorSetLayout_ != vkDSL_) {
+      deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = vkDevice_, pipeline = cps->pipeline_]() {
+        vkDT.vkDestroyPipeline(device, pipeline, nullptr);
+      }));
+      deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = vkDevice_, layout = cps->pipelineLayout_]() {
+        vkDT.vkDestroyPipelineLayout(device, layout, nullptr);
+      }));
+      cps->pipeline_ = VK_NULL_HANDLE;
+      cps->pipelineLayout_ = VK_NULL_HANDLE;
+      cps->lastVkDescriptorSetLayout_ = vkDSL_;
+    }
 
-  // 1. Transition to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
-  lvk::imageMemoryBarrier(wrapper1.cmdBuf_,
-                          image.vkImage_,
-                          0, // srcAccessMask
-                          VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, // dstAccessMask
-                          image.vkImageLayout_,
-                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                          VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, // wait for all previous operations
-                          VK_PIPELINE_STAGE_TRANSFER_BIT, // dstStageMask
-                          range);
+    if (cps->pipeline_ != VK_NULL_HANDLE) {
+      return cps->pipeline_;
+    }
 
-  // 2.  Copy the pixel data from the image into the staging buffer
-  const VkBufferImageCopy copy = {
-      .bufferOffset = desc.offset_,
-      .bufferRowLength = 0,
-      .bufferImageHeight = extent.height,
-      .imageSubresource =
-          VkImageSubresourceLayers{
-              .aspectMask = range.aspectMask,
-              .mipLevel = range.baseMipLevel,
-              .baseArrayLayer = range.baseArrayLayer,
-              .layerCount = range.layerCount,
-          },
-      .imageOffset = offset,
-      .imageExtent = extent,
-  };
-  vkCmdCopyImageToBuffer(wrapper1.cmdBuf_, image.vkImage_, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer->vkBuffer_, 1, &copy);
+    const lvk::ShaderModuleState* state = shaderModulesPool_.get(cps->desc_.smComp);
 
-  desc.handle_ = immediate_->submit(wrapper1);
-  regions_.push_back(desc);
+    LVK_ASSERT(state);
 
-  waitAndReset();
+    if (!state) {
+      return VK_NULL_HANDLE;
+    }
 
-  if (!stagingBuffer->isCoherentMemory_) {
-    stagingBuffer->invalidateMappedMemory(desc.offset_, desc.size_);
+    snapshot = *cps;
+    sm = *state;
+    dsl = vkDSL_;
   }
 
-  // 3. Copy data from staging buffer into data
-  memcpy(outData, stagingBuffer->getMappedPtr() + desc.offset_, storageSize);
+  VkPipelineLayout layout = VK_NULL_HANDLE;
+  VkPipeline pipeline = createVkPipeline(snapshot, sm, dsl, &layout);
 
-  // 4. Transition back to the initial image layout
-  auto& wrapper2 = immediate_->acquire();
+  bool isStale = false;
 
-  lvk::imageMemoryBarrier(wrapper2.cmdBuf_,
-                          image.vkImage_,
-                          VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, // srcAccessMask
-                          0, // dstAccessMask
-                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                          image.vkImageLayout_,
-                          VK_PIPELINE_STAGE_TRANSFER_BIT, // srcStageMask
-                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // dstStageMask
-                          range);
+  pipeline = installVkPipeline(handle, dsl, pipeline, layout, &isStale);
 
-  immediate_->wait(immediate_->submit(wrapper2));
+  // a new descriptor set layout has been created while compiling
+  return isStale ? getVkPipeline(handle) : pipeline;
 }
 
-void lvk::VulkanStagingDevice::ensureStagingBufferSize(uint32_t sizeNeeded) {
-  LVK_PROFILER_FUNCTION();
-
-  const uint32_t alignedSize = std::max(getAlignedSize(sizeNeeded), minBufferSize_);
+VkPipeline lvk::VulkanContext::installVkPipeline(ComputePipelineHandle handle,
+                                                 VkDescriptorSetLayout dsl,
+                                                 VkPipeline pipeline,
+                                                 VkPipelineLayout layout,
+                                                 bool* outIsStale) {
+  std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-  sizeNeeded = alignedSize < maxBufferSize_ ? alignedSize : maxBufferSize_;
+  lvk::ComputePipelineState* cps = computePipelinesPool_.isValid(handle) ? computePipelinesPool_.get(handle) : nullptr;
 
-  if (!stagingBuffer_.empty()) {
-    const bool isEnoughSize = sizeNeeded <= stagingBufferSize_;
-    const bool isMaxSize = stagingBufferSize_ == maxBufferSize_;
+  const bool isInstalled = cps && cps->pipeline_ && cps->lastVkDescriptorSetLayout_ == dsl;
 
-    if (isEnoughSize || isMaxSize) {
-      return;
+  if (!cps || dsl != vkDSL_ || isInstalled) {
+    vkDT_.vkDestroyPipeline(vkDevice_, pipeline, nullptr);
+    vkDT_.vkDestroyPipelineLayout(vkDevice_, layout, nullptr);
+    if (outIsStale) {
+      *outIsStale = cps && dsl != vkDSL_;
     }
+    return cps && dsl == vkDSL_ ? cps->pipeline_ : VK_NULL_HANDLE;
   }
 
-  waitAndReset();
-
-  // deallocate the previous staging buffer
-  stagingBuffer_ = nullptr;
-
-  // if the combined size of the new staging buffer and the existing one is larger than the limit imposed by some architectures on buffers
-  // that are device and host visible, we need to wait for the current buffer to be destroyed before we can allocate a new one
-  if ((sizeNeeded + stagingBufferSize_) > maxBufferSize_) {
-    ctx_.waitDeferredTasks();
+  if (cps->pipeline_) {
+    deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = vkDevice_, pipeline = cps->pipeline_]() {
+      vkDT.vkDestroyPipeline(device, pipeline, nullptr);
+    }));
+    deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = vkDevice_, layout = cps->pipelineLayout_]() {
+      vkDT.vkDestroyPipelineLayout(device, layout, nullptr);
+    }));
   }
 
-  stagingBufferSize_ = sizeNeeded;
-
-  char debugName[256] = {0};
-  snprintf(debugName, sizeof(debugName) - 1, "Buffer: staging buffer %u", stagingBufferCounter_++);
-
-  stagingBuffer_ = {&ctx_,
-                    ctx_.createBuffer(stagingBufferSize_,
-                                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
-                                      nullptr,
-                                      debugName)};
-  LVK_ASSERT(!stagingBuffer_.empty());
+  cps->pipeline_ = pipeline;
+  cps->pipelineLayout_ = layout;
+  cps->lastVkDescriptorSetLayout_ = dsl;
 
-  regions_.clear();
-  regions_.push_front({0, stagingBufferSize_, SubmitHandle()});
+  return pipeline;
 }
 
-lvk::VulkanStagingDevice::MemoryRegionDesc lvk::VulkanStagingDevice::getNextFreeOffset(uint32_t size) {
-  LVK_PROFILER_FUNCTION();
-
-  const uint32_t requestedAlignedSize = getAlignedSize(size);
-
-  ensureStagingBufferSize(requestedAlignedSize);
+VkPipeline lvk::VulkanContext::createVkPipeline(const ComputePipelineState& cps,
+                                                const ShaderModuleState& sm,
+                                                VkDescriptorSetLayout dsl,
+                                                VkPipelineLayout* outLayout) const {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_CREATE);
 
-  LVK_ASSERT(!regions_.empty());
+  const uint64_t beginNs = getTimeNs();
 
-  // if we can't find an available region that is big enough to store requestedAlignedSize, return whatever we could find, which will be
-  // stored in bestNextIt
-  auto bestNextIt = regions_.begin();
+  SCOPE_EXIT {
+    frameCounters_.numPipelineCompiles++;
+    frameCounters_.pipelineCompileTimeNs += getTimeNs() - beginNs;
+  };
 
-  for (auto it = regions_.begin(); it != regions_.end(); ++it) {
-    if (immediate_->isReady(it->handle_)) {
-      // This region is free, but is it big enough?
-      if (it->size_ >= requestedAlignedSize) {
-        // It is big enough!
-        const uint32_t unusedSize = it->size_ - requestedAlignedSize;
-        const uint32_t unusedOffset = it->offset_ + requestedAlignedSize;
+  VkSpecializationMapEntry entries[SpecializationConstantDesc::LVK_SPECIALIZATION_CONSTANTS_MAX] = {};
 
-        // Return this region and add the remaining unused size to the regions_ deque
-        SCOPE_EXIT {
-          regions_.erase(it);
-          if (unusedSize > 0) {
-            regions_.push_front({unusedOffset, unusedSize, SubmitHandle()});
-          }
-        };
+  const VkSpecializationInfo siComp = lvk::getPipelineShaderStageSpecializationInfo(cps.desc_.specInfo, entries);
 
-        return {it->offset_, requestedAlignedSize, SubmitHandle()};
-      }
-      // cache the largest available region that isn't as big as the one we're looking for
-      if (it->size_ > bestNextIt->size_) {
-        bestNextIt = it;
-      }
-    }
-  }
+  VkPipelineLayout layout = VK_NULL_HANDLE;
 
-  // we found a region that is available that is smaller than the requested size. It's the best we can do
-  if (bestNextIt != regions_.end() && immediate_->isReady(bestNextIt->handle_)) {
-    SCOPE_EXIT {
-      regions_.erase(bestNextIt);
+  // create pipeline layout
+  {
+    // duplicate for MoltenVK
+    const VkDescriptorSetLayout dsls[] = {dsl, dsl, dsl, dsl};
+    const VkPushConstantRange range = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sm.pushConstantsSize,
     };
-
-    return {bestNextIt->offset_, bestNextIt->size_, SubmitHandle()};
-  }
-
-  // nothing was available. Let's wait for the entire staging buffer to become free
-  waitAndReset();
-
-  // waitAndReset() adds a region that spans the entire buffer. Since we'll be using part of it, we need to replace it with a used block and
-  // an unused portion
-  regions_.clear();
-
-  // store the unused size in the deque first...
-  const uint32_t unusedSize = stagingBufferSize_ > requestedAlignedSize ? stagingBufferSize_ - requestedAlignedSize : 0;
-
-  if (unusedSize) {
-    const uint32_t unusedOffset = stagingBufferSize_ - unusedSize;
-    regions_.push_front({unusedOffset, unusedSize, SubmitHandle()});
+    const VkPipelineLayoutCreateInfo ci = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = (uint32_t)LVK_ARRAY_NUM_ELEMENTS(dsls),
+        .pSetLayouts = dsls,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &range,
+    };
+    VK_ASSERT(vkDT_.vkCreatePipelineLayout(vkDevice_, &ci, nullptr, &layout));
+    char pipelineLayoutName[256] = {0};
+    if (cps.desc_.debugName) {
+      snprintf(pipelineLayoutName, sizeof(pipelineLayoutName) - 1, "Pipeline Layout: %s", cps.desc_.debugName);
+    }
+    VK_ASSERT(lvk::setDebugObjectName(vkDT_, vkDevice_, VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)layout, pipelineLayoutName));
   }
 
-  // ...and then return the smallest free region that can hold the requested size
-  return {
-      .offset_ = 0,
-      .size_ = stagingBufferSize_ - unusedSize,
-      .handle_ = SubmitHandle(),
+  const VkComputePipelineCreateInfo ci = {
+      .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+      .flags = 0,
+      .stage = lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT, sm.sm, cps.desc_.entryPoint, &siComp),
+      .layout = layout,
+      .basePipelineHandle = VK_NULL_HANDLE,
+      .basePipelineIndex = -1,
   };
-}
-
-void lvk::VulkanStagingDevice::waitAndReset() {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_WAIT);
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VK_ASSERT(vkDT_.vkCreateComputePipelines(vkDevice_, pipelineCache_, 1, &ci, nullptr, &pipeline));
+  VK_ASSERT(lvk::setDebugObjectName(vkDT_, vkDevice_, VK_OBJECT_TYPE_PIPELINE, (uint64_t)pipeline, cps.desc_.debugName));
 
-  for (const auto& r : regions_) {
-    immediate_->wait(r.handle_);
-  };
+  *outLayout = layout;
 
-  regions_.clear();
-  regions_.push_front({0, stagingBufferSize_, SubmitHandle()});
+  return pipeline;
 }
 
-lvk::VulkanContext::VulkanContext(const lvk::ContextConfig& config, void* window, void* display) : config_(config) {
-  LVK_PROFILER_THREAD("MainThread");
-
-  pimpl_ = std::make_unique<VulkanContextImpl>();
+void lvk::VulkanContext::runPipelineCompileJobs(uint32_t numJobs,
+                                                std::function<void(uint32_t)>&& job,
+                                                std::vector<VkShaderModule>&& shaderModules) {
+  if (!numJobs) {
+    return;
+  }
 
-  if (volkInitialize() != VK_SUCCESS) {
-    LLOGW("volkInitialize() failed\n");
-    exit(255);
-  };
+  auto batch = std::make_shared<PipelineCompileBatch>();
+  batch->job = std::move(job);
+  batch->numJobs = numJobs;
+  batch->shaderModules = std::move(shaderModules);
 
-  glslang_initialize_process();
+  {
+    std::lock_guard lock(pimpl_->pipelineCompileBatchesMutex_);
+    // forget the finished batches
+    std::erase_if(pimpl_->pipelineCompileBatches_, [](const std::shared_ptr<PipelineCompileBatch>& b) { return b->isDone(); });
+    pimpl_->pipelineCompileBatches_.push_back(batch);
+  }
 
-  createInstance();
+  const uint32_t numWorkers = std::min(pimpl_->workerPool_.getNumThreads(), numJobs);
 
-  if (window) {
-    createSurface(window, display);
+  for (uint32_t i = 0; i != numWorkers; i++) {
+    // the thread finishing the last job of the batch saves the pipeline cache incrementally
+    pimpl_->workerPool_.run([this, batch]() { batch->run([this]() { savePipelineCache(); }); });
   }
 }
 
-lvk::VulkanContext::~VulkanContext() {
-  LVK_PROFILER_FUNCTION();
-
-  VK_ASSERT(vkDeviceWaitIdle(vkDevice_));
-
-  stagingDevice_.reset(nullptr);
-  swapchain_.reset(nullptr); // swapchain has to be destroyed prior to Surface
+void lvk::VulkanContext::waitPipelineCompileJobs(VkShaderModule shaderModule) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_WAIT);
 
-  if (shaderModulesPool_.numObjects()) {
-    LLOGW("Leaked %u shader modules\n", shaderModulesPool_.numObjects());
-  }
-  if (renderPipelinesPool_.numObjects()) {
-    LLOGW("Leaked %u render pipelines\n", renderPipelinesPool_.numObjects());
-  }
-  if (computePipelinesPool_.numObjects()) {
-    LLOGW("Leaked %u compute pipelines\n", computePipelinesPool_.numObjects());
-  }
-  if (samplersPool_.numObjects() > 1) {
-    // the dummy value is owned by the context
-    LLOGW("Leaked %u samplers\n", samplersPool_.numObjects() - 1);
-  }
-  if (texturesPool_.numObjects() > 1) {
-    // the dummy value is owned by the context
-    LLOGW("Leaked %u textures\n", texturesPool_.numObjects() - 1);
-  }
-  if (buffersPool_.numObjects()) {
-    LLOGW("Leaked %u buffers\n", buffersPool_.numObjects());
+  std::vector<std::shared_ptr<PipelineCompileBatch>> batches;
+  {
+    std::lock_guard lock(pimpl_->pipelineCompileBatchesMutex_);
+    for (const std::shared_ptr<PipelineCompileBatch>& b : pimpl_->pipelineCompileBatches_) {
+      if (!b->isDone() && (shaderModule == VK_NULL_HANDLE || b->uses(shaderModule))) {
+        batches.push_back(b);
+      }
+    }
   }
 
-  // manually destroy the dummy sampler
-  vkDestroySampler(vkDevice_, samplersPool_.objects_.front().obj_, nullptr);
-  samplersPool_.clear();
-  computePipelinesPool_.clear();
-  renderPipelinesPool_.clear();
-  shaderModulesPool_.clear();
-  texturesPool_.clear();
+  if (batches.empty()) {
+    return;
+  }
 
-  waitDeferredTasks();
+  ScopedHostWait hostWait(&frameCounters_, lvk::HostWait_PipelineCompiles);
 
-  immediate_.reset(nullptr);
+  for (const std::shared_ptr<PipelineCompileBatch>& b : batches) {
+    // help the workers instead of idling
+    b->run([this]() { savePipelineCache(); });
+    b->wait();
+  }
 
-  vkDestroyDescriptorSetLayout(vkDevice_, vkDSL_, nullptr);
-  vkDestroyDescriptorPool(vkDevice_, vkDPool_, nullptr);
-  vkDestroySurfaceKHR(vkInstance_, vkSurface_, nullptr);
-  vkDestroyPipelineCache(vkDevice_, pipelineCache_, nullptr);
+  std::lock_guard lock(pimpl_->pipelineCompileBatchesMutex_);
+  std::erase_if(pimpl_->pipelineCompileBatches_, [](const std::shared_ptr<PipelineCompileBatch>& b) { return b->isDone(); });
+}
 
-  // Clean up VMA
-  if (LVK_VULKAN_USE_VMA) {
-    vmaDestroyAllocator(pimpl_->vma_);
-  }
+void lvk::VulkanContext::compilePipelinesAsync(const RenderPipelineHandle* handles, uint32_t numHandles) {
+  LVK_PROFILER_FUNCTION();
 
-  // Device has to be destroyed prior to Instance
-  vkDestroyDevice(vkDevice_, nullptr);
+  struct Job {
+    RenderPipelineHandle handle;
+    RenderPipelineState rps;
+    RenderPipelineShaders shaders;
+  };
 
-  vkDestroyDebugUtilsMessengerEXT(vkInstance_, vkDebugUtilsMessenger_, nullptr);
-  vkDestroyInstance(vkInstance_, nullptr);
+  // take a snapshot of everything required to create the pipelines, so the workers do not touch the pools while compiling
+  auto jobs = std::make_shared<std::vector<Job>>();
+  VkDescriptorSetLayout dsl = VK_NULL_HANDLE;
+  {
+    std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-  glslang_finalize_process();
+    dsl = vkDSL_;
+    jobs->reserve(numHandles);
 
-  LLOGL("Vulkan graphics pipelines created: %u\n", VulkanPipelineBuilder::getNumPipelinesCreated());
-}
+    for (uint32_t i = 0; i != numHandles; i++) {
+      const lvk::RenderPipelineState* rps = renderPipelinesPool_.get(handles[i]);
+      // skip the pipelines which are ready
+      if (rps && !(rps->pipeline_ && rps->lastVkDescriptorSetLayout_ == dsl)) {
+        jobs->push_back({handles[i], *rps, getRenderPipelineShaders(rps->desc_)});
+      }
+    }
+  }
 
-lvk::ICommandBuffer& lvk::VulkanContext::acquireCommandBuffer() {
-  LVK_PROFILER_FUNCTION();
+  std::vector<VkShaderModule> shaderModules;
+  for (const Job& job : *jobs) {
+    const RenderPipelineShaders& sh = job.shaders;
+    for (const ShaderModuleState* sm : {&sh.vert, &sh.tesc, &sh.tese, &sh.geom, &sh.frag, &sh.task, &sh.mesh}) {
+      if (sm->sm != VK_NULL_HANDLE) {
+        shaderModules.push_back(sm->sm);
+      }
+    }
+  }
 
-  LVK_ASSERT_MSG(!pimpl_->currentCommandBuffer_.ctx_, "Cannot acquire more than 1 command buffer simultaneously");
+  runPipelineCompileJobs(
+      (uint32_t)jobs->size(),
+      [this, jobs, dsl](uint32_t i) {
+        const Job& job = (*jobs)[i];
 
-  pimpl_->currentCommandBuffer_ = CommandBuffer(this);
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VkShaderStageFlags stageFlags = 0;
+        VkPipeline pipeline = createVkPipeline(job.rps, job.shaders, dsl, &layout, &stageFlags);
 
-  return pimpl_->currentCommandBuffer_;
+        installVkPipeline(job.handle, dsl, pipeline, layout, stageFlags);
+      },
+      std::move(shaderModules));
 }
 
-lvk::SubmitHandle lvk::VulkanContext::submit(lvk::ICommandBuffer& commandBuffer, TextureHandle present) {
+void lvk::VulkanContext::compilePipelinesAsync(const ComputePipelineHandle* handles, uint32_t numHandles) {
   LVK_PROFILER_FUNCTION();
 
-  CommandBuffer* vkCmdBuffer = static_cast<CommandBuffer*>(&commandBuffer);
-
-  LVK_ASSERT(vkCmdBuffer);
-  LVK_ASSERT(vkCmdBuffer->ctx_);
-  LVK_ASSERT(vkCmdBuffer->wrapper_);
+  struct Job {
+    ComputePipelineHandle handle;
+    ComputePipelineState cps;
+    ShaderModuleState sm;
+  };
 
-  if (present) {
-    const lvk::VulkanTexture& tex = *texturesPool_.get(present);
+  auto jobs = std::make_shared<std::vector<Job>>();
+  VkDescriptorSetLayout dsl = VK_NULL_HANDLE;
+  {
+    std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-    LVK_ASSERT(tex.image_->isSwapchainImage_);
+    dsl = vkDSL_;
+    jobs->reserve(numHandles);
 
-    // prepare image for presentation the image might be coming from a compute shader
-    const VkPipelineStageFlagBits srcStage = (tex.image_->vkImageLayout_ == VK_IMAGE_LAYOUT_GENERAL)
-                                                 ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
-                                                 : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    tex.image_->transitionLayout(
-        vkCmdBuffer->wrapper_->cmdBuf_,
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-        srcStage,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // wait for all subsequent operations
-        VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS});
+    for (uint32_t i = 0; i != numHandles; i++) {
+      const lvk::ComputePipelineState* cps = computePipelinesPool_.get(handles[i]);
+      const lvk::ShaderModuleState* sm = cps ? shaderModulesPool_.get(cps->desc_.smComp) : nullptr;
+      if (sm && !(cps->pipeline_ && cps->lastVkDescriptorSetLayout_ == dsl)) {
+        jobs->push_back({handles[i], *cps, *sm});
+      }
+    }
   }
 
-  const bool shouldPresent = hasSwapchain() && present;
-
-  vkCmdBuffer->lastSubmitHandle_ = immediate_->submit(*vkCmdBuffer->wrapper_);
-
-  if (shouldPresent) {
-    swapchain_->present(immediate_->acquireLastSubmitSemaphore());
+  std::vector<VkShaderModule> shaderModules;
+  for (const Job& job : *jobs) {
+    shaderModules.push_back(job.sm.sm);
   }
 
-  processDeferredTasks();
-
-  SubmitHandle handle = vkCmdBuffer->lastSubmitHandle_;
+  runPipelineCompileJobs(
+      (uint32_t)jobs->size(),
+      [this, jobs, dsl](uint32_t i) {
+        const Job& job = (*jobs)[i];
 
-  // reset
-  pimpl_->currentCommandBuffer_ = {};
-
-  return handle;
-}
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VkPipeline pipeline = createVkPipeline(job.cps, job.sm, dsl, &layout);
 
-void lvk::VulkanContext::wait(SubmitHandle handle) {
-  immediate_->wait(handle);
+        installVkPipeline(job.handle, dsl, pipeline, layout);
+      },
+      std::move(shaderModules));
 }
 
-lvk::Holder<lvk::BufferHandle> lvk::VulkanContext::createBuffer(const BufferDesc& requestedDesc, Result* outResult) {
-  BufferDesc desc = requestedDesc;
-
-  if (!useStaging_ && (desc.storage == StorageType_Device)) {
-    desc.storage = StorageType_HostVisible;
-  }
-
-  // Use staging device to transfer data into the buffer when the storage is private to the device
-  VkBufferUsageFlags usageFlags = (desc.storage == StorageType_Device) ? VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-                                                                       : 0;
-
-  if (desc.usage == 0) {
-    Result::setResult(outResult, Result(Result::Code::ArgumentOutOfRange, "Invalid buffer usage"));
-    return {};
-  }
-
-  if (desc.usage & BufferUsageBits_Index) {
-    usageFlags |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-  }
-  if (desc.usage & BufferUsageBits_Vertex) {
-    usageFlags |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-  }
-  if (desc.usage & BufferUsageBits_Uniform) {
-    usageFlags |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
-  }
+bool lvk::VulkanContext::isPipelineReady(RenderPipelineHandle handle) {
+  std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-  if (desc.usage & BufferUsageBits_Storage) {
-    usageFlags |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
-  }
+  const lvk::RenderPipelineState* rps = renderPipelinesPool_.get(handle);
 
-  if (desc.usage & BufferUsageBits_Indirect) {
-    usageFlags |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
-  }
+  return rps && rps->pipeline_ && rps->lastVkDescriptorSetLayout_ == vkDSL_;
+}
 
-  const VkMemoryPropertyFlags memFlags = storageTypeToVkMemoryPropertyFlags(desc.storage);
+bool lvk::VulkanContext::isPipelineReady(ComputePipelineHandle handle) {
+  std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-  Result result;
-  BufferHandle handle = createBuffer(desc.size, usageFlags, memFlags, &result, desc.debugName);
+  const lvk::ComputePipelineState* cps = computePipelinesPool_.get(handle);
 
-  if (!LVK_VERIFY(result.isOk())) {
-    Result::setResult(outResult, result);
+  return cps && cps->pipeline_ && cps->lastVkDescriptorSetLayout_ == vkDSL_;
+}
+
+lvk::Holder<lvk::ComputePipelineHandle> lvk::VulkanContext::createComputePipeline(const ComputePipelineDesc& desc, Result* outResult) {
+  if (!LVK_VERIFY(desc.smComp.valid())) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Missing compute shader");
     return {};
   }
 
-  if (desc.data) {
-    upload(handle, desc.data, desc.size, 0);
-  }
+  // worker threads compiling pipelines access the pool
+  std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-  Result::setResult(outResult, Result());
+  ComputePipelineHandle handle = computePipelinesPool_.create(lvk::ComputePipelineState{desc});
+
+  if (!LVK_VERIFY(!handle.empty())) {
+    Result::setResult(outResult, Result::Code::RuntimeError, "Too many compute pipelines");
+    return {};
+  }
 
   return {this, handle};
 }
 
-lvk::Holder<lvk::QueryPoolHandle> lvk::VulkanContext::createQueryPool(uint32_t numQueries, const char* debugName, Result* outResult) {
-  LVK_PROFILER_FUNCTION();
+lvk::Holder<lvk::RenderPipelineHandle> lvk::VulkanContext::createRenderPipeline(const RenderPipelineDesc& desc, Result* outResult) {
+  const bool hasColorAttachments = desc.getNumColorAttachments() > 0;
+  const bool hasDepthAttachment = desc.depthFormat != Format_Invalid;
+  const bool hasAnyAttachments = hasColorAttachments || hasDepthAttachment;
+  if (!LVK_VERIFY(hasAnyAttachments)) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Need at least one attachment");
+    return {};
+  }
 
-  const VkQueryPoolCreateInfo createInfo = {
-      .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
-      .flags = 0,
-      .queryType = VK_QUERY_TYPE_TIMESTAMP,
-      .queryCount = numQueries,
-      .pipelineStatistics = 0,
-  };
+  const bool hasMeshShader = desc.smMesh.valid();
 
-  VkQueryPool queryPool = VK_NULL_HANDLE;
-  VK_ASSERT(vkCreateQueryPool(vkDevice_, &createInfo, 0, &queryPool));
+  if (hasMeshShader) {
+    if (!LVK_VERIFY(hasMeshShader_)) {
+      Result::setResult(outResult, Result::Code::RuntimeError, "Mesh shaders are not supported (VK_EXT_mesh_shader)");
+      return {};
+    }
+    if (!LVK_VERIFY(!desc.smVert.valid() && !desc.smTesc.valid() && !desc.smTese.valid() && !desc.smGeom.valid())) {
+      Result::setResult(
+          outResult, Result::Code::ArgumentOutOfRange, "Mesh shaders cannot be combined with vertex, tessellation, or geometry shaders");
+      return {};
+    }
+    if (!LVK_VERIFY(desc.vertexInput.getNumAttributes() == 0)) {
+      Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Mesh shading pipelines have no vertex input");
+      return {};
+    }
+  } else {
+    if (!LVK_VERIFY(desc.smVert.valid())) {
+      Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Missing vertex shader");
+      return {};
+    }
+    if (!LVK_VERIFY(!desc.smTask.valid())) {
+      Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "A task shader requires a mesh shader");
+      return {};
+    }
+  }
 
-  if (!queryPool) {
-    Result::setResult(outResult, Result(Result::Code::RuntimeError, "Cannot create QueryPool"));
+  if (!LVK_VERIFY(desc.smFrag.valid())) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Missing fragment shader");
     return {};
   }
 
-  if (debugName && *debugName) {
-    lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_QUERY_POOL, (uint64_t)queryPool, debugName);
-  }
+  RenderPipelineState rps = {.desc_ = desc};
 
-  lvk::QueryPoolHandle handle = queriesPool_.create(std::move(queryPool));
+  // Iterate and cache vertex input bindings and attributes
+  const lvk::VertexInput& vstate = rps.desc_.vertexInput;
 
-  return {this, handle};
-}
+  bool bufferAlreadyBound[VertexInput::LVK_VERTEX_BUFFER_MAX] = {};
 
-lvk::Holder<lvk::SamplerHandle> lvk::VulkanContext::createSampler(const SamplerStateDesc& desc, Result* outResult) {
-  LVK_PROFILER_FUNCTION();
+  rps.numAttributes_ = vstate.getNumAttributes();
 
-  Result result;
+  for (uint32_t i = 0; i != rps.numAttributes_; i++) {
+    const auto& attr = vstate.attributes[i];
 
-  SamplerHandle handle =
-      createSampler(samplerStateDescToVkSamplerCreateInfo(desc, getVkPhysicalDeviceProperties().limits), &result, desc.debugName);
+    rps.vkAttributes_[i] = {
+        .location = attr.location, .binding = attr.binding, .format = vertexFormatToVkFormat(attr.format), .offset = (uint32_t)attr.offset};
 
-  if (!LVK_VERIFY(result.isOk())) {
-    Result::setResult(outResult, Result(Result::Code::RuntimeError, "Cannot create Sampler"));
-    return {};
+    if (!bufferAlreadyBound[attr.binding]) {
+      bufferAlreadyBound[attr.binding] = true;
+      rps.vkBindings_[rps.numBindings_++] = {
+          .binding = attr.binding, .stride = vstate.inputBindings[attr.binding].stride, .inputRate = VK_VERTEX_INPUT_RATE_VERTEX};
+    }
   }
 
-  Result::setResult(outResult, result);
+  // worker threads compiling pipelines access the pool
+  std::lock_guard lock(pimpl_->pipelinesMutex_);
+
+  RenderPipelineHandle handle = renderPipelinesPool_.create(std::move(rps));
+
+  if (!LVK_VERIFY(!handle.empty())) {
+    Result::setResult(outResult, Result::Code::RuntimeError, "Too many render pipelines");
+    return {};
+  }
 
   return {this, handle};
 }
 
-lvk::Holder<lvk::TextureHandle> lvk::VulkanContext::createTexture(const TextureDesc& requestedDesc,
-                                                                  const char* debugName,
-                                                                  Result* outResult) {
-  TextureDesc desc(requestedDesc);
+void lvk::VulkanContext::destroy(lvk::ComputePipelineHandle handle) {
+  std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-  if (debugName && *debugName) {
-    desc.debugName = debugName;
+  lvk::ComputePipelineState* cps = computePipelinesPool_.get(handle);
+
+  if (!cps) {
+    return;
   }
 
-  const VkFormat vkFormat = lvk::isDepthOrStencilFormat(desc.format) ? getClosestDepthStencilFormat(desc.format)
-                                                                     : formatToVkFormat(desc.format);
+  deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = getVkDevice(), pipeline = cps->pipeline_]() {
+    vkDT.vkDestroyPipeline(device, pipeline, nullptr);
+  }));
+  deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = getVkDevice(), layout = cps->pipelineLayout_]() {
+    vkDT.vkDestroyPipelineLayout(device, layout, nullptr);
+  }));
 
-  const lvk::TextureType type = desc.type;
-  if (!LVK_VERIFY(type == TextureType_2D || type == TextureType_Cube || type == TextureType_3D)) {
-    LVK_ASSERT_MSG(false, "Only 2D, 3D and Cube textures are supported");
-    Result::setResult(outResult, Result::Code::RuntimeError);
-    return {};
-  }
+  computePipelinesPool_.destroy(handle);
+}
 
-  if (desc.numMipLevels == 0) {
-    LVK_ASSERT_MSG(false, "The number of mip levels specified must be greater than 0");
-    desc.numMipLevels = 1;
-  }
+void lvk::VulkanContext::destroy(lvk::RenderPipelineHandle handle) {
+  std::lock_guard lock(pimpl_->pipelinesMutex_);
 
-  if (desc.numSamples > 1 && desc.numMipLevels != 1) {
-    LVK_ASSERT_MSG(false, "The number of mip levels for multisampled images should be 1");
-    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "The number of mip-levels for multisampled images should be 1");
-    return {};
+  lvk::RenderPipelineState* rps = renderPipelinesPool_.get(handle);
+
+  if (!rps) {
+    return;
   }
 
-  if (desc.numSamples > 1 && type == TextureType_3D) {
-    LVK_ASSERT_MSG(false, "Multisampled 3D images are not supported");
-    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Multisampled 3D images are not supported");
-    return {};
+  deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = getVkDevice(), pipeline = rps->pipeline_]() {
+    vkDT.vkDestroyPipeline(device, pipeline, nullptr);
+  }));
+  deferredTask(std::packaged_task<void()>([&vkDT = vkDT_, device = getVkDevice(), layout = rps->pipelineLayout_]() {
+    vkDT.vkDestroyPipelineLayout(device, layout, nullptr);
+  }));
+
+  renderPipelinesPool_.destroy(handle);
+}
+
+void lvk::VulkanContext::destroy(lvk::ShaderModuleHandle handle) {
+  const lvk::ShaderModuleState* state = shaderModulesPool_.get(handle);
+
+  if (!state) {
+    return;
   }
 
-  if (!LVK_VERIFY(desc.numMipLevels <= lvk::calcNumMipLevels(desc.dimensions.width, desc.dimensions.height))) {
-    Result::setResult(outResult,
-                      Result::Code::ArgumentOutOfRange,
-                      "The number of specified mip-levels is greater than the maximum possible "
-                      "number of mip-levels.");
-    return {};
+  if (state->sm != VK_NULL_HANDLE) {
+    // pipelines compiled in the background might still be using this shader module
+    waitPipelineCompileJobs(state->sm);
+    // a shader module can be destroyed while pipelines created using its shaders are still in use
+    // https://registry.khronos.org/vulkan/specs/1.3/html/chap9.html#vkDestroyShaderModule
+    vkDT_.vkDestroyShaderModule(getVkDevice(), state->sm, nullptr);
   }
 
-  if (desc.usage == 0) {
-    LVK_ASSERT_MSG(false, "Texture usage flags are not set");
-    desc.usage = lvk::TextureUsageBits_Sampled;
+  shaderModulesPool_.destroy(handle);
+}
+
+void lvk::VulkanContext::destroy(SamplerHandle handle) {
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
+
+  if (handle.empty()) {
+    return;
   }
 
-  /* Use staging device to transfer data into the image when the storage is private to the device */
-  VkImageUsageFlags usageFlags = (desc.storage == StorageType_Device) ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0;
+  VkSampler sampler = *samplersPool_.get(handle);
 
-  if (desc.usage & lvk::TextureUsageBits_Sampled) {
-    usageFlags |= VK_IMAGE_USAGE_SAMPLED_BIT;
+  // the slot can be reused in the bindless descriptor set only after the GPU is done with it
+  samplersPool_.destroy(handle, false);
+
+  deferredTask(std::packaged_task<void()>([this, device = vkDevice_, sampler = sampler, index = handle.index()]() {
+    vkDT_.vkDestroySampler(device, sampler, nullptr);
+    std::lock_guard lock(pimpl_->descriptorsMutex_);
+    samplersPool_.freeSlot(index);
+  }));
+}
+
+void lvk::VulkanContext::destroy(BufferHandle handle) {
+  // pending uploads might reference this buffer - submit them, so the deferred deletion will wait for them
+  if (const lvk::VulkanBuffer* buf = buffersPool_.get(handle); buf && stagingDevice_) {
+    stagingDevice_->flushUploadsTo((uint64_t)buf->vkBuffer_);
   }
-  if (desc.usage & lvk::TextureUsageBits_Storage) {
-    LVK_ASSERT_MSG(desc.numSamples <= 1, "Storage images cannot be multisampled");
-    usageFlags |= VK_IMAGE_USAGE_STORAGE_BIT;
+
+  // deferred deletion handled in VulkanBuffer
+  buffersPool_.destroy(handle);
+}
+
+void lvk::VulkanContext::destroy(lvk::TextureHandle handle) {
+  if (handle.empty()) {
+    return;
   }
-  if (desc.usage & lvk::TextureUsageBits_Attachment) {
-    usageFlags |= lvk::isDepthOrStencilFormat(desc.format) ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
-                                                           : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+  // pending uploads might reference this texture (views share the image of their parent texture)
+  if (const lvk::VulkanTexture* tex = texturesPool_.get(handle); tex && tex->image_ && stagingDevice_) {
+    stagingDevice_->flushUploadsTo((uint64_t)tex->image_->vkImage_);
   }
 
-  // For now, always set this flag so we can read it back
-  usageFlags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+  // deferred deletion handled in VulkanTexture; the slot can be reused in the bindless descriptor set only after the GPU is done with it
+  texturesPool_.destroy(handle, false);
 
-  LVK_ASSERT_MSG(usageFlags != 0, "Invalid usage flags");
+  deferredTask(std::packaged_task<void()>([this, index = handle.index()]() {
+    std::lock_guard lock(pimpl_->descriptorsMutex_);
+    texturesPool_.freeSlot(index);
+  }));
+}
 
-  const VkMemoryPropertyFlags memFlags = storageTypeToVkMemoryPropertyFlags(desc.storage);
+void lvk::VulkanContext::destroy(lvk::QueryPoolHandle handle) {
+  VkQueryPool pool = *queriesPool_.get(handle);
 
-  const bool hasDebugName = desc.debugName && *desc.debugName;
+  queriesPool_.destroy(handle);
 
-  char debugNameImage[256] = {0};
-  char debugNameImageView[256] = {0};
+  deferredTask(
+      std::packaged_task<void()>([&vkDT = vkDT_, device = vkDevice_, pool = pool]() { vkDT.vkDestroyQueryPool(device, pool, nullptr); }));
+}
 
-  if (hasDebugName) {
-    snprintf(debugNameImage, sizeof(debugNameImage) - 1, "Image: %s", desc.debugName);
-    snprintf(debugNameImageView, sizeof(debugNameImageView) - 1, "Image View: %s", desc.debugName);
-  }
+void lvk::VulkanContext::destroy(Framebuffer& fb) {
+  auto destroyFbTexture = [this](TextureHandle& handle) {
+    {
+      if (handle.empty())
+        return;
+      lvk::VulkanTexture* tex = texturesPool_.get(handle);
+      if (!tex || tex->image_->isSwapchainImage_)
+        return;
+      destroy(handle);
+      handle = {};
+    }
+  };
 
-  VkImageCreateFlags createFlags = 0;
-  uint32_t arrayLayerCount = static_cast<uint32_t>(desc.numLayers);
-  VkImageViewType imageViewType;
-  VkImageType imageType;
-  VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
-  switch (desc.type) {
-  case TextureType_2D:
-    imageViewType = VK_IMAGE_VIEW_TYPE_2D;
-    imageType = VK_IMAGE_TYPE_2D;
-    samples = lvk::getVulkanSampleCountFlags(desc.numSamples);
-    break;
-  case TextureType_3D:
-    imageViewType = VK_IMAGE_VIEW_TYPE_3D;
-    imageType = VK_IMAGE_TYPE_3D;
-    break;
-  case TextureType_Cube:
-    imageViewType = VK_IMAGE_VIEW_TYPE_CUBE;
-    arrayLayerCount *= 6;
-    imageType = VK_IMAGE_TYPE_2D;
-    createFlags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
-    break;
-  default:
-    LVK_ASSERT_MSG(false, "Code should NOT be reached");
-    Result::setResult(outResult, Result::Code::RuntimeError, "Unsupported texture type");
-    return {};
+  for (Framebuffer::AttachmentDesc& a : fb.color) {
+    destroyFbTexture(a.texture);
+    destroyFbTexture(a.resolveTexture);
   }
+  destroyFbTexture(fb.depthStencil.texture);
+  destroyFbTexture(fb.depthStencil.resolveTexture);
+}
 
-  Result result;
-  std::shared_ptr<lvk::VulkanImage> image = createImage(imageType,
-                                                        VkExtent3D{desc.dimensions.width, desc.dimensions.height, desc.dimensions.depth},
-                                                        vkFormat,
-                                                        desc.numMipLevels,
-                                                        arrayLayerCount,
-                                                        VK_IMAGE_TILING_OPTIMAL,
-                                                        usageFlags,
-                                                        memFlags,
-                                                        createFlags,
-                                                        samples,
-                                                        &result,
-                                                        debugNameImage);
-  if (!LVK_VERIFY(result.isOk())) {
-    Result::setResult(outResult, result);
-    return {};
-  }
-  if (!LVK_VERIFY(image.get())) {
-    Result::setResult(outResult, Result::Code::RuntimeError, "Cannot create VulkanImage");
+lvk::Result lvk::VulkanContext::upload(lvk::BufferHandle handle, const void* data, size_t size, size_t offset) {
+  return uploadBuffer(handle, data, size, offset, lvk::QueueType_Graphics);
+}
+
+lvk::SubmitHandle lvk::VulkanContext::uploadAsync(lvk::BufferHandle handle, const void* data, size_t size, size_t offset) {
+  if (!uploadBuffer(handle, data, size, offset, lvk::QueueType_Transfer).isOk()) {
     return {};
   }
 
-  VkImageAspectFlags aspect = 0;
-  if (image->isDepthFormat_ || image->isStencilFormat_) {
-    if (image->isDepthFormat_) {
-      aspect |= VK_IMAGE_ASPECT_DEPTH_BIT;
-    } else if (image->isStencilFormat_) {
-      aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
-    }
-  } else {
-    aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+  // mapped buffers are written directly and there is nothing to submit
+  return stagingDevice_->flush(lvk::QueueType_Transfer);
+}
+
+lvk::Result lvk::VulkanContext::uploadBuffer(BufferHandle handle, const void* data, size_t size, size_t offset, lvk::QueueType queue) {
+  LVK_PROFILER_FUNCTION();
+
+  if (!LVK_VERIFY(data)) {
+    return lvk::Result();
   }
 
-  const VkComponentMapping mapping = {
-      .r = VkComponentSwizzle(desc.swizzle.r),
-      .g = VkComponentSwizzle(desc.swizzle.g),
-      .b = VkComponentSwizzle(desc.swizzle.b),
-      .a = VkComponentSwizzle(desc.swizzle.a),
-  };
+  LVK_ASSERT_MSG(size, "Data size should be non-zero");
 
-  VkImageView view =
-      image->createImageView(imageViewType, vkFormat, aspect, 0, VK_REMAINING_MIP_LEVELS, 0, arrayLayerCount, mapping, debugNameImageView);
+  lvk::VulkanBuffer* buf = buffersPool_.get(handle);
 
-  if (!LVK_VERIFY(view != VK_NULL_HANDLE)) {
-    Result::setResult(outResult, Result::Code::RuntimeError, "Cannot create VkImageView");
-    return {};
+  if (!LVK_VERIFY(buf)) {
+    return lvk::Result();
   }
 
-  TextureHandle handle = texturesPool_.create(lvk::VulkanTexture(std::move(image), view));
+  if (!LVK_VERIFY(offset + size <= buf->bufferSize_)) {
+    return lvk::Result(Result::Code::ArgumentOutOfRange, "Out of range");
+  }
 
-  awaitingCreation_ = true;
+  return stagingDevice_->bufferSubData(*buf, offset, size, data, queue);
+}
 
-  if (desc.data) {
-    LVK_ASSERT(desc.type == TextureType_2D || desc.type == TextureType_Cube);
-    LVK_ASSERT(desc.dataNumMipLevels <= desc.numMipLevels);
-    const uint32_t numLayers = desc.type == TextureType_Cube ? 6 : 1;
-    Result res = upload(handle, {.dimensions = desc.dimensions, .numLayers = numLayers, .numMipLevels = desc.dataNumMipLevels}, desc.data);
-    if (!res.isOk()) {
-      Result::setResult(outResult, res);
-      return {};
-    }
-  }
+uint8_t* lvk::VulkanContext::getMappedPtr(BufferHandle handle) const {
+  const lvk::VulkanBuffer* buf = buffersPool_.get(handle);
 
-  Result::setResult(outResult, Result());
+  LVK_ASSERT(buf);
 
-  return {this, handle};
+  return buf->isMapped() ? buf->getMappedPtr() : nullptr;
 }
 
-VkPipeline lvk::VulkanContext::getVkPipeline(RenderPipelineHandle handle) {
-  lvk::RenderPipelineState* rps = renderPipelinesPool_.get(handle);
+uint64_t lvk::VulkanContext::gpuAddress(BufferHandle handle, size_t offset) const {
+  LVK_ASSERT_MSG((offset & 7) == 0, "Buffer offset must be 8 bytes aligned as per GLSL_EXT_buffer_reference spec.");
 
-  if (!rps) {
-    return VK_NULL_HANDLE;
-  }
+  const lvk::VulkanBuffer* buf = buffersPool_.get(handle);
 
-  if (rps->lastVkDescriptorSetLayout_ != vkDSL_) {
-    deferredTask(std::packaged_task<void()>(
-        [device = getVkDevice(), pipeline = rps->pipeline_]() { vkDestroyPipeline(device, pipeline, nullptr); }));
-    deferredTask(std::packaged_task<void()>(
-        [device = getVkDevice(), layout = rps->pipelineLayout_]() { vkDestroyPipelineLayout(device, layout, nullptr); }));
-    rps->pipeline_ = VK_NULL_HANDLE;
-    rps->lastVkDescriptorSetLayout_ = vkDSL_;
+  LVK_ASSERT(buf);
+
+  return buf ? (uint64_t)buf->vkDeviceAddress_ + offset : 0u;
+}
+
+void lvk::VulkanContext::flushMappedMemory(BufferHandle handle, size_t offset, size_t size) const {
+  const lvk::VulkanBuffer* buf = buffersPool_.get(handle);
+
+  LVK_ASSERT(buf);
+
+  buf->flushMappedMemory(offset, size);
+}
+
+lvk::TransientAllocation lvk::VulkanContext::allocateTransient(ICommandBuffer& commandBuffer, size_t size, size_t alignment) {
+  LVK_PROFILER_FUNCTION();
+
+  lvk::CommandBuffer& cmdBuffer = static_cast<lvk::CommandBuffer&>(commandBuffer);
+
+  LVK_ASSERT(cmdBuffer.ctx_ == this && cmdBuffer.wrapper_);
+
+  if (!LVK_VERIFY(size)) {
+    return {};
   }
 
-  if (rps->pipeline_ != VK_NULL_HANDLE) {
-    return rps->pipeline_;
+  const lvk::QueueType queue = lvk::QueueType(cmdBuffer.wrapper_->handle_.queueType_);
+
+  const VkPhysicalDeviceLimits& limits = getVkPhysicalDeviceProperties().limits;
+
+  // 16 bytes cover GLSL_EXT_buffer_reference and std430 vec4 members
+  alignment = std::max({alignment,
+                        size_t(16),
+                        size_t(limits.minUniformBufferOffsetAlignment),
+                        size_t(limits.minStorageBufferOffsetAlignment)});
+
+  LVK_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment should be a power of 2");
+
+  std::lock_guard lock(pimpl_->transientBuffersMutex_);
+
+  std::vector<VulkanContextImpl::TransientBuffer>& buffers = pimpl_->transientBuffers_;
+  uint32_t& current = pimpl_->transientCurrentBuffer_[queue];
+
+  size_t offset = 0;
+
+  if (current != ~0u) {
+    offset = (buffers[current].offset + alignment - 1) & ~(alignment - 1);
+    if (offset + size > buffers[current].size) {
+      // retire the current buffer; it stays in use until all command buffers which allocated from it are submitted
+      current = ~0u;
+    }
   }
 
-  // build a new Vulkan pipeline
+  if (current == ~0u) {
+    offset = 0;
 
-  VkPipelineLayout layout = VK_NULL_HANDLE;
-  VkPipeline pipeline = VK_NULL_HANDLE;
+    auto isCurrent = [this](uint32_t index) {
+      return std::find(std::begin(pimpl_->transientCurrentBuffer_), std::end(pimpl_->transientCurrentBuffer_), index) !=
+             std::end(pimpl_->transientCurrentBuffer_);
+    };
+    auto isRetired = [this, &isCurrent](uint32_t index) {
+      const VulkanContextImpl::TransientBuffer& b = pimpl_->transientBuffers_[index];
+      return !b.numPendingCommandBuffers && !isCurrent(index) &&
+             std::all_of(b.submits.begin(), b.submits.end(), [this](SubmitHandle h) { return isReady(h); });
+    };
 
-  const RenderPipelineDesc& desc = rps->desc_;
+    uint32_t emptySlot = ~0u;
 
-  const uint32_t numColorAttachments = rps->desc_.getNumColorAttachments();
+    for (uint32_t i = 0; i != buffers.size(); i++) {
+      if (buffers[i].buffer.valid() && isRetired(i) && buffers[i].size > config_.transientBufferSize) {
+        // oversized buffers are freed as soon as they are retired
+        buffers[i] = {};
+      }
+      if (buffers[i].buffer.empty()) {
+        emptySlot = std::min(emptySlot, i);
+        continue;
+      }
+      if (current == ~0u && buffers[i].size >= size && isRetired(i)) {
+        current = i;
+      }
+    }
 
-  // Not all attachments are valid. We need to create color blend attachments only for active attachments
-  VkPipelineColorBlendAttachmentState colorBlendAttachmentStates[LVK_MAX_COLOR_ATTACHMENTS] = {};
-  VkFormat colorAttachmentFormats[LVK_MAX_COLOR_ATTACHMENTS] = {};
+    if (current == ~0u) {
+      const size_t bufferSize = std::max(config_.transientBufferSize, size);
+      const uint32_t index = emptySlot != ~0u ? emptySlot : (uint32_t)buffers.size();
 
-  for (uint32_t i = 0; i != numColorAttachments; i++) {
-    const auto& attachment = desc.color[i];
-    LVK_ASSERT(attachment.format != Format_Invalid);
-    colorAttachmentFormats[i] = formatToVkFormat(attachment.format);
-    if (!attachment.blendEnabled) {
-      colorBlendAttachmentStates[i] = VkPipelineColorBlendAttachmentState{
-          .blendEnable = VK_FALSE,
-          .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
-          .dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
-          .colorBlendOp = VK_BLEND_OP_ADD,
-          .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-          .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-          .alphaBlendOp = VK_BLEND_OP_ADD,
-          .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
-      };
-    } else {
-      colorBlendAttachmentStates[i] = VkPipelineColorBlendAttachmentState{
-          .blendEnable = VK_TRUE,
-          .srcColorBlendFactor = blendFactorToVkBlendFactor(attachment.srcRGBBlendFactor),
-          .dstColorBlendFactor = blendFactorToVkBlendFactor(attachment.dstRGBBlendFactor),
-          .colorBlendOp = blendOpToVkBlendOp(attachment.rgbBlendOp),
-          .srcAlphaBlendFactor = blendFactorToVkBlendFactor(attachment.srcAlphaBlendFactor),
-          .dstAlphaBlendFactor = blendFactorToVkBlendFactor(attachment.dstAlphaBlendFactor),
-          .alphaBlendOp = blendOpToVkBlendOp(attachment.alphaBlendOp),
-          .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
-      };
+      char debugName[256] = {0};
+      snprintf(debugName, sizeof(debugName) - 1, "Buffer: transient buffer %u", index);
+
+      Result result;
+      Holder<BufferHandle> buffer = createBuffer(
+          {
+              .usage = BufferUsageBits_Index | BufferUsageBits_Vertex | BufferUsageBits_Uniform | BufferUsageBits_Storage |
+                       BufferUsageBits_Indirect,
+              .storage = StorageType_HostVisible,
+              .size = bufferSize,
+              .debugName = debugName,
+          },
+          &result);
+
+      if (!LVK_VERIFY(result.isOk())) {
+        LLOGW("Cannot create a transient buffer of %zu bytes\n", bufferSize);
+        return {};
+      }
+
+      VulkanContextImpl::TransientBuffer b;
+      b.mappedPtr = getMappedPtr(buffer);
+      b.gpuAddress = gpuAddress(buffer);
+      b.buffer = std::move(buffer);
+      b.size = bufferSize;
+
+      if (index == buffers.size()) {
+        buffers.push_back(std::move(b));
+      } else {
+        buffers[index] = std::move(b);
+      }
+
+      current = index;
     }
+
+    buffers[current].offset = 0;
+    buffers[current].queue = queue;
+    buffers[current].submits.clear();
   }
 
-  const lvk::ShaderModuleState* vertModule = shaderModulesPool_.get(desc.smVert);
-  const lvk::ShaderModuleState* tescModule = shaderModulesPool_.get(desc.smTesc);
-  const lvk::ShaderModuleState* teseModule = shaderModulesPool_.get(desc.smTese);
-  const lvk::ShaderModuleState* geomModule = shaderModulesPool_.get(desc.smGeom);
-  const lvk::ShaderModuleState* fragModule = shaderModulesPool_.get(desc.smFrag);
+  VulkanContextImpl::TransientBuffer& b = buffers[current];
 
-  LVK_ASSERT(vertModule);
-  LVK_ASSERT(fragModule);
+  b.offset = offset + size;
 
-  if (tescModule || teseModule || desc.patchControlPoints) {
-    LVK_ASSERT_MSG(tescModule && teseModule, "Both tessellation control and evaluation shaders should be provided");
-    LVK_ASSERT(desc.patchControlPoints > 0 &&
-               desc.patchControlPoints <= vkPhysicalDeviceProperties2_.properties.limits.maxTessellationPatchSize);
+  // the command buffer flushes and retires everything it allocated from this buffer when it is submitted
+  auto it = std::find_if(cmdBuffer.transientRanges_.begin(),
+                         cmdBuffer.transientRanges_.end(),
+                         [current](const CommandBuffer::TransientRange& r) { return r.buffer == current; });
+
+  if (it == cmdBuffer.transientRanges_.end()) {
+    cmdBuffer.transientRanges_.push_back({.buffer = current, .begin = offset, .end = offset + size});
+    b.numPendingCommandBuffers++;
+  } else {
+    it->end = offset + size;
   }
 
-  const VkPipelineVertexInputStateCreateInfo ciVertexInputState = {
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-      .vertexBindingDescriptionCount = rps->numBindings_,
-      .pVertexBindingDescriptions = rps->numBindings_ ? rps->vkBindings_ : nullptr,
-      .vertexAttributeDescriptionCount = rps->numAttributes_,
-      .pVertexAttributeDescriptions = rps->numAttributes_ ? rps->vkAttributes_ : nullptr,
+  return {
+      .buffer = b.buffer,
+      .offset = offset,
+      .size = size,
+      .mappedPtr = b.mappedPtr + offset,
+      .gpuAddress = b.gpuAddress + offset,
   };
+}
 
-  VkSpecializationMapEntry entries[SpecializationConstantDesc::LVK_SPECIALIZATION_CONSTANTS_MAX] = {};
+lvk::Result lvk::VulkanContext::download(lvk::TextureHandle handle, const TextureRangeDesc& range, void* outData) {
+  if (!outData) {
+    return Result();
+  }
 
-  const VkSpecializationInfo si = lvk::getPipelineShaderStageSpecializationInfo(desc.specInfo, entries);
+  lvk::VulkanTexture* texture = texturesPool_.get(handle);
 
-  // create pipeline layout
-  {
-#define UPDATE_PUSH_CONSTANT_SIZE(sm, bit)                                  \
-  if (sm) {                                                                 \
-    pushConstantsSize = std::max(pushConstantsSize, sm->pushConstantsSize); \
-    rps->shaderStageFlags_ |= bit;                                          \
+  LVK_ASSERT(texture);
+
+  const Result result = validateRange(texture->getExtent(), texture->image_->numLevels_, range);
+
+  if (!LVK_VERIFY(result.isOk())) {
+    return result;
   }
-    rps->shaderStageFlags_ = 0;
-    uint32_t pushConstantsSize = 0;
-    UPDATE_PUSH_CONSTANT_SIZE(vertModule, VK_SHADER_STAGE_VERTEX_BIT);
-    UPDATE_PUSH_CONSTANT_SIZE(tescModule, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT);
-    UPDATE_PUSH_CONSTANT_SIZE(teseModule, VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT);
-    UPDATE_PUSH_CONSTANT_SIZE(geomModule, VK_SHADER_STAGE_GEOMETRY_BIT);
-    UPDATE_PUSH_CONSTANT_SIZE(fragModule, VK_SHADER_STAGE_FRAGMENT_BIT);
-#undef UPDATE_PUSH_CONSTANT_SIZE
 
-    // maxPushConstantsSize is guaranteed to be at least 128 bytes
-    // https://www.khronos.org/registry/vulkan/specs/1.3/html/vkspec.html#features-limits
-    // Table 32. Required Limits
-    const VkPhysicalDeviceLimits& limits = getVkPhysicalDeviceProperties().limits;
-    if (!LVK_VERIFY(pushConstantsSize <= limits.maxPushConstantsSize)) {
-      LLOGW("Push constants size exceeded %u (max %u bytes)", pushConstantsSize, limits.maxPushConstantsSize);
-    }
+  return stagingDevice_->getImageData(*texture->image_.get(),
+                                      VkOffset3D{(int32_t)range.x, (int32_t)range.y, (int32_t)range.z},
+                                      VkExtent3D{range.dimensions.width, range.dimensions.height, range.dimensions.depth},
+                                      VkImageSubresourceRange{
+                                          .aspectMask = texture->image_->getImageAspectFlags(),
+                                          .baseMipLevel = range.mipLevel,
+                                          .levelCount = range.numMipLevels,
+                                          .baseArrayLayer = range.layer,
+                                          .layerCount = range.numLayers,
+                                      },
+                                      texture->image_->vkImageFormat_,
+                                      outData);
+}
 
-    // duplicate for MoltenVK
-    const VkDescriptorSetLayout dsls[] = {vkDSL_, vkDSL_, vkDSL_, vkDSL_};
-    const VkPushConstantRange range = {
-        .stageFlags = rps->shaderStageFlags_,
-        .offset = 0,
-        .size = pushConstantsSize,
-    };
-    const VkPipelineLayoutCreateInfo ci = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .setLayoutCount = (uint32_t)LVK_ARRAY_NUM_ELEMENTS(dsls),
-        .pSetLayouts = dsls,
-        .pushConstantRangeCount = pushConstantsSize ? 1u : 0u,
-        .pPushConstantRanges = pushConstantsSize ? &range : nullptr,
-    };
-    VK_ASSERT(vkCreatePipelineLayout(vkDevice_, &ci, nullptr, &layout));
-    char pipelineLayoutName[256] = {0};
-    if (rps->desc_.debugName) {
-      snprintf(pipelineLayoutName, sizeof(pipelineLayoutName) - 1, "Pipeline Layout: %s", rps->desc_.debugName);
-    }
-    VK_ASSERT(lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)layout, pipelineLayoutName));
+lvk::Result lvk::VulkanContext::upload(lvk::TextureHandle handle, const TextureRangeDesc& range, const void* data) {
+  return uploadTexture(handle, range, data, lvk::QueueType_Graphics);
+}
+
+lvk::SubmitHandle lvk::VulkanContext::uploadAsync(lvk::TextureHandle handle, const TextureRangeDesc& range, const void* data) {
+  const lvk::VulkanTexture* texture = texturesPool_.get(handle);
+
+  if (!data || !texture) {
+    return {};
   }
 
-  lvk::VulkanPipelineBuilder()
-      // from Vulkan 1.0
-      .dynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-      .dynamicState(VK_DYNAMIC_STATE_SCISSOR)
-      .dynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS)
-      .dynamicState(VK_DYNAMIC_STATE_BLEND_CONSTANTS)
-      // from Vulkan 1.3 or VK_EXT_extended_dynamic_state
-      .dynamicState(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE)
-      .dynamicState(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE)
-      .dynamicState(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP)
-      // from Vulkan 1.3 or VK_EXT_extended_dynamic_state2
-      .dynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE)
-      .primitiveTopology(topologyToVkPrimitiveTopology(desc.topology))
-      .rasterizationSamples(getVulkanSampleCountFlags(desc.samplesCount))
-      .polygonMode(polygonModeToVkPolygonMode(desc.polygonMode))
-      .stencilStateOps(VK_STENCIL_FACE_FRONT_BIT,
-                       stencilOpToVkStencilOp(desc.frontFaceStencil.stencilFailureOp),
-                       stencilOpToVkStencilOp(desc.frontFaceStencil.depthStencilPassOp),
-                       stencilOpToVkStencilOp(desc.frontFaceStencil.depthFailureOp),
-                       compareOpToVkCompareOp(desc.frontFaceStencil.stencilCompareOp))
-      .stencilStateOps(VK_STENCIL_FACE_BACK_BIT,
-                       stencilOpToVkStencilOp(desc.backFaceStencil.stencilFailureOp),
-                       stencilOpToVkStencilOp(desc.backFaceStencil.depthStencilPassOp),
-                       stencilOpToVkStencilOp(desc.backFaceStencil.depthFailureOp),
-                       compareOpToVkCompareOp(desc.backFaceStencil.stencilCompareOp))
-      .stencilMasks(VK_STENCIL_FACE_FRONT_BIT, 0xFF, desc.frontFaceStencil.writeMask, desc.frontFaceStencil.readMask)
-      .stencilMasks(VK_STENCIL_FACE_BACK_BIT, 0xFF, desc.backFaceStencil.writeMask, desc.backFaceStencil.readMask)
-      .shaderStage(lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_VERTEX_BIT, vertModule->sm, desc.entryPointVert, &si))
-      .shaderStage(lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT, fragModule->sm, desc.entryPointFrag, &si))
-      .shaderStage(tescModule ? lvk::getPipelineShaderStageCreateInfo(
-                                    VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, tescModule->sm, desc.entryPointTesc, &si)
-                              : VkPipelineShaderStageCreateInfo{.module = VK_NULL_HANDLE})
-      .shaderStage(teseModule ? lvk::getPipelineShaderStageCreateInfo(
-                                    VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, teseModule->sm, desc.entryPointTese, &si)
-                              : VkPipelineShaderStageCreateInfo{.module = VK_NULL_HANDLE})
-      .shaderStage(geomModule
-                       ? lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_GEOMETRY_BIT, geomModule->sm, desc.entryPointGeom, &si)
-                       : VkPipelineShaderStageCreateInfo{.module = VK_NULL_HANDLE})
-      .cullMode(cullModeToVkCullMode(desc.cullMode))
-      .frontFace(windingModeToVkFrontFace(desc.frontFaceWinding))
-      .vertexInputState(ciVertexInputState)
-      .colorAttachments(colorBlendAttachmentStates, colorAttachmentFormats, numColorAttachments)
-      .depthAttachmentFormat(formatToVkFormat(desc.depthFormat))
-      .stencilAttachmentFormat(formatToVkFormat(desc.stencilFormat))
-      .patchControlPoints(desc.patchControlPoints)
-      .build(vkDevice_, pipelineCache_, layout, &pipeline, desc.debugName);
+  // copies into images which are not shared with the transfer queue family, or which do not match its image transfer granularity,
+  // go to the graphics queue
+  const bool isTransferCompatible =
+      texture->image_->isTransferQueueShared_ && isTransferGranularityCompatible(*texture->image_, range);
+  const lvk::QueueType queue = !transferImmediate_ || isTransferCompatible ? lvk::QueueType_Transfer : lvk::QueueType_Graphics;
 
-  rps->pipeline_ = pipeline;
-  rps->pipelineLayout_ = layout;
+  if (!uploadTexture(handle, range, data, queue).isOk()) {
+    return {};
+  }
 
-  return pipeline;
+  return stagingDevice_->flush(queue);
 }
 
-VkPipeline lvk::VulkanContext::getVkPipeline(ComputePipelineHandle handle) {
-  lvk::ComputePipelineState* cps = computePipelinesPool_.get(handle);
+bool lvk::VulkanContext::isTransferGranularityCompatible(const VulkanImage& image, const TextureRangeDesc& range) const {
+  const VkExtent3D g = deviceQueues_.transferImageGranularity;
 
-  if (!cps) {
-    return VK_NULL_HANDLE;
+  // (0, 0, 0): only whole mip-levels can be copied
+  const bool wholeLevelsOnly = !g.width && !g.height && !g.depth;
+
+  // the granularity is expressed in compressed texel blocks
+  const Dimensions block = lvk::getTextureBlockDimensions(vkFormatToFormat(image.vkImageFormat_));
+
+  for (uint32_t level = range.mipLevel; level != range.mipLevel + std::max(range.numMipLevels, 1u); level++) {
+    const uint32_t w = std::max(image.vkExtent_.width >> level, 1u);
+    const uint32_t h = std::max(image.vkExtent_.height >> level, 1u);
+    const uint32_t d = std::max(image.vkExtent_.depth >> level, 1u);
+    const uint32_t x = range.x >> (level - range.mipLevel);
+    const uint32_t y = range.y >> (level - range.mipLevel);
+    const uint32_t z = range.z >> (level - range.mipLevel);
+    const uint32_t ew = std::max(range.dimensions.width >> (level - range.mipLevel), 1u);
+    const uint32_t eh = std::max(range.dimensions.height >> (level - range.mipLevel), 1u);
+    const uint32_t ed = std::max(range.dimensions.depth >> (level - range.mipLevel), 1u);
+    auto isCompatible = [wholeLevelsOnly](uint32_t offset, uint32_t extent, uint32_t size, uint32_t granularity, uint32_t block) {
+      if (wholeLevelsOnly) {
+        return offset == 0 && extent == size;
+      }
+      const uint32_t gran = std::max(granularity, 1u) * block;
+      return offset % gran == 0 && (extent % gran == 0 || offset + extent == size);
+    };
+    if (!isCompatible(x, ew, w, g.width, block.width) || !isCompatible(y, eh, h, g.height, block.height) ||
+        !isCompatible(z, ed, d, g.depth, 1)) {
+      return false;
+    }
   }
 
-  if (cps->lastVkDescriptorSetLayout_ != vkDSL_) {
-    deferredTask(
-        std::packaged_task<void()>([device = vkDevice_, pipeline = cps->pipeline_]() { vkDestroyPipeline(device, pipeline, nullptr); }));
-    deferredTask(
-        std::packaged_task<void()>([device = vkDevice_, layout = cps->pipelineLayout_]() { vkDestroyPipelineLayout(device, layout, nullptr); }));
-    cps->pipeline_ = VK_NULL_HANDLE;
-    cps->pipelineLayout_ = VK_NULL_HANDLE;
-    cps->lastVkDescriptorSetLayout_ = vkDSL_;
+  return true;
+}
+
+lvk::Result lvk::VulkanContext::uploadTexture(TextureHandle handle, const TextureRangeDesc& range, const void* data, lvk::QueueType queue) {
+  if (!data) {
+    return Result();
   }
 
-  if (cps->pipeline_ == VK_NULL_HANDLE) {
-    const lvk::ShaderModuleState* sm = shaderModulesPool_.get(cps->desc_.smComp);
+  lvk::VulkanTexture* texture = texturesPool_.get(handle);
 
-    LVK_ASSERT(sm);
+  const Result result = validateRange(texture->getExtent(), texture->image_->numLevels_, range);
 
-    VkSpecializationMapEntry entries[SpecializationConstantDesc::LVK_SPECIALIZATION_CONSTANTS_MAX] = {};
+  if (!LVK_VERIFY(result.isOk())) {
+    return result;
+  }
 
-    const VkSpecializationInfo siComp = lvk::getPipelineShaderStageSpecializationInfo(cps->desc_.specInfo, entries);
+  const uint32_t numLayers = std::max(range.numLayers, 1u);
 
-    // create pipeline layout
-    {
-      // duplicate for MoltenVK
-      const VkDescriptorSetLayout dsls[] = {vkDSL_, vkDSL_, vkDSL_, vkDSL_};
-      const VkPushConstantRange range = {
-          .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-          .offset = 0,
-          .size = sm->pushConstantsSize,
-      };
-      const VkPipelineLayoutCreateInfo ci = {
-          .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-          .setLayoutCount = (uint32_t)LVK_ARRAY_NUM_ELEMENTS(dsls),
-          .pSetLayouts = dsls,
-          .pushConstantRangeCount = 1,
-          .pPushConstantRanges = &range,
-      };
-      VK_ASSERT(vkCreatePipelineLayout(vkDevice_, &ci, nullptr, &cps->pipelineLayout_));
-      char pipelineLayoutName[256] = {0};
-      if (cps->desc_.debugName) {
-        snprintf(pipelineLayoutName, sizeof(pipelineLayoutName) - 1, "Pipeline Layout: %s", cps->desc_.debugName);
-      }
-      VK_ASSERT(lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)cps->pipelineLayout_, pipelineLayoutName));
-    }
+  const VkImageType type = texture->image_->vkType_;
+  VkFormat vkFormat = texture->image_->vkImageFormat_;
 
-    const VkComputePipelineCreateInfo ci = {
-        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-        .flags = 0,
-        .stage = lvk::getPipelineShaderStageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT, sm->sm, cps->desc_.entryPoint, &siComp),
-        .layout = cps->pipelineLayout_,
-        .basePipelineHandle = VK_NULL_HANDLE,
-        .basePipelineIndex = -1,
-    };
-    VkPipeline pipeline = VK_NULL_HANDLE;
-    VK_ASSERT(vkCreateComputePipelines(vkDevice_, pipelineCache_, 1, &ci, nullptr, &cps->pipeline_));
-    VK_ASSERT(lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_PIPELINE, (uint64_t)cps->pipeline_, cps->desc_.debugName));
+  if (type == VK_IMAGE_TYPE_3D) {
+    return stagingDevice_->imageData3D(*texture->image_.get(),
+                                       VkOffset3D{(int32_t)range.x, (int32_t)range.y, (int32_t)range.z},
+                                       VkExtent3D{range.dimensions.width, range.dimensions.height, range.dimensions.depth},
+                                       vkFormat,
+                                       data,
+                                       queue);
   }
 
-  return cps->pipeline_;
+  const VkRect2D imageRegion = {
+      .offset = {.x = (int)range.x, .y = (int)range.y},
+      .extent = {.width = range.dimensions.width, .height = range.dimensions.height},
+  };
+  return stagingDevice_->imageData2D(
+      *texture->image_.get(), imageRegion, range.mipLevel, range.numMipLevels, range.layer, range.numLayers, vkFormat, data, queue);
 }
 
-lvk::Holder<lvk::ComputePipelineHandle> lvk::VulkanContext::createComputePipeline(const ComputePipelineDesc& desc, Result* outResult) {
-  if (!LVK_VERIFY(desc.smComp.valid())) {
-    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Missing compute shader");
-    return {};
-  }
+lvk::UploadMapping lvk::VulkanContext::mapForUpload(BufferHandle handle, size_t size, size_t offset, Result* outResult) {
+  LVK_PROFILER_FUNCTION();
 
-  return {this, computePipelinesPool_.create(lvk::ComputePipelineState{desc})};
-}
+  lvk::VulkanBuffer* buf = buffersPool_.get(handle);
 
-lvk::Holder<lvk::RenderPipelineHandle> lvk::VulkanContext::createRenderPipeline(const RenderPipelineDesc& desc, Result* outResult) {
-  const bool hasColorAttachments = desc.getNumColorAttachments() > 0;
-  const bool hasDepthAttachment = desc.depthFormat != Format_Invalid;
-  const bool hasAnyAttachments = hasColorAttachments || hasDepthAttachment;
-  if (!LVK_VERIFY(hasAnyAttachments)) {
-    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Need at least one attachment");
+  if (!LVK_VERIFY(buf && size)) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Invalid buffer or zero size");
     return {};
   }
 
-  if (!LVK_VERIFY(desc.smVert.valid())) {
-    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Missing vertex shader");
+  if (!LVK_VERIFY(offset + size <= buf->bufferSize_)) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Out of range");
     return {};
   }
 
-  if (!LVK_VERIFY(desc.smFrag.valid())) {
-    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Missing fragment shader");
+  if (buf->isMapped()) {
+    Result::setResult(outResult, Result());
+    return {
+        .mappedPtr = buf->getMappedPtr() + offset,
+        .size = size,
+        .buffer = handle,
+        .offset = offset,
+    };
+  }
+
+  if (size > UINT32_MAX) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "The size does not fit into the staging buffer");
     return {};
   }
 
-  RenderPipelineState rps = {.desc_ = desc};
+  const VulkanStagingDevice::MemoryRegionDesc desc = stagingDevice_->map((uint32_t)size);
 
-  // Iterate and cache vertex input bindings and attributes
-  const lvk::VertexInput& vstate = rps.desc_.vertexInput;
+  if (!desc.size_) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "The size does not fit into the staging buffer");
+    return {};
+  }
 
-  bool bufferAlreadyBound[VertexInput::LVK_VERTEX_BUFFER_MAX] = {};
+  Result::setResult(outResult, Result());
 
-  rps.numAttributes_ = vstate.getNumAttributes();
+  return {
+      .mappedPtr = stagingDevice_->getMappedPtr(desc),
+      .size = size,
+      .buffer = handle,
+      .offset = offset,
+      .stagingOffset = desc.offset_,
+  };
+}
 
-  for (uint32_t i = 0; i != rps.numAttributes_; i++) {
-    const auto& attr = vstate.attributes[i];
+lvk::UploadMapping lvk::VulkanContext::mapForUpload(TextureHandle handle, const TextureRangeDesc& range, Result* outResult) {
+  LVK_PROFILER_FUNCTION();
 
-    rps.vkAttributes_[i] = {
-        .location = attr.location, .binding = attr.binding, .format = vertexFormatToVkFormat(attr.format), .offset = (uint32_t)attr.offset};
+  lvk::VulkanTexture* texture = texturesPool_.get(handle);
 
-    if (!bufferAlreadyBound[attr.binding]) {
-      bufferAlreadyBound[attr.binding] = true;
-      rps.vkBindings_[rps.numBindings_++] = {
-          .binding = attr.binding, .stride = vstate.inputBindings[attr.binding].stride, .inputRate = VK_VERTEX_INPUT_RATE_VERTEX};
-    }
+  if (!LVK_VERIFY(texture)) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "Invalid texture");
+    return {};
   }
 
-  return {this, renderPipelinesPool_.create(std::move(rps))};
-}
-
-void lvk::VulkanContext::destroy(lvk::ComputePipelineHandle handle) {
-  lvk::ComputePipelineState* cps = computePipelinesPool_.get(handle);
+  const Result result = validateRange(texture->getExtent(), texture->image_->numLevels_, range);
 
-  if (!cps) {
-    return;
+  if (!LVK_VERIFY(result.isOk())) {
+    Result::setResult(outResult, result);
+    return {};
   }
 
-  deferredTask(
-      std::packaged_task<void()>([device = getVkDevice(), pipeline = cps->pipeline_]() { vkDestroyPipeline(device, pipeline, nullptr); }));
-  deferredTask(std::packaged_task<void()>(
-      [device = getVkDevice(), layout = cps->pipelineLayout_]() { vkDestroyPipelineLayout(device, layout, nullptr); }));
+  const lvk::VulkanImage& image = *texture->image_.get();
 
-  computePipelinesPool_.destroy(handle);
-}
+  // the same storage size as VulkanStagingDevice::imageData2D() and VulkanStagingDevice::imageData3D()
+  const uint32_t storageSize =
+      image.vkType_ == VK_IMAGE_TYPE_3D
+          ? range.dimensions.width * range.dimensions.height * range.dimensions.depth * getBytesPerPixel(image.vkImageFormat_)
+          : VulkanStagingDevice::getImageData2DSize(image, range.mipLevel, range.numMipLevels, range.numLayers, image.vkImageFormat_);
 
-void lvk::VulkanContext::destroy(lvk::RenderPipelineHandle handle) {
-  lvk::RenderPipelineState* rps = renderPipelinesPool_.get(handle);
+  const VulkanStagingDevice::MemoryRegionDesc desc = stagingDevice_->map(storageSize);
 
-  if (!rps) {
-    return;
+  if (!desc.size_) {
+    Result::setResult(outResult, Result::Code::ArgumentOutOfRange, "The texture range does not fit into the staging buffer");
+    return {};
   }
 
-  deferredTask(
-      std::packaged_task<void()>([device = getVkDevice(), pipeline = rps->pipeline_]() { vkDestroyPipeline(device, pipeline, nullptr); }));
-  deferredTask(std::packaged_task<void()>(
-      [device = getVkDevice(), layout = rps->pipelineLayout_]() { vkDestroyPipelineLayout(device, layout, nullptr); }));
+  Result::setResult(outResult, Result());
 
-  renderPipelinesPool_.destroy(handle);
+  return {
+      .mappedPtr = stagingDevice_->getMappedPtr(desc),
+      .size = storageSize,
+      .texture = handle,
+      .range = range,
+      .stagingOffset = desc.offset_,
+  };
 }
 
-void lvk::VulkanContext::destroy(lvk::ShaderModuleHandle handle) {
-  const lvk::ShaderModuleState* state = shaderModulesPool_.get(handle);
+lvk::Result lvk::VulkanContext::commitUpload(const UploadMapping& mapping) {
+  LVK_PROFILER_FUNCTION();
 
-  if (!state) {
-    return;
+  if (!LVK_VERIFY(mapping.valid())) {
+    return Result(Result::Code::ArgumentOutOfRange, "Invalid mapping");
   }
 
-  if (state->sm != VK_NULL_HANDLE) {
-    // a shader module can be destroyed while pipelines created using its shaders are still in use
-    // https://registry.khronos.org/vulkan/specs/1.3/html/chap9.html#vkDestroyShaderModule
-    vkDestroyShaderModule(getVkDevice(), state->sm, nullptr);
+  if (mapping.stagingOffset == ~0u) {
+    // written directly into a host-visible buffer
+    flushMappedMemory(mapping.buffer, mapping.offset, mapping.size);
+    return Result();
   }
 
-  shaderModulesPool_.destroy(handle);
-}
-
-void lvk::VulkanContext::destroy(SamplerHandle handle) {
-  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_DESTROY);
+  const VulkanStagingDevice::MemoryRegionDesc desc = {
+      .offset_ = mapping.stagingOffset,
+      .size_ = (uint32_t)mapping.size,
+  };
 
-  VkSampler sampler = *samplersPool_.get(handle);
+  // unmap and record the copy atomically: otherwise an intermediate flush() from another thread would retire the region before the
+  // copy from it is recorded (and it could be reused while the copy is still pending)
+  std::lock_guard lock(stagingDevice_->mutex_);
 
-  samplersPool_.destroy(handle);
+  stagingDevice_->unmap(desc);
 
-  deferredTask(std::packaged_task<void()>([device = vkDevice_, sampler = sampler]() { vkDestroySampler(device, sampler, nullptr); }));
-}
+  if (mapping.buffer) {
+    lvk::VulkanBuffer* buf = buffersPool_.get(mapping.buffer);
 
-void lvk::VulkanContext::destroy(BufferHandle handle) {
-  // deferred deletion handled in VulkanBuffer
-  buffersPool_.destroy(handle);
-}
+    if (!LVK_VERIFY(buf)) {
+      return Result(Result::Code::ArgumentOutOfRange, "The buffer was destroyed before commitUpload()");
+    }
 
-void lvk::VulkanContext::destroy(lvk::TextureHandle handle) {
-  // deferred deletion handled in VulkanTexture
-  texturesPool_.destroy(handle);
-}
+    stagingDevice_->recordBufferCopy(*buf, mapping.offset, mapping.stagingOffset, (uint32_t)mapping.size, lvk::QueueType_Graphics);
 
-void lvk::VulkanContext::destroy(lvk::QueryPoolHandle handle) {
-  VkQueryPool pool = *queriesPool_.get(handle);
+    return Result();
+  }
 
-  queriesPool_.destroy(handle);
+  lvk::VulkanTexture* texture = texturesPool_.get(mapping.texture);
 
-  deferredTask(std::packaged_task<void()>([device = vkDevice_, pool = pool]() { vkDestroyQueryPool(device, pool, nullptr); }));
-}
+  if (!LVK_VERIFY(texture)) {
+    return Result(Result::Code::ArgumentOutOfRange, "The texture was destroyed before commitUpload()");
+  }
 
-void lvk::VulkanContext::destroy(Framebuffer& fb) {
-  auto destroyFbTexture = [this](TextureHandle& handle) {
-    {
-      if (handle.empty())
-        return;
-      lvk::VulkanTexture* tex = texturesPool_.get(handle);
-      if (!tex || tex->image_->isSwapchainImage_)
-        return;
-      destroy(handle);
-      handle = {};
-    }
-  };
+  const TextureRangeDesc& range = mapping.range;
+  lvk::VulkanImage& image = *texture->image_.get();
 
-  for (Framebuffer::AttachmentDesc& a : fb.color) {
-    destroyFbTexture(a.texture);
-    destroyFbTexture(a.resolveTexture);
+  if (image.vkType_ == VK_IMAGE_TYPE_3D) {
+    stagingDevice_->recordImageCopy3D(image,
+                                      VkOffset3D{(int32_t)range.x, (int32_t)range.y, (int32_t)range.z},
+                                      VkExtent3D{range.dimensions.width, range.dimensions.height, range.dimensions.depth},
+                                      mapping.stagingOffset,
+                                      lvk::QueueType_Graphics);
+  } else {
+    const VkRect2D imageRegion = {
+        .offset = {.x = (int)range.x, .y = (int)range.y},
+        .extent = {.width = range.dimensions.width, .height = range.dimensions.height},
+    };
+    stagingDevice_->recordImageCopy2D(image,
+                                      imageRegion,
+                                      range.mipLevel,
+                                      range.numMipLevels,
+                                      range.layer,
+                                      range.numLayers,
+                                      image.vkImageFormat_,
+                                      mapping.stagingOffset,
+                                      lvk::QueueType_Graphics);
   }
-  destroyFbTexture(fb.depthStencil.texture);
-  destroyFbTexture(fb.depthStencil.resolveTexture);
-}
 
-lvk::Result lvk::VulkanContext::upload(lvk::BufferHandle handle, const void* data, size_t size, size_t offset) {
-  LVK_PROFILER_FUNCTION();
+  return Result();
+}
 
-  if (!LVK_VERIFY(data)) {
-    return lvk::Result();
+lvk::Dimensions lvk::VulkanContext::getDimensions(TextureHandle handle) const {
+  if (!handle) {
+    return {};
   }
 
-  LVK_ASSERT_MSG(size, "Data size should be non-zero");
+  const lvk::VulkanTexture* tex = texturesPool_.get(handle);
 
-  lvk::VulkanBuffer* buf = buffersPool_.get(handle);
+  LVK_ASSERT(tex);
 
-  if (!LVK_VERIFY(buf)) {
-    return lvk::Result();
+  if (!tex || !tex->image_) {
+    return {};
   }
 
-  if (!LVK_VERIFY(offset + size <= buf->bufferSize_)) {
-    return lvk::Result(Result::Code::ArgumentOutOfRange, "Out of range");
+  return {
+      .width = tex->image_->vkExtent_.width,
+      .height = tex->image_->vkExtent_.height,
+      .depth = tex->image_->vkExtent_.depth,
+  };
+}
+
+void lvk::VulkanContext::generateMipmap(TextureHandle handle) const {
+  if (handle.empty()) {
+    return;
   }
 
-  stagingDevice_->bufferSubData(*buf, offset, size, data);
+  const lvk::VulkanTexture* tex = texturesPool_.get(handle);
 
-  return lvk::Result();
+  if (tex->image_->numLevels_ > 1) {
+    LVK_ASSERT(tex->image_->vkImageLayout_ != VK_IMAGE_LAYOUT_UNDEFINED);
+    // record into the same command buffer as the uploads - it will be submitted with the next VulkanContext::submit()
+    std::lock_guard lock(stagingDevice_->mutex_);
+    const auto& wrapper = stagingDevice_->getPendingCommandBuffer(lvk::QueueType_Graphics);
+    stagingDevice_->pendingTargets_[lvk::QueueType_Graphics].push_back((uint64_t)tex->image_->vkImage_);
+    tex->image_->generateMipmap(wrapper.cmdBuf_);
+  }
 }
 
-uint8_t* lvk::VulkanContext::getMappedPtr(BufferHandle handle) const {
-  const lvk::VulkanBuffer* buf = buffersPool_.get(handle);
+void lvk::VulkanContext::generateMipmap(const TextureHandle* handles, uint32_t numHandles) const {
+  LVK_PROFILER_FUNCTION();
 
-  LVK_ASSERT(buf);
+  LVK_ASSERT(handles || !numHandles);
 
-  return buf->isMapped() ? buf->getMappedPtr() : nullptr;
+  // all blit chains go into one command buffer
+  std::lock_guard lock(stagingDevice_->mutex_);
+
+  for (uint32_t i = 0; i != numHandles; i++) {
+    generateMipmap(handles[i]);
+  }
 }
 
-uint64_t lvk::VulkanContext::gpuAddress(BufferHandle handle, size_t offset) const {
-  LVK_ASSERT_MSG((offset & 7) == 0, "Buffer offset must be 8 bytes aligned as per GLSL_EXT_buffer_reference spec.");
+lvk::Format lvk::VulkanContext::getFormat(TextureHandle handle) const {
+  if (handle.empty()) {
+    return Format_Invalid;
+  }
 
-  const lvk::VulkanBuffer* buf = buffersPool_.get(handle);
+  return vkFormatToFormat(texturesPool_.get(handle)->image_->vkImageFormat_);
+}
 
-  LVK_ASSERT(buf);
+uint32_t lvk::VulkanContext::getNumMipLevels(TextureHandle handle) const {
+  if (handle.empty()) {
+    return 0;
+  }
 
-  return buf ? (uint64_t)buf->vkDeviceAddress_ + offset : 0u;
+  return texturesPool_.get(handle)->image_->numLevels_;
 }
 
-void lvk::VulkanContext::flushMappedMemory(BufferHandle handle, size_t offset, size_t size) const {
-  const lvk::VulkanBuffer* buf = buffersPool_.get(handle);
+lvk::Result lvk::VulkanContext::updateTexturePages(TextureHandle handle, const TexturePage* pages, uint32_t numPages) {
+  LVK_PROFILER_FUNCTION();
 
-  LVK_ASSERT(buf);
+  lvk::VulkanTexture* tex = texturesPool_.get(handle);
 
-  buf->flushMappedMemory(offset, size);
-}
+  if (!LVK_VERIFY(tex && tex->image_->isSparse_)) {
+    return Result(Result::Code::ArgumentOutOfRange, "The texture is not sparse");
+  }
 
-lvk::Result lvk::VulkanContext::download(lvk::TextureHandle handle, const TextureRangeDesc& range, void* outData) {
-  if (!outData) {
+  if (!numPages) {
     return Result();
   }
 
-  lvk::VulkanTexture* texture = texturesPool_.get(handle);
+  LVK_ASSERT(pages);
 
-  LVK_ASSERT(texture);
+  lvk::VulkanImage& img = *tex->image_;
 
-  const Result result = validateRange(texture->getExtent(), texture->image_->numLevels_, range);
+  const VkSparseImageMemoryRequirements& req = img.sparseRequirements_;
+  const VkExtent3D& pageSize = req.formatProperties.imageGranularity;
+  const bool isSingleMipTail = (req.formatProperties.flags & VK_SPARSE_IMAGE_FORMAT_SINGLE_MIPTAIL_BIT) != 0;
+  const VkImageAspectFlags aspect = img.getImageAspectFlags();
 
-  if (!LVK_VERIFY(result.isOk())) {
-    return result;
+  // 1. validate all pages before anything is allocated or bound, so an error leaves the texture unchanged; when a page is listed
+  // more than once, the last entry wins
+  struct Update {
+    uint64_t key = 0;
+    bool isMipTail = false;
+    uint32_t mipTailLayer = 0;
+    VkImageSubresource subresource = {};
+    VkOffset3D offset = {};
+    VkExtent3D extent = {};
+    bool isResident = false;
+    VulkanImage::SparsePage mem;
+  };
+
+  std::vector<Update> updates;
+  std::unordered_map<uint64_t, uint32_t> updateIndices;
+
+  updates.reserve(numPages);
+
+  for (uint32_t i = 0; i != numPages; i++) {
+    const TexturePage& page = pages[i];
+
+    if (!LVK_VERIFY(page.mipLevel < img.numLevels_ && page.layer < img.numLayers_)) {
+      return Result(Result::Code::ArgumentOutOfRange, "Invalid mip-level or layer");
+    }
+
+    Update u = {
+        .isMipTail = page.mipLevel >= req.imageMipTailFirstLod,
+        .mipTailLayer = isSingleMipTail ? 0 : page.layer,
+        .subresource = {aspect, page.mipLevel, page.layer},
+        .isResident = page.isResident,
+    };
+
+    if (!u.isMipTail) {
+      const uint32_t w = std::max(img.vkExtent_.width >> page.mipLevel, 1u);
+      const uint32_t h = std::max(img.vkExtent_.height >> page.mipLevel, 1u);
+      const uint32_t d = std::max(img.vkExtent_.depth >> page.mipLevel, 1u);
+      const uint32_t x = page.x * pageSize.width;
+      const uint32_t y = page.y * pageSize.height;
+      const uint32_t z = page.z * pageSize.depth;
+      if (!LVK_VERIFY(x < w && y < h && z < d)) {
+        return Result(Result::Code::ArgumentOutOfRange, "The page is outside of its mip-level");
+      }
+      u.offset = {int32_t(x), int32_t(y), int32_t(z)};
+      // pages at the edges of a mip-level can be partial
+      u.extent = {std::min(pageSize.width, w - x), std::min(pageSize.height, h - y), std::min(pageSize.depth, d - z)};
+    }
+
+    u.key = u.isMipTail ? getTexturePageKey(0xff, u.mipTailLayer, 0, 0, 0)
+                        : getTexturePageKey(page.mipLevel, page.layer, page.x, page.y, page.z);
+
+    if (const auto it = updateIndices.find(u.key); it != updateIndices.end()) {
+      updates[it->second] = u;
+    } else {
+      updateIndices[u.key] = (uint32_t)updates.size();
+      updates.push_back(u);
+    }
   }
 
-  stagingDevice_->getImageData(*texture->image_.get(),
-                               VkOffset3D{(int32_t)range.x, (int32_t)range.y, (int32_t)range.z},
-                               VkExtent3D{range.dimensions.width, range.dimensions.height, range.dimensions.depth},
-                               VkImageSubresourceRange{
-                                   .aspectMask = texture->image_->getImageAspectFlags(),
-                                   .baseMipLevel = range.mipLevel,
-                                   .levelCount = range.numMipLevels,
-                                   .baseArrayLayer = range.layer,
-                                   .layerCount = range.numLayers,
-                               },
-                               texture->image_->vkImageFormat_,
-                               outData);
+  std::lock_guard lock(pimpl_->texturePagesMutex_);
 
-  return Result();
-}
+  std::erase_if(updates, [&img](const Update& u) { return u.isResident == img.sparsePages_.contains(u.key); });
 
-lvk::Result lvk::VulkanContext::upload(lvk::TextureHandle handle, const TextureRangeDesc& range, const void* data) {
-  if (!data) {
+  if (updates.empty()) {
     return Result();
   }
 
-  lvk::VulkanTexture* texture = texturesPool_.get(handle);
+  // 2. allocate memory for all new resident pages; free everything allocated here if any allocation fails
+  for (uint32_t i = 0; i != updates.size(); i++) {
+    Update& u = updates[i];
 
-  const Result result = validateRange(texture->getExtent(), texture->image_->numLevels_, range);
+    if (!u.isResident) {
+      continue;
+    }
 
-  if (!LVK_VERIFY(result.isOk())) {
-    return result;
+    const VkMemoryRequirements memRequirements = {
+        .size = u.isMipTail ? req.imageMipTailSize : img.sparseMemoryRequirements_.alignment,
+        .alignment = img.sparseMemoryRequirements_.alignment,
+        .memoryTypeBits = img.sparseMemoryRequirements_.memoryTypeBits,
+    };
+
+    VkResult result = VK_SUCCESS;
+
+    if (LVK_VULKAN_USE_VMA) {
+      const VmaAllocationCreateInfo ci = {.usage = VMA_MEMORY_USAGE_GPU_ONLY};
+      VmaAllocationInfo info = {};
+      result = vmaAllocateMemory((VmaAllocator)getVmaAllocator(), &memRequirements, &ci, &u.mem.allocation, &info);
+      u.mem.memory = info.deviceMemory;
+      u.mem.offset = info.offset;
+      u.mem.size = memRequirements.size;
+    } else if (u.isMipTail) {
+      // mip tails can span several pages: a dedicated allocation
+      result = lvk::allocateMemory(
+          vkDT_, vkPhysicalDevice_, vkDevice_, &memRequirements, storageTypeToVkMemoryPropertyFlags(StorageType_Device), &u.mem.memory);
+      u.mem.size = memRequirements.size;
+    } else {
+      result = pimpl_->sparsePageBlocks_.allocate(vkDT_, vkPhysicalDevice_, vkDevice_, memRequirements, &u.mem);
+    }
+
+    if (result != VK_SUCCESS) {
+      for (uint32_t j = 0; j != i; j++) {
+        if (updates[j].isResident) {
+          freeSparsePage(pimpl_->vma_, vkDT_, vkDevice_, &pimpl_->sparsePageBlocks_, updates[j].mem);
+        }
+      }
+      return Result(Result::Code::RuntimeError, "Cannot allocate memory for a sparse page");
+    }
+  }
+
+  // 3. nothing can fail from here on: record the binds; all updates of one image go into the same VkSparseImageMemoryBindInfo
+  VulkanContextImpl::PendingTexturePages* pending = nullptr;
+
+  for (VulkanContextImpl::PendingTexturePages& p : pimpl_->pendingTexturePages_) {
+    if (p.image == img.vkImage_) {
+      pending = &p;
+      break;
+    }
   }
 
-  const uint32_t numLayers = std::max(range.numLayers, 1u);
+  if (!pending) {
+    pending = &pimpl_->pendingTexturePages_.emplace_back();
+    pending->image = img.vkImage_;
+  }
 
-  const VkImageType type = texture->image_->vkType_;
-  VkFormat vkFormat = texture->image_->vkImageFormat_;
+  for (const Update& u : updates) {
+    // an empty page unbinds memory
+    if (u.isResident) {
+      img.sparsePages_[u.key] = u.mem;
+    } else {
+      const auto it = img.sparsePages_.find(u.key);
+      pimpl_->releasedTexturePages_.push_back(it->second);
+      img.sparsePages_.erase(it);
+    }
 
-  if (type == VK_IMAGE_TYPE_3D) {
-    stagingDevice_->imageData3D(*texture->image_.get(),
-                                VkOffset3D{(int32_t)range.x, (int32_t)range.y, (int32_t)range.z},
-                                VkExtent3D{range.dimensions.width, range.dimensions.height, range.dimensions.depth},
-                                vkFormat,
-                                data);
-  } else {
-    const VkRect2D imageRegion = {
-        .offset = {.x = (int)range.x, .y = (int)range.y},
-        .extent = {.width = range.dimensions.width, .height = range.dimensions.height},
-    };
-    stagingDevice_->imageData2D(
-        *texture->image_.get(), imageRegion, range.mipLevel, range.numMipLevels, range.layer, range.numLayers, vkFormat, data);
+    if (u.isMipTail) {
+      pending->opaqueBinds.push_back({
+          .resourceOffset = req.imageMipTailOffset + u.mipTailLayer * req.imageMipTailStride,
+          .size = req.imageMipTailSize,
+          .memory = u.mem.memory,
+          .memoryOffset = u.mem.offset,
+      });
+    } else {
+      pending->binds.push_back({
+          .subresource = u.subresource,
+          .offset = u.offset,
+          .extent = u.extent,
+          .memory = u.mem.memory,
+          .memoryOffset = u.mem.offset,
+      });
+    }
   }
 
   return Result();
 }
 
-lvk::Dimensions lvk::VulkanContext::getDimensions(TextureHandle handle) const {
-  if (!handle) {
-    return {};
-  }
-
+lvk::SparseTextureInfo lvk::VulkanContext::getSparseTextureInfo(TextureHandle handle) const {
   const lvk::VulkanTexture* tex = texturesPool_.get(handle);
 
-  LVK_ASSERT(tex);
-
-  if (!tex || !tex->image_) {
+  if (!tex || !tex->image_->isSparse_) {
     return {};
   }
 
+  const lvk::VulkanImage& img = *tex->image_;
+  const VkSparseImageMemoryRequirements& req = img.sparseRequirements_;
+
+  std::lock_guard lock(pimpl_->texturePagesMutex_);
+
   return {
-      .width = tex->image_->vkExtent_.width,
-      .height = tex->image_->vkExtent_.height,
-      .depth = tex->image_->vkExtent_.depth,
+      .pageSize = {req.formatProperties.imageGranularity.width,
+                   req.formatProperties.imageGranularity.height,
+                   req.formatProperties.imageGranularity.depth},
+      .pageBytes = uint32_t(img.sparseMemoryRequirements_.alignment),
+      .mipTailFirstLevel = std::min(req.imageMipTailFirstLod, img.numLevels_),
+      .mipTailBytes = uint32_t(req.imageMipTailSize),
+      .numResidentPages = uint32_t(img.sparsePages_.size()),
+      .isNonResidentStrict = getVkPhysicalDeviceProperties().sparseProperties.residencyNonResidentStrict == VK_TRUE,
   };
 }
 
-void lvk::VulkanContext::generateMipmap(TextureHandle handle) const {
-  if (handle.empty()) {
-    return;
+std::vector<lvk::VulkanImage::SparsePage> lvk::VulkanContext::flushTexturePages(uint64_t* outBindValue) {
+  std::lock_guard lock(pimpl_->texturePagesMutex_);
+
+  if (outBindValue) {
+    *outBindValue = 0;
   }
 
-  const lvk::VulkanTexture* tex = texturesPool_.get(handle);
+  if (pimpl_->pendingTexturePages_.empty()) {
+    return std::exchange(pimpl_->releasedTexturePages_, {});
+  }
 
-  if (tex->image_->numLevels_ > 1) {
-    LVK_ASSERT(tex->image_->vkImageLayout_ != VK_IMAGE_LAYOUT_UNDEFINED);
-    const auto& wrapper = immediate_->acquire();
-    tex->image_->generateMipmap(wrapper.cmdBuf_);
-    immediate_->submit(wrapper);
+  LVK_PROFILER_FUNCTION_COLOR(LVK_PROFILER_COLOR_SUBMIT);
+
+  std::vector<VkSparseImageMemoryBindInfo> imageBinds;
+  std::vector<VkSparseImageOpaqueMemoryBindInfo> opaqueBinds;
+
+  for (const VulkanContextImpl::PendingTexturePages& p : pimpl_->pendingTexturePages_) {
+    if (!p.binds.empty()) {
+      imageBinds.push_back({.image = p.image, .bindCount = (uint32_t)p.binds.size(), .pBinds = p.binds.data()});
+    }
+    if (!p.opaqueBinds.empty()) {
+      opaqueBinds.push_back({.image = p.image, .bindCount = (uint32_t)p.opaqueBinds.size(), .pBinds = p.opaqueBinds.data()});
+    }
+  }
+
+  // one vkQueueBindSparse() for all textures
+  if (!imageBinds.empty() || !opaqueBinds.empty()) {
+    const uint64_t bindValue =
+        immediate_->bindSparse(imageBinds.data(), (uint32_t)imageBinds.size(), opaqueBinds.data(), (uint32_t)opaqueBinds.size());
+    if (outBindValue) {
+      *outBindValue = bindValue;
+    }
   }
+
+  pimpl_->pendingTexturePages_.clear();
+
+  return std::exchange(pimpl_->releasedTexturePages_, {});
 }
 
-lvk::Format lvk::VulkanContext::getFormat(TextureHandle handle) const {
-  if (handle.empty()) {
-    return Format_Invalid;
+void lvk::VulkanContext::freeTexturePages(std::vector<VulkanImage::SparsePage>&& pages, SubmitHandle handle) {
+  if (pages.empty()) {
+    return;
   }
 
-  return vkFormatToFormat(texturesPool_.get(handle)->image_->vkImageFormat_);
+  // the submit waits for the unbinding
+  deferredTask(std::packaged_task<void()>([vma = getVmaAllocator(),
+                                           &vkDT = vkDT_,
+                                           device = vkDevice_,
+                                           blocks = &pimpl_->sparsePageBlocks_,
+                                           pages = std::move(pages)]() {
+                 for (const VulkanImage::SparsePage& page : pages) {
+                   freeSparsePage((VmaAllocator)vma, vkDT, device, blocks, page);
+                 }
+               }),
+               handle);
 }
 
 lvk::Holder<lvk::ShaderModuleHandle> lvk::VulkanContext::createShaderModule(const ShaderModuleDesc& desc, Result* outResult) {
@@ -4101,9 +7621,49 @@ lvk::Holder<lvk::ShaderModuleHandle> lvk::VulkanContext::createShaderModule(cons
     Result::setResult(outResult, result);
     return {};
   }
+
+  ShaderModuleHandle handle = shaderModulesPool_.create(std::move(sm));
+
+  if (!LVK_VERIFY(!handle.empty())) {
+    vkDT_.vkDestroyShaderModule(vkDevice_, sm.sm, nullptr);
+    Result::setResult(outResult, Result::Code::RuntimeError, "Too many shader modules");
+    return {};
+  }
+
   Result::setResult(outResult, result);
 
-  return {this, shaderModulesPool_.create(std::move(sm))};
+  return {this, handle};
+}
+
+void lvk::VulkanContext::createShaderModules(const ShaderModuleDesc* descs,
+                                             uint32_t numDescs,
+                                             Holder<ShaderModuleHandle>* outHandles,
+                                             Result* outResults) {
+  LVK_PROFILER_FUNCTION();
+
+  LVK_ASSERT(descs || !numDescs);
+  LVK_ASSERT(outHandles || !numDescs);
+
+  std::vector<ShaderModuleState> states(numDescs);
+  std::vector<Result> results(numDescs);
+
+  // glslang and vkCreateShaderModule() are thread-safe; the SPIR-V cache is guarded by its own mutex
+  pimpl_->workerPool_.parallelFor(numDescs, [this, descs, &states, &results](uint32_t i) {
+    const ShaderModuleDesc& desc = descs[i];
+    states[i] = desc.dataSize ? createShaderModuleFromSPIRV(desc.data, desc.dataSize, desc.debugName, &results[i])
+                              : createShaderModuleFromGLSL(desc.stage, desc.data, desc.debugName, &results[i]);
+  });
+
+  // the pool is not thread-safe
+  for (uint32_t i = 0; i != numDescs; i++) {
+    ShaderModuleHandle handle = results[i].isOk() ? shaderModulesPool_.create(std::move(states[i])) : ShaderModuleHandle();
+    if (results[i].isOk() && !LVK_VERIFY(!handle.empty())) {
+      vkDT_.vkDestroyShaderModule(vkDevice_, states[i].sm, nullptr);
+      results[i] = Result(Result::Code::RuntimeError, "Too many shader modules");
+    }
+    outHandles[i] = Holder<ShaderModuleHandle>(this, handle);
+    Result::setResult(outResults ? &outResults[i] : nullptr, results[i]);
+  }
 }
 
 lvk::ShaderModuleState lvk::VulkanContext::createShaderModuleFromSPIRV(const void* spirv,
@@ -4119,7 +7679,7 @@ lvk::ShaderModuleState lvk::VulkanContext::createShaderModuleFromSPIRV(const voi
   };
 
   {
-    const VkResult result = vkCreateShaderModule(vkDevice_, &ci, nullptr, &vkShaderModule);
+    const VkResult result = vkDT_.vkCreateShaderModule(vkDevice_, &ci, nullptr, &vkShaderModule);
 
     lvk::setResultFrom(outResult, result);
 
@@ -4128,7 +7688,7 @@ lvk::ShaderModuleState lvk::VulkanContext::createShaderModuleFromSPIRV(const voi
     }
   }
 
-  VK_ASSERT(lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)vkShaderModule, debugName));
+  VK_ASSERT(lvk::setDebugObjectName(vkDT_, vkDevice_, VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)vkShaderModule, debugName));
 
   LVK_ASSERT(vkShaderModule != VK_NULL_HANDLE);
 
@@ -4179,6 +7739,17 @@ lvk::ShaderModuleState lvk::VulkanContext::createShaderModuleFromGLSL(ShaderStag
       #extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
       )";
     }
+    if (vkStage == VK_SHADER_STAGE_TASK_BIT_EXT || vkStage == VK_SHADER_STAGE_MESH_BIT_EXT) {
+      sourcePatched += R"(
+      #version 460
+      #extension GL_EXT_mesh_shader : require
+      #extension GL_EXT_buffer_reference : require
+      #extension GL_EXT_buffer_reference_uvec2 : require
+      #extension GL_EXT_debug_printf : enable
+      #extension GL_EXT_nonuniform_qualifier : require
+      #extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
+      )";
+    }
     if (vkStage == VK_SHADER_STAGE_FRAGMENT_BIT) {
       sourcePatched += R"(
       #version 460
@@ -4224,10 +7795,58 @@ lvk::ShaderModuleState lvk::VulkanContext::createShaderModuleFromGLSL(ShaderStag
     source = sourcePatched.c_str();
   }
 
-  const glslang_resource_t glslangResource = lvk::getGlslangResource(getVkPhysicalDeviceProperties().limits);
+  const VkPhysicalDeviceLimits& limits = getVkPhysicalDeviceProperties().limits;
+
+  // the key covers the patched source, the stage, and the device limits used to build the glslang resource
+  uint64_t key = hashFNV1a(&kSpirvCacheVersion, sizeof(kSpirvCacheVersion));
+  key = hashFNV1a(&vkStage, sizeof(vkStage), key);
+  key = hashGlslangLimits(limits, key);
+  key = hashFNV1a(source, strlen(source), key);
 
   std::vector<uint8_t> spirv;
-  const Result result = lvk::compileShader(vkStage, source, &spirv, &glslangResource);
+
+  {
+    std::lock_guard lock(pimpl_->spirvCacheMutex_);
+    auto it = pimpl_->spirvCache_.find(key);
+    if (it != pimpl_->spirvCache_.end()) {
+      spirv = it->second.spirv;
+      pimpl_->spirvCacheLRU_.splice(pimpl_->spirvCacheLRU_.begin(), pimpl_->spirvCacheLRU_, it->second.lru);
+    }
+  }
+
+  if (spirv.empty()) {
+    const std::string fileName = shaderCacheDir_.empty() ? std::string() : getSpirvCacheFileName(shaderCacheDir_.c_str(), key);
+
+    if (fileName.empty() || !loadSpirvCacheFile(fileName.c_str(), key, &spirv)) {
+      const glslang_resource_t glslangResource = lvk::getGlslangResource(limits);
+
+      const Result result = lvk::compileShader(vkStage, source, &spirv, &glslangResource);
+
+      if (!result.isOk()) {
+        Result::setResult(outResult, result);
+        return {};
+      }
+
+      if (!fileName.empty()) {
+        saveSpirvCacheFile(fileName.c_str(), key, spirv);
+      }
+    }
+
+    std::lock_guard lock(pimpl_->spirvCacheMutex_);
+    // another thread might have compiled the same source in the meantime
+    if (!pimpl_->spirvCache_.contains(key)) {
+      pimpl_->spirvCacheLRU_.push_front(key);
+      pimpl_->spirvCache_[key] = {.spirv = spirv, .lru = pimpl_->spirvCacheLRU_.begin()};
+      pimpl_->spirvCacheBytes_ += spirv.size();
+      // evict the least recently used entries, but always keep the one just added
+      while (pimpl_->spirvCacheBytes_ > VulkanContextImpl::kSpirvCacheMaxBytes && pimpl_->spirvCacheLRU_.size() > 1) {
+        auto it = pimpl_->spirvCache_.find(pimpl_->spirvCacheLRU_.back());
+        pimpl_->spirvCacheBytes_ -= it->second.spirv.size();
+        pimpl_->spirvCache_.erase(it);
+        pimpl_->spirvCacheLRU_.pop_back();
+      }
+    }
+  }
 
   return createShaderModuleFromSPIRV(spirv.data(), spirv.size(), debugName, outResult);
 }
@@ -4248,80 +7867,446 @@ uint32_t lvk::VulkanContext::getNumSwapchainImages() const {
   return hasSwapchain() ? swapchain_->getNumSwapchainImages() : 0;
 }
 
-lvk::TextureHandle lvk::VulkanContext::getCurrentSwapchainTexture() {
-  LVK_PROFILER_FUNCTION();
+lvk::TextureHandle lvk::VulkanContext::getCurrentSwapchainTexture() {
+  LVK_PROFILER_FUNCTION();
+
+  if (!hasSwapchain()) {
+    return {};
+  }
+
+  TextureHandle tex = swapchain_->getCurrentTexture();
+
+  if (!LVK_VERIFY(tex.valid())) {
+    LVK_ASSERT_MSG(false, "Swapchain has no valid texture");
+    return {};
+  }
+
+  LVK_ASSERT_MSG(texturesPool_.get(tex)->image_->vkImageFormat_ != VK_FORMAT_UNDEFINED, "Invalid image format");
+
+  return tex;
+}
+
+void lvk::VulkanContext::recreateSwapchain(int newWidth, int newHeight) {
+  initSwapchain(newWidth, newHeight);
+}
+
+uint64_t lvk::VulkanContext::getLastPresentId() const {
+  return lastPresentId_;
+}
+
+bool lvk::VulkanContext::waitForPresent(uint64_t presentId, uint64_t timeoutNs) {
+  if (!hasSwapchain() || !presentId) {
+    return false;
+  }
+
+  ScopedHostWait hostWait(&frameCounters_, lvk::HostWait_Present);
+
+  return swapchain_->waitForPresent(presentId, timeoutNs);
+}
+
+uint32_t lvk::VulkanContext::getFramebufferMSAABitMask() const {
+  const VkPhysicalDeviceLimits& limits = getVkPhysicalDeviceProperties().limits;
+  return limits.framebufferColorSampleCounts;
+}
+
+bool lvk::VulkanContext::isStorageFormatSupported(Format format) const {
+  const VkFormat vkFormat = formatToVkFormat(format);
+
+  if (vkFormat == VK_FORMAT_UNDEFINED) {
+    return false;
+  }
+
+  VkFormatProperties props = {};
+  vkGetPhysicalDeviceFormatProperties(vkPhysicalDevice_, vkFormat, &props);
+
+  return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+}
+
+double lvk::VulkanContext::getTimestampPeriodToMs() const {
+  return double(getVkPhysicalDeviceProperties().limits.timestampPeriod) * 1e-6;
+}
+
+bool lvk::VulkanContext::getQueryPoolResults(QueryPoolHandle pool,
+                                             uint32_t firstQuery,
+                                             uint32_t queryCount,
+                                             size_t dataSize,
+                                             void* outData,
+                                             size_t stride) const {
+  VkQueryPool vkPool = *queriesPool_.get(pool);
+
+  VK_ASSERT(vkDT_.vkGetQueryPoolResults(
+      vkDevice_, vkPool, firstQuery, queryCount, dataSize, outData, stride, VK_QUERY_RESULT_WAIT_BIT | VK_QUERY_RESULT_64_BIT));
+
+  return true;
+}
+
+uint32_t lvk::VulkanContext::getGPUProfilerScopes(GPUProfilerScope* outScopes, uint32_t maxOutScopes, uint64_t* outFrameIndex) const {
+  // gpuProfilerNextFrame() replaces the resolved scopes on present, possibly on another thread
+  std::lock_guard lock(pimpl_->gpuProfilerMutex_);
+
+  const std::vector<lvk::GPUProfilerScope>& scopes = pimpl_->gpuProfilerResolvedScopes_;
+
+  if (outScopes) {
+    std::copy_n(scopes.begin(), std::min((size_t)maxOutScopes, scopes.size()), outScopes);
+  }
+  if (outFrameIndex) {
+    *outFrameIndex = pimpl_->gpuProfilerResolvedFrameIndex_;
+  }
+
+  return (uint32_t)scopes.size();
+}
+
+lvk::FrameStats lvk::VulkanFrameCounters::reset() {
+  FrameStats stats = {
+      .numSubmits = numSubmits.exchange(0),
+      .numBarriers = numBarriers.exchange(0),
+      .numDescriptorSetUpdates = numDescriptorSetUpdates.exchange(0),
+      .numDescriptorWrites = numDescriptorWrites.exchange(0),
+      .numPipelineCompiles = numPipelineCompiles.exchange(0),
+      .pipelineCompileTimeMs = double(pipelineCompileTimeNs.exchange(0)) * 1e-6,
+      .stagingBytes = stagingBytes.exchange(0),
+  };
+
+  for (uint32_t i = 0; i != HostWait_Num; i++) {
+    stats.hostWaits[i] = {
+        .count = numHostWaits[i].exchange(0),
+        .timeMs = double(hostWaitTimeNs[i].exchange(0)) * 1e-6,
+    };
+  }
+
+  return stats;
+}
+
+lvk::FrameStats lvk::VulkanContext::getFrameStats() const {
+  std::lock_guard lock(pimpl_->frameStatsMutex_);
+
+  return pimpl_->frameStats_;
+}
+
+lvk::CommandBufferStats lvk::VulkanContext::getCommandBufferStats() const {
+  std::lock_guard lock(pimpl_->commandBufferStatsMutex_);
+
+  return pimpl_->commandBufferStats_;
+}
+
+uint32_t lvk::VulkanContext::getMemoryHeapStats(MemoryHeapStats* outHeaps) const {
+  VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+  };
+  VkPhysicalDeviceMemoryProperties2 props = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+      .pNext = hasMemoryBudget_ ? &budgetProps : nullptr,
+  };
+  vkGetPhysicalDeviceMemoryProperties2(vkPhysicalDevice_, &props);
+
+  // VMA takes the budget from VK_EXT_memory_budget and estimates it otherwise
+  VmaBudget vmaBudgets[VK_MAX_MEMORY_HEAPS] = {};
+  if (LVK_VULKAN_USE_VMA) {
+    vmaGetHeapBudgets((VmaAllocator)getVmaAllocator(), vmaBudgets);
+  }
+
+  const uint32_t numHeaps = std::min(props.memoryProperties.memoryHeapCount, (uint32_t)MemoryStats::LVK_MAX_MEMORY_HEAPS);
+
+  for (uint32_t i = 0; i != numHeaps; i++) {
+    const VkMemoryHeap& heap = props.memoryProperties.memoryHeaps[i];
+    MemoryHeapStats& stats = outHeaps[i];
+    stats = {
+        .size = heap.size,
+        .isDeviceLocal = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0,
+    };
+    if (LVK_VULKAN_USE_VMA) {
+      stats.budget = vmaBudgets[i].budget;
+      stats.usage = vmaBudgets[i].usage;
+    } else if (hasMemoryBudget_) {
+      stats.budget = budgetProps.heapBudget[i];
+      stats.usage = budgetProps.heapUsage[i];
+    } else {
+      // the same heuristic as VMA uses
+      stats.budget = heap.size * 8 / 10;
+    }
+  }
+
+  return numHeaps;
+}
+
+lvk::MemoryStats lvk::VulkanContext::getMemoryStats() const {
+  LVK_PROFILER_FUNCTION();
+
+  MemoryStats stats;
+
+  stats.numHeaps = getMemoryHeapStats(stats.heaps);
+  stats.hasMemoryBudget = hasMemoryBudget_;
+
+  std::unique_lock buffersLock(buffersPool_.mutex_);
+
+  for (const auto& entry : buffersPool_.objects_) {
+    const lvk::VulkanBuffer& buf = entry.obj_;
+    if (buf.vkBuffer_ != VK_NULL_HANDLE) {
+      stats.numBuffers++;
+      stats.bufferBytes += buf.bufferSize_;
+    }
+  }
+
+  buffersLock.unlock();
+
+  // texture views share images
+  std::unordered_set<const lvk::VulkanImage*> images;
+
+  std::lock_guard texturesLock(texturesPool_.mutex_);
+
+  for (const auto& entry : texturesPool_.objects_) {
+    const lvk::VulkanImage* img = entry.obj_.image_.get();
+    if (!img || img->isSwapchainImage_ || !images.insert(img).second) {
+      continue;
+    }
+    stats.numTextures++;
+    if (img->aliasOf_) {
+      continue;
+    }
+    if (img->isSparse_) {
+      std::lock_guard lock(pimpl_->texturePagesMutex_);
+      for (const auto& p : img->sparsePages_) {
+        stats.textureBytes += p.second.size;
+      }
+      continue;
+    }
+    if (LVK_VULKAN_USE_VMA) {
+      VmaAllocationInfo info = {};
+      vmaGetAllocationInfo((VmaAllocator)getVmaAllocator(), img->vmaAllocation_, &info);
+      stats.textureBytes += info.size;
+    } else {
+      stats.textureBytes += img->vkMemorySize_;
+    }
+  }
+
+  if (stagingDevice_) {
+    // uploads change the staging ring on other threads
+    std::lock_guard lock(stagingDevice_->mutex_);
+    stats.stagingBufferBytes = stagingDevice_->stagingBufferSize_;
+    for (const VulkanStagingDevice::MemoryRegionDesc& r : stagingDevice_->regions_) {
+      stats.stagingBufferBytesInFlight += r.size_;
+    }
+  }
+
+  {
+    std::lock_guard lock(pimpl_->transientBuffersMutex_);
+    for (const VulkanContextImpl::TransientBuffer& b : pimpl_->transientBuffers_) {
+      stats.transientBufferBytes += b.size;
+    }
+  }
+
+  return stats;
+}
+
+void lvk::VulkanContext::checkMemoryBudget() {
+  if (!config_.memoryBudgetCallback) {
+    return;
+  }
+
+  MemoryHeapStats heaps[MemoryStats::LVK_MAX_MEMORY_HEAPS];
+
+  const uint32_t numHeaps = getMemoryHeapStats(heaps);
+
+  for (uint32_t i = 0; i != numHeaps; i++) {
+    const MemoryHeapStats& heap = heaps[i];
+    const uint32_t bit = 1u << i;
+    if (heap.budget && double(heap.usage) > double(heap.budget) * config_.memoryBudgetThreshold) {
+      if (!(pimpl_->memoryBudgetExceededHeaps_.fetch_or(bit) & bit)) {
+        config_.memoryBudgetCallback(this, i, heap.usage, heap.budget);
+      }
+    } else {
+      pimpl_->memoryBudgetExceededHeaps_.fetch_and(~bit);
+    }
+  }
+}
+
+void lvk::VulkanContext::initGPUProfiler() {
+  LVK_PROFILER_FUNCTION();
+
+  if (!config_.enableGPUProfiler) {
+    return;
+  }
+
+  const VkPhysicalDeviceLimits& limits = getVkPhysicalDeviceProperties().limits;
+
+  if (!vkFeatures12_.hostQueryReset || !limits.timestampComputeAndGraphics || !config_.gpuProfilerMaxScopesPerFrame) {
+    LLOGW("GPU profiler is not supported on this device (hostQueryReset and timestampComputeAndGraphics are required)\n");
+    config_.enableGPUProfiler = false;
+    return;
+  }
+
+  const uint32_t numQueries = 2 * config_.gpuProfilerMaxScopesPerFrame;
+
+  for (uint32_t i = 0; i != VulkanContextImpl::kGPUProfilerNumFrames; i++) {
+    VulkanContextImpl::GPUProfilerFrame& frame = pimpl_->gpuProfilerFrames_[i];
+
+    const VkQueryPoolCreateInfo ci = {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .flags = 0,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = numQueries,
+        .pipelineStatistics = 0,
+    };
+    VK_ASSERT(vkDT_.vkCreateQueryPool(vkDevice_, &ci, nullptr, &frame.queryPool));
+    VK_ASSERT(lvk::setDebugObjectName(vkDT_, vkDevice_, VK_OBJECT_TYPE_QUERY_POOL, (uint64_t)frame.queryPool, "Query pool: GPU profiler"));
+    vkDT_.vkResetQueryPool(vkDevice_, frame.queryPool, 0, numQueries);
+
+    frame.scopes.resize(config_.gpuProfilerMaxScopesPerFrame);
+  }
+
+#if defined(LVK_WITH_TRACY)
+  // a reference GPU timestamp to align the GPU timeline with the CPU one
+  {
+    VulkanContextImpl::GPUProfilerFrame& frame = pimpl_->gpuProfilerFrames_[0];
+    const VulkanImmediateCommands::CommandBufferWrapper& wrapper = immediate_->acquire();
+    vkDT_.vkCmdWriteTimestamp(wrapper.cmdBuf_, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, 0);
+    immediate_->wait(immediate_->submit(wrapper));
+    int64_t gpuTime = 0;
+    VK_ASSERT(vkDT_.vkGetQueryPoolResults(
+        vkDevice_, frame.queryPool, 0, 1, sizeof(gpuTime), &gpuTime, sizeof(gpuTime), VK_QUERY_RESULT_WAIT_BIT | VK_QUERY_RESULT_64_BIT));
+    vkDT_.vkResetQueryPool(vkDevice_, frame.queryPool, 0, 1);
+    pimpl_->tracyGpuContext_ = tracyCreateGpuContext(gpuTime, limits.timestampPeriod);
+  }
+#endif // LVK_WITH_TRACY
+}
+
+void lvk::VulkanContext::gpuProfilerNextFrame() {
+  LVK_PROFILER_FUNCTION();
+
+  VulkanContextImpl& impl = *pimpl_;
+
+  std::lock_guard lock(impl.gpuProfilerMutex_);
+
+  impl.gpuProfilerCurrentFrame_ = (impl.gpuProfilerCurrentFrame_ + 1) % VulkanContextImpl::kGPUProfilerNumFrames;
 
-  if (!hasSwapchain()) {
-    return {};
+  VulkanContextImpl::GPUProfilerFrame& frame = impl.gpuProfilerFrames_[impl.gpuProfilerCurrentFrame_];
+
+  // this is the oldest frame in the ring: its command buffers are normally retired by now, so this does not stall
+  for (SubmitHandle handle : frame.submits) {
+    wait(handle);
   }
 
-  TextureHandle tex = swapchain_->getCurrentTexture();
+  if (frame.numScopes) {
+    // a value and an availability word per query; unbalanced scopes have unavailable end timestamps
+    std::vector<uint64_t> results(4 * frame.numScopes);
 
-  if (!LVK_VERIFY(tex.valid())) {
-    LVK_ASSERT_MSG(false, "Swapchain has no valid texture");
-    return {};
-  }
+    vkDT_.vkGetQueryPoolResults(vkDevice_,
+                                frame.queryPool,
+                                0,
+                                2 * frame.numScopes,
+                                results.size() * sizeof(uint64_t),
+                                results.data(),
+                                2 * sizeof(uint64_t),
+                                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
 
-  LVK_ASSERT_MSG(texturesPool_.get(tex)->image_->vkImageFormat_ != VK_FORMAT_UNDEFINED, "Invalid image format");
+    auto isAvailable = [&results](uint32_t query) -> bool { return results[2 * query + 1] != 0; };
+    auto getTimestamp = [&results](uint32_t query) -> uint64_t { return results[2 * query + 0]; };
 
-  return tex;
-}
+    uint64_t minTimestamp = UINT64_MAX;
 
-void lvk::VulkanContext::recreateSwapchain(int newWidth, int newHeight) {
-  initSwapchain(newWidth, newHeight);
-}
+    for (uint32_t i = 0; i != frame.numScopes; i++) {
+      if (isAvailable(2 * i)) {
+        minTimestamp = std::min(minTimestamp, getTimestamp(2 * i));
+      }
+    }
 
-uint32_t lvk::VulkanContext::getFramebufferMSAABitMask() const {
-  const VkPhysicalDeviceLimits& limits = getVkPhysicalDeviceProperties().limits;
-  return limits.framebufferColorSampleCounts;
-}
+    const double toMs = getTimestampPeriodToMs();
 
-double lvk::VulkanContext::getTimestampPeriodToMs() const {
-  return double(getVkPhysicalDeviceProperties().limits.timestampPeriod) * 1e-6;
-}
+    for (uint32_t i = 0; i != frame.numScopes; i++) {
+      lvk::GPUProfilerScope& s = frame.scopes[i];
+      const bool hasBegin = isAvailable(2 * i);
+      const bool hasEnd = hasBegin && isAvailable(2 * i + 1) && getTimestamp(2 * i + 1) >= getTimestamp(2 * i);
+      s.timeBeginMs = hasBegin ? double(getTimestamp(2 * i) - minTimestamp) * toMs : 0.0;
+      s.durationMs = hasEnd ? double(getTimestamp(2 * i + 1) - getTimestamp(2 * i)) * toMs : 0.0;
+    }
 
-bool lvk::VulkanContext::getQueryPoolResults(QueryPoolHandle pool,
-                                             uint32_t firstQuery,
-                                             uint32_t queryCount,
-                                             size_t dataSize,
-                                             void* outData,
-                                             size_t stride) const {
-  VkQueryPool vkPool = *queriesPool_.get(pool);
+    impl.gpuProfilerResolvedScopes_.assign(frame.scopes.begin(), frame.scopes.begin() + frame.numScopes);
+    impl.gpuProfilerResolvedFrameIndex_ = frame.frameIndex;
 
-  VK_ASSERT(vkGetQueryPoolResults(
-      vkDevice_, vkPool, firstQuery, queryCount, dataSize, outData, stride, VK_QUERY_RESULT_WAIT_BIT | VK_QUERY_RESULT_64_BIT));
+#if defined(LVK_WITH_TRACY)
+    // Tracy expects properly nested zones: emit every tree depth-first (scopes of one command buffer are already pre-ordered)
+    std::vector<uint32_t> roots(frame.numScopes);
+    std::vector<uint32_t> order(frame.numScopes);
+    for (uint32_t i = 0; i != frame.numScopes; i++) {
+      const uint32_t parent = frame.scopes[i].parent;
+      roots[i] = parent == ~0u ? i : roots[parent];
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&roots](uint32_t a, uint32_t b) { return roots[a] < roots[b]; });
 
-  return true;
+    struct OpenZone {
+      uint32_t scope;
+      uint16_t queryId;
+    };
+    std::vector<OpenZone> stack;
+
+    auto endZone = [&]() {
+      const OpenZone& z = stack.back();
+      const uint32_t end = isAvailable(2 * z.scope + 1) ? 2 * z.scope + 1 : 2 * z.scope;
+      tracyGpuZoneEnd(impl.tracyGpuContext_, uint16_t(z.queryId + 1));
+      tracyGpuTime(impl.tracyGpuContext_, uint16_t(z.queryId + 1), (int64_t)getTimestamp(end));
+      stack.pop_back();
+    };
+
+    for (uint32_t i : order) {
+      if (!isAvailable(2 * i)) {
+        continue;
+      }
+      while (!stack.empty() && stack.back().scope != frame.scopes[i].parent) {
+        endZone();
+      }
+      const uint16_t queryId = impl.tracyNextQueryId_;
+      impl.tracyNextQueryId_ += 2;
+      tracyGpuZoneBegin(impl.tracyGpuContext_, queryId, frame.scopes[i].name);
+      tracyGpuTime(impl.tracyGpuContext_, queryId, (int64_t)getTimestamp(2 * i));
+      stack.push_back({i, queryId});
+    }
+    while (!stack.empty()) {
+      endZone();
+    }
+#endif // LVK_WITH_TRACY
+
+    vkDT_.vkResetQueryPool(vkDevice_, frame.queryPool, 0, 2 * frame.numScopes);
+  }
+
+  frame.numScopes = 0;
+  frame.submits.clear();
+  frame.frameIndex = ++impl.gpuProfilerFrameIndex_;
 }
 
-void lvk::VulkanContext::createInstance() {
+void lvk::VulkanContext::createInstance(bool enableSurface) {
   vkInstance_ = VK_NULL_HANDLE;
 
-  const char* instanceExtensionNames[] = {
-    VK_KHR_SURFACE_EXTENSION_NAME,
+  std::vector<const char*> instanceExtensionNames = {
     VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
+#if defined(__APPLE__)
+    VK_EXT_LAYER_SETTINGS_EXTENSION_NAME,
+#endif
+#if defined(LVK_WITH_VULKAN_PORTABILITY)
+    VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME,
+#endif
+  };
+
+  if (enableSurface) {
+    instanceExtensionNames.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
 #if defined(_WIN32)
-    VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
+    instanceExtensionNames.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
 #elif defined(VK_USE_PLATFORM_ANDROID_KHR)
-    VK_KHR_ANDROID_SURFACE_EXTENSION_NAME,
+    instanceExtensionNames.push_back(VK_KHR_ANDROID_SURFACE_EXTENSION_NAME);
 #elif defined(__linux__)
 #if defined(VK_USE_PLATFORM_WAYLAND_KHR)
-    VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME,
+    instanceExtensionNames.push_back(VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME);
 #else
-    VK_KHR_XLIB_SURFACE_EXTENSION_NAME,
+    instanceExtensionNames.push_back(VK_KHR_XLIB_SURFACE_EXTENSION_NAME);
 #endif
 #elif defined(__APPLE__)
-    VK_EXT_LAYER_SETTINGS_EXTENSION_NAME,
-    VK_MVK_MACOS_SURFACE_EXTENSION_NAME,
+    instanceExtensionNames.push_back(VK_MVK_MACOS_SURFACE_EXTENSION_NAME);
 #endif
-#if defined(LVK_WITH_VULKAN_PORTABILITY)
-    VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME,
-#endif
-    VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME // enabled only for validation
-  };
+  }
 
-  const uint32_t numInstanceExtensions = config_.enableValidation ? (uint32_t)LVK_ARRAY_NUM_ELEMENTS(instanceExtensionNames)
-                                                                  : (uint32_t)LVK_ARRAY_NUM_ELEMENTS(instanceExtensionNames) - 1;
+  if (config_.enableValidation) {
+    instanceExtensionNames.push_back(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+  }
 
 #if !defined(ANDROID)
   // GPU Assisted Validation doesn't work on Android.
@@ -4392,12 +8377,31 @@ void lvk::VulkanContext::createInstance() {
       .pApplicationInfo = &appInfo,
       .enabledLayerCount = config_.enableValidation ? (uint32_t)LVK_ARRAY_NUM_ELEMENTS(kDefaultValidationLayers) : 0u,
       .ppEnabledLayerNames = config_.enableValidation ? kDefaultValidationLayers : nullptr,
-      .enabledExtensionCount = numInstanceExtensions,
-      .ppEnabledExtensionNames = instanceExtensionNames,
+      .enabledExtensionCount = (uint32_t)instanceExtensionNames.size(),
+      .ppEnabledExtensionNames = instanceExtensionNames.data(),
   };
   VK_ASSERT(vkCreateInstance(&ci, nullptr, &vkInstance_));
 
-  volkLoadInstance(vkInstance_);
+  // `volkMutex` is locked by the caller
+  if (volkGetLoadedInstance() == VK_NULL_HANDLE) {
+    volkLoadInstanceOnly(vkInstance_);
+  }
+
+  auto getProcAddr = [instance = vkInstance_](const char* name) { return vkGetInstanceProcAddr(instance, name); };
+
+  vkIT_.vkCreateDebugUtilsMessengerEXT = (PFN_vkCreateDebugUtilsMessengerEXT)getProcAddr("vkCreateDebugUtilsMessengerEXT");
+  vkIT_.vkDestroyDebugUtilsMessengerEXT = (PFN_vkDestroyDebugUtilsMessengerEXT)getProcAddr("vkDestroyDebugUtilsMessengerEXT");
+  if (enableSurface) {
+    vkIT_.vkDestroySurfaceKHR = (PFN_vkDestroySurfaceKHR)getProcAddr("vkDestroySurfaceKHR");
+    vkIT_.vkGetPhysicalDeviceSurfaceSupportKHR =
+        (PFN_vkGetPhysicalDeviceSurfaceSupportKHR)getProcAddr("vkGetPhysicalDeviceSurfaceSupportKHR");
+    vkIT_.vkGetPhysicalDeviceSurfaceCapabilitiesKHR =
+        (PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR)getProcAddr("vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
+    vkIT_.vkGetPhysicalDeviceSurfaceFormatsKHR =
+        (PFN_vkGetPhysicalDeviceSurfaceFormatsKHR)getProcAddr("vkGetPhysicalDeviceSurfaceFormatsKHR");
+    vkIT_.vkGetPhysicalDeviceSurfacePresentModesKHR =
+        (PFN_vkGetPhysicalDeviceSurfacePresentModesKHR)getProcAddr("vkGetPhysicalDeviceSurfacePresentModesKHR");
+  }
 
   // debug messenger
   {
@@ -4410,7 +8414,7 @@ void lvk::VulkanContext::createInstance() {
         .pfnUserCallback = &vulkanDebugCallback,
         .pUserData = this,
     };
-    VK_ASSERT(vkCreateDebugUtilsMessengerEXT(vkInstance_, &ci, nullptr, &vkDebugUtilsMessenger_));
+    VK_ASSERT(vkIT_.vkCreateDebugUtilsMessengerEXT(vkInstance_, &ci, nullptr, &vkDebugUtilsMessenger_));
   }
 
   uint32_t count = 0;
@@ -4429,20 +8433,25 @@ void lvk::VulkanContext::createInstance() {
 }
 
 void lvk::VulkanContext::createSurface(void* window, void* display) {
+  // platform surface functions are loaded from `vkInstance_` (see `vkIT_`)
 #if defined(VK_USE_PLATFORM_WIN32_KHR)
   const VkWin32SurfaceCreateInfoKHR ci = {
       .sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
       .hinstance = GetModuleHandle(nullptr),
       .hwnd = (HWND)window,
   };
-  VK_ASSERT(vkCreateWin32SurfaceKHR(vkInstance_, &ci, nullptr, &vkSurface_));
+  const PFN_vkCreateWin32SurfaceKHR vkCreateSurface =
+      (PFN_vkCreateWin32SurfaceKHR)vkGetInstanceProcAddr(vkInstance_, "vkCreateWin32SurfaceKHR");
+  VK_ASSERT(vkCreateSurface(vkInstance_, &ci, nullptr, &vkSurface_));
 #elif defined(VK_USE_PLATFORM_ANDROID_KHR)
   const VkAndroidSurfaceCreateInfoKHR ci = {
       .sType = VK_STRUCTURE_TYPE_ANDROID_SURFACE_CREATE_INFO_KHR, 
       .pNext = nullptr, 
       .flags = 0, 
       .window = (ANativeWindow*)window};
-  VK_ASSERT(vkCreateAndroidSurfaceKHR(vkInstance_, &ci, nullptr, &vkSurface_));
+  const PFN_vkCreateAndroidSurfaceKHR vkCreateSurface =
+      (PFN_vkCreateAndroidSurfaceKHR)vkGetInstanceProcAddr(vkInstance_, "vkCreateAndroidSurfaceKHR");
+  VK_ASSERT(vkCreateSurface(vkInstance_, &ci, nullptr, &vkSurface_));
 #elif defined(VK_USE_PLATFORM_XLIB_KHR)
   const VkXlibSurfaceCreateInfoKHR ci = {
       .sType = VK_STRUCTURE_TYPE_XLIB_SURFACE_CREATE_INFO_KHR,
@@ -4450,7 +8459,9 @@ void lvk::VulkanContext::createSurface(void* window, void* display) {
       .dpy = (Display*)display,
       .window = (Window)window,
   };
-  VK_ASSERT(vkCreateXlibSurfaceKHR(vkInstance_, &ci, nullptr, &vkSurface_));
+  const PFN_vkCreateXlibSurfaceKHR vkCreateSurface =
+      (PFN_vkCreateXlibSurfaceKHR)vkGetInstanceProcAddr(vkInstance_, "vkCreateXlibSurfaceKHR");
+  VK_ASSERT(vkCreateSurface(vkInstance_, &ci, nullptr, &vkSurface_));
 #elif defined(VK_USE_PLATFORM_WAYLAND_KHR)
   const VkWaylandSurfaceCreateInfoKHR ci = {
       .sType = VK_STRUCTURE_TYPE_WAYLAND_SURFACE_CREATE_INFO_KHR,
@@ -4458,65 +8469,75 @@ void lvk::VulkanContext::createSurface(void* window, void* display) {
       .display = (wl_display*)display,
       .surface = (wl_surface*)window,
   };
-  VK_ASSERT(vkCreateWaylandSurfaceKHR(vkInstance_, &ci, nullptr, &vkSurface_));
+  const PFN_vkCreateWaylandSurfaceKHR vkCreateSurface =
+      (PFN_vkCreateWaylandSurfaceKHR)vkGetInstanceProcAddr(vkInstance_, "vkCreateWaylandSurfaceKHR");
+  VK_ASSERT(vkCreateSurface(vkInstance_, &ci, nullptr, &vkSurface_));
 #elif defined(VK_USE_PLATFORM_MACOS_MVK)
   const VkMacOSSurfaceCreateInfoMVK ci = {
       .sType = VK_STRUCTURE_TYPE_MACOS_SURFACE_CREATE_INFO_MVK,
       .flags = 0,
       .pView = window,
   };
-  VK_ASSERT(vkCreateMacOSSurfaceMVK(vkInstance_, &ci, nullptr, &vkSurface_));
+  const PFN_vkCreateMacOSSurfaceMVK vkCreateSurface =
+      (PFN_vkCreateMacOSSurfaceMVK)vkGetInstanceProcAddr(vkInstance_, "vkCreateMacOSSurfaceMVK");
+  VK_ASSERT(vkCreateSurface(vkInstance_, &ci, nullptr, &vkSurface_));
 #else
 #error Implement for other platforms
 #endif
 }
 
 uint32_t lvk::VulkanContext::queryDevices(HWDeviceType deviceType, HWDeviceDesc* outDevices, uint32_t maxOutDevices) {
-  // Physical devices
-  uint32_t deviceCount = 0;
-  VK_ASSERT(vkEnumeratePhysicalDevices(vkInstance_, &deviceCount, nullptr));
-  std::vector<VkPhysicalDevice> vkDevices(deviceCount);
-  VK_ASSERT(vkEnumeratePhysicalDevices(vkInstance_, &deviceCount, vkDevices.data()));
+  return enumeratePhysicalDevices(vkInstance_, deviceType, outDevices, maxOutDevices);
+}
 
-  auto convertVulkanDeviceTypeToIGL = [](VkPhysicalDeviceType vkDeviceType) -> HWDeviceType {
-    switch (vkDeviceType) {
-    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
-      return HWDeviceType_Integrated;
-    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
-      return HWDeviceType_Discrete;
-    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
-      return HWDeviceType_External;
-    case VK_PHYSICAL_DEVICE_TYPE_CPU:
-      return HWDeviceType_Software;
-    default:
-      return HWDeviceType_Software;
-    }
-  };
+uint32_t lvk::VulkanContext::queryDevices(HWDeviceDesc* outDevices, uint32_t maxOutDevices) {
+  if (volkInitialize() != VK_SUCCESS) {
+    LLOGW("volkInitialize() failed\n");
+    return 0;
+  }
 
-  const HWDeviceType desiredDeviceType = deviceType;
+  const VkApplicationInfo appInfo = {
+      .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+      .pApplicationName = "LVK/Vulkan",
+      .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+      .pEngineName = "LVK/Vulkan",
+      .engineVersion = VK_MAKE_VERSION(1, 0, 0),
+      .apiVersion = VK_API_VERSION_1_3,
+  };
 
-  uint32_t numCompatibleDevices = 0;
+#if defined(LVK_WITH_VULKAN_PORTABILITY)
+  const char* instanceExtensionNames[] = {VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME};
+#endif
+  // no layers, no debug messenger, and no surface extensions
+  const VkInstanceCreateInfo ci = {
+      .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+#if defined(LVK_WITH_VULKAN_PORTABILITY)
+      .flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR,
+#endif
+      .pApplicationInfo = &appInfo,
+#if defined(LVK_WITH_VULKAN_PORTABILITY)
+      .enabledExtensionCount = (uint32_t)LVK_ARRAY_NUM_ELEMENTS(instanceExtensionNames),
+      .ppEnabledExtensionNames = instanceExtensionNames,
+#endif
+  };
 
-  for (uint32_t i = 0; i < deviceCount; ++i) {
-    VkPhysicalDevice physicalDevice = vkDevices[i];
-    VkPhysicalDeviceProperties deviceProperties;
-    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+  VkInstance instance = VK_NULL_HANDLE;
 
-    const HWDeviceType deviceType = convertVulkanDeviceTypeToIGL(deviceProperties.deviceType);
+  if (vkCreateInstance(&ci, nullptr, &instance) != VK_SUCCESS) {
+    LLOGW("vkCreateInstance() failed\n");
+    return 0;
+  }
 
-    // filter non-suitable hardware devices
-    if (desiredDeviceType != HWDeviceType_Software && desiredDeviceType != deviceType) {
-      continue;
-    }
+  const uint32_t numDevices = enumeratePhysicalDevices(instance, HWDeviceType_Software, outDevices, maxOutDevices);
 
-    if (outDevices && numCompatibleDevices < maxOutDevices) {
-      outDevices[numCompatibleDevices] = {.guid = (uintptr_t)vkDevices[i], .type = deviceType};
-      strncpy(outDevices[numCompatibleDevices].name, deviceProperties.deviceName, strlen(deviceProperties.deviceName));
-      numCompatibleDevices++;
-    }
+  // VkPhysicalDevice handles do not outlive the instance
+  for (uint32_t i = 0; outDevices && i != numDevices; i++) {
+    outDevices[i].guid = 0;
   }
 
-  return numCompatibleDevices;
+  ((PFN_vkDestroyInstance)vkGetInstanceProcAddr(instance, "vkDestroyInstance"))(instance, nullptr);
+
+  return numDevices;
 }
 
 lvk::Result lvk::VulkanContext::initContext(const HWDeviceDesc& desc) {
@@ -4569,26 +8590,48 @@ lvk::Result lvk::VulkanContext::initContext(const HWDeviceDesc& desc) {
     return Result(Result::Code::RuntimeError, "VK_QUEUE_COMPUTE_BIT is not supported");
   }
 
+  // use only a dedicated DMA queue for transfers, otherwise fall back to the graphics queue
+  deviceQueues_.transferQueueFamilyIndex = lvk::findQueueFamilyIndex(vkPhysicalDevice_, VK_QUEUE_TRANSFER_BIT);
+
+  if (deviceQueues_.transferQueueFamilyIndex == DeviceQueues::INVALID ||
+      deviceQueues_.transferQueueFamilyIndex == deviceQueues_.computeQueueFamilyIndex) {
+    deviceQueues_.transferQueueFamilyIndex = deviceQueues_.graphicsQueueFamilyIndex;
+  }
+
+  {
+    uint32_t numFamilies = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice_, &numFamilies, nullptr);
+    std::vector<VkQueueFamilyProperties> families(numFamilies);
+    vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice_, &numFamilies, families.data());
+    deviceQueues_.transferImageGranularity = families[deviceQueues_.transferQueueFamilyIndex].minImageTransferGranularity;
+  }
+
+  {
+    DeviceQueues& q = deviceQueues_;
+    for (uint32_t familyIndex : {q.graphicsQueueFamilyIndex, q.computeQueueFamilyIndex, q.transferQueueFamilyIndex}) {
+      if (std::find(q.uniqueFamilyIndices, q.uniqueFamilyIndices + q.numUniqueFamilyIndices, familyIndex) ==
+          q.uniqueFamilyIndices + q.numUniqueFamilyIndices) {
+        q.uniqueFamilyIndices[q.numUniqueFamilyIndices++] = familyIndex;
+      }
+    }
+  }
+
   const float queuePriority = 1.0f;
 
-  const VkDeviceQueueCreateInfo ciQueue[2] = {
-      {
-          .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-          .queueFamilyIndex = deviceQueues_.graphicsQueueFamilyIndex,
-          .queueCount = 1,
-          .pQueuePriorities = &queuePriority,
-      },
-      {
-          .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-          .queueFamilyIndex = deviceQueues_.computeQueueFamilyIndex,
-          .queueCount = 1,
-          .pQueuePriorities = &queuePriority,
-      },
-  };
-  const uint32_t numQueues = ciQueue[0].queueFamilyIndex == ciQueue[1].queueFamilyIndex ? 1 : 2;
+  VkDeviceQueueCreateInfo ciQueue[LVK_ARRAY_NUM_ELEMENTS(deviceQueues_.uniqueFamilyIndices)] = {};
+
+  const uint32_t numQueues = deviceQueues_.numUniqueFamilyIndices;
+
+  for (uint32_t i = 0; i != numQueues; i++) {
+    ciQueue[i] = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .queueFamilyIndex = deviceQueues_.uniqueFamilyIndices[i],
+        .queueCount = 1,
+        .pQueuePriorities = &queuePriority,
+    };
+  }
 
-  const char* deviceExtensionNames[] = {
-    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+  std::vector<const char*> deviceExtensionNames = {
 #if defined(LVK_WITH_TRACY)
     VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME,
 #endif
@@ -4617,6 +8660,54 @@ lvk::Result lvk::VulkanContext::initContext(const HWDeviceDesc& desc) {
 #endif
   };
 
+  if (vkSurface_ != VK_NULL_HANDLE) {
+    deviceExtensionNames.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+  }
+
+  // optional extensions
+  {
+    std::vector<VkExtensionProperties> props;
+    getDeviceExtensionProps(vkPhysicalDevice_, props);
+    hasMemoryBudget_ = hasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, props);
+    if (hasMemoryBudget_) {
+      deviceExtensionNames.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    if (hasExtension(VK_EXT_MESH_SHADER_EXTENSION_NAME, props)) {
+      VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT};
+      VkPhysicalDeviceFeatures2 features = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, .pNext = &meshShaderFeatures};
+      vkGetPhysicalDeviceFeatures2(vkPhysicalDevice_, &features);
+      hasMeshShader_ = meshShaderFeatures.taskShader && meshShaderFeatures.meshShader;
+    }
+    if (hasMeshShader_) {
+      deviceExtensionNames.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+    }
+    if (config_.enablePresentWait && vkSurface_ != VK_NULL_HANDLE && hasExtension(VK_KHR_PRESENT_ID_EXTENSION_NAME, props) &&
+        hasExtension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME, props)) {
+      VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR};
+      VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+                                                                .pNext = &presentWaitFeatures};
+      VkPhysicalDeviceFeatures2 features = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, .pNext = &presentIdFeatures};
+      vkGetPhysicalDeviceFeatures2(vkPhysicalDevice_, &features);
+      hasPresentWait_ = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+    }
+    if (hasPresentWait_) {
+      deviceExtensionNames.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+      deviceExtensionNames.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    } else if (config_.enablePresentWait && vkSurface_ != VK_NULL_HANDLE) {
+      LLOGW("VK_KHR_present_wait is not supported\n");
+    }
+  }
+
+  {
+    // sparse binding operations are executed on the graphics queue
+    uint32_t numFamilies = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice_, &numFamilies, nullptr);
+    std::vector<VkQueueFamilyProperties> families(numFamilies);
+    vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice_, &numFamilies, families.data());
+    hasSparseResidency_ = vkFeatures10_.features.sparseBinding && vkFeatures10_.features.sparseResidencyImage2D &&
+                          (families[deviceQueues_.graphicsQueueFamilyIndex].queueFlags & VK_QUEUE_SPARSE_BINDING_BIT);
+  }
+
   VkPhysicalDeviceFeatures deviceFeatures10 = {
 #if !defined(__APPLE__)
       .geometryShader = VK_TRUE,
@@ -4633,6 +8724,10 @@ lvk::Result lvk::VulkanContext::initContext(const HWDeviceDesc& desc) {
       .textureCompressionBC = VK_TRUE,
 #endif
       .fragmentStoresAndAtomics = VK_TRUE,
+      .shaderResourceResidency = hasSparseResidency_ ? vkFeatures10_.features.shaderResourceResidency : VK_FALSE,
+      .sparseBinding = hasSparseResidency_ ? VK_TRUE : VK_FALSE,
+      .sparseResidencyImage2D = hasSparseResidency_ ? VK_TRUE : VK_FALSE,
+      .sparseResidencyImage3D = hasSparseResidency_ ? vkFeatures10_.features.sparseResidencyImage3D : VK_FALSE,
   };
   VkPhysicalDeviceVulkan11Features deviceFeatures11 = {
       .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
@@ -4654,6 +8749,7 @@ lvk::Result lvk::VulkanContext::initContext(const HWDeviceDesc& desc) {
       .descriptorBindingVariableDescriptorCount = VK_TRUE,
       .runtimeDescriptorArray = VK_TRUE,
       .uniformBufferStandardLayout = VK_TRUE,
+      .hostQueryReset = config_.enableGPUProfiler && vkFeatures12_.hostQueryReset ? VK_TRUE : VK_FALSE,
       .timelineSemaphore = VK_TRUE,
       .bufferDeviceAddress = VK_TRUE,
   };
@@ -4689,14 +8785,40 @@ lvk::Result lvk::VulkanContext::initContext(const HWDeviceDesc& desc) {
 #else
   const void* createInfoNext = &deviceFeatures13;
 #endif
-  
+
+  VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT,
+      .pNext = const_cast<void*>(createInfoNext),
+      .taskShader = VK_TRUE,
+      .meshShader = VK_TRUE,
+  };
+
+  if (hasMeshShader_) {
+    createInfoNext = &meshShaderFeatures;
+  }
+
+  VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+      .pNext = const_cast<void*>(createInfoNext),
+      .presentId = VK_TRUE,
+  };
+  VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+      .pNext = &presentIdFeatures,
+      .presentWait = VK_TRUE,
+  };
+
+  if (hasPresentWait_) {
+    createInfoNext = &presentWaitFeatures;
+  }
+
   const VkDeviceCreateInfo ci = {
       .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
       .pNext = createInfoNext,
       .queueCreateInfoCount = numQueues,
       .pQueueCreateInfos = ciQueue,
-      .enabledExtensionCount = (uint32_t)LVK_ARRAY_NUM_ELEMENTS(deviceExtensionNames),
-      .ppEnabledExtensionNames = deviceExtensionNames,
+      .enabledExtensionCount = (uint32_t)deviceExtensionNames.size(),
+      .ppEnabledExtensionNames = deviceExtensionNames.data(),
       .pEnabledFeatures = &deviceFeatures10,
   };
 
@@ -4883,39 +9005,94 @@ lvk::Result lvk::VulkanContext::initContext(const HWDeviceDesc& desc) {
 
   VK_ASSERT_RETURN(vkCreateDevice(vkPhysicalDevice_, &ci, nullptr, &vkDevice_));
 
-  volkLoadDevice(vkDevice_);
+  // device-level functions are loaded directly from the driver for this VkDevice
+  volkLoadDeviceTable(&vkDT_, vkDevice_);
+  vkDT_.vkSetDebugUtilsObjectNameEXT = (PFN_vkSetDebugUtilsObjectNameEXT)vkGetInstanceProcAddr(vkInstance_, "vkSetDebugUtilsObjectNameEXT");
+  vkDT_.vkCmdBeginDebugUtilsLabelEXT = (PFN_vkCmdBeginDebugUtilsLabelEXT)vkGetInstanceProcAddr(vkInstance_, "vkCmdBeginDebugUtilsLabelEXT");
+  vkDT_.vkCmdEndDebugUtilsLabelEXT = (PFN_vkCmdEndDebugUtilsLabelEXT)vkGetInstanceProcAddr(vkInstance_, "vkCmdEndDebugUtilsLabelEXT");
+  vkDT_.vkCmdInsertDebugUtilsLabelEXT =
+      (PFN_vkCmdInsertDebugUtilsLabelEXT)vkGetInstanceProcAddr(vkInstance_, "vkCmdInsertDebugUtilsLabelEXT");
 
 #if defined(__APPLE__)
-  vkCmdBeginRendering = vkCmdBeginRenderingKHR;
-  vkCmdEndRendering = vkCmdEndRenderingKHR;
-  vkCmdSetDepthWriteEnable = vkCmdSetDepthWriteEnableEXT;
-  vkCmdSetDepthTestEnable = vkCmdSetDepthTestEnableEXT;
-  vkCmdSetDepthCompareOp = vkCmdSetDepthCompareOpEXT;
-  vkCmdSetDepthBiasEnable = vkCmdSetDepthBiasEnableEXT;
+  vkDT_.vkCmdBeginRendering = vkDT_.vkCmdBeginRenderingKHR;
+  vkDT_.vkCmdEndRendering = vkDT_.vkCmdEndRenderingKHR;
+  vkDT_.vkCmdSetDepthWriteEnable = vkDT_.vkCmdSetDepthWriteEnableEXT;
+  vkDT_.vkCmdSetDepthTestEnable = vkDT_.vkCmdSetDepthTestEnableEXT;
+  vkDT_.vkCmdSetDepthCompareOp = vkDT_.vkCmdSetDepthCompareOpEXT;
+  vkDT_.vkCmdSetDepthBiasEnable = vkDT_.vkCmdSetDepthBiasEnableEXT;
 #endif
 
-  vkGetDeviceQueue(vkDevice_, deviceQueues_.graphicsQueueFamilyIndex, 0, &deviceQueues_.graphicsQueue);
-  vkGetDeviceQueue(vkDevice_, deviceQueues_.computeQueueFamilyIndex, 0, &deviceQueues_.computeQueue);
+  vkDT_.vkGetDeviceQueue(vkDevice_, deviceQueues_.graphicsQueueFamilyIndex, 0, &deviceQueues_.graphicsQueue);
+  vkDT_.vkGetDeviceQueue(vkDevice_, deviceQueues_.computeQueueFamilyIndex, 0, &deviceQueues_.computeQueue);
+  vkDT_.vkGetDeviceQueue(vkDevice_, deviceQueues_.transferQueueFamilyIndex, 0, &deviceQueues_.transferQueue);
 
-  VK_ASSERT(lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_DEVICE, (uint64_t)vkDevice_, "Device: VulkanContext::vkDevice_"));
+  VK_ASSERT(lvk::setDebugObjectName(vkDT_, vkDevice_, VK_OBJECT_TYPE_DEVICE, (uint64_t)vkDevice_, "Device: VulkanContext::vkDevice_"));
 
-  immediate_ =
-      std::make_unique<lvk::VulkanImmediateCommands>(vkDevice_, deviceQueues_.graphicsQueueFamilyIndex, "VulkanContext::immediate_");
+  immediate_ = std::make_unique<lvk::VulkanImmediateCommands>(
+      vkDT_, vkDevice_, deviceQueues_.graphicsQueueFamilyIndex, "VulkanContext::immediate_", lvk::QueueType_Graphics, &frameCounters_);
+
+  if (deviceQueues_.computeQueueFamilyIndex != deviceQueues_.graphicsQueueFamilyIndex) {
+    computeImmediate_ = std::make_unique<lvk::VulkanImmediateCommands>(vkDT_,
+                                                                       vkDevice_,
+                                                                       deviceQueues_.computeQueueFamilyIndex,
+                                                                       "VulkanContext::computeImmediate_",
+                                                                       lvk::QueueType_Compute,
+                                                                       &frameCounters_);
+  }
+
+  if (deviceQueues_.transferQueueFamilyIndex != deviceQueues_.graphicsQueueFamilyIndex) {
+    transferImmediate_ = std::make_unique<lvk::VulkanImmediateCommands>(vkDT_,
+                                                                        vkDevice_,
+                                                                        deviceQueues_.transferQueueFamilyIndex,
+                                                                        "VulkanContext::transferImmediate_",
+                                                                        lvk::QueueType_Transfer,
+                                                                        &frameCounters_);
+  }
+
+  if (config_.shaderCacheDir) {
+    shaderCacheDir_ = config_.shaderCacheDir;
+  }
 
   // create Vulkan pipeline cache
   {
+    std::vector<uint8_t> fileData;
+
+    if (config_.pipelineCacheDir) {
+      pipelineCacheFileName_ = getPipelineCacheFileName(config_.pipelineCacheDir, vkPhysicalDeviceProperties2_.properties);
+      fileData = loadPipelineCacheFile(
+          pipelineCacheFileName_.c_str(), vkPhysicalDeviceProperties2_.properties, config_.pipelineCacheMaxFileSize);
+    }
+
+    const bool hasAppData = config_.pipelineCacheData && config_.pipelineCacheDataSize;
+
     const VkPipelineCacheCreateInfo ci = {
         VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
         nullptr,
         VkPipelineCacheCreateFlags(0),
-        config_.pipelineCacheDataSize,
-        config_.pipelineCacheData,
+        hasAppData ? config_.pipelineCacheDataSize : fileData.size(),
+        hasAppData ? config_.pipelineCacheData : fileData.data(),
     };
-    vkCreatePipelineCache(vkDevice_, &ci, nullptr, &pipelineCache_);
+    VK_ASSERT(vkDT_.vkCreatePipelineCache(vkDevice_, &ci, nullptr, &pipelineCache_));
+
+    // both the application and the disk provided a cache: merge the disk blob into the application one
+    if (hasAppData && !fileData.empty()) {
+      const VkPipelineCacheCreateInfo ciFile = {
+          VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+          nullptr,
+          VkPipelineCacheCreateFlags(0),
+          fileData.size(),
+          fileData.data(),
+      };
+      VkPipelineCache fileCache = VK_NULL_HANDLE;
+      if (vkDT_.vkCreatePipelineCache(vkDevice_, &ciFile, nullptr, &fileCache) == VK_SUCCESS) {
+        VK_ASSERT(vkDT_.vkMergePipelineCaches(vkDevice_, pipelineCache_, 1, &fileCache));
+        vkDT_.vkDestroyPipelineCache(vkDevice_, fileCache, nullptr);
+      }
+    }
   }
 
   if (LVK_VULKAN_USE_VMA) {
-    pimpl_->vma_ = lvk::createVmaAllocator(vkPhysicalDevice_, vkDevice_, vkInstance_, apiVersion);
+    pimpl_->vma_ = lvk::createVmaAllocator(vkDT_, vkPhysicalDevice_, vkDevice_, vkInstance_, apiVersion, hasMemoryBudget_);
     LVK_ASSERT(pimpl_->vma_ != VK_NULL_HANDLE);
   }
 
@@ -4991,10 +9168,15 @@ lvk::Result lvk::VulkanContext::initContext(const HWDeviceDesc& desc) {
       nullptr,
       "Sampler: default");
 
-  growDescriptorPool(currentMaxTextures_, currentMaxSamplers_);
+  // reserve the bindless capacity up front, so the descriptor set layout (and all pipelines) do not have to be recreated later
+  growDescriptorPool(
+      std::clamp(config_.maxTextures, 1u, vkPhysicalDeviceVulkan12Properties_.maxDescriptorSetUpdateAfterBindSampledImages),
+      std::clamp(config_.maxSamplers, 1u, vkPhysicalDeviceVulkan12Properties_.maxDescriptorSetUpdateAfterBindSamplers));
 
   querySurfaceCapabilities();
 
+  initGPUProfiler();
+
   return Result();
 }
 
@@ -5006,7 +9188,8 @@ lvk::Result lvk::VulkanContext::initSwapchain(uint32_t width, uint32_t height) {
 
   if (swapchain_) {
     // destroy the old swapchain first
-    VK_ASSERT(vkDeviceWaitIdle(vkDevice_));
+    ScopedHostWait hostWait(&frameCounters_, lvk::HostWait_DeviceIdle);
+    VK_ASSERT(vkDT_.vkDeviceWaitIdle(vkDevice_));
     swapchain_ = nullptr;
   }
 
@@ -5038,17 +9221,23 @@ lvk::Result lvk::VulkanContext::growDescriptorPool(uint32_t maxTextures, uint32_
   }
 
   if (vkDSL_ != VK_NULL_HANDLE) {
-    deferredTask(std::packaged_task<void()>([device = vkDevice_, dsl = vkDSL_]() { vkDestroyDescriptorSetLayout(device, dsl, nullptr); }));
+    deferredTask(std::packaged_task<void()>(
+        [&vkDT = vkDT_, device = vkDevice_, dsl = vkDSL_]() { vkDT.vkDestroyDescriptorSetLayout(device, dsl, nullptr); }));
   }
   if (vkDPool_ != VK_NULL_HANDLE) {
-    deferredTask(std::packaged_task<void()>([device = vkDevice_, dp = vkDPool_]() { vkDestroyDescriptorPool(device, dp, nullptr); }));
+    deferredTask(std::packaged_task<void()>(
+        [&vkDT = vkDT_, device = vkDevice_, dp = vkDPool_]() { vkDT.vkDestroyDescriptorPool(device, dp, nullptr); }));
   }
 
   // create default descriptor set layout which is going to be shared by graphics pipelines
+  const VkShaderStageFlags stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
+                                        VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT | VK_SHADER_STAGE_FRAGMENT_BIT |
+                                        VK_SHADER_STAGE_COMPUTE_BIT |
+                                        (hasMeshShader_ ? VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT : 0);
   const VkDescriptorSetLayoutBinding bindings[kBinding_NumBindings] = {
-      lvk::getDSLBinding(kBinding_Textures, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, maxTextures),
-      lvk::getDSLBinding(kBinding_Samplers, VK_DESCRIPTOR_TYPE_SAMPLER, maxSamplers),
-      lvk::getDSLBinding(kBinding_StorageImages, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxTextures),
+      lvk::getDSLBinding(kBinding_Textures, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, maxTextures, stageFlags),
+      lvk::getDSLBinding(kBinding_Samplers, VK_DESCRIPTOR_TYPE_SAMPLER, maxSamplers, stageFlags),
+      lvk::getDSLBinding(kBinding_StorageImages, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxTextures, stageFlags),
   };
   const uint32_t flags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
                          VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
@@ -5068,9 +9257,9 @@ lvk::Result lvk::VulkanContext::growDescriptorPool(uint32_t maxTextures, uint32_
       .bindingCount = kBinding_NumBindings,
       .pBindings = bindings,
   };
-  VK_ASSERT(vkCreateDescriptorSetLayout(vkDevice_, &dslci, nullptr, &vkDSL_));
+  VK_ASSERT(vkDT_.vkCreateDescriptorSetLayout(vkDevice_, &dslci, nullptr, &vkDSL_));
   VK_ASSERT(lvk::setDebugObjectName(
-      vkDevice_, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)vkDSL_, "Descriptor Set Layout: VulkanContext::vkDSL_"));
+      vkDT_, vkDevice_, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)vkDSL_, "Descriptor Set Layout: VulkanContext::vkDSL_"));
 
   {
     // create default descriptor pool and allocate 1 descriptor set
@@ -5086,14 +9275,14 @@ lvk::Result lvk::VulkanContext::growDescriptorPool(uint32_t maxTextures, uint32_
         .poolSizeCount = kBinding_NumBindings,
         .pPoolSizes = poolSizes,
     };
-    VK_ASSERT_RETURN(vkCreateDescriptorPool(vkDevice_, &ci, nullptr, &vkDPool_));
+    VK_ASSERT_RETURN(vkDT_.vkCreateDescriptorPool(vkDevice_, &ci, nullptr, &vkDPool_));
     const VkDescriptorSetAllocateInfo ai = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
         .descriptorPool = vkDPool_,
         .descriptorSetCount = 1,
         .pSetLayouts = &vkDSL_,
     };
-    VK_ASSERT_RETURN(vkAllocateDescriptorSets(vkDevice_, &ai, &vkDSet_));
+    VK_ASSERT_RETURN(vkDT_.vkAllocateDescriptorSets(vkDevice_, &ai, &vkDSet_));
   }
 
   return Result();
@@ -5119,7 +9308,13 @@ lvk::BufferHandle lvk::VulkanContext::createBuffer(VkDeviceSize bufferSize,
   ENSURE_BUFFER_SIZE(VK_BUFFER_USAGE_FLAG_BITS_MAX_ENUM, limits.maxStorageBufferRange);
 #undef ENSURE_BUFFER_SIZE
 
-  return buffersPool_.create(VulkanBuffer(this, vkDevice_, bufferSize, usageFlags, memFlags, debugName));
+  const BufferHandle handle = buffersPool_.create(VulkanBuffer(this, vkDevice_, bufferSize, usageFlags, memFlags, debugName));
+
+  if (!LVK_VERIFY(!handle.empty())) {
+    Result::setResult(outResult, Result::Code::RuntimeError, "Too many buffers");
+  }
+
+  return handle;
 }
 
 std::shared_ptr<lvk::VulkanImage> lvk::VulkanContext::createImage(VkImageType imageType,
@@ -5133,23 +9328,56 @@ std::shared_ptr<lvk::VulkanImage> lvk::VulkanContext::createImage(VkImageType im
                                                                   VkImageCreateFlags flags,
                                                                   VkSampleCountFlagBits samples,
                                                                   lvk::Result* outResult,
-                                                                  const char* debugName) {
+                                                                  const char* debugName,
+                                                                  const std::shared_ptr<VulkanImage>& aliasOf) {
   if (!validateImageLimits(imageType, samples, extent, getVkPhysicalDeviceProperties().limits, outResult)) {
     return nullptr;
   }
 
-  return std::make_shared<VulkanImage>(
-      *this, vkDevice_, extent, imageType, format, numLevels, numLayers, tiling, usageFlags, memFlags, flags, samples, debugName);
+  std::shared_ptr<VulkanImage> image = std::make_shared<VulkanImage>(*this,
+                                                                     vkDevice_,
+                                                                     extent,
+                                                                     imageType,
+                                                                     format,
+                                                                     numLevels,
+                                                                     numLayers,
+                                                                     tiling,
+                                                                     usageFlags,
+                                                                     memFlags,
+                                                                     flags,
+                                                                     samples,
+                                                                     debugName,
+                                                                     aliasOf,
+                                                                     outResult);
+
+  if (aliasOf && image->vkImage_ == VK_NULL_HANDLE) {
+    // the reason is reported by the VulkanImage constructor
+    return nullptr;
+  }
+
+  if ((flags & VK_IMAGE_CREATE_SPARSE_BINDING_BIT) && image->vkImage_ == VK_NULL_HANDLE) {
+    Result::setResult(outResult, Result::Code::RuntimeError, "Sparse residency is not supported for this image format");
+    return nullptr;
+  }
+
+  return image;
 }
 
 void lvk::VulkanContext::bindDefaultDescriptorSets(VkCommandBuffer cmdBuf, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) const {
   LVK_PROFILER_FUNCTION();
   const VkDescriptorSet dsets[4] = {vkDSet_, vkDSet_, vkDSet_, vkDSet_};
-  vkCmdBindDescriptorSets(cmdBuf, bindPoint, layout, 0, (uint32_t)LVK_ARRAY_NUM_ELEMENTS(dsets), dsets, 0, nullptr);
+  vkDT_.vkCmdBindDescriptorSets(cmdBuf, bindPoint, layout, 0, (uint32_t)LVK_ARRAY_NUM_ELEMENTS(dsets), dsets, 0, nullptr);
 }
 
 void lvk::VulkanContext::checkAndUpdateDescriptorSets() {
-  if (!awaitingCreation_) {
+  std::lock_guard lock(pimpl_->descriptorsMutex_);
+  // textures and samplers can be created on other threads while the descriptors are written
+  std::scoped_lock poolsLock(texturesPool_.mutex_, samplersPool_.mutex_);
+
+  std::vector<uint32_t>& dirtyTextures = texturesPool_.dirtySlots_;
+  std::vector<uint32_t>& dirtySamplers = samplersPool_.dirtySlots_;
+
+  if (dirtyTextures.empty() && dirtySamplers.empty()) {
     // nothing to update here
     return;
   }
@@ -5157,8 +9385,6 @@ void lvk::VulkanContext::checkAndUpdateDescriptorSets() {
   // newly created resources can be used immediately - make sure they are put into descriptor sets
   LVK_PROFILER_FUNCTION();
 
-  // update Vulkan descriptor set here
-
   // make sure the guard values are always there
   LVK_ASSERT(texturesPool_.numObjects() >= 1);
   LVK_ASSERT(samplersPool_.numObjects() >= 1);
@@ -5173,88 +9399,100 @@ void lvk::VulkanContext::checkAndUpdateDescriptorSets() {
     newMaxSamplers *= 2;
   }
   if (newMaxTextures != currentMaxTextures_ || newMaxSamplers != currentMaxSamplers_) {
+    LLOGW("Bindless capacity exceeded: %u textures, %u samplers (reserved %u, %u). Increase ContextConfig::maxTextures/maxSamplers to "
+          "avoid recreating all pipelines\n",
+          (uint32_t)texturesPool_.objects_.size(),
+          (uint32_t)samplersPool_.objects_.size(),
+          currentMaxTextures_,
+          currentMaxSamplers_);
+    // the previous descriptor pool and set are destroyed only after the GPU is done with them
     growDescriptorPool(newMaxTextures, newMaxSamplers);
-  }
-
-  // 1. Sampled and storage images
+    // the new descriptor set is empty
+    dirtyTextures.resize(texturesPool_.objects_.size());
+    dirtySamplers.resize(samplersPool_.objects_.size());
+    std::iota(dirtyTextures.begin(), dirtyTextures.end(), 0u);
+    std::iota(dirtySamplers.begin(), dirtySamplers.end(), 0u);
+  }
+
+  // Only the changed slots are written and there is no need to wait for the GPU: new slots are not used by any submitted command
+  // buffers, and freed slots are returned to the pools only after the GPU is done with them
+  // (VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT).
+  std::sort(dirtyTextures.begin(), dirtyTextures.end());
+  std::sort(dirtySamplers.begin(), dirtySamplers.end());
+  dirtyTextures.erase(std::unique(dirtyTextures.begin(), dirtyTextures.end()), dirtyTextures.end());
+  dirtySamplers.erase(std::unique(dirtySamplers.begin(), dirtySamplers.end()), dirtySamplers.end());
+
+  // the info arrays should not be reallocated - the writes point into them
   std::vector<VkDescriptorImageInfo> infoSampledImages;
   std::vector<VkDescriptorImageInfo> infoStorageImages;
+  std::vector<VkDescriptorImageInfo> infoSamplers;
+  std::vector<VkWriteDescriptorSet> writes;
 
-  infoSampledImages.reserve(texturesPool_.numObjects());
-  infoStorageImages.reserve(texturesPool_.numObjects());
+  infoSampledImages.reserve(dirtyTextures.size());
+  infoStorageImages.reserve(dirtyTextures.size());
+  infoSamplers.reserve(dirtySamplers.size());
+
+  auto getWrite = [this](uint32_t binding, VkDescriptorType type, uint32_t slot, const VkDescriptorImageInfo* info) {
+    return VkWriteDescriptorSet{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = vkDSet_,
+        .dstBinding = binding,
+        .dstArrayElement = slot,
+        .descriptorCount = 1,
+        .descriptorType = type,
+        .pImageInfo = info,
+    };
+  };
 
+  // 1. Sampled and storage images
   // use the dummy texture to avoid sparse array
   VkImageView dummyImageView = texturesPool_.objects_[0].obj_.imageView_;
 
-  for (const auto& obj : texturesPool_.objects_) {
-    const VulkanImage* img = obj.obj_.image_.get();
-    const VkImageView view = obj.obj_.imageView_;
+  for (size_t i = 0; i != dirtyTextures.size(); i++) {
+    const uint32_t slot = dirtyTextures[i];
+    const VulkanTexture& tex = texturesPool_.objects_[slot].obj_;
+    const VulkanImage* img = tex.image_.get();
+    const VkImageView view = tex.imageView_;
     // multisampled images cannot be directly accessed from shaders
     const bool isTextureAvailable = img && ((img->vkSamples_ & VK_SAMPLE_COUNT_1_BIT) == VK_SAMPLE_COUNT_1_BIT);
     const bool isSampledImage = isTextureAvailable && img->isSampledImage();
-    const bool isStorageImage = isTextureAvailable && img->isStorageImage();
+    const bool isStorageImage = isTextureAvailable && tex.isStorageView_;
     infoSampledImages.push_back({VK_NULL_HANDLE, isSampledImage ? view : dummyImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
     LVK_ASSERT(infoSampledImages.back().imageView != VK_NULL_HANDLE);
     infoStorageImages.push_back({VK_NULL_HANDLE, isStorageImage ? view : dummyImageView, VK_IMAGE_LAYOUT_GENERAL});
+    if (i && slot == dirtyTextures[i - 1] + 1) {
+      // extend the current contiguous range of slots
+      writes[writes.size() - 2].descriptorCount++;
+      writes[writes.size() - 1].descriptorCount++;
+    } else {
+      writes.push_back(getWrite(kBinding_Textures, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, slot, &infoSampledImages.back()));
+      writes.push_back(getWrite(kBinding_StorageImages, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, slot, &infoStorageImages.back()));
+    }
   }
 
   // 2. Samplers
-  std::vector<VkDescriptorImageInfo> infoSamplers;
-  infoSamplers.reserve(samplersPool_.objects_.size());
-
-  for (const auto& sampler : samplersPool_.objects_) {
-    infoSamplers.push_back({sampler.obj_ ? sampler.obj_ : samplersPool_.objects_[0].obj_, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED});
-  }
-
-  VkWriteDescriptorSet write[kBinding_NumBindings] = {};
-  uint32_t numWrites = 0;
-
-  if (!infoSampledImages.empty()) {
-    write[numWrites++] = VkWriteDescriptorSet{
-        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet = vkDSet_,
-        .dstBinding = kBinding_Textures,
-        .dstArrayElement = 0,
-        .descriptorCount = (uint32_t)infoSampledImages.size(),
-        .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-        .pImageInfo = infoSampledImages.data(),
-    };
-  }
-
-  if (!infoSamplers.empty()) {
-    write[numWrites++] = VkWriteDescriptorSet{
-        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet = vkDSet_,
-        .dstBinding = kBinding_Samplers,
-        .dstArrayElement = 0,
-        .descriptorCount = (uint32_t)infoSamplers.size(),
-        .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
-        .pImageInfo = infoSamplers.data(),
-    };
-  }
-
-  if (!infoStorageImages.empty()) {
-    write[numWrites++] = VkWriteDescriptorSet{
-        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet = vkDSet_,
-        .dstBinding = kBinding_StorageImages,
-        .dstArrayElement = 0,
-        .descriptorCount = (uint32_t)infoStorageImages.size(),
-        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-        .pImageInfo = infoStorageImages.data(),
-    };
+  for (size_t i = 0; i != dirtySamplers.size(); i++) {
+    const uint32_t slot = dirtySamplers[i];
+    const VkSampler sampler = samplersPool_.objects_[slot].obj_;
+    infoSamplers.push_back({sampler ? sampler : samplersPool_.objects_[0].obj_, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED});
+    if (i && slot == dirtySamplers[i - 1] + 1) {
+      writes.back().descriptorCount++;
+    } else {
+      writes.push_back(getWrite(kBinding_Samplers, VK_DESCRIPTOR_TYPE_SAMPLER, slot, &infoSamplers.back()));
+    }
   }
 
-  // do not switch to the next descriptor set if there is nothing to update
-  if (numWrites) {
+  if (!writes.empty()) {
 #if LVK_VULKAN_PRINT_COMMANDS
-    LLOGL("vkUpdateDescriptorSets()\n");
+    LLOGL("vkUpdateDescriptorSets(%u)\n", (uint32_t)writes.size());
 #endif // LVK_VULKAN_PRINT_COMMANDS
-    immediate_->wait(immediate_->getLastSubmitHandle());
-    vkUpdateDescriptorSets(vkDevice_, numWrites, write, 0, nullptr);
+    vkDT_.vkUpdateDescriptorSets(vkDevice_, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+    frameCounters_.numDescriptorSetUpdates++;
+    frameCounters_.numDescriptorWrites += (uint32_t)writes.size();
   }
 
-  awaitingCreation_ = false;
+  dirtyTextures.clear();
+  dirtySamplers.clear();
 }
 
 lvk::SamplerHandle lvk::VulkanContext::createSampler(const VkSamplerCreateInfo& ci, lvk::Result* outResult, const char* debugName) {
@@ -5262,12 +9500,15 @@ lvk::SamplerHandle lvk::VulkanContext::createSampler(const VkSamplerCreateInfo&
 
   VkSampler sampler = VK_NULL_HANDLE;
 
-  VK_ASSERT(vkCreateSampler(vkDevice_, &ci, nullptr, &sampler));
-  VK_ASSERT(lvk::setDebugObjectName(vkDevice_, VK_OBJECT_TYPE_SAMPLER, (uint64_t)sampler, debugName));
+  VK_ASSERT(vkDT_.vkCreateSampler(vkDevice_, &ci, nullptr, &sampler));
+  VK_ASSERT(lvk::setDebugObjectName(vkDT_, vkDevice_, VK_OBJECT_TYPE_SAMPLER, (uint64_t)sampler, debugName));
 
   SamplerHandle handle = samplersPool_.create(VkSampler(sampler));
 
-  awaitingCreation_ = true;
+  if (!LVK_VERIFY(!handle.empty())) {
+    vkDT_.vkDestroySampler(vkDevice_, sampler, nullptr);
+    Result::setResult(outResult, Result::Code::RuntimeError, "Too many samplers");
+  }
 
   return handle;
 }
@@ -5289,22 +9530,22 @@ void lvk::VulkanContext::querySurfaceCapabilities() {
     return;
   }
 
-  vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vkPhysicalDevice_, vkSurface_, &deviceSurfaceCaps_);
+  vkIT_.vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vkPhysicalDevice_, vkSurface_, &deviceSurfaceCaps_);
 
   uint32_t formatCount;
-  vkGetPhysicalDeviceSurfaceFormatsKHR(vkPhysicalDevice_, vkSurface_, &formatCount, nullptr);
+  vkIT_.vkGetPhysicalDeviceSurfaceFormatsKHR(vkPhysicalDevice_, vkSurface_, &formatCount, nullptr);
 
   if (formatCount) {
     deviceSurfaceFormats_.resize(formatCount);
-    vkGetPhysicalDeviceSurfaceFormatsKHR(vkPhysicalDevice_, vkSurface_, &formatCount, deviceSurfaceFormats_.data());
+    vkIT_.vkGetPhysicalDeviceSurfaceFormatsKHR(vkPhysicalDevice_, vkSurface_, &formatCount, deviceSurfaceFormats_.data());
   }
 
   uint32_t presentModeCount;
-  vkGetPhysicalDeviceSurfacePresentModesKHR(vkPhysicalDevice_, vkSurface_, &presentModeCount, nullptr);
+  vkIT_.vkGetPhysicalDeviceSurfacePresentModesKHR(vkPhysicalDevice_, vkSurface_, &presentModeCount, nullptr);
 
   if (presentModeCount) {
     devicePresentModes_.resize(presentModeCount);
-    vkGetPhysicalDeviceSurfacePresentModesKHR(vkPhysicalDevice_, vkSurface_, &presentModeCount, devicePresentModes_.data());
+    vkIT_.vkGetPhysicalDeviceSurfacePresentModesKHR(vkPhysicalDevice_, vkSurface_, &presentModeCount, devicePresentModes_.data());
   }
 }
 
@@ -5332,22 +9573,54 @@ VkFormat lvk::VulkanContext::getClosestDepthStencilFormat(lvk::Format desiredFor
 
 std::vector<uint8_t> lvk::VulkanContext::getPipelineCacheData() const {
   size_t size = 0;
-  vkGetPipelineCacheData(vkDevice_, pipelineCache_, &size, nullptr);
+  vkDT_.vkGetPipelineCacheData(vkDevice_, pipelineCache_, &size, nullptr);
 
   std::vector<uint8_t> data(size);
 
   if (size) {
-    vkGetPipelineCacheData(vkDevice_, pipelineCache_, &size, data.data());
+    vkDT_.vkGetPipelineCacheData(vkDevice_, pipelineCache_, &size, data.data());
   }
 
   return data;
 }
 
+void lvk::VulkanContext::savePipelineCache() const {
+  if (pipelineCacheFileName_.empty() || pipelineCache_ == VK_NULL_HANDLE) {
+    return;
+  }
+
+  LVK_PROFILER_FUNCTION();
+
+  std::lock_guard lock(pimpl_->pipelineCacheFileMutex_);
+
+  const std::vector<uint8_t> data = getPipelineCacheData();
+
+  if (data.empty()) {
+    return;
+  }
+
+  if (data.size() > config_.pipelineCacheMaxFileSize) {
+    LLOGW("Pipeline cache size %u exceeds ContextConfig::pipelineCacheMaxFileSize, not saving it\n", (uint32_t)data.size());
+    return;
+  }
+
+  savePipelineCacheFile(pipelineCacheFileName_.c_str(), vkPhysicalDeviceProperties2_.properties, data);
+}
+
 void lvk::VulkanContext::deferredTask(std::packaged_task<void()>&& task, SubmitHandle handle) const {
+  DeferredTask t(std::move(task));
   if (handle.empty()) {
-    handle = immediate_->getLastSubmitHandle();
+    for (uint32_t q = 0; q != lvk::QueueType_Num; q++) {
+      // do not add the same queue twice if there are no dedicated queues
+      if (q == lvk::QueueType_Graphics || getImmediateCommands(lvk::QueueType(q)) != immediate_.get()) {
+        t.handles_[q] = getImmediateCommands(lvk::QueueType(q))->getLastSubmitHandle();
+      }
+    }
+  } else {
+    t.handles_[handle.queueType_] = handle;
   }
-  pimpl_->deferredTasks_.emplace_back(std::move(task), handle);
+  std::lock_guard lock(pimpl_->deferredTasksMutex_);
+  pimpl_->deferredTasks_.push_back(std::move(t));
 }
 
 void* lvk::VulkanContext::getVmaAllocator() const {
@@ -5355,18 +9628,40 @@ void* lvk::VulkanContext::getVmaAllocator() const {
 }
 
 void lvk::VulkanContext::processDeferredTasks() const {
-  while (!pimpl_->deferredTasks_.empty() && immediate_->isReady(pimpl_->deferredTasks_.front().handle_, true)) {
-    pimpl_->deferredTasks_.front().task_();
-    pimpl_->deferredTasks_.pop_front();
+  while (true) {
+    DeferredTask task;
+    {
+      std::lock_guard lock(pimpl_->deferredTasksMutex_);
+      if (pimpl_->deferredTasks_.empty()) {
+        return;
+      }
+      const DeferredTask& front = pimpl_->deferredTasks_.front();
+      // the completed timeline value is cached - only the first blocked task queries Vulkan, the rest are retired in bulk
+      for (const SubmitHandle& h : front.handles_) {
+        if (!getImmediateCommands(h)->isReady(h)) {
+          return;
+        }
+      }
+      task = std::move(pimpl_->deferredTasks_.front());
+      pimpl_->deferredTasks_.pop_front();
+    }
+    // run the task without holding the lock - it is allowed to schedule more deferred tasks
+    task.task_();
   }
 }
 
 void lvk::VulkanContext::waitDeferredTasks() {
-  for (auto& task : pimpl_->deferredTasks_) {
-    immediate_->wait(task.handle_);
+  std::deque<DeferredTask> tasks;
+  {
+    std::lock_guard lock(pimpl_->deferredTasksMutex_);
+    tasks.swap(pimpl_->deferredTasks_);
+  }
+  for (auto& task : tasks) {
+    for (const SubmitHandle& h : task.handles_) {
+      getImmediateCommands(h)->wait(h);
+    }
     task.task_();
   }
-  pimpl_->deferredTasks_.clear();
 }
 
 void lvk::VulkanContext::invokeShaderModuleErrorCallback(int line, int col, const char* debugName, VkShaderModule sm) {
@@ -5376,9 +9671,13 @@ void lvk::VulkanContext::invokeShaderModuleErrorCallback(int line, int col, cons
 
   lvk::ShaderModuleHandle handle;
 
-  for (uint32_t i = 0; i != shaderModulesPool_.objects_.size(); i++) {
-    if (shaderModulesPool_.objects_[i].obj_.sm == sm) {
-      handle = shaderModulesPool_.getHandle(i);
+  {
+    // shader modules can be created on other threads; the callback is invoked outside of the lock
+    std::lock_guard lock(shaderModulesPool_.mutex_);
+    for (uint32_t i = 0; i != shaderModulesPool_.objects_.size(); i++) {
+      if (shaderModulesPool_.objects_[i].obj_.sm == sm) {
+        handle = shaderModulesPool_.getHandle(i);
+      }
     }
   }
 
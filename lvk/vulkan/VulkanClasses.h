@@ -10,9 +10,14 @@
 #include <lvk/vulkan/VulkanUtils.h>
 #include <lvk/Pool.h>
 
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace lvk {
@@ -23,9 +28,18 @@ struct DeviceQueues {
   const static uint32_t INVALID = 0xFFFFFFFF;
   uint32_t graphicsQueueFamilyIndex = INVALID;
   uint32_t computeQueueFamilyIndex = INVALID;
+  uint32_t transferQueueFamilyIndex = INVALID; // same as graphicsQueueFamilyIndex if there is no dedicated transfer queue
+  // VkQueueFamilyProperties::minImageTransferGranularity of the transfer queue family
+  VkExtent3D transferImageGranularity = {1, 1, 1};
 
   VkQueue graphicsQueue = VK_NULL_HANDLE;
   VkQueue computeQueue = VK_NULL_HANDLE;
+  VkQueue transferQueue = VK_NULL_HANDLE;
+
+  // unique queue family indices of all queues; resources which can cross queues are shared between their families (see
+  // getSharingQueueFamilies() in VulkanClasses.cpp)
+  uint32_t uniqueFamilyIndices[3] = {};
+  uint32_t numUniqueFamilyIndices = 0;
 };
 
 class VulkanBuffer final {
@@ -85,7 +99,9 @@ class VulkanImage final {
               VkMemoryPropertyFlags memFlags,
               VkImageCreateFlags createFlags,
               VkSampleCountFlagBits samples,
-              const char* debugName);
+              const char* debugName,
+              const std::shared_ptr<VulkanImage>& aliasOf = nullptr,
+              lvk::Result* outResult = nullptr);
   VulkanImage(lvk::VulkanContext& ctx,
               VkDevice device,
               VkImage image,
@@ -139,6 +155,8 @@ class VulkanImage final {
   VkImage vkImage_ = VK_NULL_HANDLE;
   VkImageUsageFlags vkUsageFlags_ = 0;
   VkDeviceMemory vkMemory_ = VK_NULL_HANDLE;
+  VkDeviceSize vkMemorySize_ = 0; // non-VMA allocations
+  uint32_t vkMemoryTypeIndex_ = 0; // non-VMA allocations
   VmaAllocationCreateInfo vmaAllocInfo_ = {};
   VmaAllocation vmaAllocation_ = VK_NULL_HANDLE;
   VkFormatProperties vkFormatProperties_ = {};
@@ -152,13 +170,31 @@ class VulkanImage final {
   uint32_t numLayers_ = 1u;
   bool isDepthFormat_ = false;
   bool isStencilFormat_ = false;
+  bool isMutableFormat_ = false; // sRGB storage images can be viewed as UNORM (and vice versa)
+  bool isCubeCompatible_ = false;
+  bool isTransferQueueShared_ = false; // the transfer queue family can write the image in uploadAsync()
   // current image layout
   mutable VkImageLayout vkImageLayout_ = VK_IMAGE_LAYOUT_UNDEFINED;
+  // the image which owns the memory this image is bound to (TextureDesc::aliasOf)
+  std::shared_ptr<VulkanImage> aliasOf_;
+  // TextureDesc::isSparse: memory of resident pages keyed on their mip-level, layer, and page coordinates
+  struct SparsePage {
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE; // non-VMA allocations
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t block = ~0u; // non-VMA pages sub-allocated from a memory block; ~0u for dedicated allocations (mip tails)
+  };
+  bool isSparse_ = false;
+  VkSparseImageMemoryRequirements sparseRequirements_ = {};
+  VkMemoryRequirements sparseMemoryRequirements_ = {}; // `alignment` is the size of one page
+  std::unordered_map<uint64_t, SparsePage> sparsePages_;
 };
 
 struct VulkanTexture final {
   VulkanTexture() = default;
-  VulkanTexture(std::shared_ptr<lvk::VulkanImage> image, VkImageView imageView);
+  // `viewFormat` is VK_FORMAT_UNDEFINED if `imageView` has the format of `image`
+  VulkanTexture(std::shared_ptr<lvk::VulkanImage> image, VkImageView imageView, VkFormat viewFormat = VK_FORMAT_UNDEFINED);
   ~VulkanTexture();
 
   VulkanTexture(const VulkanTexture&) = delete;
@@ -177,9 +213,30 @@ struct VulkanTexture final {
 
   std::shared_ptr<lvk::VulkanImage> image_;
   VkImageView imageView_ = VK_NULL_HANDLE; // all mip-levels
+  bool isStorageView_ = false; // sRGB views of mutable-format storage images cannot be used as storage images
   VkImageView imageViewForFramebuffer_[LVK_MAX_MIP_LEVELS][6] = {}; // max 6 faces for cubemap rendering
 };
 
+// counters behind IContext::getFrameStats(); updated from any thread
+struct VulkanFrameCounters final {
+  std::atomic<uint32_t> numHostWaits[HostWait_Num] = {};
+  std::atomic<uint64_t> hostWaitTimeNs[HostWait_Num] = {};
+  std::atomic<uint32_t> numSubmits = 0;
+  std::atomic<uint32_t> numBarriers = 0;
+  std::atomic<uint32_t> numDescriptorSetUpdates = 0;
+  std::atomic<uint32_t> numDescriptorWrites = 0;
+  std::atomic<uint32_t> numPipelineCompiles = 0;
+  std::atomic<uint64_t> pipelineCompileTimeNs = 0;
+  std::atomic<uint64_t> stagingBytes = 0;
+
+  void addHostWait(HostWait wait, uint64_t timeNs) {
+    numHostWaits[wait]++;
+    hostWaitTimeNs[wait] += timeNs;
+  }
+  // returns the accumulated values and starts over
+  FrameStats reset();
+};
+
 class VulkanSwapchain final {
   enum { LVK_MAX_SWAPCHAIN_IMAGES = 16 };
 
@@ -187,7 +244,10 @@ class VulkanSwapchain final {
   VulkanSwapchain(VulkanContext& ctx, uint32_t width, uint32_t height);
   ~VulkanSwapchain();
 
-  Result present(VkSemaphore waitSemaphore);
+  // `presentId` is passed via VK_KHR_present_id if present wait is enabled
+  Result present(VkSemaphore waitSemaphore, uint64_t presentId);
+  // VK_KHR_present_wait; returns false on timeout
+  bool waitForPresent(uint64_t presentId, uint64_t timeoutNs) const;
   VkImage getCurrentVkImage() const;
   VkImageView getCurrentVkImageView() const;
   TextureHandle getCurrentTexture();
@@ -208,6 +268,7 @@ class VulkanSwapchain final {
   TextureHandle swapchainTextures_[LVK_MAX_SWAPCHAIN_IMAGES] = {};
   VkSemaphore acquireSemaphore_ = VK_NULL_HANDLE;
   VkFence acquireFence_ = VK_NULL_HANDLE;
+  uint64_t firstPresentId_ = 0; // present ids of previous swapchains are never signaled by this one
 };
 
 class VulkanImmediateCommands final {
@@ -216,7 +277,12 @@ class VulkanImmediateCommands final {
   // an existing buffer becomes available
   static constexpr uint32_t kMaxCommandBuffers = 64;
 
-  VulkanImmediateCommands(VkDevice device, uint32_t queueFamilyIndex, const char* debugName);
+  VulkanImmediateCommands(const VulkanDeviceTable& vkDT,
+                          VkDevice device,
+                          uint32_t queueFamilyIndex,
+                          const char* debugName,
+                          lvk::QueueType queueType = lvk::QueueType_Graphics,
+                          VulkanFrameCounters* counters = nullptr);
   ~VulkanImmediateCommands();
   VulkanImmediateCommands(const VulkanImmediateCommands&) = delete;
   VulkanImmediateCommands& operator=(const VulkanImmediateCommands&) = delete;
@@ -224,38 +290,74 @@ class VulkanImmediateCommands final {
   struct CommandBufferWrapper {
     VkCommandBuffer cmdBuf_ = VK_NULL_HANDLE;
     VkCommandBuffer cmdBufAllocated_ = VK_NULL_HANDLE;
+    // every command buffer has its own pool, so different threads can record different command buffers simultaneously
+    VkCommandPool commandPool_ = VK_NULL_HANDLE;
+    // `handle_.submitId_` is the lower 32 bits of `timelineValue_`
     SubmitHandle handle_ = {};
-    VkFence fence_ = VK_NULL_HANDLE;
     VkSemaphore semaphore_ = VK_NULL_HANDLE;
+    // the value `timelineSemaphore_` is signaled with when this buffer completes (shared by buffers submitted together)
+    uint64_t timelineValue_ = 0;
     bool isEncoding_ = false;
   };
 
-  // returns the current command buffer (creates one if it does not exist)
+  // returns the current command buffer (creates one if it does not exist); thread-safe
   const CommandBufferWrapper& acquire();
   SubmitHandle submit(const CommandBufferWrapper& wrapper);
+  // submit multiple command buffers in the specified order using one vkQueueSubmit(); returns the handle of the last one
+  // `waitTimelineSemaphores` are usually signaled by other queues (cross-queue dependencies)
+  SubmitHandle submit(const CommandBufferWrapper* const* wrappers,
+                      uint32_t numWrappers,
+                      const VkSemaphore* waitTimelineSemaphores = nullptr,
+                      const uint64_t* waitTimelineValues = nullptr,
+                      uint32_t numWaitTimelineSemaphores = 0);
   void waitSemaphore(VkSemaphore semaphore);
+  // executed after all previous submits; the next submit waits for it. Returns the timeline value other queues should wait for
+  uint64_t bindSparse(const VkSparseImageMemoryBindInfo* imageBinds,
+                      uint32_t numImageBinds,
+                      const VkSparseImageOpaqueMemoryBindInfo* opaqueBinds,
+                      uint32_t numOpaqueBinds);
   VkSemaphore acquireLastSubmitSemaphore();
-  VkFence getVkFence(SubmitHandle handle) const;
   SubmitHandle getLastSubmitHandle() const;
   bool isReady(SubmitHandle handle, bool fastCheckNoVulkan = false) const;
-  void wait(SubmitHandle handle);
+  // `reason` is reported by IContext::getFrameStats() if the handle is not ready yet
+  void wait(SubmitHandle handle, HostWait reason = HostWait_Submit);
   void waitAll();
+  VkSemaphore getTimelineSemaphore() const {
+    return timelineSemaphore_;
+  }
+  // returns the timeline value another queue should wait for; 0 if the submit handle has already completed
+  uint64_t getTimelineValue(SubmitHandle handle) const;
+  lvk::QueueType getQueueType() const {
+    return queueType_;
+  }
 
  private:
+  // all private functions expect `mutex_` to be locked by the caller
   void purge();
+  bool isReadyLocked(SubmitHandle handle, bool fastCheckNoVulkan) const;
+  uint64_t getTimelineValueLocked(SubmitHandle handle) const;
+  // query the timeline semaphore once and update `completedValue_`
+  uint64_t updateCompletedValueLocked() const;
 
  private:
+  const VulkanDeviceTable& vkDT_;
   VkDevice device_ = VK_NULL_HANDLE;
   VkQueue queue_ = VK_NULL_HANDLE;
-  VkCommandPool commandPool_ = VK_NULL_HANDLE;
   uint32_t queueFamilyIndex_ = 0;
+  lvk::QueueType queueType_ = lvk::QueueType_Graphics;
   const char* debugName_ = "";
   CommandBufferWrapper buffers_[kMaxCommandBuffers];
+  // signaled with a monotonically increasing value by every submit; used to retire command buffers and to synchronize with other queues
+  VkSemaphore timelineSemaphore_ = VK_NULL_HANDLE;
+  uint64_t timelineValue_ = 0; // the last submitted value
+  mutable uint64_t completedValue_ = 0; // the last known completed value
   SubmitHandle lastSubmitHandle_ = SubmitHandle();
   VkSemaphore lastSubmitSemaphore_ = VK_NULL_HANDLE;
   VkSemaphore waitSemaphore_ = VK_NULL_HANDLE;
+  uint64_t waitBindSparseValue_ = 0; // the timeline value signaled by the last bindSparse() if no submit waited for it yet
   uint32_t numAvailableCommandBuffers_ = kMaxCommandBuffers;
-  uint32_t submitCounter_ = 1;
+  VulkanFrameCounters* counters_ = nullptr;
+  mutable std::mutex mutex_;
 };
 
 struct RenderPipelineState final {
@@ -300,7 +402,8 @@ class VulkanPipelineBuilder final {
   VulkanPipelineBuilder& stencilAttachmentFormat(VkFormat format);
   VulkanPipelineBuilder& patchControlPoints(uint32_t numPoints);
 
-  VkResult build(VkDevice device,
+  VkResult build(const VulkanDeviceTable& vkDT,
+                 VkDevice device,
                  VkPipelineCache pipelineCache,
                  VkPipelineLayout pipelineLayout,
                  VkPipeline* outPipeline,
@@ -316,7 +419,7 @@ class VulkanPipelineBuilder final {
   VkDynamicState dynamicStates_[LVK_MAX_DYNAMIC_STATES] = {};
 
   uint32_t numShaderStages_ = 0;
-  VkPipelineShaderStageCreateInfo shaderStages_[Stage_Frag + 1] = {};
+  VkPipelineShaderStageCreateInfo shaderStages_[Stage_Mesh + 1] = {};
 
   VkPipelineVertexInputStateCreateInfo vertexInputState_;
   VkPipelineInputAssemblyStateCreateInfo inputAssembly_;
@@ -332,7 +435,7 @@ class VulkanPipelineBuilder final {
   VkFormat depthAttachmentFormat_ = VK_FORMAT_UNDEFINED;
   VkFormat stencilAttachmentFormat_ = VK_FORMAT_UNDEFINED;
 
-  static uint32_t numPipelinesCreated_;
+  static std::atomic<uint32_t> numPipelinesCreated_;
 };
 
 struct ComputePipelineState final {
@@ -350,10 +453,21 @@ struct ShaderModuleState final {
   uint32_t pushConstantsSize = 0;
 };
 
+// shader modules resolved from RenderPipelineDesc, so VkPipeline objects can be created without accessing the pools
+struct RenderPipelineShaders final {
+  ShaderModuleState vert;
+  ShaderModuleState tesc;
+  ShaderModuleState tese;
+  ShaderModuleState geom;
+  ShaderModuleState frag;
+  ShaderModuleState task;
+  ShaderModuleState mesh;
+};
+
 class CommandBuffer final : public ICommandBuffer {
  public:
   CommandBuffer() = default;
-  explicit CommandBuffer(VulkanContext* ctx);
+  explicit CommandBuffer(VulkanContext* ctx, lvk::QueueType queue = lvk::QueueType_Graphics);
   ~CommandBuffer() override;
 
   CommandBuffer& operator=(CommandBuffer&& other) = default;
@@ -374,6 +488,11 @@ class CommandBuffer final : public ICommandBuffer {
   void cmdBeginRendering(const lvk::RenderPass& renderPass, const lvk::Framebuffer& desc, const Dependencies& deps) override;
   void cmdEndRendering() override;
 
+  void cmdPipelineBarrier(const TextureBarrier* textureBarriers,
+                          uint32_t numTextureBarriers,
+                          const BufferBarrier* bufferBarriers,
+                          uint32_t numBufferBarriers) override;
+
   void cmdBindViewport(const Viewport& viewport) override;
   void cmdBindScissorRect(const ScissorRect& rect) override;
 
@@ -398,6 +517,14 @@ class CommandBuffer final : public ICommandBuffer {
                                    size_t countBufferOffset,
                                    uint32_t maxDrawCount,
                                    uint32_t stride = 0) override;
+  void cmdDrawMeshTasks(const Dimensions& threadgroupCount) override;
+  void cmdDrawMeshTasksIndirect(BufferHandle indirectBuffer, size_t indirectBufferOffset, uint32_t drawCount, uint32_t stride = 0) override;
+  void cmdDrawMeshTasksIndirectCount(BufferHandle indirectBuffer,
+                                     size_t indirectBufferOffset,
+                                     BufferHandle countBuffer,
+                                     size_t countBufferOffset,
+                                     uint32_t maxDrawCount,
+                                     uint32_t stride = 0) override;
 
   void cmdSetBlendColor(const float color[4]) override;
   void cmdSetDepthBias(float depthBias, float slopeScale, float clamp) override;
@@ -405,6 +532,14 @@ class CommandBuffer final : public ICommandBuffer {
   void cmdResetQueryPool(QueryPoolHandle pool, uint32_t firstQuery, uint32_t queryCount) override;
   void cmdWriteTimestamp(QueryPoolHandle pool, uint32_t query) override;
 
+  void cmdCopyBuffer(BufferHandle src, size_t srcOffset, BufferHandle dst, size_t dstOffset, size_t size) override;
+  void cmdFillBuffer(BufferHandle buffer, size_t offset, size_t size, uint32_t value) override;
+  void cmdCopyTextureToBuffer(TextureHandle src, const TextureRangeDesc& range, BufferHandle dst, size_t dstOffset) override;
+
+  const CommandBufferStats& getStats() const override {
+    return stats_;
+  }
+
   VkCommandBuffer getVkCommandBuffer() const {
     return wrapper_ ? wrapper_->cmdBuf_ : VK_NULL_HANDLE;
   }
@@ -412,22 +547,73 @@ class CommandBuffer final : public ICommandBuffer {
  private:
   void useComputeTexture(TextureHandle texture);
   void bufferBarrier(BufferHandle handle, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
+  void addSubmitDependencies(const Dependencies& deps);
+  void gpuProfilerBeginScope(const char* name) const;
+  void gpuProfilerEndScope() const;
 
  private:
   friend class VulkanContext;
 
+  enum { kMaxWaitSubmits = 16 };
+
   VulkanContext* ctx_ = nullptr;
   const VulkanImmediateCommands::CommandBufferWrapper* wrapper_ = nullptr;
+  lvk::QueueType queueType_ = lvk::QueueType_Graphics;
+
+  // submits from other queues this command buffer depends on
+  SubmitHandle waitSubmits_[kMaxWaitSubmits] = {};
+  uint32_t numWaitSubmits_ = 0;
+
+  // IContext::allocateTransient(): the bytes of every transient buffer this command buffer allocated from; they are flushed and
+  // retired by its own submit
+  struct TransientRange {
+    uint32_t buffer = 0; // index into VulkanContextImpl::transientBuffers_
+    size_t begin = 0;
+    size_t end = 0;
+  };
+  std::vector<TransientRange> transientRanges_;
 
   lvk::Framebuffer framebuffer_ = {};
   lvk::SubmitHandle lastSubmitHandle_ = {};
 
   VkPipeline lastPipelineBound_ = VK_NULL_HANDLE;
 
+  // redundant state filtering: the dynamic state last recorded into this command buffer (all pipelines share the same set of
+  // dynamic states, so it survives pipeline changes and render passes)
+  enum { kMaxTrackedPushConstantsSize = 256 };
+  struct VertexBufferBinding {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+  };
+  bool hasViewport_ = false;
+  VkViewport viewport_ = {};
+  bool hasScissor_ = false;
+  VkRect2D scissor_ = {};
+  bool hasDepthState_ = false;
+  DepthState depthState_ = {};
+  VertexBufferBinding vertexBuffers_[VertexInput::LVK_VERTEX_BUFFER_MAX] = {};
+  VkBuffer indexBuffer_ = VK_NULL_HANDLE;
+  VkDeviceSize indexBufferOffset_ = 0;
+  VkIndexType indexType_ = VK_INDEX_TYPE_MAX_ENUM;
+  // push constants are tracked per 4-byte word and only for the VkPipelineLayout they were pushed with
+  VkPipelineLayout pushConstantsLayout_ = VK_NULL_HANDLE;
+  VkShaderStageFlags pushConstantsStages_ = 0;
+  uint64_t pushConstantsValidWords_ = 0; // bit N: bytes [4*N, 4*N+4) of `pushConstants_` are valid
+  uint8_t pushConstants_[kMaxTrackedPushConstantsSize] = {};
+
+  CommandBufferStats stats_ = {};
+
   bool isRendering_ = false;
 
+  // attachments already transitioned by cmdPipelineBarrier() for the next cmdBeginRendering()
+  std::vector<TextureHandle> transitionedAttachments_;
+
   lvk::RenderPipelineHandle currentPipelineGraphics_ = {};
   lvk::ComputePipelineHandle currentPipelineCompute_ = {};
+
+  // GPU profiler: the frame this command buffer writes timestamps into, and the stack of its open scopes (~0u if a scope did not fit)
+  mutable uint32_t gpuProfilerFrame_ = ~0u;
+  mutable std::vector<uint32_t> gpuProfilerScopeStack_;
 };
 
 class VulkanStagingDevice final {
@@ -438,31 +624,84 @@ class VulkanStagingDevice final {
   VulkanStagingDevice(const VulkanStagingDevice&) = delete;
   VulkanStagingDevice& operator=(const VulkanStagingDevice&) = delete;
 
-  void bufferSubData(VulkanBuffer& buffer, size_t dstOffset, size_t size, const void* data);
-  void imageData2D(VulkanImage& image,
-                   const VkRect2D& imageRegion,
-                   uint32_t baseMipLevel,
-                   uint32_t numMipLevels,
-                   uint32_t layer,
-                   uint32_t numLayers,
-                   VkFormat format,
-                   const void* data);
-  void imageData3D(VulkanImage& image, const VkOffset3D& offset, const VkExtent3D& extent, VkFormat format, const void* data);
-  void getImageData(VulkanImage& image,
-                    const VkOffset3D& offset,
-                    const VkExtent3D& extent,
-                    VkImageSubresourceRange range,
-                    VkFormat format,
-                    void* outData);
+  // all uploads are recorded into one command buffer which is submitted together with the next VulkanContext::submit();
+  // QueueType_Transfer uploads are recorded separately and have to be submitted using flush(QueueType_Transfer).
+  // These fail if the staging buffer is full of regions mapped by IContext::mapForUpload() and not committed yet
+  Result bufferSubData(VulkanBuffer& buffer,
+                       size_t dstOffset,
+                       size_t size,
+                       const void* data,
+                       lvk::QueueType queue = lvk::QueueType_Graphics);
+  Result imageData2D(VulkanImage& image,
+                     const VkRect2D& imageRegion,
+                     uint32_t baseMipLevel,
+                     uint32_t numMipLevels,
+                     uint32_t layer,
+                     uint32_t numLayers,
+                     VkFormat format,
+                     const void* data,
+                     lvk::QueueType queue = lvk::QueueType_Graphics);
+  Result imageData3D(VulkanImage& image,
+                     const VkOffset3D& offset,
+                     const VkExtent3D& extent,
+                     VkFormat format,
+                     const void* data,
+                     lvk::QueueType queue = lvk::QueueType_Graphics);
+  Result getImageData(VulkanImage& image,
+                      const VkOffset3D& offset,
+                      const VkExtent3D& extent,
+                      VkImageSubresourceRange range,
+                      VkFormat format,
+                      void* outData);
+
+  bool hasPendingUploads(lvk::QueueType queue = lvk::QueueType_Graphics) const {
+    return pending_[queue] != nullptr;
+  }
+  // submit all pending uploads right away
+  SubmitHandle flush(lvk::QueueType queue = lvk::QueueType_Graphics);
+  // submit pending uploads only on the queues which have copies into `vkBufferOrImage` (before it is destroyed)
+  void flushUploadsTo(uint64_t vkBufferOrImage);
 
  private:
+  friend class VulkanContext;
+
   struct MemoryRegionDesc {
     uint32_t offset_ = 0;
     uint32_t size_ = 0;
-    SubmitHandle handle_ = {};
+    SubmitHandle handle_ = {}; // empty while the region is used by pending uploads
+    lvk::QueueType queue_ = lvk::QueueType_Graphics; // the pending command buffer using this region
+    bool isMapped_ = false; // written by the application (IContext::mapForUpload()) and not committed yet
   };
 
-  MemoryRegionDesc getNextFreeOffset(uint32_t size);
+  // returns a contiguous region of the ring buffer; the region can be smaller than `size` only if `allowPartial` is true. Returns an
+  // empty region if the ring is blocked by a mapped region (waiting for it would deadlock: it is committed only by the application)
+  MemoryRegionDesc allocate(uint32_t size, bool allowPartial, lvk::QueueType queue = lvk::QueueType_Graphics);
+  // zero-copy uploads: the region is pinned until unmap(); the copy is recorded by VulkanContext::commitUpload() using record*()
+  MemoryRegionDesc map(uint32_t size, lvk::QueueType queue = lvk::QueueType_Graphics);
+  uint8_t* getMappedPtr(const MemoryRegionDesc& desc) const;
+  void unmap(const MemoryRegionDesc& desc);
+  void recordBufferCopy(VulkanBuffer& buffer, size_t dstOffset, uint32_t srcOffset, uint32_t size, lvk::QueueType queue);
+  void recordImageCopy2D(VulkanImage& image,
+                         const VkRect2D& imageRegion,
+                         uint32_t baseMipLevel,
+                         uint32_t numMipLevels,
+                         uint32_t layer,
+                         uint32_t numLayers,
+                         VkFormat format,
+                         uint32_t srcOffset,
+                         lvk::QueueType queue);
+  void recordImageCopy3D(VulkanImage& image, const VkOffset3D& offset, const VkExtent3D& extent, uint32_t srcOffset, lvk::QueueType queue);
+  static uint32_t getImageData2DSize(const VulkanImage& image,
+                                     uint32_t baseMipLevel,
+                                     uint32_t numMipLevels,
+                                     uint32_t numLayers,
+                                     VkFormat format);
+  const VulkanImmediateCommands::CommandBufferWrapper& getPendingCommandBuffer(lvk::QueueType queue = lvk::QueueType_Graphics);
+  // QueueType_Transfer uploads are recorded for a transfer-only queue only if the device has a dedicated transfer queue family;
+  // otherwise they are submitted on the graphics queue and need full barriers
+  bool isDedicatedTransferQueue(lvk::QueueType queue) const;
+  // the pending command buffer was submitted by VulkanContext
+  void onSubmitted(lvk::QueueType queue, SubmitHandle handle);
   void ensureStagingBufferSize(uint32_t sizeNeeded);
   void waitAndReset();
   static uint32_t getAlignedSize(uint32_t size) {
@@ -473,12 +712,20 @@ class VulkanStagingDevice final {
  private:
   VulkanContext& ctx_;
   lvk::Holder<BufferHandle> stagingBuffer_;
-  std::unique_ptr<lvk::VulkanImmediateCommands> immediate_;
+  // uploads recorded since the last submit; allocated from VulkanContext::getImmediateCommands(queue)
+  const VulkanImmediateCommands::CommandBufferWrapper* pending_[lvk::QueueType_Num] = {};
+  // VkBuffer and VkImage handles written by `pending_`
+  std::vector<uint64_t> pendingTargets_[lvk::QueueType_Num];
   uint32_t stagingBufferSize_ = 0;
   uint32_t stagingBufferCounter_ = 0;
   uint32_t maxBufferSize_ = 0;
   const uint32_t minBufferSize_ = 4u * 2048u * 2048u;
+  // the staging buffer is a ring: `head_` is the next free byte, used regions are stored in the allocation order
+  uint32_t head_ = 0;
   std::deque<MemoryRegionDesc> regions_;
+  uint32_t numMappedRegions_ = 0; // the staging buffer cannot be reallocated while there are mapped regions
+  // uploads can be recorded on any thread; recursive because flush() and ensureStagingBufferSize() are called internally
+  std::recursive_mutex mutex_;
 };
 
 class VulkanContext final : public IContext {
@@ -486,18 +733,29 @@ class VulkanContext final : public IContext {
   VulkanContext(const lvk::ContextConfig& config, void* window, void* display = nullptr);
   ~VulkanContext();
 
-  ICommandBuffer& acquireCommandBuffer() override;
+  ICommandBuffer& acquireCommandBuffer(lvk::QueueType queue) override;
 
   SubmitHandle submit(lvk::ICommandBuffer& commandBuffer, TextureHandle present) override;
+  SubmitHandle submit(lvk::ICommandBuffer* const* commandBuffers, uint32_t numCommandBuffers, TextureHandle present) override;
+  void endFrame() override;
   void wait(SubmitHandle handle) override;
+  bool isReady(SubmitHandle handle) const override;
 
   Holder<BufferHandle> createBuffer(const BufferDesc& desc, Result* outResult) override;
   Holder<SamplerHandle> createSampler(const SamplerStateDesc& desc, Result* outResult) override;
   Holder<TextureHandle> createTexture(const TextureDesc& desc, const char* debugName, Result* outResult) override;
+  Holder<TextureHandle> createTextureView(TextureHandle texture,
+                                          const TextureViewDesc& desc,
+                                          const char* debugName,
+                                          Result* outResult) override;
 
   Holder<ComputePipelineHandle> createComputePipeline(const ComputePipelineDesc& desc, Result* outResult) override;
   Holder<RenderPipelineHandle> createRenderPipeline(const RenderPipelineDesc& desc, Result* outResult) override;
   Holder<ShaderModuleHandle> createShaderModule(const ShaderModuleDesc& desc, Result* outResult) override;
+  void createShaderModules(const ShaderModuleDesc* descs,
+                           uint32_t numDescs,
+                           Holder<ShaderModuleHandle>* outHandles,
+                           Result* outResults) override;
 
   Holder<QueryPoolHandle> createQueryPool(uint32_t numQueries, const char* debugName, Result* outResult) override;
 
@@ -511,34 +769,59 @@ class VulkanContext final : public IContext {
   void destroy(Framebuffer& fb) override;
 
   Result upload(BufferHandle handle, const void* data, size_t size, size_t offset) override;
+  SubmitHandle uploadAsync(BufferHandle handle, const void* data, size_t size, size_t offset) override;
   uint8_t* getMappedPtr(BufferHandle handle) const override;
   uint64_t gpuAddress(BufferHandle handle, size_t offset) const override;
   void flushMappedMemory(BufferHandle handle, size_t offset, size_t size) const override;
+  TransientAllocation allocateTransient(ICommandBuffer& commandBuffer, size_t size, size_t alignment) override;
+  UploadMapping mapForUpload(BufferHandle handle, size_t size, size_t offset, Result* outResult) override;
+  Result commitUpload(const UploadMapping& mapping) override;
 
   Result upload(TextureHandle handle, const TextureRangeDesc& range, const void* data) override;
+  SubmitHandle uploadAsync(TextureHandle handle, const TextureRangeDesc& range, const void* data) override;
+  UploadMapping mapForUpload(TextureHandle handle, const TextureRangeDesc& range, Result* outResult) override;
   Result download(TextureHandle handle, const TextureRangeDesc& range, void* outData) override;
   Dimensions getDimensions(TextureHandle handle) const override;
   void generateMipmap(TextureHandle handle) const override;
+  void generateMipmap(const TextureHandle* handles, uint32_t numHandles) const override;
   Format getFormat(TextureHandle handle) const override;
+  uint32_t getNumMipLevels(TextureHandle handle) const override;
+  Result updateTexturePages(TextureHandle handle, const TexturePage* pages, uint32_t numPages) override;
+  SparseTextureInfo getSparseTextureInfo(TextureHandle handle) const override;
 
   TextureHandle getCurrentSwapchainTexture() override;
   Format getSwapchainFormat() const override;
   ColorSpace getSwapChainColorSpace() const override;
   uint32_t getNumSwapchainImages() const override;
   void recreateSwapchain(int newWidth, int newHeight) override;
+  uint64_t getLastPresentId() const override;
+  bool waitForPresent(uint64_t presentId, uint64_t timeoutNs) override;
 
   uint32_t getFramebufferMSAABitMask() const override;
+  bool isStorageFormatSupported(Format format) const override;
 
   double getTimestampPeriodToMs() const override;
   bool getQueryPoolResults(QueryPoolHandle pool, uint32_t firstQuery, uint32_t queryCount, size_t dataSize, void* outData, size_t stride)
       const override;
+  uint32_t getGPUProfilerScopes(GPUProfilerScope* outScopes, uint32_t maxOutScopes, uint64_t* outFrameIndex) const override;
+  CommandBufferStats getCommandBufferStats() const override;
+  MemoryStats getMemoryStats() const override;
+  FrameStats getFrameStats() const override;
+
+  void compilePipelinesAsync(const RenderPipelineHandle* handles, uint32_t numHandles) override;
+  void compilePipelinesAsync(const ComputePipelineHandle* handles, uint32_t numHandles) override;
+  bool isPipelineReady(RenderPipelineHandle handle) override;
+  bool isPipelineReady(ComputePipelineHandle handle) override;
 
   ///////////////
 
   VkPipeline getVkPipeline(ComputePipelineHandle handle);
   VkPipeline getVkPipeline(RenderPipelineHandle handle);
 
+  // returns the number of compatible devices if `outDevices` is nullptr
   uint32_t queryDevices(HWDeviceType deviceType, HWDeviceDesc* outDevices, uint32_t maxOutDevices = 1);
+  // all physical devices of a short-lived bare VkInstance; their `guid` is 0 as the handles do not outlive the instance
+  static uint32_t queryDevices(HWDeviceDesc* outDevices, uint32_t maxOutDevices);
   lvk::Result initContext(const HWDeviceDesc& desc);
   lvk::Result initSwapchain(uint32_t width, uint32_t height);
 
@@ -553,7 +836,8 @@ class VulkanContext final : public IContext {
                                            VkImageCreateFlags flags,
                                            VkSampleCountFlagBits samples,
                                            lvk::Result* outResult,
-                                           const char* debugName = nullptr);
+                                           const char* debugName = nullptr,
+                                           const std::shared_ptr<VulkanImage>& aliasOf = nullptr);
   BufferHandle createBuffer(VkDeviceSize bufferSize,
                             VkBufferUsageFlags usageFlags,
                             VkMemoryPropertyFlags memFlags,
@@ -584,6 +868,20 @@ class VulkanContext final : public IContext {
 
   std::vector<uint8_t> getPipelineCacheData() const;
 
+  // QueueType_Compute and QueueType_Transfer fall back to the graphics queue if there are no dedicated queues
+  lvk::VulkanImmediateCommands* getImmediateCommands(lvk::QueueType queue) const {
+    if (queue == lvk::QueueType_Compute && computeImmediate_) {
+      return computeImmediate_.get();
+    }
+    if (queue == lvk::QueueType_Transfer && transferImmediate_) {
+      return transferImmediate_.get();
+    }
+    return immediate_.get();
+  }
+  lvk::VulkanImmediateCommands* getImmediateCommands(SubmitHandle handle) const {
+    return getImmediateCommands(lvk::QueueType(handle.queueType_));
+  }
+
   // execute a task some time in the future after the submit handle finished processing
   void deferredTask(std::packaged_task<void()>&& task, SubmitHandle handle = SubmitHandle()) const;
 
@@ -596,12 +894,53 @@ class VulkanContext final : public IContext {
   void invokeShaderModuleErrorCallback(int line, int col, const char* debugName, VkShaderModule sm);
 
  private:
-  void createInstance();
+  void createInstance(bool enableSurface);
   void createSurface(void* window, void* display);
   void querySurfaceCapabilities();
   void processDeferredTasks() const;
   void waitDeferredTasks();
   lvk::Result growDescriptorPool(uint32_t maxTextures, uint32_t maxSamplers);
+  lvk::Result uploadBuffer(BufferHandle handle, const void* data, size_t size, size_t offset, lvk::QueueType queue);
+  lvk::Result uploadTexture(TextureHandle handle, const TextureRangeDesc& range, const void* data, lvk::QueueType queue);
+  // can `range` be copied on the transfer queue family (VkQueueFamilyProperties::minImageTransferGranularity)
+  bool isTransferGranularityCompatible(const VulkanImage& image, const TextureRangeDesc& range) const;
+  RenderPipelineShaders getRenderPipelineShaders(const RenderPipelineDesc& desc) const;
+  // thread-safe: do not access any pools
+  VkPipeline createVkPipeline(const RenderPipelineState& rps,
+                              const RenderPipelineShaders& shaders,
+                              VkDescriptorSetLayout dsl,
+                              VkPipelineLayout* outLayout,
+                              VkShaderStageFlags* outStageFlags) const;
+  VkPipeline createVkPipeline(const ComputePipelineState& cps, const ShaderModuleState& sm, VkDescriptorSetLayout dsl, VkPipelineLayout* outLayout)
+      const;
+  // stores a pipeline compiled outside of the lock unless it is stale or another thread was faster; returns the pipeline in use
+  VkPipeline installVkPipeline(RenderPipelineHandle handle,
+                               VkDescriptorSetLayout dsl,
+                               VkPipeline pipeline,
+                               VkPipelineLayout layout,
+                               VkShaderStageFlags stageFlags,
+                               bool* outIsStale = nullptr);
+  VkPipeline installVkPipeline(ComputePipelineHandle handle,
+                               VkDescriptorSetLayout dsl,
+                               VkPipeline pipeline,
+                               VkPipelineLayout layout,
+                               bool* outIsStale = nullptr);
+  // runs `job(0...numJobs-1)` on worker threads
+  void runPipelineCompileJobs(uint32_t numJobs, std::function<void(uint32_t)>&& job, std::vector<VkShaderModule>&& shaderModules);
+  // waits for the jobs compiling pipelines from `shaderModule`, or for all jobs if it is VK_NULL_HANDLE
+  void waitPipelineCompileJobs(VkShaderModule shaderModule = VK_NULL_HANDLE);
+  // writes the pipeline cache into ContextConfig::pipelineCacheDir
+  void savePipelineCache() const;
+  void initGPUProfiler();
+  // called by endFrame(): resolves the oldest frame in the ring and reuses its queries for the new frame
+  void gpuProfilerNextFrame();
+  uint32_t getMemoryHeapStats(MemoryHeapStats* outHeaps) const;
+  // invokes ContextConfig::memoryBudgetCallback for heaps which crossed the threshold
+  void checkMemoryBudget();
+  // executes all pending sparse page updates on the graphics queue; returns the memory of released pages which has to be freed
+  // after the next submit; `outBindValue` is the graphics timeline value other queues should wait for (0 if nothing was bound)
+  std::vector<VulkanImage::SparsePage> flushTexturePages(uint64_t* outBindValue = nullptr);
+  void freeTexturePages(std::vector<VulkanImage::SparsePage>&& pages, SubmitHandle handle);
   ShaderModuleState createShaderModuleFromSPIRV(const void* spirv, size_t numBytes, const char* debugName, Result* outResult) const;
   ShaderModuleState createShaderModuleFromGLSL(ShaderStage stage, const char* source, const char* debugName, Result* outResult) const;
 
@@ -612,6 +951,8 @@ class VulkanContext final : public IContext {
   VkInstance vkInstance_ = VK_NULL_HANDLE;
   VkDebugUtilsMessengerEXT vkDebugUtilsMessenger_ = VK_NULL_HANDLE;
   VkSurfaceKHR vkSurface_ = VK_NULL_HANDLE;
+  // VK_EXT_debug_utils and WSI entry points of `vkInstance_`; the WSI ones are nullptr for headless contexts
+  VulkanInstanceTable vkIT_ = {};
   VkPhysicalDevice vkPhysicalDevice_ = VK_NULL_HANDLE;
   VkDevice vkDevice_ = VK_NULL_HANDLE;
 
@@ -639,24 +980,41 @@ class VulkanContext final : public IContext {
   std::vector<VkPresentModeKHR> devicePresentModes_;
 
  public:
+  // device-level entry points of `vkDevice_`; volk globals hold only core instance-level functions which are shared by all contexts
+  VulkanDeviceTable vkDT_ = {};
   DeviceQueues deviceQueues_;
   std::unique_ptr<lvk::VulkanSwapchain> swapchain_;
   std::unique_ptr<lvk::VulkanImmediateCommands> immediate_;
+  // async compute queue; nullptr if the device does not have a separate compute queue family
+  std::unique_ptr<lvk::VulkanImmediateCommands> computeImmediate_;
+  // DMA transfer queue; nullptr if the device does not have a dedicated transfer queue family
+  std::unique_ptr<lvk::VulkanImmediateCommands> transferImmediate_;
   std::unique_ptr<lvk::VulkanStagingDevice> stagingDevice_;
-  uint32_t currentMaxTextures_ = 16;
-  uint32_t currentMaxSamplers_ = 16;
+  mutable VulkanFrameCounters frameCounters_; // updated by const functions, e.g. createVkPipeline()
+  uint32_t currentMaxTextures_ = 0;
+  uint32_t currentMaxSamplers_ = 0;
   VkDescriptorSetLayout vkDSL_ = VK_NULL_HANDLE;
   VkDescriptorPool vkDPool_ = VK_NULL_HANDLE;
   VkDescriptorSet vkDSet_ = VK_NULL_HANDLE;
   // don't use staging on devices with shared host-visible memory
   bool useStaging_ = true;
+  // VK_EXT_memory_budget
+  bool hasMemoryBudget_ = false;
+  // sparse binding on the graphics queue and sparse residency of 2D images (TextureDesc::isSparse)
+  bool hasSparseResidency_ = false;
+  // VK_EXT_mesh_shader with task and mesh shaders
+  bool hasMeshShader_ = false;
+  // VK_KHR_present_id and VK_KHR_present_wait (ContextConfig::enablePresentWait)
+  bool hasPresentWait_ = false;
+  uint64_t lastPresentId_ = 0;
 
   std::unique_ptr<struct VulkanContextImpl> pimpl_;
 
   VkPipelineCache pipelineCache_ = VK_NULL_HANDLE;
-
-  // a texture/sampler was created since the last descriptor set update
-  mutable bool awaitingCreation_ = false;
+  // empty if ContextConfig::pipelineCacheDir is not set
+  std::string pipelineCacheFileName_;
+  // empty if ContextConfig::shaderCacheDir is not set
+  std::string shaderCacheDir_;
 
   lvk::ContextConfig config_;
 
@@ -245,25 +245,42 @@ lvk::Format lvk::vkFormatToFormat(VkFormat format) {
   return Format_Invalid;
 }
 
-VkSemaphore lvk::createSemaphore(VkDevice device, const char* debugName) {
+VkSemaphore lvk::createSemaphore(const VulkanDeviceTable& vkDT, VkDevice device, const char* debugName) {
   const VkSemaphoreCreateInfo ci = {
       .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
       .flags = 0,
   };
   VkSemaphore semaphore = VK_NULL_HANDLE;
-  VK_ASSERT(vkCreateSemaphore(device, &ci, nullptr, &semaphore));
-  VK_ASSERT(lvk::setDebugObjectName(device, VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)semaphore, debugName));
+  VK_ASSERT(vkDT.vkCreateSemaphore(device, &ci, nullptr, &semaphore));
+  VK_ASSERT(lvk::setDebugObjectName(vkDT, device, VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)semaphore, debugName));
   return semaphore;
 }
 
-VkFence lvk::createFence(VkDevice device, const char* debugName) {
+VkSemaphore lvk::createSemaphoreTimeline(const VulkanDeviceTable& vkDT, VkDevice device, uint64_t initialValue, const char* debugName) {
+  const VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+      .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+      .initialValue = initialValue,
+  };
+  const VkSemaphoreCreateInfo ci = {
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+      .pNext = &semaphoreTypeCreateInfo,
+      .flags = 0,
+  };
+  VkSemaphore semaphore = VK_NULL_HANDLE;
+  VK_ASSERT(vkDT.vkCreateSemaphore(device, &ci, nullptr, &semaphore));
+  VK_ASSERT(lvk::setDebugObjectName(vkDT, device, VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)semaphore, debugName));
+  return semaphore;
+}
+
+VkFence lvk::createFence(const VulkanDeviceTable& vkDT, VkDevice device, const char* debugName) {
   const VkFenceCreateInfo ci = {
       .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
       .flags = 0,
   };
   VkFence fence = VK_NULL_HANDLE;
-  VK_ASSERT(vkCreateFence(device, &ci, nullptr, &fence));
-  VK_ASSERT(lvk::setDebugObjectName(device, VK_OBJECT_TYPE_FENCE, (uint64_t)fence, debugName));
+  VK_ASSERT(vkDT.vkCreateFence(device, &ci, nullptr, &fence));
+  VK_ASSERT(lvk::setDebugObjectName(vkDT, device, VK_OBJECT_TYPE_FENCE, (uint64_t)fence, debugName));
   return fence;
 }
 
@@ -294,9 +311,12 @@ uint32_t lvk::findQueueFamilyIndex(VkPhysicalDevice physDev, VkQueueFlags flags)
       return q;
   }
 
-  // dedicated queue for transfer
+  // dedicated queue for transfer (DMA engines do not support graphics or compute)
   if (flags & VK_QUEUE_TRANSFER_BIT) {
-    const uint32_t q = findDedicatedQueueFamilyIndex(flags, VK_QUEUE_GRAPHICS_BIT);
+    uint32_t q = findDedicatedQueueFamilyIndex(flags, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+    if (q != DeviceQueues::INVALID)
+      return q;
+    q = findDedicatedQueueFamilyIndex(flags, VK_QUEUE_GRAPHICS_BIT);
     if (q != DeviceQueues::INVALID)
       return q;
   }
@@ -305,41 +325,43 @@ uint32_t lvk::findQueueFamilyIndex(VkPhysicalDevice physDev, VkQueueFlags flags)
   return findDedicatedQueueFamilyIndex(flags, 0);
 }
 
-VmaAllocator lvk::createVmaAllocator(VkPhysicalDevice physDev,
+VmaAllocator lvk::createVmaAllocator(const VulkanDeviceTable& vkDT,
+                                     VkPhysicalDevice physDev,
                                      VkDevice device,
                                      VkInstance instance,
-                                     uint32_t apiVersion) {
+                                     uint32_t apiVersion,
+                                     bool hasMemoryBudget) {
   const VmaVulkanFunctions funcs = {
       .vkGetInstanceProcAddr = vkGetInstanceProcAddr,
       .vkGetDeviceProcAddr = vkGetDeviceProcAddr,
       .vkGetPhysicalDeviceProperties = vkGetPhysicalDeviceProperties,
       .vkGetPhysicalDeviceMemoryProperties = vkGetPhysicalDeviceMemoryProperties,
-      .vkAllocateMemory = vkAllocateMemory,
-      .vkFreeMemory = vkFreeMemory,
-      .vkMapMemory = vkMapMemory,
-      .vkUnmapMemory = vkUnmapMemory,
-      .vkFlushMappedMemoryRanges = vkFlushMappedMemoryRanges,
-      .vkInvalidateMappedMemoryRanges = vkInvalidateMappedMemoryRanges,
-      .vkBindBufferMemory = vkBindBufferMemory,
-      .vkBindImageMemory = vkBindImageMemory,
-      .vkGetBufferMemoryRequirements = vkGetBufferMemoryRequirements,
-      .vkGetImageMemoryRequirements = vkGetImageMemoryRequirements,
-      .vkCreateBuffer = vkCreateBuffer,
-      .vkDestroyBuffer = vkDestroyBuffer,
-      .vkCreateImage = vkCreateImage,
-      .vkDestroyImage = vkDestroyImage,
-      .vkCmdCopyBuffer = vkCmdCopyBuffer,
-      .vkGetBufferMemoryRequirements2KHR = vkGetBufferMemoryRequirements2,
-      .vkGetImageMemoryRequirements2KHR = vkGetImageMemoryRequirements2,
-      .vkBindBufferMemory2KHR = vkBindBufferMemory2,
-      .vkBindImageMemory2KHR = vkBindImageMemory2,
+      .vkAllocateMemory = vkDT.vkAllocateMemory,
+      .vkFreeMemory = vkDT.vkFreeMemory,
+      .vkMapMemory = vkDT.vkMapMemory,
+      .vkUnmapMemory = vkDT.vkUnmapMemory,
+      .vkFlushMappedMemoryRanges = vkDT.vkFlushMappedMemoryRanges,
+      .vkInvalidateMappedMemoryRanges = vkDT.vkInvalidateMappedMemoryRanges,
+      .vkBindBufferMemory = vkDT.vkBindBufferMemory,
+      .vkBindImageMemory = vkDT.vkBindImageMemory,
+      .vkGetBufferMemoryRequirements = vkDT.vkGetBufferMemoryRequirements,
+      .vkGetImageMemoryRequirements = vkDT.vkGetImageMemoryRequirements,
+      .vkCreateBuffer = vkDT.vkCreateBuffer,
+      .vkDestroyBuffer = vkDT.vkDestroyBuffer,
+      .vkCreateImage = vkDT.vkCreateImage,
+      .vkDestroyImage = vkDT.vkDestroyImage,
+      .vkCmdCopyBuffer = vkDT.vkCmdCopyBuffer,
+      .vkGetBufferMemoryRequirements2KHR = vkDT.vkGetBufferMemoryRequirements2,
+      .vkGetImageMemoryRequirements2KHR = vkDT.vkGetImageMemoryRequirements2,
+      .vkBindBufferMemory2KHR = vkDT.vkBindBufferMemory2,
+      .vkBindImageMemory2KHR = vkDT.vkBindImageMemory2,
       .vkGetPhysicalDeviceMemoryProperties2KHR = vkGetPhysicalDeviceMemoryProperties2,
-      .vkGetDeviceBufferMemoryRequirements = vkGetDeviceBufferMemoryRequirements,
-      .vkGetDeviceImageMemoryRequirements = vkGetDeviceImageMemoryRequirements,
+      .vkGetDeviceBufferMemoryRequirements = vkDT.vkGetDeviceBufferMemoryRequirements,
+      .vkGetDeviceImageMemoryRequirements = vkDT.vkGetDeviceImageMemoryRequirements,
   };
 
   const VmaAllocatorCreateInfo ci = {
-      .flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
+      .flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT | (hasMemoryBudget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0u),
       .physicalDevice = physDev,
       .device = device,
       .preferredLargeHeapBlockSize = 0,
@@ -355,6 +377,7 @@ VmaAllocator lvk::createVmaAllocator(VkPhysicalDevice physDev,
   return vma;
 }
 
+// the limits read here are hashed into the SPIR-V cache key, see hashGlslangLimits() in VulkanClasses.cpp
 glslang_resource_t lvk::getGlslangResource(const VkPhysicalDeviceLimits& limits) {
   const glslang_resource_t resource = {
       .max_lights = 32,
@@ -452,6 +475,16 @@ glslang_resource_t lvk::getGlslangResource(const VkPhysicalDeviceLimits& limits)
       .max_task_work_group_size_y_nv = 1,
       .max_task_work_group_size_z_nv = 1,
       .max_mesh_view_count_nv = 4,
+      // minimal guaranteed VK_EXT_mesh_shader limits
+      .max_mesh_output_vertices_ext = 256,
+      .max_mesh_output_primitives_ext = 256,
+      .max_mesh_work_group_size_x_ext = 128,
+      .max_mesh_work_group_size_y_ext = 128,
+      .max_mesh_work_group_size_z_ext = 128,
+      .max_task_work_group_size_x_ext = 128,
+      .max_task_work_group_size_y_ext = 128,
+      .max_task_work_group_size_z_ext = 128,
+      .max_mesh_view_count_ext = 1,
       .maxDualSourceDrawBuffersEXT = 1,
       .limits = {
           .non_inductive_for_loops = true,
@@ -566,6 +599,10 @@ static glslang_stage_t getGLSLangShaderStage(VkShaderStageFlagBits stage) {
     return GLSLANG_STAGE_FRAGMENT;
   case VK_SHADER_STAGE_COMPUTE_BIT:
     return GLSLANG_STAGE_COMPUTE;
+  case VK_SHADER_STAGE_TASK_BIT_EXT:
+    return GLSLANG_STAGE_TASK;
+  case VK_SHADER_STAGE_MESH_BIT_EXT:
+    return GLSLANG_STAGE_MESH;
   default:
     assert(false);
   };
@@ -662,7 +699,7 @@ lvk::Result lvk::compileShader(VkShaderStageFlagBits stage,
   return Result();
 }
 
-VkResult lvk::setDebugObjectName(VkDevice device, VkObjectType type, uint64_t handle, const char* name) {
+VkResult lvk::setDebugObjectName(const VulkanDeviceTable& vkDT, VkDevice device, VkObjectType type, uint64_t handle, const char* name) {
   if (!name || !*name) {
     return VK_SUCCESS;
   }
@@ -672,7 +709,7 @@ VkResult lvk::setDebugObjectName(VkDevice device, VkObjectType type, uint64_t ha
       .objectHandle = handle,
       .pObjectName = name,
   };
-  return vkSetDebugUtilsObjectNameEXT(device, &ni);
+  return vkDT.vkSetDebugUtilsObjectNameEXT(device, &ni);
 }
 
 VkSpecializationInfo lvk::getPipelineShaderStageSpecializationInfo(lvk::SpecializationConstantDesc desc,
@@ -709,7 +746,7 @@ VkPipelineShaderStageCreateInfo lvk::getPipelineShaderStageCreateInfo(VkShaderSt
   };
 }
 
-static uint32_t findMemoryType(VkPhysicalDevice physDev, uint32_t memoryTypeBits, VkMemoryPropertyFlags flags) {
+uint32_t lvk::findMemoryType(VkPhysicalDevice physDev, uint32_t memoryTypeBits, VkMemoryPropertyFlags flags) {
   VkPhysicalDeviceMemoryProperties memProperties;
   vkGetPhysicalDeviceMemoryProperties(physDev, &memProperties);
 
@@ -725,7 +762,8 @@ static uint32_t findMemoryType(VkPhysicalDevice physDev, uint32_t memoryTypeBits
   return 0;
 }
 
-VkResult lvk::allocateMemory(VkPhysicalDevice physDev,
+VkResult lvk::allocateMemory(const VulkanDeviceTable& vkDT,
+                             VkPhysicalDevice physDev,
                              VkDevice device,
                              const VkMemoryRequirements* memRequirements,
                              VkMemoryPropertyFlags props,
@@ -742,21 +780,24 @@ VkResult lvk::allocateMemory(VkPhysicalDevice physDev,
       .allocationSize = memRequirements->size,
       .memoryTypeIndex = findMemoryType(physDev, memRequirements->memoryTypeBits, props),
   };
-  return vkAllocateMemory(device, &ai, nullptr, outMemory);
+  return vkDT.vkAllocateMemory(device, &ai, nullptr, outMemory);
 }
 
-VkDescriptorSetLayoutBinding lvk::getDSLBinding(uint32_t binding, VkDescriptorType descriptorType, uint32_t descriptorCount) {
+VkDescriptorSetLayoutBinding lvk::getDSLBinding(uint32_t binding,
+                                                VkDescriptorType descriptorType,
+                                                uint32_t descriptorCount,
+                                                VkShaderStageFlags stageFlags) {
   return VkDescriptorSetLayoutBinding{
       .binding = binding,
       .descriptorType = descriptorType,
       .descriptorCount = descriptorCount,
-      .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT | VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT |
-                    VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+      .stageFlags = stageFlags,
       .pImmutableSamplers = nullptr,
   };
 }
 
-void lvk::imageMemoryBarrier(VkCommandBuffer buffer,
+void lvk::imageMemoryBarrier(const VulkanDeviceTable& vkDT,
+                             VkCommandBuffer buffer,
                              VkImage image,
                              VkAccessFlags srcAccessMask,
                              VkAccessFlags dstAccessMask,
@@ -764,7 +805,8 @@ void lvk::imageMemoryBarrier(VkCommandBuffer buffer,
                              VkImageLayout newImageLayout,
                              VkPipelineStageFlags srcStageMask,
                              VkPipelineStageFlags dstStageMask,
-                             VkImageSubresourceRange subresourceRange) {
+                             VkImageSubresourceRange subresourceRange,
+                             VulkanFrameCounters& counters) {
   const VkImageMemoryBarrier barrier = {
       .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
       .srcAccessMask = srcAccessMask,
@@ -774,7 +816,19 @@ void lvk::imageMemoryBarrier(VkCommandBuffer buffer,
       .image = image,
       .subresourceRange = subresourceRange,
   };
-  vkCmdPipelineBarrier(buffer, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+  counters.numBarriers++;
+  vkDT.vkCmdPipelineBarrier(buffer, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void lvk::bufferMemoryBarrier(const VulkanDeviceTable& vkDT,
+                              VkCommandBuffer buffer,
+                              const VkBufferMemoryBarrier* barriers,
+                              uint32_t numBarriers,
+                              VkPipelineStageFlags srcStageMask,
+                              VkPipelineStageFlags dstStageMask,
+                              VulkanFrameCounters& counters) {
+  counters.numBarriers++;
+  vkDT.vkCmdPipelineBarrier(buffer, srcStageMask, dstStageMask, 0, 0, nullptr, numBarriers, barriers, 0, nullptr);
 }
 
 VkSampleCountFlagBits lvk::getVulkanSampleCountFlags(uint32_t numSamples) {
@@ -60,12 +60,44 @@ typedef struct glslang_resource_s glslang_resource_t;
 
 namespace lvk {
 
-VkSemaphore createSemaphore(VkDevice device, const char* debugName);
-VkFence createFence(VkDevice device, const char* debugName);
-VmaAllocator createVmaAllocator(VkPhysicalDevice physDev, VkDevice device, VkInstance instance, uint32_t apiVersion);
+struct VulkanFrameCounters;
+
+// Device-level entry points of one VkDevice. Commands of VK_EXT_debug_utils are not part of VolkDeviceTable as it is an instance
+// extension: they are loaded from the VkInstance which created the device.
+struct VulkanDeviceTable : VolkDeviceTable {
+  PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT = nullptr;
+  PFN_vkCmdBeginDebugUtilsLabelEXT vkCmdBeginDebugUtilsLabelEXT = nullptr;
+  PFN_vkCmdEndDebugUtilsLabelEXT vkCmdEndDebugUtilsLabelEXT = nullptr;
+  PFN_vkCmdInsertDebugUtilsLabelEXT vkCmdInsertDebugUtilsLabelEXT = nullptr;
+};
+
+// Instance-extension entry points of one VkInstance. The loader returns them only for instances which enabled the extensions, so
+// they cannot be shared via volk globals.
+struct VulkanInstanceTable {
+  PFN_vkCreateDebugUtilsMessengerEXT vkCreateDebugUtilsMessengerEXT = nullptr;
+  PFN_vkDestroyDebugUtilsMessengerEXT vkDestroyDebugUtilsMessengerEXT = nullptr;
+  PFN_vkDestroySurfaceKHR vkDestroySurfaceKHR = nullptr;
+  PFN_vkGetPhysicalDeviceSurfaceSupportKHR vkGetPhysicalDeviceSurfaceSupportKHR = nullptr;
+  PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR vkGetPhysicalDeviceSurfaceCapabilitiesKHR = nullptr;
+  PFN_vkGetPhysicalDeviceSurfaceFormatsKHR vkGetPhysicalDeviceSurfaceFormatsKHR = nullptr;
+  PFN_vkGetPhysicalDeviceSurfacePresentModesKHR vkGetPhysicalDeviceSurfacePresentModesKHR = nullptr;
+};
+
+// device-level functions are called through the VulkanDeviceTable of the VulkanContext which owns `device`
+VkSemaphore createSemaphore(const VulkanDeviceTable& vkDT, VkDevice device, const char* debugName);
+VkSemaphore createSemaphoreTimeline(const VulkanDeviceTable& vkDT, VkDevice device, uint64_t initialValue, const char* debugName);
+VkFence createFence(const VulkanDeviceTable& vkDT, VkDevice device, const char* debugName);
+VmaAllocator createVmaAllocator(const VulkanDeviceTable& vkDT,
+                                VkPhysicalDevice physDev,
+                                VkDevice device,
+                                VkInstance instance,
+                                uint32_t apiVersion,
+                                bool hasMemoryBudget);
 uint32_t findQueueFamilyIndex(VkPhysicalDevice physDev, VkQueueFlags flags);
-VkResult setDebugObjectName(VkDevice device, VkObjectType type, uint64_t handle, const char* name);
-VkResult allocateMemory(VkPhysicalDevice physDev,
+VkResult setDebugObjectName(const VulkanDeviceTable& vkDT, VkDevice device, VkObjectType type, uint64_t handle, const char* name);
+uint32_t findMemoryType(VkPhysicalDevice physDev, uint32_t memoryTypeBits, VkMemoryPropertyFlags flags);
+VkResult allocateMemory(const VulkanDeviceTable& vkDT,
+                        VkPhysicalDevice physDev,
                         VkDevice device,
                         const VkMemoryRequirements* memRequirements,
                         VkMemoryPropertyFlags props,
@@ -78,13 +110,18 @@ Result compileShader(VkShaderStageFlagBits stage,
                      const glslang_resource_t* glslLangResource = nullptr);
 
 VkSamplerCreateInfo samplerStateDescToVkSamplerCreateInfo(const lvk::SamplerStateDesc& desc, const VkPhysicalDeviceLimits& limits);
-VkDescriptorSetLayoutBinding getDSLBinding(uint32_t binding, VkDescriptorType descriptorType, uint32_t descriptorCount);
+VkDescriptorSetLayoutBinding getDSLBinding(uint32_t binding,
+                                           VkDescriptorType descriptorType,
+                                           uint32_t descriptorCount,
+                                           VkShaderStageFlags stageFlags);
 VkSpecializationInfo getPipelineShaderStageSpecializationInfo(lvk::SpecializationConstantDesc desc, VkSpecializationMapEntry* outEntries);
 VkPipelineShaderStageCreateInfo getPipelineShaderStageCreateInfo(VkShaderStageFlagBits stage,
                                                                  VkShaderModule shaderModule,
                                                                  const char* entryPoint,
                                                                  const VkSpecializationInfo* specializationInfo);
-void imageMemoryBarrier(VkCommandBuffer buffer,
+// all pipeline barriers are recorded using these helpers (or CommandBuffer::cmdPipelineBarrier()) to be counted in `counters`
+void imageMemoryBarrier(const VulkanDeviceTable& vkDT,
+                        VkCommandBuffer buffer,
                         VkImage image,
                         VkAccessFlags srcAccessMask,
                         VkAccessFlags dstAccessMask,
@@ -92,7 +129,15 @@ void imageMemoryBarrier(VkCommandBuffer buffer,
                         VkImageLayout newImageLayout,
                         VkPipelineStageFlags srcStageMask,
                         VkPipelineStageFlags dstStageMask,
-                        VkImageSubresourceRange subresourceRange);
+                        VkImageSubresourceRange subresourceRange,
+                        VulkanFrameCounters& counters);
+void bufferMemoryBarrier(const VulkanDeviceTable& vkDT,
+                         VkCommandBuffer buffer,
+                         const VkBufferMemoryBarrier* barriers,
+                         uint32_t numBarriers,
+                         VkPipelineStageFlags srcStageMask,
+                         VkPipelineStageFlags dstStageMask,
+                         VulkanFrameCounters& counters);
 
 VkSampleCountFlagBits getVulkanSampleCountFlags(uint32_t numSamples);
 
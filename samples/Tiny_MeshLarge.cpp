@@ -48,7 +48,10 @@
 #include <tiny_obj_loader.h>
 
 #include <lvk/LVK.h>
+#include <lvk/GPUCulling.h>
 #include <lvk/HelpersImGui.h>
+#include <lvk/MeshCache.h>
+#include <lvk/TextureStreamer.h>
 #include <implot/implot.h>
 
 #if defined(ANDROID)
@@ -59,7 +62,7 @@
 #include <GLFW/glfw3.h>
 #endif
 
-constexpr uint32_t kMeshCacheVersion = 0xC0DE0009;
+constexpr uint32_t kMeshCacheVersion = 0xC0DE000B;
 #if !defined(__APPLE__)
 constexpr int kNumSamplesMSAA = 8;
 #else
@@ -81,6 +84,8 @@ std::string folderThirdParty;
 std::string folderContentRoot;
 
 std::unique_ptr<lvk::ImGuiRenderer> imgui_;
+std::unique_ptr<lvk::TextureStreamer> textureStreamer_;
+std::unique_ptr<lvk::GPUCulling> gpuCulling_;
 
 enum GPUTimestamp {
   GPUTimestamp_BeginSceneRendering = 0,
@@ -481,6 +486,7 @@ lvk::Framebuffer fbOffscreen_;
 lvk::Holder<lvk::TextureHandle> fbOffscreenColor_;
 lvk::Holder<lvk::TextureHandle> fbOffscreenDepth_;
 lvk::Holder<lvk::TextureHandle> fbOffscreenResolve_;
+lvk::Holder<lvk::TextureHandle> fbOffscreenDepthResolve_;
 lvk::Framebuffer fbShadowMap_;
 lvk::Holder<lvk::ShaderModuleHandle> smMeshVert_;
 lvk::Holder<lvk::ShaderModuleHandle> smMeshFrag_;
@@ -520,6 +526,7 @@ glm::vec2 mousePos_ = glm::vec2(0.0f);
 bool mousePressed_ = false;
 bool enableComputePass_ = false;
 bool enableWireframe_ = false;
+bool enableGPUCulling_ = true;
 bool showPerfStats_ = false;
 
 bool isShadowMapDirty_ = true;
@@ -533,7 +540,10 @@ struct VertexData {
 
 std::vector<VertexData> vertexData_;
 std::vector<uint32_t> indexData_;
+uint32_t numIndices_ = 0;
 std::vector<uint32_t> shapeVertexCnt_;
+// meshlets: `indexData_` is sorted by clusters
+std::vector<lvk::GPUCullingCluster> clusters_;
 
 struct UniformsPerFrame {
   mat4 proj;
@@ -563,6 +573,15 @@ struct CachedMaterial {
   char alpha_texname[MAX_MATERIAL_NAME] = {};
 };
 
+// application data stored in the mesh cache file next to vertices and indices
+enum CacheChunk {
+  CacheChunk_Materials = 0,
+  CacheChunk_Clusters,
+  CacheChunk_Shapes,
+  CacheChunk_ShapeVertexCounts,
+  CacheChunk_NUM_CHUNKS
+};
+
 // this goes into our GLSL shaders
 struct GPUMaterial {
   vec4 ambient = vec4(0.0f);
@@ -582,6 +601,10 @@ struct MaterialTextures {
   lvk::TextureHandle ambient;
   lvk::TextureHandle diffuse;
   lvk::TextureHandle alpha;
+  // compressed textures are streamed progressively and their handles change (see updateStreamedTextures())
+  lvk::TextureStreamer::TextureId streamedAmbient = lvk::TextureStreamer::kInvalidTexture;
+  lvk::TextureStreamer::TextureId streamedDiffuse = lvk::TextureStreamer::kInvalidTexture;
+  lvk::TextureStreamer::TextureId streamedAlpha = lvk::TextureStreamer::kInvalidTexture;
 };
 
 std::vector<MaterialTextures> textures_; // same indexing as in materials_
@@ -606,6 +629,7 @@ struct LoadedMaterial {
 std::mutex imagesCacheMutex_;
 std::unordered_map<std::string, LoadedImage> imagesCache_; // accessible only from the loader pool (multiple threads)
 std::unordered_map<std::string, lvk::Holder<lvk::TextureHandle>> texturesCache_; // accessible the main thread
+std::unordered_map<std::string, lvk::TextureStreamer::TextureId> streamedTexturesCache_; // accessible the main thread
 std::vector<LoadedMaterial> loadedMaterials_;
 std::mutex loadedMaterialsMutex_;
 std::atomic<bool> loaderShouldExit_ = false;
@@ -716,7 +740,8 @@ bool init() {
       }},
       .depth = {
           .loadOp = lvk::LoadOp_Clear,
-          .storeOp = lvk::StoreOp_Store,
+          // the resolved depth buffer is used to build the depth pyramid for occlusion culling
+          .storeOp = kNumSamplesMSAA > 1 ? lvk::StoreOp_MsaaResolve : lvk::StoreOp_Store,
           .clearDepth = 1.0f,
       }};
 
@@ -738,6 +763,8 @@ bool init() {
   createOffscreenFramebuffer();
   createPipelines();
 
+  textureStreamer_ = std::make_unique<lvk::TextureStreamer>(*ctx_);
+
   imgui_ = std::make_unique<lvk::ImGuiRenderer>(
       *ctx_, (folderThirdParty + "3D-Graphics-Rendering-Cookbook/data/OpenSans-Light.ttf").c_str(), float(height_) / 70.0f);
 
@@ -755,6 +782,7 @@ bool init() {
 
 void destroy() {
   imgui_ = nullptr;
+  gpuCulling_ = nullptr;
 
   vb0_ = nullptr;
   ib0_ = nullptr;
@@ -784,6 +812,8 @@ void destroy() {
   skyboxTextureIrradiance_ = nullptr;
   textures_.clear();
   texturesCache_.clear();
+  streamedTexturesCache_.clear();
+  textureStreamer_ = nullptr;
   sampler_ = nullptr;
   samplerShadow_ = nullptr;
   ctx_->destroy(fbMain_);
@@ -791,6 +821,7 @@ void destroy() {
   fbOffscreenColor_ = nullptr;
   fbOffscreenDepth_ = nullptr;
   fbOffscreenResolve_ = nullptr;
+  fbOffscreenDepthResolve_ = nullptr;
   queryPoolTimestamps_ = nullptr;
   ctx_ = nullptr;
 
@@ -904,6 +935,53 @@ bool loadAndCache(const char* cacheFileName) {
     meshopt_optimizeVertexFetch(vertexData_.data(), indexData_.data(), indexCount, vertexData_.data(), vertexCount, sizeof(VertexData));
   }
 
+  // split the mesh into meshlets; every meshlet is an indirect draw culled on the GPU
+  {
+    const size_t kMaxVertices = 64;
+    const size_t kMaxTriangles = 124;
+    const float kConeWeight = 0.25f;
+    const size_t vertexCount = vertexData_.size();
+    const size_t maxMeshlets = meshopt_buildMeshletsBound(indexData_.size(), kMaxVertices, kMaxTriangles);
+    std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+    std::vector<uint32_t> meshletVertices(maxMeshlets * kMaxVertices);
+    std::vector<uint8_t> meshletTriangles(maxMeshlets * kMaxTriangles * 3);
+    const size_t numMeshlets = meshopt_buildMeshlets(meshlets.data(),
+                                                     meshletVertices.data(),
+                                                     meshletTriangles.data(),
+                                                     indexData_.data(),
+                                                     indexData_.size(),
+                                                     &vertexData_[0].position.x,
+                                                     vertexCount,
+                                                     sizeof(VertexData),
+                                                     kMaxVertices,
+                                                     kMaxTriangles,
+                                                     kConeWeight);
+    std::vector<uint32_t> indices;
+    indices.reserve(indexData_.size());
+    clusters_.reserve(numMeshlets);
+    for (size_t i = 0; i != numMeshlets; i++) {
+      const meshopt_Meshlet& m = meshlets[i];
+      const meshopt_Bounds bounds = meshopt_computeMeshletBounds(&meshletVertices[m.vertex_offset],
+                                                                 &meshletTriangles[m.triangle_offset],
+                                                                 m.triangle_count,
+                                                                 &vertexData_[0].position.x,
+                                                                 vertexCount,
+                                                                 sizeof(VertexData));
+      clusters_.push_back(lvk::GPUCullingCluster{
+          .center = {bounds.center[0], bounds.center[1], bounds.center[2]},
+          .radius = bounds.radius,
+          .coneAxis = {bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]},
+          .coneCutoff = bounds.cone_cutoff,
+          .indexCount = m.triangle_count * 3,
+          .firstIndex = (uint32_t)indices.size(),
+      });
+      for (uint32_t j = 0; j != m.triangle_count * 3; j++) {
+        indices.push_back(meshletVertices[m.vertex_offset + meshletTriangles[m.triangle_offset + j]]);
+      }
+    }
+    indexData_ = std::move(indices);
+  }
+
   // loop over materials
   for (auto& m : materials) {
     CachedMaterial mtl;
@@ -925,70 +1003,59 @@ bool loadAndCache(const char* cacheFileName) {
 
   LLOGL("Caching mesh...\n");
 
-  FILE* cacheFile = fopen(cacheFileName, "wb");
-  if (!cacheFile) {
-    return false;
-  }
-  const uint32_t numMaterials = (uint32_t)cachedMaterials_.size();
-  const uint32_t numVertices = (uint32_t)vertexData_.size();
-  const uint32_t numIndices = (uint32_t)indexData_.size();
-  fwrite(&kMeshCacheVersion, sizeof(kMeshCacheVersion), 1, cacheFile);
-  fwrite(&numMaterials, sizeof(numMaterials), 1, cacheFile);
-  fwrite(&numVertices, sizeof(numVertices), 1, cacheFile);
-  fwrite(&numIndices, sizeof(numIndices), 1, cacheFile);
-  fwrite(cachedMaterials_.data(), sizeof(CachedMaterial), numMaterials, cacheFile);
-  fwrite(vertexData_.data(), sizeof(VertexData), numVertices, cacheFile);
-  fwrite(indexData_.data(), sizeof(uint32_t), numIndices, cacheFile);
-  const uint32_t numShapes = (uint32_t)shapeData.size();
-  fwrite(&numShapes, sizeof(numShapes), 1, cacheFile);
-  fwrite(shapeData.data(), sizeof(VertexData), numShapes, cacheFile);
-  const uint32_t numShapeVertices = (uint32_t)shapeVertexCnt_.size();
-  fwrite(&numShapeVertices, sizeof(numShapeVertices), 1, cacheFile);
-  fwrite(shapeVertexCnt_.data(), sizeof(uint32_t), numShapeVertices, cacheFile);
-  return fclose(cacheFile) == 0;
+  const lvk::MeshCacheChunk chunks[CacheChunk_NUM_CHUNKS] = {
+      {cachedMaterials_.data(), sizeof(CachedMaterial) * cachedMaterials_.size()},
+      {clusters_.data(), sizeof(lvk::GPUCullingCluster) * clusters_.size()},
+      {shapeData.data(), sizeof(VertexData) * shapeData.size()},
+      {shapeVertexCnt_.data(), sizeof(uint32_t) * shapeVertexCnt_.size()},
+  };
+  const lvk::Result result = lvk::saveMeshCache(cacheFileName,
+                                                {
+                                                    .version = kMeshCacheVersion,
+                                                    .vertices = vertexData_.data(),
+                                                    .vertexStride = sizeof(VertexData),
+                                                    .numVertices = (uint32_t)vertexData_.size(),
+                                                    .indices = indexData_.data(),
+                                                    .numIndices = (uint32_t)indexData_.size(),
+                                                    .chunks = chunks,
+                                                    .numChunks = CacheChunk_NUM_CHUNKS,
+                                                });
+  // the mesh is loaded back from the cache file
+  vertexData_ = {};
+  indexData_ = {};
+  return result.isOk();
 }
 
-bool loadFromCache(const char* cacheFileName) {
-  FILE* cacheFile = fopen(cacheFileName, "rb");
-  SCOPE_EXIT {
-    if (cacheFile) {
-      fclose(cacheFile);
-    }
-  };
-  if (!cacheFile) {
+bool loadFromCache(const char* cacheFileName, lvk::MeshCache& cache) {
+  LVK_PROFILER_FUNCTION();
+
+  const lvk::Result result = cache.open(cacheFileName, kMeshCacheVersion);
+  if (!result.isOk()) {
+    LLOGL("Cannot load cache file: %s\n", result.message);
     return false;
   }
-#define CHECK_READ(expected, read) \
-  if ((read) != (expected)) {      \
-    return false;                  \
-  }
-  uint32_t versionProbe = 0;
-  CHECK_READ(1, fread(&versionProbe, sizeof(versionProbe), 1, cacheFile));
-  if (versionProbe != kMeshCacheVersion) {
-    LLOGL("Cache file has wrong version id\n");
+  if (cache.getVertexStride() != sizeof(VertexData) || cache.getNumChunks() != CacheChunk_NUM_CHUNKS) {
+    LLOGL("Cache file has wrong layout\n");
+    cache.close();
     return false;
   }
-  uint32_t numMaterials = 0;
-  uint32_t numVertices = 0;
-  uint32_t numIndices = 0;
-  CHECK_READ(1, fread(&numMaterials, sizeof(numMaterials), 1, cacheFile));
-  CHECK_READ(1, fread(&numVertices, sizeof(numVertices), 1, cacheFile));
-  CHECK_READ(1, fread(&numIndices, sizeof(numIndices), 1, cacheFile));
-  cachedMaterials_.resize(numMaterials);
-  vertexData_.resize(numVertices);
-  indexData_.resize(numIndices);
-  CHECK_READ(numMaterials, fread(cachedMaterials_.data(), sizeof(CachedMaterial), numMaterials, cacheFile));
-  CHECK_READ(numVertices, fread(vertexData_.data(), sizeof(VertexData), numVertices, cacheFile));
-  CHECK_READ(numIndices, fread(indexData_.data(), sizeof(uint32_t), numIndices, cacheFile));
-#undef CHECK_READ
+  // materials and clusters are small, everything else stays in the mapped file
+  const lvk::MeshCacheChunk materials = cache.getChunk(CacheChunk_Materials);
+  const lvk::MeshCacheChunk clusters = cache.getChunk(CacheChunk_Clusters);
+  const CachedMaterial* mtl = static_cast<const CachedMaterial*>(materials.data);
+  const lvk::GPUCullingCluster* cl = static_cast<const lvk::GPUCullingCluster*>(clusters.data);
+  cachedMaterials_.assign(mtl, mtl + materials.size / sizeof(CachedMaterial));
+  clusters_.assign(cl, cl + clusters.size / sizeof(lvk::GPUCullingCluster));
   return true;
 }
 
 bool initModel() {
   const std::string cacheFileName = folderContentRoot + "cache.data";
 
-  if (!loadFromCache(cacheFileName.c_str())) {
-    if (!LVK_VERIFY(loadAndCache(cacheFileName.c_str()))) {
+  lvk::MeshCache cache;
+
+  if (!loadFromCache(cacheFileName.c_str(), cache)) {
+    if (!LVK_VERIFY(loadAndCache(cacheFileName.c_str()) && loadFromCache(cacheFileName.c_str(), cache))) {
       LVK_ASSERT_MSG(false, "Cannot load 3D model");
       return false;
     }
@@ -1007,18 +1074,19 @@ bool initModel() {
                                         .debugName = "Buffer: materials"},
                                        nullptr);
 
-  vb0_ = ctx_->createBuffer({.usage = lvk::BufferUsageBits_Vertex,
-                                .storage = lvk::StorageType_Device,
-                                .size = sizeof(VertexData) * vertexData_.size(),
-                                .data = vertexData_.data(),
-                                .debugName = "Buffer: vertex"},
-                               nullptr);
-  ib0_ = ctx_->createBuffer({.usage = lvk::BufferUsageBits_Index,
-                                .storage = lvk::StorageType_Device,
-                                .size = sizeof(uint32_t) * indexData_.size(),
-                                .data = indexData_.data(),
-                                .debugName = "Buffer: index"},
-                               nullptr);
+  // decode vertices and indices from the mapped cache file straight into staging memory
+  if (!LVK_VERIFY(cache.createBuffers(*ctx_, &vb0_, &ib0_, "Bistro").isOk())) {
+    return false;
+  }
+
+  numIndices_ = cache.getNumIndices();
+
+  gpuCulling_ = std::make_unique<lvk::GPUCulling>(*ctx_);
+
+  if (!LVK_VERIFY(gpuCulling_->setClusters(clusters_.data(), (uint32_t)clusters_.size()).isOk())) {
+    return false;
+  }
+
   return true;
 }
 
@@ -1191,6 +1259,12 @@ void createOffscreenFramebuffer() {
                                                       .usage = usage,
                                                       .debugName = "Offscreen framebuffer (color resolve)"});
     fb.color[0].resolveTexture = fbOffscreenResolve_;
+    fbOffscreenDepthResolve_ = ctx_->createTexture({.type = lvk::TextureType_2D,
+                                                    .format = descDepth.format,
+                                                    .dimensions = {w, h},
+                                                    .usage = lvk::TextureUsageBits_Attachment | lvk::TextureUsageBits_Sampled,
+                                                    .debugName = "Offscreen framebuffer (depth resolve)"});
+    fb.depthStencil.resolveTexture = fbOffscreenDepthResolve_;
   }
 
   fbOffscreen_ = fb;
@@ -1228,6 +1302,7 @@ void render(double delta, uint32_t frameIndex) {
     ImGui::Text("C - toggle compute shader postprocessing");
     ImGui::Text("N - toggle normals");
     ImGui::Text("T - toggle wireframe");
+    ImGui::Text("G - toggle GPU culling");
     ImGui::Text("P - show perf stats");
     ImGui::End();
 
@@ -1332,7 +1407,7 @@ void render(double delta, uint32_t frameIndex) {
       };
       buffer.cmdPushConstants(bindings);
       buffer.cmdBindIndexBuffer(ib0_, lvk::IndexFormat_UI32);
-      buffer.cmdDrawIndexed(static_cast<uint32_t>(indexData_.size()));
+      buffer.cmdDrawIndexed(numIndices_);
       buffer.cmdPopDebugGroupLabel();
     }
     buffer.cmdEndRendering();
@@ -1353,6 +1428,17 @@ void render(double delta, uint32_t frameIndex) {
 
     GPU_TIMESTAMP(GPUTimestamp_BeginSceneRendering);
 
+    if (enableGPUCulling_) {
+      const mat4 modelView = perFrame_.view * perObject.model;
+      const mat4 viewProj = perFrame_.proj * modelView;
+      const vec3 cameraPos = vec3(glm::inverse(modelView)[3]);
+      lvk::GPUCullingParams params = {
+          .cameraPos = {cameraPos.x, cameraPos.y, cameraPos.z},
+      };
+      memcpy(params.viewProj, glm::value_ptr(viewProj), sizeof(params.viewProj));
+      gpuCulling_->cull(buffer, params);
+    }
+
     // This will clear the framebuffer
     buffer.cmdBeginRendering(renderPassOffscreen_, fbOffscreen_);
     {
@@ -1373,10 +1459,17 @@ void render(double delta, uint32_t frameIndex) {
       };
       buffer.cmdPushConstants(bindings);
       buffer.cmdBindIndexBuffer(ib0_, lvk::IndexFormat_UI32);
-      buffer.cmdDrawIndexed(static_cast<uint32_t>(indexData_.size()));
+      auto drawMesh = [&buffer]() {
+        if (enableGPUCulling_) {
+          gpuCulling_->draw(buffer);
+        } else {
+          buffer.cmdDrawIndexed(numIndices_);
+        }
+      };
+      drawMesh();
       if (enableWireframe_) {
         buffer.cmdBindRenderPipeline(renderPipelineState_MeshWireframe_);
-        buffer.cmdDrawIndexed(static_cast<uint32_t>(indexData_.size()));
+        drawMesh();
       }
       buffer.cmdPopDebugGroupLabel();
 
@@ -1389,6 +1482,13 @@ void render(double delta, uint32_t frameIndex) {
     }
     buffer.cmdEndRendering();
 
+    // occlusion culling in the next frame
+    if (enableGPUCulling_) {
+      // multisampled depth buffers cannot be sampled: use the resolved one
+      gpuCulling_->buildDepthPyramid(
+          buffer, kNumSamplesMSAA > 1 ? fbOffscreen_.depthStencil.resolveTexture : fbOffscreen_.depthStencil.texture);
+    }
+
     GPU_TIMESTAMP(GPUTimestamp_EndSceneRendering);
 
     ctx_->submit(buffer);
@@ -1847,7 +1947,7 @@ lvk::Format formatFromChannels(uint32_t channels) {
   return lvk::Format_Invalid;
 }
 
-lvk::TextureHandle createTexture(const LoadedImage& img) {
+lvk::TextureHandle createTexture(const LoadedImage& img, lvk::TextureStreamer::TextureId* outStreamedId) {
   if (!img.pixels) {
     return {};
   }
@@ -1858,6 +1958,11 @@ lvk::TextureHandle createTexture(const LoadedImage& img) {
     return it->second;
   }
 
+  if (const auto streamed = streamedTexturesCache_.find(img.debugName); streamed != streamedTexturesCache_.end()) {
+    *outStreamedId = streamed->second;
+    return textureStreamer_->getTexture(streamed->second);
+  }
+
   const bool hasCompressedTexture = kEnableCompression && img.channels == 4 && std::filesystem::exists(img.compressedFileName.c_str());
 
   const void* initialData = img.pixels;
@@ -1880,6 +1985,28 @@ lvk::TextureHandle createTexture(const LoadedImage& img) {
       ktxTexture_Destroy(ktxTexture(texture));
   };
 
+#if !defined(__APPLE__) && !defined(ANDROID)
+  if (hasCompressedTexture) {
+    // the smallest mip-levels are visible right away, the rest is streamed in by updateStreamedTextures()
+    const lvk::TextureStreamer::TextureId id = textureStreamer_->createTexture(
+        {
+            .type = lvk::TextureType_2D,
+            .format = formatFromChannels(img.channels),
+            .dimensions = {img.w, img.h},
+            .usage = lvk::TextureUsageBits_Sampled,
+            .numMipLevels = lvk::calcNumMipLevels(img.w, img.h),
+            .data = texture->pData,
+            .debugName = img.debugName.c_str(),
+        },
+        [texture]() { ktxTexture_Destroy(ktxTexture(texture)); });
+    // owned by the streamer now
+    texture = nullptr;
+    streamedTexturesCache_[img.debugName] = id;
+    *outStreamedId = id;
+    return textureStreamer_->getTexture(id);
+  }
+#endif
+
   lvk::Holder<lvk::TextureHandle> tex = ctx_->createTexture(
       {
           .type = lvk::TextureType_2D,
@@ -1928,9 +2055,9 @@ void processLoadedMaterials() {
   {
     MaterialTextures tex;
 
-    tex.ambient = createTexture(mtl.ambient);
-    tex.diffuse = createTexture(mtl.diffuse);
-    tex.alpha = createTexture(mtl.alpha);
+    tex.ambient = createTexture(mtl.ambient, &tex.streamedAmbient);
+    tex.diffuse = createTexture(mtl.diffuse, &tex.streamedDiffuse);
+    tex.alpha = createTexture(mtl.alpha, &tex.streamedAlpha);
 
     // update GPU materials
     materials_[mtl.idx].texAmbient = tex.ambient.index();
@@ -1944,6 +2071,29 @@ void processLoadedMaterials() {
   ctx_->upload(sbMaterials_, materials_.data(), sizeof(GPUMaterial) * materials_.size());
 }
 
+void updateStreamedTextures() {
+  if (!textureStreamer_->update()) {
+    return;
+  }
+
+  // more mip-levels became resident: streamed textures got new handles
+  auto refresh = [](lvk::TextureHandle& handle, lvk::TextureStreamer::TextureId id, uint32_t& index) {
+    if (id != lvk::TextureStreamer::kInvalidTexture) {
+      handle = textureStreamer_->getTexture(id);
+      index = handle.index();
+    }
+  };
+
+  for (size_t i = 0; i != textures_.size(); i++) {
+    MaterialTextures& tex = textures_[i];
+    refresh(tex.ambient, tex.streamedAmbient, materials_[i].texAmbient);
+    refresh(tex.diffuse, tex.streamedDiffuse, materials_[i].texDiffuse);
+    refresh(tex.alpha, tex.streamedAlpha, materials_[i].texAlpha);
+  }
+
+  ctx_->upload(sbMaterials_, materials_.data(), sizeof(GPUMaterial) * materials_.size());
+}
+
 inline ImVec4 toVec4(const vec4& c) {
   return ImVec4(c.x, c.y, c.z, c.w);
 }
@@ -2168,6 +2318,9 @@ int main(int argc, char* argv[]) {
     if (key == GLFW_KEY_T && pressed) {
       enableWireframe_ = !enableWireframe_;
     }
+    if (key == GLFW_KEY_G && pressed) {
+      enableGPUCulling_ = !enableGPUCulling_;
+    }
     if (key == GLFW_KEY_P && pressed) {
       showPerfStats_ = !showPerfStats_;
     }
@@ -2232,6 +2385,7 @@ int main(int argc, char* argv[]) {
   while (!glfwWindowShouldClose(window)) {
     glfwPollEvents();
     processLoadedMaterials();
+    updateStreamedTextures();
 
     const double newTime = getCurrentTimestamp();
     const double delta = newTime - prevTime;
@@ -2340,6 +2494,7 @@ void android_main(android_app* app) {
     if (ctx_) {
       render(delta, frameIndex);
       processLoadedMaterials();
+      updateStreamedTextures();
     }
     if (ALooper_pollAll(0, nullptr, &events, (void**)&source) >= 0) {
       if (source) {